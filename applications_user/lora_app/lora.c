@@ -3,7 +3,11 @@ Code porting from LoRa library https://github.dev/thekakester/Arduino-LoRa-Sx126
 */
 
 #include <furi.h>
-#include <furi_hal.h>
+
+#include "lora_hal.h"
+#include "lora_notify.h"
+#include "lora_perf.h"
+#include "lora_trace.h"
 
 #define TAG "LORA"
 
@@ -13,6 +17,7 @@ Code porting from LoRa library https://github.dev/thekakester/Arduino-LoRa-Sx126
 #define PRESET_FAST      2
 
 #define REG_LR_SYNCWORD     0x0740
+#define REG_IQ_POLARITY     0x0736 // Datasheet 15.4, IQ polarity errata
 #define RADIO_READ_REGISTER 0x1D
 
 #define REG_RFFrequency31_24 0x088B
@@ -22,19 +27,14 @@ Code porting from LoRa library https://github.dev/thekakester/Arduino-LoRa-Sx126
 
 #define FREQ_STEP 0.95367431640625
 
-static uint32_t timeout = 1000;
-//static uint32_t timeout = 100;
-
-FuriHalSpiBusHandle spi_handle;
-const FuriHalSpiBusHandle* spi = &spi_handle;
+#define LDRO_SYMBOL_US 16380 // LowDataRateOptimize from this symbol time on, see lowDataRateFor
 
-const GpioPin* const pin_beacon = &gpio_swclk;
-const GpioPin* const pin_nss0 = &gpio_ext_pa4;
-const GpioPin* const pin_nss1 = &gpio_ext_pc0;
-const GpioPin* const pin_reset = &gpio_ext_pc1;
-const GpioPin* const pin_ant_sw = &gpio_usart_tx;
-const GpioPin* const pin_busy = &gpio_usart_rx;
-const GpioPin* const pin_dio1 = &gpio_ext_pc3;
+//Radio watchdog, see radioWatchdog
+#define WATCHDOG_MAX_FAULTS 3 // Consecutive BUSY timeouts or SPI failures before a reset
+#define WATCHDOG_IDLE_MS    30000 // Receiving without an interrupt for this long checks the radio
+#define WATCHDOG_RETRY_MS   2000 // Time between two reset attempts while the radio is lost
+#define TX_DONE_MARGIN_MS   100 // Waited for TxDone past the time on air of the packet
+#define CLEAR_IRQ_TRIES     WATCHDOG_MAX_FAULTS // ClearIrqStatus sent before DIO1 counts as stuck
 
 bool inReceiveMode = false;
 uint8_t spiBuff[32]; //Buffer for sending SPI commands to radio
@@ -46,12 +46,35 @@ uint8_t codingRate;
 uint8_t spreadingFactor;
 uint16_t syncWord;
 uint8_t lowDataRateOptimize;
-uint32_t transmitTimeout; //Worst-case transmit time depends on some factors
+int8_t txPower = 22; //dBm, -9 to +22
+uint8_t rampTime = 0x02; //PA ramp time code, 0x02 = 40us
+bool configPreloaded = false; //Config variables were set by configPreload before begin
+
+//Packet parameters used by both receive and transmit, set with setPacketParams
+uint16_t packetPreamble = 12; //Preamble length in symbols, also the app's default
+uint8_t packetHeaderType = 0x00; //0x00 = Variable Len, 0x01 = Fixed Length
+uint8_t packetPayloadLength = 0xFF; //Payload length received with a fixed length header
+uint8_t packetCRC = 0x00; //0x00 = Off, 0x01 = On
+uint8_t packetInvertIQ = 0x00; //0x00 = Standard, 0x01 = Inverted
+uint8_t packetParamsSent[6]; //Last SetPacketParameters arguments sent to the radio
+bool packetParamsValid = false; //packetParamsSent holds what the radio is using
 
 int rssi = 0;
 int snr = 0;
 int signalRssi = 0;
 
+//Radio watchdog state
+uint8_t busyTimeouts = 0; //Consecutive BUSY waits that timed out
+uint8_t spiFailures = 0; //Consecutive SPI commands that failed
+uint32_t lastIrqTick = 0; //Last interrupt, or when receive mode was entered
+uint32_t outageStartTick = 0; //When the current outage was detected, 0 if there is none
+uint32_t lastRecoveryTick = 0; //Last reset attempt
+uint32_t radioOutages = 0; //Outages recovered from
+uint32_t radioRecoveryMs = 0; //Total time spent in those outages
+
+bool configSetSyncWord(uint16_t sw);
+uint32_t getTimeOnAir(uint8_t payloadLen);
+
 // test
 void abandone() {
     FURI_LOG_E(TAG, "abandon hope all ye who enter here");
@@ -61,23 +84,48 @@ int16_t getRSSI() {
     return rssi;
 }
 
-void checkBusy() {
-    uint8_t busy_timeout_cnt;
-    busy_timeout_cnt = 0;
+int8_t getSNR() {
+    return snr;
+}
 
-    furi_hal_gpio_init_simple(pin_busy, GpioModeInput);
+/* Frequency the radio is set to, in Hz */
+uint32_t getFrequency() {
+    return ((uint64_t)pllFrequency * 32000000) >> 25; // Inverse of frequencyToPLL
+}
 
-    while(furi_hal_gpio_read(pin_busy)) {
-        furi_delay_ms(1);
-        busy_timeout_cnt++;
+/* Send one SPI command to the radio, command holds the opcode followed by its parameters.
+Everything the driver writes goes through here or through the lora_hal functions directly.
+Returns FALSE if the SPI transfer failed.
+*/
+static bool radioCommand(const uint8_t* command, size_t size) {
+    LORA_PERF_BEGIN(perf);
+    lora_hal_select();
+    bool success = lora_hal_spi_write(command, size);
+    lora_hal_deselect();
+    LORA_PERF_END(lora_perf_opcode_probe(command[0]), perf);
+    lora_trace_record(command[0], command + 1, size - 1);
 
-        if(busy_timeout_cnt > 10) //wait 10mS for busy to complete
-        {
-            busy_timeout_cnt = 0;
-            FURI_LOG_E(TAG, "ERROR - Busy Timeout!");
-            break;
-        }
+    if(!success) {
+        FURI_LOG_E(TAG, "FAILED - SPI command 0x%02X failed.", command[0]);
+        spiFailures++;
+    } else {
+        spiFailures = 0;
     }
+    return success;
+}
+
+void checkBusy() {
+    LORA_PERF_BEGIN(perf);
+    uint32_t busyStart = lora_trace_busy_begin();
+
+    if(!lora_hal_wait_ready(10)) { //wait 10mS for busy to complete
+        FURI_LOG_E(TAG, "ERROR - Busy Timeout!");
+        busyTimeouts++;
+    } else {
+        busyTimeouts = 0;
+    }
+    LORA_PERF_END(LoRaPerfProbeBusyWait, perf);
+    lora_trace_busy_end(busyStart);
 }
 
 void readRegisters(uint16_t address, uint8_t* buffer, uint16_t size) {
@@ -88,23 +136,41 @@ void readRegisters(uint16_t address, uint8_t* buffer, uint16_t size) {
     addr_l = address & 0x00FF;
     checkBusy();
 
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-
-    furi_hal_spi_acquire(spi);
+    lora_hal_select();
 
     spiBuff[0] = RADIO_READ_REGISTER;
     spiBuff[1] = addr_h;
     spiBuff[2] = addr_l;
     spiBuff[3] = 0x00;
 
-    furi_hal_spi_bus_tx(spi, spiBuff, 4, timeout);
+    lora_hal_spi_write(spiBuff, 4);
 
     for(index = 0; index < size; index++) {
-        furi_hal_spi_bus_rx(spi, buffer + index, 1, timeout);
+        lora_hal_spi_exchange(buffer + index, 1);
     }
 
-    furi_hal_spi_release(spi);
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+    lora_hal_deselect();
+
+    // Trace the address followed by the first values read
+    spiBuff[3] = size > 0 ? buffer[0] : 0x00;
+    spiBuff[4] = size > 1 ? buffer[1] : 0x00;
+    lora_trace_record(RADIO_READ_REGISTER, spiBuff + 1, size + 3);
+}
+
+/* Trace a WriteBuffer or ReadBuffer.  The length counts the offset and dummy bytes like the
+other transactions, but the payload is kept instead of them since it is more useful.  It is
+copied first, the payload can be shorter than the bytes the trace keeps.
+*/
+static void traceBufferTransfer(
+    uint8_t opcode,
+    const uint8_t* payload,
+    size_t payloadLen,
+    size_t headerLen) {
+    uint8_t kept[4] = {0};
+    if(payloadLen > 0) {
+        memcpy(kept, payload, payloadLen < sizeof(kept) ? payloadLen : sizeof(kept));
+    }
+    lora_trace_record(opcode, kept, payloadLen + headerLen);
 }
 
 uint8_t readRegister(uint16_t address) {
@@ -114,6 +180,17 @@ uint8_t readRegister(uint16_t address) {
     return data;
 }
 
+void writeRegister(uint16_t address, uint8_t value) {
+    checkBusy();
+
+    spiBuff[0] = 0x0D; // WriteRegister opcode
+    spiBuff[1] = address >> 8;
+    spiBuff[2] = address & 0x00FF;
+    spiBuff[3] = value;
+
+    radioCommand(spiBuff, 4);
+}
+
 uint32_t getFreqInt() {
     //get the current set device frequency from registers, return as long integer
 
@@ -180,20 +257,14 @@ uint32_t frequencyToPLL(long rfFreq) {
 //You must set this->pllFrequency before calling this
 void updateRadioFrequency() {
     // Set PLL frequency (this is a complicated math equation. See datasheet entry for SetRfFrequency)
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
     spiBuff[0] = 0x86; //Opcode for set RF Frequencty
     spiBuff[1] = (pllFrequency >> 24) & 0xFF; //MSB of pll frequency
     spiBuff[2] = (pllFrequency >> 16) & 0xFF; //
     spiBuff[3] = (pllFrequency >> 8) & 0xFF; //
     spiBuff[4] = (pllFrequency >> 0) & 0xFF; //LSB of requency
-    furi_hal_spi_bus_tx(spi, spiBuff, 5, timeout);
-
-    furi_hal_spi_release(spi);
+    radioCommand(spiBuff, 5);
 
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-    furi_delay_ms(100); // Give time for the radio to process command
+    checkBusy(); // Wait for the radio to process the command
 }
 
 /** (Optional) Set the operating frequency of the radio.
@@ -231,8 +302,6 @@ void updateModulationParameters() {
     // on a radio frequency monitor.
     // You just MUST call "setModulationParameters", otherwise the radio won't work at all
 
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-
     spiBuff[0] = 0x8B; // Opcode for "SetModulationParameters"
     spiBuff[1] =
         spreadingFactor; // ModParam1 = Spreading Factor.  Can be SF5-SF12, written in hex (0x05-0x0C)
@@ -241,51 +310,10 @@ void updateModulationParameters() {
     spiBuff[3] =
         codingRate; // ModParam3 = CodingRate.  Semtech recommends CR_4_5 (which is 0x01).  Options are 0x01-0x04, which correspond to coding rate 5-8 respectively
     spiBuff[4] =
-        lowDataRateOptimize; // LowDataRateOptimize.  0x00 = 0ff, 0x01 = On.  Required to be on for SF11 + SF12
-
-    furi_hal_spi_acquire(spi);
+        lowDataRateOptimize; // LowDataRateOptimize.  0x00 = 0ff, 0x01 = On.  See lowDataRateFor
 
-    if(furi_hal_spi_bus_tx(
-           spi, spiBuff, 5, timeout)) { // Assuming 'timeout' is defined somewhere in the code
-        furi_hal_spi_release(spi);
-    } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
-    }
-
-    //furi_hal_spi_release(spi);
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-    furi_delay_ms(100); // Give time for the radio to process command
-
-    // Determine transmit timeout based on spreading factor
-    // TODO:
-    // TIMEOUT SET TO 1000, STILL CHECKING HOW TO FIX
-    switch(spreadingFactor) {
-    case 12:
-        transmitTimeout = 1000; // 252000; // Actual tx time 126 seconds
-        break;
-    case 11:
-        transmitTimeout = 1000; // 160000; // Actual tx time 81 seconds
-        break;
-    case 10:
-        transmitTimeout = 1000; // 60000; // Actual tx time 36 seconds
-        break;
-    case 9:
-        transmitTimeout = 1000; // 40000; // Actual tx time 20 seconds
-        break;
-    case 8:
-        transmitTimeout = 1000; // 20000; // Actual tx time 11 seconds
-        break;
-    case 7:
-        transmitTimeout = 1000; // 12000; // Actual tx time 6.3 seconds
-        break;
-    case 6:
-        transmitTimeout = 1000; // 7000; // Actual tx time 3.7s seconds
-        break;
-    default: // SF5
-        transmitTimeout = 1000; //5000; // Actual tx time 2.2 seconds
-        break;
-    }
+    radioCommand(spiBuff, 5);
+    checkBusy(); // Wait for the radio to process the command
 }
 
 /**(Optional) Use one of the pre-made radio configurations
@@ -332,138 +360,119 @@ bool configSetPreset(int preset) {
     return false;
 }
 
+/* Optimal PA settings for the SX1262, see datasheet table 13-21.
+Each row is the smallest PA configuration that reaches maxPower with SetTxParams at +22 dBm,
+lower powers reuse the row and back off the SetTxParams power by the difference.
+currentMa is the typical supply current at maxPower (datasheet table 3-5, DC-DC on, 3.3 V).
+*/
+static const struct {
+    int8_t maxPower;
+    uint8_t paDutyCycle;
+    uint8_t hpMax;
+    uint8_t currentMa;
+} paOptimal[] = {
+    {14, 0x02, 0x02, 45},
+    {17, 0x02, 0x03, 90},
+    {20, 0x03, 0x05, 102},
+    {22, 0x04, 0x07, 118},
+};
+
+#define PA_SUPPLY_MV 3300
+
+/* Row of paOptimal used for a TX power */
+static uint8_t paOptimalIndex(int8_t power) {
+    uint8_t i = 0;
+    while(i < COUNT_OF(paOptimal) - 1 && paOptimal[i].maxPower < power) {
+        i++;
+    }
+    return i;
+}
+
+/* Send SetPaConfig and SetTxParams for txPower and rampTime */
+static void writeTxPower() {
+    uint8_t row = paOptimalIndex(txPower);
+
+    // Set PA Config
+    // See datasheet 13.1.4 for descriptions and optimal settings recommendations
+    spiBuff[0] = 0x95; // Opcode for "SetPaConfig"
+    spiBuff[1] = paOptimal[row].paDutyCycle; // paDutyCycle. Set in conjunction with hpMax
+    spiBuff[2] = paOptimal[row].hpMax; // hpMax. 0x00-0x07 where 0x07 is max power
+    spiBuff[3] = 0x00; // device select: 0x00 = SX1262, 0x01 = SX1261
+    spiBuff[4] = 0x01; // paLut (reserved, always set to 1)
+
+    radioCommand(spiBuff, 5);
+    checkBusy(); // Wait for the radio to process the command
+
+    // Set TX Params
+    // See datasheet 13.4.4 for details
+    spiBuff[0] = 0x8E; // Opcode for SetTxParams
+    spiBuff[1] = (uint8_t)(22 - (paOptimal[row].maxPower - txPower)); // -9(0xF7) to 22(0x16)
+    spiBuff[2] = rampTime; // Ramp time. Lookup table. See table 13-41. 0x02="40uS"
+
+    radioCommand(spiBuff, 3);
+    checkBusy(); // Wait for the radio to process the command
+}
+
 /*Send the bare-bones required commands needed for radio to run.
 * Do not set custom or optional commands here, please keep this section as simplified as possible.
 * Essential commands are found by reading the datasheet
 */
 void configureRadioEssentials() {
-    // Tell DIO2 to control the RF switch so we don't have to do it manually
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-
-    furi_hal_spi_acquire(spi);
+    packetParamsValid = false; // The radio was reset, its packet parameters are unknown
 
+    // Tell DIO2 to control the RF switch so we don't have to do it manually
     spiBuff[0] = 0x9D; //Opcode for "SetDIO2AsRfSwitchCtrl"
     spiBuff[1] = 0x01; //Enable
 
-    if(furi_hal_spi_bus_tx(spi, spiBuff, 2, timeout)) {
-        furi_hal_spi_release(spi);
-    } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
-    }
-
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-    furi_delay_ms(100); // Give time for the radio to process command
+    radioCommand(spiBuff, 2);
+    checkBusy(); // Wait for the radio to process the command
 
     // Just a single SPI command to set the frequency, but it's broken out
     // into its own function so we can call it on-the-fly when the config changes
-    configSetFrequency(915000000); // Set default frequency to 915mhz
+    if(configPreloaded) {
+        updateRadioFrequency(); // Frequency chosen with configPreload
+    } else {
+        configSetFrequency(915000000); // Set default frequency to 915mhz
+    }
 
     // Set modem to LoRa (described in datasheet section 13.4.2)
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
     spiBuff[0] = 0x8A; // Opcode for "SetPacketType"
     spiBuff[1] = 0x01; // Packet Type: 0x00=GFSK, 0x01=LoRa
 
-    if(furi_hal_spi_bus_tx(spi, spiBuff, 2, timeout)) {
-        furi_hal_spi_release(spi);
-    } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
-    }
-
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-    furi_delay_ms(100); // Give time for radio to process the command
+    radioCommand(spiBuff, 2);
+    checkBusy(); // Wait for the radio to process the command
 
     // Set Rx Timeout to reset on SyncWord or Header detection
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
     spiBuff[0] = 0x9F; // Opcode for "StopTimerOnPreamble"
     spiBuff[1] = 0x00; // Stop timer on: 0x00=SyncWord or header detection, 0x01=preamble detection
 
-    if(furi_hal_spi_bus_tx(spi, spiBuff, 2, timeout)) {
-        furi_hal_spi_release(spi);
-    } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
-    }
-
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-    furi_delay_ms(100); // Give time for radio to process the command
+    radioCommand(spiBuff, 2);
+    checkBusy(); // Wait for the radio to process the command
 
     // Set modulation parameters is just one more SPI command, but since it
     // is often called frequently when changing the radio config, it's broken up into its own function
-    configSetPreset(PRESET_DEFAULT); // Sets default modulation parameters
-
-    // Set PA Config
-    // See datasheet 13.1.4 for descriptions and optimal settings recommendations
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
-    spiBuff[0] = 0x95; // Opcode for "SetPaConfig"
-    spiBuff[1] = 0x04; // paDutyCycle. See datasheet, set in conjunction with hpMax
-    spiBuff[2] = 0x07; // hpMax. Basically Tx power. 0x00-0x07 where 0x07 is max power
-    spiBuff[3] = 0x00; // device select: 0x00 = SX1262, 0x01 = SX1261
-    spiBuff[4] = 0x01; // paLut (reserved, always set to 1)
-
-    if(furi_hal_spi_bus_tx(spi, spiBuff, 5, timeout)) {
-        furi_hal_spi_release(spi);
+    if(configPreloaded) {
+        updateModulationParameters(); // Modulation chosen with configPreload
     } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
+        configSetPreset(PRESET_DEFAULT); // Sets default modulation parameters
     }
 
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-    furi_delay_ms(100); // Give time for radio to process the command
-
-    // Set TX Params
-    // See datasheet 13.4.4 for details
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
-    spiBuff[0] = 0x8E; // Opcode for SetTxParams
-    spiBuff[1] =
-        22; // Power. Can be -17(0xEF) to +14x0E in Low Pow mode. -9(0xF7) to 22(0x16) in high power mode
-    spiBuff[2] = 0x02; // Ramp time. Lookup table. See table 13-41. 0x02="40uS"
-
-    if(furi_hal_spi_bus_tx(spi, spiBuff, 3, timeout)) {
-        furi_hal_spi_release(spi);
-    } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
-    }
-
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-    furi_delay_ms(100); // Give time for radio to process the command
+    // PA configuration and TX power, see writeTxPower
+    writeTxPower();
 
     // Set LoRa Symbol Number timeout
     // How many symbols are needed for a good receive.
     // Symbols are preamble symbols
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
     spiBuff[0] = 0xA0; // Opcode for "SetLoRaSymbNumTimeout"
     spiBuff[1] = 0x00; // Number of symbols. Ping-pong example from Semtech uses 5
 
-    if(furi_hal_spi_bus_tx(spi, spiBuff, 2, timeout)) {
-        furi_hal_spi_release(spi);
-    } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
-    }
-
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-    furi_delay_ms(100); // Give time for radio to process the command
+    radioCommand(spiBuff, 2);
+    checkBusy(); // Wait for the radio to process the command
 
     // Enable interrupts
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
     spiBuff[0] = 0x08; // 0x08 is the opcode for "SetDioIrqParams"
     spiBuff[1] = 0x00; // IRQMask MSB. IRQMask is "what interrupts are enabled"
-    spiBuff[2] = 0x02; // IRQMask LSB See datasheet table 13-29 for details
+    spiBuff[2] = 0x03; // IRQMask LSB, RxDone and TxDone. See datasheet table 13-29
     spiBuff[3] =
         0xFF; // DIO1 mask MSB. Of the interrupts detected, which should be triggered on DIO1 pin
     spiBuff[4] = 0xFF; // DIO1 Mask LSB
@@ -472,64 +481,73 @@ void configureRadioEssentials() {
     spiBuff[7] = 0x00; // DIO3 Mask MSB
     spiBuff[8] = 0x00; // DIO3 Mask LSB
 
-    if(furi_hal_spi_bus_tx(spi, spiBuff, 9, timeout)) {
-        furi_hal_spi_release(spi);
-    } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
-    }
+    radioCommand(spiBuff, 9);
+    checkBusy(); // Wait for the radio to process the command
 
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-    furi_delay_ms(100); // Give time for radio to process the command
+    // The radio powers up with the private sync word, only a preloaded one needs writing
+    if(configPreloaded) {
+        configSetSyncWord(syncWord);
+    }
 }
 
+/* Wait until the radio has processed the last command, BUSY goes low when it is done.
+The BUSY interrupt wakes us up, so this returns as soon as the radio is ready instead of on a
+polling grid.  Returns FALSE if the radio is still busy after timeout milliseconds.
+*/
 bool waitForRadioCommandCompletion(uint32_t timeout) {
-    uint32_t startTime = furi_get_tick(); // Get the start time in ticks
-    bool dataTransmitted = false;
+    LORA_PERF_BEGIN(perf);
+    uint32_t busyStart = lora_trace_busy_begin();
 
-    // Keep checking the radio status until the operation is completed
-    while(!dataTransmitted) {
-        // Wait a while between SPI status queries to avoid reading too quickly
-        furi_delay_ms(5);
+    bool ready = lora_hal_wait_ready(timeout);
+    busyTimeouts = ready ? 0 : busyTimeouts + 1;
 
-        // Request a status update from the radio
-        furi_hal_gpio_write(pin_nss1, false); // Enable the radio chip-select
-        furi_hal_spi_acquire(spi);
-
-        spiBuff[0] = 0xC0; // Opcode for the "getStatus" command
-        spiBuff[1] = 0x00; // Dummy byte, status will overwrite this byte
-
-        furi_hal_spi_bus_tx(spi, spiBuff, 2, timeout);
-
-        furi_hal_spi_release(spi);
-        furi_hal_gpio_write(pin_nss1, true); // Disable the radio chip-select
+    LORA_PERF_END(LoRaPerfProbeCommandWait, perf);
+    lora_trace_busy_end(busyStart);
+    return ready;
+}
 
-        // Parse the status
-        uint8_t chipMode = (spiBuff[1] >> 4) & 0x07; // Chip mode is bits [6:4] (3-bits)
-        uint8_t commandStatus = (spiBuff[1] >> 1) & 0x07; // Command status is bits [3:1] (3-bits)
+/* Clear every pending interrupt, DIO1 goes back low */
+static void clearInterrupts() {
+    spiBuff[0] = 0x02; //Opcode for ClearIRQStatus command
+    spiBuff[1] = 0xFF; //IRQ bits to clear (MSB) (0xFFFF means clear all interrupts)
+    spiBuff[2] = 0xFF; //IRQ bits to clear (LSB)
 
-        // Check if the operation has finished
-        //Status 0, 1, 2 mean we're still busy.  Anything else means we're done.
-        //Commands 3-6 = command timeout, command processing error, failure to execute command, and Tx Done (respoectively)
-        if(commandStatus != 0 && commandStatus != 1 && commandStatus != 2) {
-            dataTransmitted = true;
-            FURI_LOG_E(TAG, "DATA TRANSMITTED");
-        }
+    radioCommand(spiBuff, 3);
+}
 
-        // If we are in standby mode, there's no need to wait anymore
-        if(chipMode == 0x03 || chipMode == 0x02) {
-            dataTransmitted = true;
-            FURI_LOG_E(TAG, "DATA TRANSMITTED STANBY MODE");
-        }
+/* Wait for an interrupt enabled by SetDioIrqParams (TxDone for transmit) and clear it, so DIO1
+is low again for lora_receive_async.  Returns FALSE if nothing was raised before the timeout.
+*/
+static bool waitForInterrupt(uint32_t timeout) {
+    bool raised = lora_hal_wait_dio1(timeout);
+    clearInterrupts();
+    return raised;
+}
 
-        // Prevent infinite loop by implementing a timeout
-        if((furi_get_tick() - startTime) >= furi_ms_to_ticks(timeout)) {
-            return false;
-        }
+/* Bandwidth in Hz for each bandwidth setting, indexed by the register value (0x07 is unused) */
+static const uint32_t bandwidthHz[] = {
+    7810, // 0x00
+    15630, // 0x01
+    31250, // 0x02
+    62500, // 0x03
+    125000, // 0x04
+    250000, // 0x05
+    500000, // 0x06
+    0, // 0x07
+    10420, // 0x08
+    20830, // 0x09
+    41670, // 0x0A
+};
+
+/* LowDataRateOptimize for a spreading factor and bandwidth setting.  The datasheet asks for it
+when a symbol (2^SF / BW) lasts 16.38 ms or more: SF11 at 125 kHz needs it, SF11 at 250 kHz
+(Meshtastic LongFast) must not have it, or the payload is coded differently from the other radios.
+*/
+static uint8_t lowDataRateFor(int sf, int bw) {
+    if(bw < 0 || bw >= (int)COUNT_OF(bandwidthHz) || bandwidthHz[bw] == 0) {
+        return 0;
     }
-
-    // Success!
-    return true;
+    return ((1000000ULL << sf) / bandwidthHz[bw] >= LDRO_SYMBOL_US) ? 1 : 0;
 }
 
 /* Set the bandwidth (basically, this is how big the frequency span is that we occupy)
@@ -555,6 +573,7 @@ bool configSetBandwidth(int bw) {
         return false;
     }
     bandwidth = bw;
+    lowDataRateOptimize = lowDataRateFor(spreadingFactor, bw);
     updateModulationParameters();
     return true;
 }
@@ -576,33 +595,24 @@ bool configSetSyncWord(uint16_t sw) {
     uint8_t lsb = sw & 0xFF;
 
     // Write MSB to 0x0740
-    furi_hal_gpio_write(pin_nss1, false); // CS low
-    furi_hal_spi_acquire(spi);
-
     spiBuff[0] = 0x0D; // WriteRegister opcode
     spiBuff[1] = 0x07; // Address high byte (0x0740)
     spiBuff[2] = 0x40; // Address low byte
     spiBuff[3] = msb; // Data
-    furi_hal_spi_bus_tx(spi, spiBuff, 4, timeout);
 
-    furi_hal_spi_release(spi);
-    furi_hal_gpio_write(pin_nss1, true); // CS high
+    radioCommand(spiBuff, 4);
 
     // Write LSB to 0x0741
-    furi_hal_gpio_write(pin_nss1, false); // CS low
-    furi_hal_spi_acquire(spi);
-
     spiBuff[0] = 0x0D; // WriteRegister opcode
     spiBuff[1] = 0x07; // Address high byte (0x0741)
     spiBuff[2] = 0x41; // Address low byte
     spiBuff[3] = lsb; // Data
-    furi_hal_spi_bus_tx(spi, spiBuff, 4, timeout);
 
-    furi_hal_spi_release(spi);
-    furi_hal_gpio_write(pin_nss1, true); // CS high
+    radioCommand(spiBuff, 4);
 
     furi_delay_ms(1); // give chip time
 
+    syncWord = sw;
     return true;
 }
 
@@ -612,12 +622,198 @@ bool configSetSpreadingFactor(int sf) {
     if(sf < 5 || sf > 12) {
         return false;
     }
-    lowDataRateOptimize = (sf >= 11) ? 1 : 0; // Turn on for SF11+SF12, turn off for anything else
+    lowDataRateOptimize = lowDataRateFor(sf, bandwidth);
     spreadingFactor = sf;
     updateModulationParameters();
     return true;
 }
 
+/* Check a configuration before any of it is stored: frequency within the SX1262 range, a
+bandwidth code the radio knows (there is no 0x07), SF5-SF12 and coding rate 4/5-4/8 (1-4).
+*/
+static bool configIsValid(long frequencyInHz, int bw, int sf, int cr) {
+    return frequencyInHz >= 150000000 && frequencyInHz <= 960000000 && bw >= 0 && bw <= 0x0A &&
+           bw != 7 && sf >= 5 && sf <= 12 && cr >= 1 && cr <= 4;
+}
+
+/* Retune the radio to a frequency, bandwidth and spreading factor in one go.
+Only the commands whose values differ from the current radio state are sent, so applying
+the same channel twice costs no SPI traffic at all.
+Returns FALSE (and changes nothing) if any of the values is invalid.
+*/
+bool configSetChannel(long frequencyInHz, int bw, int sf) {
+    if(!configIsValid(frequencyInHz, bw, sf, 1)) { // The coding rate is not changed
+        return false;
+    }
+
+    uint32_t pll = frequencyToPLL(frequencyInHz);
+    if(pll != pllFrequency) {
+        pllFrequency = pll;
+        updateRadioFrequency();
+    }
+
+    uint8_t ldro = lowDataRateFor(sf, bw);
+    if(bw != bandwidth || sf != spreadingFactor || ldro != lowDataRateOptimize) {
+        bandwidth = bw;
+        spreadingFactor = sf;
+        lowDataRateOptimize = ldro;
+        updateModulationParameters();
+    }
+
+    return true;
+}
+
+/* Switch to a whole radio configuration at once.
+Like configSetChannel, only the commands whose values differ from the current radio state are
+sent: at most one SetRfFrequency, one SetModulationParams and one sync word write, so the time
+a switch takes is bounded whatever the previous configuration was.
+Returns FALSE (and changes nothing) if any of the values is invalid.
+*/
+bool configApply(long frequencyInHz, int bw, int sf, int cr, uint16_t sw) {
+    if(!configIsValid(frequencyInHz, bw, sf, cr)) {
+        return false;
+    }
+
+    uint32_t pll = frequencyToPLL(frequencyInHz);
+    if(pll != pllFrequency) {
+        pllFrequency = pll;
+        updateRadioFrequency();
+    }
+
+    uint8_t ldro = lowDataRateFor(sf, bw);
+    if(bw != bandwidth || sf != spreadingFactor || cr != codingRate ||
+       ldro != lowDataRateOptimize) {
+        bandwidth = bw;
+        spreadingFactor = sf;
+        codingRate = cr;
+        lowDataRateOptimize = ldro;
+        updateModulationParameters();
+    }
+
+    if(sw != syncWord) {
+        configSetSyncWord(sw);
+    }
+
+    return true;
+}
+
+/* Choose the configuration begin() applies, instead of 915mhz and PRESET_DEFAULT.
+Nothing is sent to the radio here, configureRadioEssentials writes every value once during
+its setup pass, so restoring a saved configuration costs no extra SPI commands.
+Returns FALSE (and changes nothing) if any of the values is invalid.
+*/
+bool configPreload(long frequencyInHz, int bw, int sf, int cr, uint16_t sw) {
+    if(!configIsValid(frequencyInHz, bw, sf, cr)) {
+        return false;
+    }
+
+    pllFrequency = frequencyToPLL(frequencyInHz);
+    bandwidth = bw;
+    spreadingFactor = sf;
+    codingRate = cr;
+    lowDataRateOptimize = lowDataRateFor(sf, bw);
+    syncWord = sw;
+    configPreloaded = true;
+    return true;
+}
+
+/* Set the TX power in dBm (-9 to +22) and the PA ramp time code (0x00 = 10us to 0x07 = 3.4ms).
+The PA is configured with the datasheet's optimal paDutyCycle/hpMax pair for the power, which
+draws less current than running the full +22 dBm PA backed off.
+Returns FALSE (and changes nothing) if any of the values is invalid.
+*/
+bool configSetTxPower(int power, int ramp) {
+    if(power < -9 || power > 22 || ramp < 0 || ramp > 0x07) {
+        return false;
+    }
+    txPower = power;
+    rampTime = ramp;
+    writeTxPower();
+    return true;
+}
+
+/* Choose the TX power begin() applies, like configPreload.  Nothing is sent to the radio.
+Returns FALSE (and changes nothing) if any of the values is invalid.
+*/
+bool configPreloadTxPower(int power, int ramp) {
+    if(power < -9 || power > 22 || ramp < 0 || ramp > 0x07) {
+        return false;
+    }
+    txPower = power;
+    rampTime = ramp;
+    return true;
+}
+
+/* Send SetPacketParameters for the current packet parameters and a payload length.
+Nothing is sent if the radio already has exactly these values.
+*/
+static void writePacketParams(uint8_t payloadLength) {
+    uint8_t params[6] = {
+        packetPreamble >> 8, //Preamble Len MSB
+        packetPreamble & 0xFF, //Preamble Len LSB
+        packetHeaderType, //Header Type. 0x00 = Variable Len, 0x01 = Fixed Length
+        payloadLength, //Payload Length (Max is 255 bytes)
+        packetCRC, //CRC Type. 0x00 = Off, 0x01 = on
+        packetInvertIQ, //Invert IQ.  0x00 = Standard, 0x01 = Inverted
+    };
+
+    if(packetParamsValid && memcmp(params, packetParamsSent, sizeof(params)) == 0) {
+        return;
+    }
+    bool iqChanged = !packetParamsValid || params[5] != packetParamsSent[5];
+
+    spiBuff[0] = 0x8C; //Opcode for "SetPacketParameters"
+    memcpy(&spiBuff[1], params, sizeof(params));
+
+    radioCommand(spiBuff, 7);
+    waitForRadioCommandCompletion(100);
+
+    memcpy(packetParamsSent, params, sizeof(params));
+    packetParamsValid = true;
+
+    // Errata 15.4: with inverted IQ, bit 2 of 0x0736 must be cleared, otherwise set
+    if(iqChanged) {
+        uint8_t iqPolarity = readRegister(REG_IQ_POLARITY);
+        if(packetInvertIQ) {
+            iqPolarity &= ~(1 << 2);
+        } else {
+            iqPolarity |= (1 << 2);
+        }
+        writeRegister(REG_IQ_POLARITY, iqPolarity);
+    }
+}
+
+/* Choose the packet parameters begin() leaves the driver with, like configPreload.
+Nothing is sent to the radio, setModeReceive and transmit write them when they are first needed.
+*/
+void configPreloadPacketParams(
+    uint16_t preamble,
+    uint8_t headerType,
+    uint8_t payloadLength,
+    uint8_t crc,
+    uint8_t invertIQ) {
+    packetPreamble = preamble;
+    packetHeaderType = headerType;
+    packetPayloadLength = payloadLength;
+    packetCRC = crc;
+    packetInvertIQ = invertIQ;
+}
+
+/* Preamble length in symbols used for receive and transmit */
+uint16_t getPacketPreamble() {
+    return packetPreamble;
+}
+
+/* Payload length given to the radio while receiving */
+static uint8_t receivePayloadLength() {
+    // With a variable length header the length comes from the packet, accept up to the maximum
+    return packetHeaderType ? packetPayloadLength : 0xFF;
+}
+
+/* Set the packet parameters used to receive and transmit.
+packetParam3 is the payload length expected with a fixed length header, transmit() always sends
+the length of its data.  The radio is only updated if something changed.
+*/
 void setPacketParams(
     uint16_t packetParam1,
     uint8_t packetParam2,
@@ -625,37 +821,13 @@ void setPacketParams(
     uint8_t packetParam4,
     uint8_t packetParam5) {
     // Order is preamble, header type, packet length, CRC, IQ
+    packetPreamble = packetParam1;
+    packetHeaderType = packetParam2;
+    packetPayloadLength = packetParam3;
+    packetCRC = packetParam4;
+    packetInvertIQ = packetParam5;
 
-    uint8_t preambleMSB = packetParam1 >> 8;
-    uint8_t preambleLSB = packetParam1 & 0xFF;
-
-    //savedPacketParam1 = packetParam1;
-    //savedPacketParam2 = packetParam2;
-    //savedPacketParam3 = packetParam3;
-    //savedPacketParam4 = packetParam4;
-    //savedPacketParam5 = packetParam5;
-
-    spiBuff[0] = 0x8C; //Opcode for "SetPacketParameters"
-    spiBuff[1] = preambleMSB; //Preamble Len MSB
-    spiBuff[2] = preambleLSB; //Preamble Len LSB
-    spiBuff[3] = packetParam2; //Header Type. 0x00 = Variable Len, 0x01 = Fixed Length
-    spiBuff[4] = packetParam3; //Payload Length (Max is 255 bytes)
-    spiBuff[5] = packetParam4; //0x00 = Off, 0x01 = on
-    spiBuff[6] = packetParam5; //0x00 = Standard, 0x01 = Inverted
-
-    // Acquire SPI and write command
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
-    if(furi_hal_spi_bus_tx(spi, spiBuff, 7, timeout)) {
-        furi_hal_spi_release(spi);
-    } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
-    }
-
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-    waitForRadioCommandCompletion(100);
+    writePacketParams(receivePayloadLength());
 }
 
 //Sets the radio into receive mode, allowing it to listen for incoming packets.
@@ -666,53 +838,23 @@ void setModeReceive() {
         return;
     } // We're already in receive mode, this would do nothing
 
-    // Set packet parameters
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
-    spiBuff[0] = 0x8C; //Opcode for "SetPacketParameters"
-    spiBuff[1] = 0x00; //PacketParam1 = Preamble Len MSB
-    spiBuff[2] = 0x0C; //PacketParam2 = Preamble Len LSB
-    spiBuff[3] = 0x00; //PacketParam3 = Header Type. 0x00 = Variable Len, 0x01 = Fixed Length
-    spiBuff[4] = 0xFF; //PacketParam4 = Payload Length (Max is 255 bytes)
-    spiBuff[5] = 0x00; //PacketParam5 = CRC Type. 0x00 = Off, 0x01 = on
-    spiBuff[6] = 0x00; //PacketParam6 = Invert IQ.  0x00 = Standard, 0x01 = Inverted
-
-    if(furi_hal_spi_bus_tx(spi, spiBuff, 7, timeout)) {
-        furi_hal_spi_release(spi);
-    } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
-    }
-
-    //furi_hal_spi_release(spi);
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-
-    waitForRadioCommandCompletion(100);
+    // Set packet parameters, transmit() may have changed the payload length
+    writePacketParams(receivePayloadLength());
 
     // Tell the chip to wait for it to receive a packet.
     // Based on our previous config, this should throw an interrupt when we get a packet
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
     spiBuff[0] = 0x82; //0x82 is the opcode for "SetRX"
     spiBuff[1] = 0xFF; //24-bit timeout, 0xFFFFFF means no timeout
     spiBuff[2] = 0xFF; // ^^
     spiBuff[3] = 0xFF; // ^^
 
-    if(furi_hal_spi_bus_tx(spi, spiBuff, 4, timeout)) {
-        furi_hal_spi_release(spi);
-    } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
-    }
-
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+    radioCommand(spiBuff, 4);
 
     waitForRadioCommandCompletion(100);
 
     // Remember that we're in receive mode so we don't need to run this code again unnecessarily
     inReceiveMode = true;
+    lastIrqTick = furi_get_tick(); // The watchdog measures silence from here
 }
 
 /* Set radio into standby mode.
@@ -720,16 +862,10 @@ Switching directly from Rx to Tx mode can be slow, so we first want to go into s
 void setModeStandby() {
     // Tell the chip to wait for it to receive a packet.
     // Based on our previous config, this should throw an interrupt when we get a packet
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-
     spiBuff[0] = 0x80; //0x80 is the opcode for "SetStandby"
     spiBuff[1] = 0x01; //0x00 = STDBY_RC, 0x01=STDBY_XOSC
 
-    furi_hal_spi_acquire(spi);
-    furi_hal_spi_bus_tx(spi, spiBuff, 2, timeout);
-    furi_hal_spi_release(spi);
-
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+    radioCommand(spiBuff, 2);
     waitForRadioCommandCompletion(100);
     inReceiveMode = false; // No longer in receive mode
 }
@@ -745,68 +881,93 @@ void transmit(uint8_t* data, int dataLen) {
         setModeStandby();
     }
 
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-
-    spiBuff[0] = 0x8C; // Opcode for "SetPacketParameters"
-    spiBuff[1] = 0x00; // PacketParam1 = Preamble Len MSB
-    spiBuff[2] = 0x0C; // PacketParam2 = Preamble Len LSB
-    spiBuff[3] = 0x00; // PacketParam3 = Header Type. 0x00 = Variable Len, 0x01 = Fixed Length
-    spiBuff[4] = dataLen; // PacketParam4 = Payload Length (Max is 255 bytes)
-    spiBuff[5] = 0x00; // PacketParam5 = CRC Type. 0x00 = Off, 0x01 = on
-    spiBuff[6] = 0x00; // PacketParam6 = Invert IQ.  0x00 = Standard, 0x01 = Inverted
-
-    furi_hal_spi_acquire(spi);
-    furi_hal_spi_bus_tx(spi, spiBuff, 7, timeout);
-    furi_hal_spi_release(spi);
-
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
-    waitForRadioCommandCompletion(100); // Give time for radio to process the command
+    // The packet parameters shared with receive, with the length of this payload
+    writePacketParams(dataLen);
 
     // Write the payload to the buffer
-    // Reminder: PayloadLength is defined in setPacketParams
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-
+    // Reminder: PayloadLength was just sent by writePacketParams
     spiBuff[0] = 0x0E, //Opcode for WriteBuffer command
         spiBuff[1] = 0x00; //Dummy byte before writing payload
 
-    furi_hal_spi_acquire(spi);
-    furi_hal_spi_bus_tx(spi, spiBuff, 2, timeout);
-
-    // Transmit data in chunks to avoid overwriting the original buffer
-    uint8_t size = sizeof(spiBuff);
-    for(uint16_t i = 0; i < dataLen; i += size) {
-        if(i + size > dataLen) {
-            size = dataLen - i;
-        }
-        memcpy(spiBuff, &(data[i]), size);
-        furi_hal_spi_bus_tx(spi, data + i, size, timeout); // Write the payload itself
+    LORA_PERF_BEGIN(perf);
+    lora_hal_select();
+    lora_hal_spi_write(spiBuff, 2);
+    if(dataLen > 0) {
+        lora_hal_spi_write(data, dataLen); // Write the payload itself, straight from the caller
     }
-
-    furi_hal_spi_release(spi);
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+    lora_hal_deselect();
+    LORA_PERF_END(LoRaPerfProbeWriteBuffer, perf);
+    traceBufferTransfer(0x0E, data, dataLen, 1);
     waitForRadioCommandCompletion(1000); // Give time for radio to process the command
 
-    // Transmit
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
+    // A packet received before going to standby would be taken for TxDone
+    clearInterrupts();
 
+    // Transmit
     spiBuff[0] = 0x83; // Opcode for SetTx command
     spiBuff[1] = 0xFF; // Timeout (3-byte number)
     spiBuff[2] = 0xFF; // Timeout (3-byte number)
     spiBuff[3] = 0xFF; // Timeout (3-byte number)
 
-    furi_hal_spi_acquire(spi);
-    furi_hal_spi_bus_tx(spi, spiBuff, 4, timeout);
-    furi_hal_spi_release(spi);
-
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+    radioCommand(spiBuff, 4);
 
-    waitForRadioCommandCompletion(
-        transmitTimeout); // Wait for tx to complete, with a timeout so we don't wait forever
+    // Wait for TxDone on DIO1, as long as the packet takes on air so the next one can't cut it
+    uint32_t timeout = getTimeOnAir(dataLen) + TX_DONE_MARGIN_MS;
+    if(!waitForInterrupt(timeout)) {
+        FURI_LOG_W(TAG, "TX done not raised in %lu ms", timeout);
+    } else {
+        lora_notify_post(LoRaNotifyEventTx);
+    }
 
     // Remember that we are in Tx mode.  If we want to receive a packet, we need to switch into receiving mode
     inReceiveMode = false;
 }
 
+/* Time-on-air of a packet with the current modulation parameters, in milliseconds (rounded up).
+See datasheet section 6.1.4 for the formula. Uses the packet parameters set with setPacketParams.
+*/
+uint32_t getTimeOnAir(uint8_t payloadLen) {
+    const uint32_t preambleLen = packetPreamble;
+    const int32_t headerBits = packetHeaderType ? 0 : 20; // Explicit header only
+    const int32_t crcBits = packetCRC ? 16 : 0;
+
+    if(bandwidth >= COUNT_OF(bandwidthHz) || bandwidthHz[bandwidth] == 0) {
+        return 0;
+    }
+
+    // Count in quarter symbols, the fixed part of the packet has 4.25 or 6.25 extra symbols
+    int32_t sf = spreadingFactor;
+    int32_t bits = 8 * payloadLen + crcBits - 4 * sf + headerBits;
+    int32_t bitsPerSymbol = 4 * sf;
+    uint32_t quarterSymbols = preambleLen * 4 + 8 * 4;
+
+    if(sf <= 6) {
+        quarterSymbols += 25;
+    } else {
+        quarterSymbols += 17;
+        bits += 8;
+        if(lowDataRateFor(sf, bandwidth)) {
+            bitsPerSymbol = 4 * (sf - 2);
+        }
+    }
+
+    if(bits > 0) {
+        quarterSymbols += ((bits + bitsPerSymbol - 1) / bitsPerSymbol) * (codingRate + 4) * 4;
+    }
+
+    // Symbol time is 2^SF / BW
+    uint64_t timeUs = ((uint64_t)quarterSymbols << sf) * 1000000 / (4 * bandwidthHz[bandwidth]);
+    return (uint32_t)((timeUs + 999) / 1000);
+}
+
+/* Estimated energy drawn by the radio to transmit for airtimeMs at the current TX power, in uJ.
+Uses the typical supply current of the PA configuration, an upper bound below its maximum power.
+*/
+uint32_t getTxEnergy(uint32_t airtimeMs) {
+    uint32_t currentMa = paOptimal[paOptimalIndex(txPower)].currentMa;
+    return currentMa * PA_SUPPLY_MV / 1000 * airtimeMs;
+}
+
 /*Receive a packet if available
 If available, this will return the size of the packet and store the packet contents into the user-provided buffer.
 A max length of the buffer can be provided to avoid buffer overflow.  If buffer is not large enough for entire payload, overflow is thrown out.
@@ -819,50 +980,38 @@ Returns payload size (1-255) when a packet with a non-zero payload is received.
 int lora_receive_async(uint8_t* buff, int buffMaxLen) {
     setModeReceive(); // Sets the mode to receive (if not already in receive mode)
 
-    if(furi_hal_gpio_read(pin_dio1)) {
-        furi_hal_gpio_write(pin_beacon, true);
-        furi_delay_ms(50);
-        furi_hal_gpio_write(pin_beacon, false);
-    }
-
     // Radio pin DIO1 (interrupt) goes high when we have a packet ready. If it's low, there's no packet yet
-    if(!furi_hal_gpio_read(pin_dio1)) {
+    if(!lora_hal_dio1()) {
         return -1;
     } // Return -1, meaning no packet ready
-
-    FURI_LOG_E(TAG, "packet ready... ");
+    lastIrqTick = furi_get_tick();
 
     // Tell the radio to clear the interrupt, and set the pin back inactive.
-    while(furi_hal_gpio_read(pin_dio1)) {
-        // Clear all interrupt flags. This should result in the interrupt pin going low
-        furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-        furi_hal_spi_acquire(spi);
-
-        spiBuff[0] = 0x02; //Opcode for ClearIRQStatus command
-        spiBuff[1] = 0xFF; //IRQ bits to clear (MSB) (0xFFFF means clear all interrupts)
-        spiBuff[2] = 0xFF; //IRQ bits to clear (LSB)
-
-        furi_hal_spi_bus_tx(spi, spiBuff, 3, timeout);
-
-        furi_hal_spi_release(spi);
-        furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+    // A wedged radio, or no module at all (DIO1 floats), keeps the pin high: each try that
+    // leaves it high counts as a fault, so radioWatchdog resets the radio instead of us spinning
+    for(uint8_t tries = 0; lora_hal_dio1(); tries++) {
+        if(tries == CLEAR_IRQ_TRIES) {
+            FURI_LOG_E(TAG, "ERROR - DIO1 stuck high");
+            return -1;
+        }
+        clearInterrupts();
+        if(lora_hal_dio1()) {
+            busyTimeouts++;
+        }
     }
 
     // (Optional) Read the packet status info from the radio.
     // This provides debug info about the packet we received
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
     spiBuff[0] = 0x14; //Opcode for get packet status
     spiBuff[1] = 0xFF; //Dummy byte. Returns status
     spiBuff[2] = 0xFF; //Dummy byte. Returns rssi
     spiBuff[3] = 0xFF; //Dummy byte. Returns snd
     spiBuff[4] = 0xFF; //Dummy byte. Returns signal RSSI
 
-    furi_hal_spi_bus_rx(spi, spiBuff, 5, timeout);
-
-    furi_hal_spi_release(spi);
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+    lora_hal_select();
+    lora_hal_spi_exchange(spiBuff, 5);
+    lora_hal_deselect();
+    lora_trace_record(0x14, spiBuff + 1, 4);
 
     // Store these values as class variables so they can be accessed if needed
     // Documentation for what these variables mean can be found in the .h file
@@ -875,23 +1024,18 @@ int lora_receive_async(uint8_t* buff, int buffMaxLen) {
 
     // We're almost ready to read the packet from the radio
     // But first we have to know how big the packet is, and where in the radio memory it is stored
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
     spiBuff[0] = 0x13; //Opcode for GetRxBufferStatus command
     spiBuff[1] = 0xFF; //Dummy.  Returns radio status
     spiBuff[2] = 0xFF; //Dummy.  Returns loraPacketLength
     spiBuff[3] = 0xFF; //Dummy.  Returns memory offset (address)
 
-    furi_hal_spi_bus_rx(spi, spiBuff, 4, timeout);
-
-    furi_hal_spi_release(spi);
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+    lora_hal_select();
+    lora_hal_spi_exchange(spiBuff, 4);
+    lora_hal_deselect();
+    lora_trace_record(0x13, spiBuff + 1, 3);
 
     uint8_t payloadLen = spiBuff[2]; // How long the lora packet is
 
-    FURI_LOG_E(TAG, "payloadLen = %d", payloadLen);
-
     uint8_t startAddress = spiBuff[3]; // Where in 1262 memory is the packet stored
 
     // Make sure we don't overflow the buffer if the packet is larger than our buffer
@@ -900,22 +1044,22 @@ int lora_receive_async(uint8_t* buff, int buffMaxLen) {
     }
 
     // Read the radio buffer from the SX1262 into the user-supplied buffer
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
-
     spiBuff[0] = 0x1E; // Opcode for ReadBuffer command
     spiBuff[1] = startAddress; // SX1262 memory location to start reading from
     spiBuff[2] = 0x00; // Dummy byte
-    furi_hal_spi_bus_tx(spi, spiBuff, 3, timeout); // Send commands to get read started
-    furi_hal_spi_bus_rx(
-        spi,
-        buff,
-        payloadLen,
-        timeout); // Get the contents from the radio and store it into the user provided buffer
 
-    furi_hal_spi_release(spi);
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+    LORA_PERF_BEGIN(perf);
+    lora_hal_select();
+    lora_hal_spi_write(spiBuff, 3); // Send commands to get read started
+    if(payloadLen > 0) {
+        // Get the contents from the radio and store it into the user provided buffer
+        lora_hal_spi_exchange(buff, payloadLen);
+    }
+    lora_hal_deselect();
+    LORA_PERF_END(LoRaPerfProbeReadBuffer, perf);
+    traceBufferTransfer(0x1E, buff, payloadLen, 2);
 
+    lora_notify_post(LoRaNotifyEventRx);
     return payloadLen; // Return how many bytes we actually read
 }
 
@@ -923,21 +1067,17 @@ void regTest() {
     uint8_t regValue;
     checkBusy();
 
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-
-    furi_hal_spi_acquire(spi);
+    lora_hal_select();
 
     spiBuff[0] = 0x1D;
     spiBuff[1] = 0x07;
     spiBuff[2] = 0x40;
     spiBuff[3] = 0x00;
 
-    furi_hal_spi_bus_tx(spi, spiBuff, 4, timeout);
-    furi_hal_spi_bus_rx(spi, &regValue, 1, timeout);
-
-    furi_hal_spi_release(spi);
+    lora_hal_spi_write(spiBuff, 4);
+    lora_hal_spi_exchange(&regValue, 1);
 
-    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+    lora_hal_deselect();
 }
 
 /* Tests that SPI is communicating correctly with the radio.
@@ -952,37 +1092,22 @@ bool sanityCheck() {
     uint8_t dummy_byte = 0x00;
     uint8_t regValue;
 
-    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
-    furi_hal_spi_acquire(spi);
+    lora_hal_select();
 
-    if(furi_hal_spi_bus_tx(spi, command_read_register, 1, timeout) &&
-       furi_hal_spi_bus_tx(spi, read_register_address, 2, timeout) &&
-       furi_hal_spi_bus_tx(spi, &dummy_byte, 1, timeout) &&
-       furi_hal_spi_bus_rx(spi, &regValue, 1, timeout)) {
+    if(lora_hal_spi_write(command_read_register, 1) &&
+       lora_hal_spi_write(read_register_address, 2) && lora_hal_spi_write(&dummy_byte, 1) &&
+       lora_hal_spi_exchange(&regValue, 1)) {
         FURI_LOG_E(TAG, "REGISTER VALUE: %02x", regValue);
-        furi_hal_spi_release(spi);
-        furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+        lora_hal_deselect();
 
         if(regValue == 0x14) {
-            // Initialize the LED pin as output.
-            // GpioModeOutputPushPull means true = 3.3 volts, false = 0 volts.
-            // GpioModeOutputOpenDrain means true = floating, false = 0 volts.
-            furi_hal_gpio_init_simple(pin_beacon, GpioModeOutputPushPull);
-            furi_hal_gpio_write(pin_beacon, true);
-            furi_delay_ms(100);
-            furi_hal_gpio_write(pin_beacon, false);
-            furi_delay_ms(100);
-            furi_hal_gpio_write(pin_beacon, true);
-            furi_delay_ms(100);
-            furi_hal_gpio_write(pin_beacon, false);
-            furi_delay_ms(100);
+            lora_notify_post(LoRaNotifyEventRadio); // Blinks the beacon LED
         }
 
         return regValue == 0x14; // Success if we read 0x14 from the register
     } else {
-        FURI_LOG_E(TAG, "FAILED - furi_hal_spi_bus_tx or furi_hal_spi_bus_rx failed.");
-        furi_hal_spi_release(spi);
-        furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+        FURI_LOG_E(TAG, "FAILED - SPI read of the sync word register failed.");
+        lora_hal_deselect();
         return false;
     }
 }
@@ -1012,38 +1137,14 @@ void printRegisters(uint16_t Start, uint16_t End) {
     }
 }
 
-void init_spi() {
-    spi_handle.bus = furi_hal_spi_bus_handle_external.bus;
-    spi_handle.callback = furi_hal_spi_bus_handle_external.callback;
-    spi_handle.cs = pin_nss1;
-    spi_handle.miso = furi_hal_spi_bus_handle_external.miso;
-    spi_handle.mosi = furi_hal_spi_bus_handle_external.mosi;
-    spi_handle.sck = furi_hal_spi_bus_handle_external.sck;
-}
-
 bool begin() {
-    //furi_hal_gpio_init(pin_reset, GpioModeOutputPushPull, GpioPullUp, GpioSpeedVeryHigh);
-    //furi_hal_gpio_init(pin_nss1, GpioModeOutputPushPull, GpioPullUp, GpioSpeedVeryHigh);
-
-    init_spi();
-
-    furi_hal_gpio_init_simple(pin_reset, GpioModeOutputPushPull);
-    furi_hal_gpio_init_simple(pin_nss0, GpioModeOutputPushPull);
-    furi_hal_gpio_init_simple(pin_nss1, GpioModeOutputPushPull);
-
-    furi_hal_gpio_init_simple(pin_beacon, GpioModeOutputPushPull);
-
-    furi_hal_gpio_write(pin_nss0, false);
-    furi_hal_gpio_write(pin_nss1, true);
-    furi_hal_gpio_write(pin_reset, true);
-
-    furi_hal_gpio_init_simple(pin_dio1, GpioModeInput);
+    lora_hal_init();
 
     FURI_LOG_E(TAG, "RESET DEVICE...");
     furi_delay_ms(10);
-    furi_hal_gpio_write(pin_reset, false);
+    lora_hal_reset(true);
     furi_delay_ms(2);
-    furi_hal_gpio_write(pin_reset, true);
+    lora_hal_reset(false);
     furi_delay_ms(25);
 
     checkBusy();
@@ -1064,3 +1165,99 @@ bool begin() {
 
     return true; //Return success that we set up the radio
 }
+
+/* Release what begin() set up.  The pin interrupts must be removed before the app exits,
+the handlers would be unloaded with it. */
+void end() {
+    lora_hal_deinit();
+}
+
+/* Ask the radio for its status.  Returns TRUE if it answers that it is receiving, a radio that
+lost its configuration or a dead SPI link answers something else. */
+static bool radioIsReceiving() {
+    spiBuff[0] = 0xC0; // Opcode for the "getStatus" command
+    spiBuff[1] = 0x00; // Dummy byte, status will overwrite this byte
+
+    lora_hal_select();
+    lora_hal_spi_exchange(spiBuff, 2);
+    lora_hal_deselect();
+    lora_trace_record(0xC0, spiBuff + 1, 1);
+
+    return ((spiBuff[1] >> 4) & 0x07) == 0x05; // Chip mode RX
+}
+
+/* Reset the radio and send it the configuration it had, from the config variables.
+Returns TRUE if the radio answered after the reset. */
+static bool radioRecover() {
+    bool wasReceiving = inReceiveMode;
+
+    lora_hal_reset(true);
+    furi_delay_ms(2);
+    lora_hal_reset(false);
+    lora_hal_wait_ready(25);
+
+    busyTimeouts = 0;
+    spiFailures = 0;
+    inReceiveMode = false;
+    if(!sanityCheck()) {
+        return false;
+    }
+
+    configPreloaded = true; // The config variables hold what the radio was using
+    configureRadioEssentials();
+    if(wasReceiving) {
+        setModeReceive();
+    }
+    return busyTimeouts == 0 && spiFailures == 0;
+}
+
+/* Detect a wedged radio and bring it back: BUSY stuck high or SPI commands failing several times
+in a row, or no interrupt for WATCHDOG_IDLE_MS while receiving and the radio no longer reports
+receive mode.  The radio is reset and gets the current configuration again, receive mode is
+resumed if it was on.  Call it regularly from the code using the radio.
+Returns TRUE when an outage ended with this call, outageMs is then set to how long it lasted.
+*/
+bool radioWatchdog(uint32_t* outageMs) {
+    uint32_t now = furi_get_tick();
+
+    if(outageStartTick == 0) {
+        bool faulty = busyTimeouts >= WATCHDOG_MAX_FAULTS || spiFailures >= WATCHDOG_MAX_FAULTS;
+        if(!faulty && inReceiveMode && now - lastIrqTick >= furi_ms_to_ticks(WATCHDOG_IDLE_MS)) {
+            faulty = !radioIsReceiving();
+            lastIrqTick = now; // Quiet but healthy, check again after another idle period
+        }
+        if(!faulty) {
+            return false;
+        }
+        FURI_LOG_W(TAG, "Radio not responding, resetting it");
+        outageStartTick = now ? now : 1;
+    } else if(now - lastRecoveryTick < furi_ms_to_ticks(WATCHDOG_RETRY_MS)) {
+        return false;
+    }
+
+    lastRecoveryTick = now;
+    if(!radioRecover()) {
+        return false; // Try again after WATCHDOG_RETRY_MS
+    }
+
+    uint32_t elapsed = furi_get_tick() - outageStartTick;
+    outageStartTick = 0;
+    radioOutages++;
+    radioRecoveryMs += elapsed;
+    FURI_LOG_I(TAG, "Radio recovered after %lu ms", elapsed);
+
+    if(outageMs) {
+        *outageMs = elapsed;
+    }
+    return true;
+}
+
+/* Number of outages radioWatchdog recovered from */
+uint32_t getRadioOutages() {
+    return radioOutages;
+}
+
+/* Total time of the outages radioWatchdog recovered from, in milliseconds */
+uint32_t getRadioRecoveryMs() {
+    return radioRecoveryMs;
+}
@@ -0,0 +1,221 @@
+#include "lora_devices.h"
+
+#include <string.h>
+
+#define LORA_DEVICES_SLOT_MASK (LORA_DEVICES_SLOTS - 1)
+#define LORA_DEVICES_RESET_GAP 0x8000 // A smaller FCnt step back is a restarted counter
+
+_Static_assert(LORA_DEVICES_SLOTS == 1 << LORA_DEVICES_SLOT_BITS, "LORA_DEVICES_SLOT_BITS");
+_Static_assert(LORA_DEVICES_SLOTS >= 2 * LORA_DEVICES_MAX, "LORA_DEVICES_SLOTS");
+
+static const char* const lora_devices_sort_names[] = {
+    "Recent",
+    "Uplinks",
+    "RSSI",
+    "Lost",
+    "Address",
+};
+
+// Fibonacci hashing, DevAddrs of one network share their top bits
+static uint16_t lora_devices_home(uint32_t dev_addr) {
+    return (uint32_t)(dev_addr * 2654435769u) >> (32 - LORA_DEVICES_SLOT_BITS);
+}
+
+// Slot holding a device, or the empty slot ending its probe run
+static uint16_t lora_devices_probe(const LoRaDevices* devices, uint32_t dev_addr) {
+    uint16_t slot = lora_devices_home(dev_addr);
+    while(devices->slots[slot] != LORA_DEVICES_NONE &&
+          devices->devices[devices->slots[slot]].dev_addr != dev_addr) {
+        slot = (slot + 1) & LORA_DEVICES_SLOT_MASK;
+    }
+    return slot;
+}
+
+// Empty a slot and move back the devices after it that would no longer be found
+static void lora_devices_remove_slot(LoRaDevices* devices, uint16_t hole) {
+    uint16_t slot = hole;
+    devices->slots[hole] = LORA_DEVICES_NONE;
+    while(true) {
+        slot = (slot + 1) & LORA_DEVICES_SLOT_MASK;
+        uint16_t index = devices->slots[slot];
+        if(index == LORA_DEVICES_NONE) {
+            return;
+        }
+        // A device can fill the hole if its home is not between the hole and its slot
+        uint16_t home = lora_devices_home(devices->devices[index].dev_addr);
+        if(((slot - home) & LORA_DEVICES_SLOT_MASK) >= ((slot - hole) & LORA_DEVICES_SLOT_MASK)) {
+            devices->slots[hole] = index;
+            devices->slots[slot] = LORA_DEVICES_NONE;
+            hole = slot;
+        }
+    }
+}
+
+static void lora_devices_unlink(LoRaDevices* devices, uint16_t index) {
+    LoRaDevice* device = &devices->devices[index];
+    if(device->newer != LORA_DEVICES_NONE) {
+        devices->devices[device->newer].older = device->older;
+    } else {
+        devices->newest = device->older;
+    }
+    if(device->older != LORA_DEVICES_NONE) {
+        devices->devices[device->older].newer = device->newer;
+    } else {
+        devices->oldest = device->newer;
+    }
+}
+
+static void lora_devices_link_newest(LoRaDevices* devices, uint16_t index) {
+    LoRaDevice* device = &devices->devices[index];
+    device->newer = LORA_DEVICES_NONE;
+    device->older = devices->newest;
+    if(devices->newest != LORA_DEVICES_NONE) {
+        devices->devices[devices->newest].newer = index;
+    } else {
+        devices->oldest = index;
+    }
+    devices->newest = index;
+}
+
+void lora_devices_reset(LoRaDevices* devices) {
+    memset(devices->slots, 0xFF, sizeof(devices->slots));
+    devices->count = 0;
+    devices->newest = LORA_DEVICES_NONE;
+    devices->oldest = LORA_DEVICES_NONE;
+    devices->evicted = 0;
+}
+
+static void lora_devices_count_uplink(LoRaDevice* device, const LoRaHistoryEntry* meta) {
+    if(meta->sf >= 5 && meta->sf <= 12) {
+        device->sf_uplinks[meta->sf - 5]++;
+    }
+    for(size_t i = 0; i < LORA_DEVICES_CHANNELS; i++) {
+        if(device->channel_uplinks[i] == 0) {
+            device->channel_hz[i] = meta->frequency;
+        }
+        if(device->channel_hz[i] == meta->frequency) {
+            device->channel_uplinks[i]++;
+            return;
+        }
+    }
+    device->channel_other++;
+}
+
+LoRaDevice* lora_devices_update(
+    LoRaDevices* devices,
+    const LoRaWANFrame* frame,
+    const LoRaHistoryEntry* meta) {
+    if(!lora_lorawan_is_data(frame->mtype)) {
+        return NULL;
+    }
+
+    uint16_t slot = lora_devices_probe(devices, frame->dev_addr);
+    uint16_t index = devices->slots[slot];
+    LoRaDevice* device;
+    bool known = index != LORA_DEVICES_NONE;
+
+    if(known) {
+        lora_devices_unlink(devices, index);
+        device = &devices->devices[index];
+    } else {
+        if(devices->count < LORA_DEVICES_MAX) {
+            index = devices->count++;
+        } else {
+            // Reuse the least recently seen device, its removal can move the probe run
+            index = devices->oldest;
+            lora_devices_remove_slot(
+                devices, lora_devices_probe(devices, devices->devices[index].dev_addr));
+            lora_devices_unlink(devices, index);
+            devices->evicted++;
+            slot = lora_devices_probe(devices, frame->dev_addr);
+        }
+        devices->slots[slot] = index;
+        device = &devices->devices[index];
+        memset(device, 0, sizeof(LoRaDevice));
+        device->dev_addr = frame->dev_addr;
+    }
+    lora_devices_link_newest(devices, index);
+    device->last_seen = meta->tick;
+
+    if(frame->mtype == LoRaWANMTypeUnconfirmedDown || frame->mtype == LoRaWANMTypeConfirmedDown) {
+        device->downlinks++;
+        return device;
+    }
+
+    if(device->uplinks == 0) {
+        device->rssi_min = meta->rssi;
+        device->rssi_max = meta->rssi;
+    } else {
+        // The same FCnt again is a retransmission, a step back a restarted counter
+        uint16_t step = frame->fcnt - device->fcnt;
+        if(step >= LORA_DEVICES_RESET_GAP) {
+            device->fcnt_resets++;
+        } else if(step > 1) {
+            device->fcnt_lost += step - 1;
+        }
+        if(meta->rssi < device->rssi_min) device->rssi_min = meta->rssi;
+        if(meta->rssi > device->rssi_max) device->rssi_max = meta->rssi;
+    }
+    device->uplinks++;
+    device->fcnt = frame->fcnt;
+    device->rssi_sum += meta->rssi;
+    device->rssi_last = meta->rssi;
+    device->snr_sum += meta->snr;
+    device->snr_last = meta->snr;
+    lora_devices_count_uplink(device, meta);
+    return device;
+}
+
+const LoRaDevice* lora_devices_find(const LoRaDevices* devices, uint32_t dev_addr) {
+    uint16_t index = devices->slots[lora_devices_probe(devices, dev_addr)];
+    return index != LORA_DEVICES_NONE ? &devices->devices[index] : NULL;
+}
+
+int16_t lora_devices_rssi_average(const LoRaDevice* device) {
+    return device->uplinks ? device->rssi_sum / (int32_t)device->uplinks : 0;
+}
+
+// true if a goes before b
+static bool
+    lora_devices_before(const LoRaDevice* a, const LoRaDevice* b, LoRaDevicesSort sort) {
+    switch(sort) {
+    case LoRaDevicesSortUplinks:
+        return a->uplinks > b->uplinks;
+    case LoRaDevicesSortRssi:
+        return lora_devices_rssi_average(a) > lora_devices_rssi_average(b);
+    case LoRaDevicesSortLost:
+        return a->fcnt_lost > b->fcnt_lost;
+    case LoRaDevicesSortAddress:
+        return a->dev_addr < b->dev_addr;
+    default:
+        return false;
+    }
+}
+
+size_t lora_devices_sort(const LoRaDevices* devices, LoRaDevicesSort sort, uint16_t* order) {
+    // Start from the most recent device, ties stay in that order
+    size_t count = 0;
+    for(uint16_t index = devices->newest; index != LORA_DEVICES_NONE;
+        index = devices->devices[index].older) {
+        order[count++] = index;
+    }
+    if(sort == LoRaDevicesSortRecent) {
+        return count;
+    }
+
+    // Insertion sort, stable and without recursion for a few hundred entries
+    for(size_t i = 1; i < count; i++) {
+        uint16_t index = order[i];
+        const LoRaDevice* device = &devices->devices[index];
+        size_t j = i;
+        for(; j > 0 && lora_devices_before(device, &devices->devices[order[j - 1]], sort); j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = index;
+    }
+    return count;
+}
+
+const char* lora_devices_sort_name(LoRaDevicesSort sort) {
+    return sort < LoRaDevicesSortCount ? lora_devices_sort_names[sort] : "";
+}
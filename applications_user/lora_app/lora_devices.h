@@ -0,0 +1,117 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lora_history.h"
+#include "lora_lorawan.h"
+
+#define LORA_DEVICES_MAX       256 // Devices tracked, the least recently seen one makes room
+#define LORA_DEVICES_SLOTS     512 // Hash slots, 1 << LORA_DEVICES_SLOT_BITS, at most half used
+#define LORA_DEVICES_SLOT_BITS 9
+#define LORA_DEVICES_CHANNELS  4 // Frequencies counted per device
+#define LORA_DEVICES_NONE      0xFFFF // Empty slot or end of the LRU list
+
+/**
+ * A LoRaWAN end device seen by the sniffer, keyed by its DevAddr.  RSSI, SNR, FCnt, spreading
+ * factor and channel are only taken from uplinks, downlinks to the device are counted apart
+ * since they come from a gateway and have their own frame counter.
+*/
+typedef struct {
+    uint32_t dev_addr;
+    uint32_t uplinks;
+    uint32_t downlinks;
+    uint32_t last_seen; // furi_get_tick of the last packet
+    int32_t rssi_sum; // dBm, over the uplinks
+    int16_t rssi_min;
+    int16_t rssi_max;
+    int16_t rssi_last;
+    int8_t snr_last; // dB
+    int32_t snr_sum;
+    uint16_t fcnt; // FCnt of the last uplink
+    uint16_t fcnt_resets; // FCnt went back, the device rejoined or restarted
+    uint32_t fcnt_lost; // Uplinks missing between the FCnts seen
+    uint16_t sf_uplinks[8]; // Uplinks per spreading factor, SF5 to SF12
+    uint32_t channel_hz[LORA_DEVICES_CHANNELS]; // First frequencies the device used
+    uint16_t channel_uplinks[LORA_DEVICES_CHANNELS];
+    uint16_t channel_other; // Uplinks on any other frequency
+    uint16_t newer; // LRU list, LORA_DEVICES_NONE for the newest device
+    uint16_t older; // LRU list, LORA_DEVICES_NONE for the oldest device
+} LoRaDevice;
+
+/**
+ * Devices seen by the sniffer, in a fixed arena: nothing is allocated after the table itself.
+ * Devices are found by DevAddr through an open-addressed hash table with linear probing, kept
+ * at most half full so a lookup takes a probe or two.  Removed devices are filled in by moving
+ * the rest of their probe run back, so there are no tombstones and lookups stay short after
+ * any number of evictions.  A list from the most to the least recently seen device picks the
+ * one dropped when the table is full.
+*/
+typedef struct {
+    LoRaDevice devices[LORA_DEVICES_MAX];
+    uint16_t slots[LORA_DEVICES_SLOTS]; // Index in devices, LORA_DEVICES_NONE when empty
+    uint16_t count;
+    uint16_t newest;
+    uint16_t oldest;
+    uint32_t evicted; // Devices dropped to make room since the last reset
+} LoRaDevices;
+
+typedef enum {
+    LoRaDevicesSortRecent, // Most recently seen first
+    LoRaDevicesSortUplinks, // Most uplinks first
+    LoRaDevicesSortRssi, // Strongest average RSSI first
+    LoRaDevicesSortLost, // Most missing uplinks first
+    LoRaDevicesSortAddress, // Lowest DevAddr first
+    LoRaDevicesSortCount,
+} LoRaDevicesSort;
+
+/**
+ * @brief      Forget every device.
+ * @param      devices  The table.
+*/
+void lora_devices_reset(LoRaDevices* devices);
+
+/**
+ * @brief      Account a received packet to its device, adding the device if it is new.
+ * @details    Takes a hash lookup and a few list updates, whatever the number of devices.
+ * @param      devices  The table.
+ * @param      frame    The decoded packet.
+ * @param      meta     Metadata of the packet, number, offset and length are not used.
+ * @return     The device, NULL if the frame is not a data frame and has no DevAddr.
+*/
+LoRaDevice* lora_devices_update(
+    LoRaDevices* devices,
+    const LoRaWANFrame* frame,
+    const LoRaHistoryEntry* meta);
+
+/**
+ * @brief      Find a device.
+ * @param      devices   The table.
+ * @param      dev_addr  Its DevAddr.
+ * @return     The device, NULL if it is not in the table.
+*/
+const LoRaDevice* lora_devices_find(const LoRaDevices* devices, uint32_t dev_addr);
+
+/**
+ * @brief      List the devices in an order.
+ * @param      devices  The table.
+ * @param      sort     The order.
+ * @param      order    Filled with indexes in devices->devices, LORA_DEVICES_MAX entries.
+ * @return     Number of devices listed.
+*/
+size_t lora_devices_sort(const LoRaDevices* devices, LoRaDevicesSort sort, uint16_t* order);
+
+/**
+ * @brief      Name of an order for the screen ("Recent").
+ * @param      sort  The order.
+ * @return     The name.
+*/
+const char* lora_devices_sort_name(LoRaDevicesSort sort);
+
+/**
+ * @brief      Average RSSI of the uplinks of a device.
+ * @param      device  The device.
+ * @return     dBm, 0 without uplinks.
+*/
+int16_t lora_devices_rssi_average(const LoRaDevice* device);
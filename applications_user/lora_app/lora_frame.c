@@ -0,0 +1,66 @@
+#include "lora_frame.h"
+
+#include <string.h>
+
+uint16_t lora_frame_crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for(size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for(uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint8_t* lora_frame_put_u16(uint8_t* out, uint16_t value) {
+    out[0] = value;
+    out[1] = value >> 8;
+    return out + 2;
+}
+
+static uint8_t* lora_frame_put_u32(uint8_t* out, uint32_t value) {
+    out[0] = value;
+    out[1] = value >> 8;
+    out[2] = value >> 16;
+    out[3] = value >> 24;
+    return out + 4;
+}
+
+size_t lora_frame_encode(
+    const LoRaFrameMeta* meta,
+    const uint8_t* payload,
+    size_t payload_len,
+    uint8_t* out,
+    size_t out_size) {
+    size_t body_len = LORA_FRAME_META_LEN + payload_len;
+    size_t frame_len = LORA_FRAME_HEAD_LEN + body_len + LORA_FRAME_CRC_LEN;
+    if(payload_len > 255 || frame_len > out_size) {
+        return 0;
+    }
+
+    uint8_t* p = out;
+    *p++ = LORA_FRAME_SYNC_0;
+    *p++ = LORA_FRAME_SYNC_1;
+    p = lora_frame_put_u16(p, body_len);
+
+    uint8_t* body = p;
+    *p++ = LORA_FRAME_TYPE_PACKET;
+    p = lora_frame_put_u32(p, meta->sequence);
+    p = lora_frame_put_u32(p, meta->dropped);
+    p = lora_frame_put_u32(p, meta->timestamp);
+    p = lora_frame_put_u32(p, meta->tick);
+    p = lora_frame_put_u32(p, meta->frequency);
+    *p++ = meta->bw;
+    *p++ = meta->sf;
+    *p++ = meta->cr;
+    *p++ = (uint8_t)meta->snr;
+    p = lora_frame_put_u16(p, (uint16_t)meta->rssi);
+    if(payload_len > 0) {
+        memcpy(p, payload, payload_len);
+        p += payload_len;
+    }
+
+    lora_frame_put_u16(p, lora_frame_crc16(body, body_len));
+    return frame_len;
+}
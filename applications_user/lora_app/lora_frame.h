@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Binary frame used to stream captured packets to a computer, all numbers little endian:
+ *
+ *   sync      2 bytes   0xA5 0x5A
+ *   length    uint16    Bytes of the body
+ *   body:
+ *     type      uint8     LORA_FRAME_TYPE_PACKET
+ *     sequence  uint32    Counts every captured packet, sent or not
+ *     dropped   uint32    Packets that could not be sent so far
+ *     timestamp uint32    RTC time, seconds since 1970-01-01
+ *     tick      uint32    furi_get_tick when the packet was read, milliseconds
+ *     frequency uint32    Hz
+ *     bw        uint8     SX126x bandwidth code
+ *     sf        uint8     Spreading factor
+ *     cr        uint8     Coding rate code, 1-4 for 4/5-4/8
+ *     snr       int8      dB
+ *     rssi      int16     dBm
+ *     payload   0-255 bytes
+ *   crc       uint16    CRC-16/CCITT-FALSE of the body
+ *
+ * A receiver finds frames with the sync bytes and drops the ones with a bad CRC, so it can
+ * join a stream at any point.  tools/lora_stream_receive.py decodes it.
+*/
+#define LORA_FRAME_SYNC_0      0xA5
+#define LORA_FRAME_SYNC_1      0x5A
+#define LORA_FRAME_TYPE_PACKET 0x01
+
+#define LORA_FRAME_HEAD_LEN 4 // Sync and length
+#define LORA_FRAME_META_LEN 27 // Body without the payload
+#define LORA_FRAME_CRC_LEN  2
+#define LORA_FRAME_MAX_LEN  (LORA_FRAME_HEAD_LEN + LORA_FRAME_META_LEN + 255 + LORA_FRAME_CRC_LEN)
+
+typedef struct {
+    uint32_t sequence;
+    uint32_t dropped;
+    uint32_t timestamp;
+    uint32_t tick;
+    uint32_t frequency;
+    uint8_t bw;
+    uint8_t sf;
+    uint8_t cr;
+    int8_t snr;
+    int16_t rssi;
+} LoRaFrameMeta;
+
+/**
+ * @brief      CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF).
+ * @param      data    The bytes.
+ * @param      length  Number of bytes.
+ * @return     The CRC.
+*/
+uint16_t lora_frame_crc16(const uint8_t* data, size_t length);
+
+/**
+ * @brief      Build the frame of a captured packet.
+ * @param      meta         The packet metadata.
+ * @param      payload      The packet payload.
+ * @param      payload_len  Number of bytes in payload, at most 255.
+ * @param      out          Output buffer.
+ * @param      out_size     Size of out, LORA_FRAME_MAX_LEN is always enough.
+ * @return     Length of the frame, 0 if out is too small or the payload too long.
+*/
+size_t lora_frame_encode(
+    const LoRaFrameMeta* meta,
+    const uint8_t* payload,
+    size_t payload_len,
+    uint8_t* out,
+    size_t out_size);
@@ -0,0 +1,122 @@
+#include "lora_hal.h"
+
+#include <furi.h>
+#include <furi_hal.h>
+
+static uint32_t timeout = 1000;
+
+static FuriHalSpiBusHandle spi_handle;
+static const FuriHalSpiBusHandle* spi = &spi_handle;
+
+static const GpioPin* const pin_beacon = &gpio_swclk;
+static const GpioPin* const pin_nss0 = &gpio_ext_pa4;
+static const GpioPin* const pin_nss1 = &gpio_ext_pc0;
+static const GpioPin* const pin_reset = &gpio_ext_pc1;
+static const GpioPin* const pin_busy = &gpio_usart_rx;
+static const GpioPin* const pin_dio1 = &gpio_ext_pc3;
+
+#define LORA_HAL_DIO1_POLL_MS 1 // DIO1 has no interrupt, see lora_hal_init
+
+// Set from the BUSY interrupt, waited on by lora_hal_wait_ready
+typedef enum {
+    LoRaHalEventReady = (1 << 0), // BUSY went low
+} LoRaHalEvent;
+
+static FuriEventFlag* events;
+
+static void lora_hal_busy_isr(void* context) {
+    UNUSED(context);
+    furi_event_flag_set(events, LoRaHalEventReady);
+}
+
+void lora_hal_init(void) {
+    spi_handle.bus = furi_hal_spi_bus_handle_external.bus;
+    spi_handle.callback = furi_hal_spi_bus_handle_external.callback;
+    spi_handle.cs = pin_nss1;
+    spi_handle.miso = furi_hal_spi_bus_handle_external.miso;
+    spi_handle.mosi = furi_hal_spi_bus_handle_external.mosi;
+    spi_handle.sck = furi_hal_spi_bus_handle_external.sck;
+
+    furi_hal_gpio_init_simple(pin_reset, GpioModeOutputPushPull);
+    furi_hal_gpio_init_simple(pin_nss0, GpioModeOutputPushPull);
+    furi_hal_gpio_init_simple(pin_nss1, GpioModeOutputPushPull);
+
+    furi_hal_gpio_init_simple(pin_beacon, GpioModeOutputPushPull);
+
+    furi_hal_gpio_write(pin_nss0, false);
+    furi_hal_gpio_write(pin_nss1, true);
+    furi_hal_gpio_write(pin_reset, true);
+
+    // DIO1 (PC3) is on EXTI line 3 like the OK button (PH3).  An interrupt on it would take
+    // the line from the input service, so it is only read.  BUSY (PB7) has line 7 to itself.
+    furi_hal_gpio_init_simple(pin_dio1, GpioModeInput);
+
+    events = furi_event_flag_alloc();
+    furi_hal_gpio_init(pin_busy, GpioModeInterruptFall, GpioPullNo, GpioSpeedVeryHigh);
+    furi_hal_gpio_add_int_callback(pin_busy, lora_hal_busy_isr, NULL);
+}
+
+void lora_hal_deinit(void) {
+    furi_hal_gpio_remove_int_callback(pin_busy);
+    furi_hal_gpio_init_simple(pin_busy, GpioModeAnalog);
+    furi_hal_gpio_init_simple(pin_dio1, GpioModeAnalog);
+    furi_event_flag_free(events);
+    events = NULL;
+}
+
+void lora_hal_select(void) {
+    furi_hal_gpio_write(pin_nss1, false); // Enable radio chip-select
+    furi_hal_spi_acquire(spi);
+}
+
+void lora_hal_deselect(void) {
+    furi_hal_spi_release(spi);
+    furi_hal_gpio_write(pin_nss1, true); // Disable radio chip-select
+}
+
+bool lora_hal_spi_write(const uint8_t* data, size_t size) {
+    return furi_hal_spi_bus_tx(spi, data, size, timeout);
+}
+
+bool lora_hal_spi_exchange(uint8_t* data, size_t size) {
+    // bus_rx clocks out the buffer contents while it reads into it
+    return furi_hal_spi_bus_rx(spi, data, size, timeout);
+}
+
+bool lora_hal_busy(void) {
+    return furi_hal_gpio_read(pin_busy);
+}
+
+bool lora_hal_dio1(void) {
+    return furi_hal_gpio_read(pin_dio1);
+}
+
+bool lora_hal_wait_ready(uint32_t timeout_ms) {
+    // The event is cleared before the pin is read, so an edge between the read and the wait
+    // still wakes us up
+    furi_event_flag_clear(events, LoRaHalEventReady);
+    if(!furi_hal_gpio_read(pin_busy)) {
+        return true;
+    }
+    furi_event_flag_wait(events, LoRaHalEventReady, FuriFlagWaitAny, furi_ms_to_ticks(timeout_ms));
+    return !furi_hal_gpio_read(pin_busy);
+}
+
+bool lora_hal_wait_dio1(uint32_t timeout_ms) {
+    uint32_t start = furi_get_tick();
+    while(!furi_hal_gpio_read(pin_dio1)) {
+        if(furi_get_tick() - start >= furi_ms_to_ticks(timeout_ms)) {
+            return false;
+        }
+        furi_delay_ms(LORA_HAL_DIO1_POLL_MS);
+    }
+    return true;
+}
+
+void lora_hal_reset(bool asserted) {
+    furi_hal_gpio_write(pin_reset, !asserted);
+}
+
+void lora_hal_beacon(bool on) {
+    furi_hal_gpio_write(pin_beacon, on);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Pins and SPI bus of the SX1262 module.  The driver in lora.c only reaches the hardware
+ * through these functions, lora_hal.c implements them on the Flipper external SPI bus.
+*/
+
+/**
+ * @brief      Set up the SPI handle and the radio pins.
+ * @details    Chip-select is left inactive and reset released.  BUSY raises an interrupt
+ *            that wakes lora_hal_wait_ready.  DIO1 is only read, its pin shares an interrupt
+ *            line with the OK button.
+*/
+void lora_hal_init(void);
+
+/**
+ * @brief      Remove the BUSY interrupt, must be called before the app exits.
+*/
+void lora_hal_deinit(void);
+
+/**
+ * @brief      Take the SPI bus and pull chip-select low, starting a radio command.
+*/
+void lora_hal_select(void);
+
+/**
+ * @brief      Release chip-select and the SPI bus, ending a radio command.
+*/
+void lora_hal_deselect(void);
+
+/**
+ * @brief      Send bytes to the radio, what it sends back is discarded.
+ * @param      data  The bytes to send.
+ * @param      size  Number of bytes.
+ * @return     true on success.
+*/
+bool lora_hal_spi_write(const uint8_t* data, size_t size);
+
+/**
+ * @brief      Send bytes to the radio and replace them with the bytes it sends back.
+ * @param      data  The bytes to send, overwritten with the received bytes.
+ * @param      size  Number of bytes.
+ * @return     true on success.
+*/
+bool lora_hal_spi_exchange(uint8_t* data, size_t size);
+
+/**
+ * @brief      Read the BUSY pin.
+ * @return     true while the radio is processing a command.
+*/
+bool lora_hal_busy(void);
+
+/**
+ * @brief      Read the DIO1 interrupt pin.
+ * @return     true when an enabled interrupt is pending.
+*/
+bool lora_hal_dio1(void);
+
+/**
+ * @brief      Wait for the radio to finish processing a command (BUSY low).
+ * @details    Returns right away if BUSY is already low, otherwise sleeps until the BUSY
+ *            interrupt instead of polling.
+ * @param      timeout_ms  Longest wait.
+ * @return     false if BUSY is still high after the timeout.
+*/
+bool lora_hal_wait_ready(uint32_t timeout_ms);
+
+/**
+ * @brief      Wait for an enabled radio interrupt (DIO1 high).
+ * @details    DIO1 has no pin interrupt, it is read every millisecond.
+ * @param      timeout_ms  Longest wait.
+ * @return     false if DIO1 is still low after the timeout.
+*/
+bool lora_hal_wait_dio1(uint32_t timeout_ms);
+
+/**
+ * @brief      Drive the radio reset pin.
+ * @param      asserted  true holds the radio in reset.
+*/
+void lora_hal_reset(bool asserted);
+
+/**
+ * @brief      Drive the beacon LED.
+ * @param      on  true lights the LED.
+*/
+void lora_hal_beacon(bool on);
@@ -0,0 +1,59 @@
+#include "lora_hex.h"
+
+#include <string.h>
+
+// clang-format off
+// "000102...FEFF", every byte value is at index (value * 2)
+#define LORA_HEX_ROW(h) \
+    h"0" h"1" h"2" h"3" h"4" h"5" h"6" h"7" h"8" h"9" h"A" h"B" h"C" h"D" h"E" h"F"
+
+static const char lora_hex_pairs[] =
+    LORA_HEX_ROW("0") LORA_HEX_ROW("1") LORA_HEX_ROW("2") LORA_HEX_ROW("3")
+    LORA_HEX_ROW("4") LORA_HEX_ROW("5") LORA_HEX_ROW("6") LORA_HEX_ROW("7")
+    LORA_HEX_ROW("8") LORA_HEX_ROW("9") LORA_HEX_ROW("A") LORA_HEX_ROW("B")
+    LORA_HEX_ROW("C") LORA_HEX_ROW("D") LORA_HEX_ROW("E") LORA_HEX_ROW("F");
+
+// Nibble value + 1 for every valid hex digit, 0 for anything else
+static const uint8_t lora_hex_values[256] = {
+    ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,
+    ['5'] = 6,  ['6'] = 7,  ['7'] = 8,  ['8'] = 9,  ['9'] = 10,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+};
+// clang-format on
+
+size_t lora_hex_encode(const uint8_t* data, size_t data_len, char* out, size_t out_size) {
+    if(out_size < LORA_HEX_ENCODED_LEN(data_len) + 1) {
+        if(out_size > 0) {
+            out[0] = '\0';
+        }
+        return 0;
+    }
+
+    for(size_t i = 0; i < data_len; i++) {
+        memcpy(out + i * 2, &lora_hex_pairs[data[i] * 2], 2);
+    }
+    out[data_len * 2] = '\0';
+
+    return data_len * 2;
+}
+
+int32_t lora_hex_decode(const char* hex, size_t hex_len, uint8_t* out, size_t out_size) {
+    if((hex_len & 1) || out_size < hex_len / 2) {
+        return -1;
+    }
+
+    const uint8_t* in = (const uint8_t*)hex;
+    size_t length = hex_len / 2;
+
+    for(size_t i = 0; i < length; i++) {
+        uint8_t high = lora_hex_values[in[i * 2]];
+        uint8_t low = lora_hex_values[in[i * 2 + 1]];
+        if(!high || !low) {
+            return -1;
+        }
+        out[i] = ((high - 1) << 4) | (low - 1);
+    }
+
+    return (int32_t)length;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Characters needed to hex-encode len bytes (not counting the terminating NULL)
+#define LORA_HEX_ENCODED_LEN(len) ((len) * 2)
+
+/**
+ * @brief      Encode bytes as upper-case ASCII hex.
+ * @details    Two characters are emitted per byte using a 512-byte pair table, followed by a
+ *            terminating NULL.  Nothing is written past out_size.
+ * @param      data      The bytes to encode.
+ * @param      data_len  Number of bytes in data.
+ * @param      out       Destination buffer.
+ * @param      out_size  Size of out, must be at least LORA_HEX_ENCODED_LEN(data_len) + 1.
+ * @return     Number of characters written (without the NULL), 0 if out is too small.
+*/
+size_t lora_hex_encode(const uint8_t* data, size_t data_len, char* out, size_t out_size);
+
+/**
+ * @brief      Decode an ASCII hex string (upper or lower case) into bytes.
+ * @details    The input does not need to be NULL terminated, only hex_len characters are read.
+ * @param      hex       The characters to decode.
+ * @param      hex_len   Number of characters in hex, must be even.
+ * @param      out       Destination buffer.
+ * @param      out_size  Size of out, must be at least hex_len / 2.
+ * @return     Number of bytes decoded, -1 on odd length, invalid character or short buffer.
+*/
+int32_t lora_hex_decode(const char* hex, size_t hex_len, uint8_t* out, size_t out_size);
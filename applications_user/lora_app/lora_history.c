@@ -0,0 +1,75 @@
+#include "lora_history.h"
+
+#include <string.h>
+
+static LoRaHistoryEntry* lora_history_oldest(LoRaHistory* history) {
+    uint8_t index = (history->head + LORA_HISTORY_LEN - history->count) % LORA_HISTORY_LEN;
+    return &history->entries[index];
+}
+
+void lora_history_reset(LoRaHistory* history) {
+    history->head = 0;
+    history->count = 0;
+    history->write = 0;
+    history->total = 0;
+}
+
+void lora_history_push(
+    LoRaHistory* history,
+    const LoRaHistoryEntry* meta,
+    const uint8_t* payload,
+    size_t payload_len) {
+    if(payload_len > LORA_HISTORY_PAYLOAD_MAX) {
+        payload_len = LORA_HISTORY_PAYLOAD_MAX;
+    }
+    // Empty payloads still take a byte, so the kept payloads always follow each other in the
+    // arena from the oldest one to write
+    size_t span = payload_len > 0 ? payload_len : 1;
+
+    if(history->count == LORA_HISTORY_LEN) {
+        history->count--;
+    }
+    while(history->count > 0) {
+        uint16_t oldest = lora_history_oldest(history)->offset;
+        if(oldest < history->write) {
+            // The room up to the end of the arena is free
+            if(history->write + span <= LORA_HISTORY_ARENA) {
+                break;
+            }
+            history->write = 0;
+        } else if(oldest > history->write && history->write + span <= oldest) {
+            break;
+        } else {
+            history->count--;
+        }
+    }
+    if(history->count == 0) {
+        history->write = 0;
+    }
+
+    LoRaHistoryEntry* entry = &history->entries[history->head];
+    *entry = *meta;
+    entry->number = history->total++;
+    entry->offset = history->write;
+    entry->length = payload_len;
+    memcpy(&history->arena[entry->offset], payload, payload_len);
+
+    history->write += span;
+    history->head = (history->head + 1) % LORA_HISTORY_LEN;
+    history->count++;
+}
+
+const LoRaHistoryEntry*
+    lora_history_get(const LoRaHistory* history, size_t age, const uint8_t** payload) {
+    if(age >= history->count) {
+        return NULL;
+    }
+    const LoRaHistoryEntry* entry =
+        &history->entries[(history->head + LORA_HISTORY_LEN - 1 - age) % LORA_HISTORY_LEN];
+    *payload = &history->arena[entry->offset];
+    return entry;
+}
+
+size_t lora_history_count(const LoRaHistory* history) {
+    return history->count;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LORA_HISTORY_LEN         32 // Most packets kept
+#define LORA_HISTORY_ARENA       2048 // Bytes shared by the kept payloads
+#define LORA_HISTORY_PAYLOAD_MAX 255 // Longest payload, longer ones are cut
+
+/**
+ * Last packets received by the sniffer.  The payloads are packed one after the other in a
+ * fixed arena used as a ring, so short packets leave room for more of them.  The oldest packets
+ * are dropped when a new one needs their room or all LORA_HISTORY_LEN entries are used.  Nothing
+ * is allocated after the history itself.
+*/
+typedef struct {
+    uint32_t number; // Counts every packet pushed since the last reset
+    uint32_t tick; // furi_get_tick when the packet was read
+    uint32_t frequency; // Hz
+    int16_t rssi; // dBm
+    int8_t snr; // dB
+    uint8_t sf; // Spreading factor
+    uint16_t offset; // Payload position in the arena
+    uint8_t length; // Payload length
+} LoRaHistoryEntry;
+
+typedef struct {
+    LoRaHistoryEntry entries[LORA_HISTORY_LEN]; // Ring, head is the next entry written
+    uint8_t head;
+    uint8_t count;
+    uint16_t write; // Arena position of the next payload
+    uint32_t total; // Packets pushed since the last reset
+    uint8_t arena[LORA_HISTORY_ARENA];
+} LoRaHistory;
+
+/**
+ * @brief      Forget every packet.
+ * @param      history  The history.
+*/
+void lora_history_reset(LoRaHistory* history);
+
+/**
+ * @brief      Add a packet, dropping the oldest ones if there is no room for it.
+ * @param      history      The history.
+ * @param      meta         Packet metadata, number, offset and length are filled in.
+ * @param      payload      The payload.
+ * @param      payload_len  Bytes in payload, cut to LORA_HISTORY_PAYLOAD_MAX.
+*/
+void lora_history_push(
+    LoRaHistory* history,
+    const LoRaHistoryEntry* meta,
+    const uint8_t* payload,
+    size_t payload_len);
+
+/**
+ * @brief      Get a kept packet.
+ * @param      history  The history.
+ * @param      age      0 for the newest packet, count - 1 for the oldest.
+ * @param      payload  Set to the payload in the arena, valid until the next push.
+ * @return     The packet, NULL if age is not below the number of kept packets.
+*/
+const LoRaHistoryEntry*
+    lora_history_get(const LoRaHistory* history, size_t age, const uint8_t** payload);
+
+/**
+ * @brief      Get the number of kept packets.
+ * @param      history  The history.
+ * @return     Between 0 and LORA_HISTORY_LEN.
+*/
+size_t lora_history_count(const LoRaHistory* history);
@@ -0,0 +1,143 @@
+#include "lora_log_reader.h"
+
+#include <string.h>
+
+#define LORA_LOG_SCAN_CHUNK 64 // Read size when looking for the end of a cut line
+
+static size_t
+    lora_log_reader_read(LoRaLogReader* reader, uint64_t position, char* out, size_t size) {
+    if(!storage_file_seek(reader->file, position, true)) {
+        return 0;
+    }
+    return storage_file_read(reader->file, out, size);
+}
+
+// Load the line starting at position, the reader is unchanged on failure
+static bool lora_log_reader_load(LoRaLogReader* reader, uint64_t position) {
+    char buffer[LORA_LOG_SCAN_CHUNK];
+    size_t count;
+
+    if(position >= reader->size) {
+        return false;
+    }
+    count = lora_log_reader_read(reader, position, reader->line, LORA_LOG_LINE_MAX);
+    if(count == 0) {
+        return false;
+    }
+
+    char* newline = memchr(reader->line, '\n', count);
+    if(newline) {
+        reader->length = newline - reader->line;
+        reader->next = position + reader->length + 1;
+    } else {
+        // Cut line or last line without a line ending, find where the next line starts
+        reader->length = count;
+        reader->next = position + count;
+        while(reader->next < reader->size) {
+            count = lora_log_reader_read(reader, reader->next, buffer, sizeof(buffer));
+            if(count == 0) {
+                reader->next = reader->size;
+                break;
+            }
+            newline = memchr(buffer, '\n', count);
+            if(newline) {
+                reader->next += newline - buffer + 1;
+                break;
+            }
+            reader->next += count;
+        }
+    }
+
+    if(reader->length > 0 && reader->line[reader->length - 1] == '\r') {
+        reader->length--;
+    }
+    reader->line[reader->length] = '\0';
+    reader->offset = position;
+    return true;
+}
+
+bool lora_log_reader_open(LoRaLogReader* reader, File* file) {
+    reader->file = file;
+    reader->size = storage_file_size(file);
+    reader->offset = 0;
+    reader->next = 0;
+    reader->length = 0;
+    reader->line[0] = '\0';
+
+    if(!lora_log_reader_load(reader, 0)) {
+        return false;
+    }
+    return reader->length > 0 || lora_log_reader_next(reader);
+}
+
+bool lora_log_reader_next(LoRaLogReader* reader) {
+    uint64_t offset = reader->offset;
+    uint64_t next = reader->next;
+
+    while(lora_log_reader_load(reader, reader->next)) {
+        if(reader->length > 0) {
+            return true;
+        }
+    }
+
+    // Only empty lines left, stay on the current one
+    lora_log_reader_load(reader, offset);
+    reader->next = next;
+    return false;
+}
+
+bool lora_log_reader_prev(LoRaLogReader* reader) {
+    uint64_t current = reader->offset;
+    uint64_t offset = current;
+
+    while(offset > 0) {
+        // The previous line ends with the '\n' at offset - 1, look for the one before it
+        uint64_t end = offset - 1;
+        uint64_t start = end > LORA_LOG_LINE_MAX ? end - LORA_LOG_LINE_MAX : 0;
+        size_t count = lora_log_reader_read(reader, start, reader->line, end - start);
+        size_t line_start = 0;
+        for(size_t i = count; i > 0; i--) {
+            if(reader->line[i - 1] == '\n') {
+                line_start = i;
+                break;
+            }
+        }
+        // Without a '\n' the line is longer than the buffer, it is shown from its middle
+        offset = start + line_start;
+
+        // A CRLF file has "\r" lines where an empty line is, skip them like next does
+        if(end > offset && lora_log_reader_load(reader, offset) && reader->length > 0) {
+            return true;
+        }
+    }
+
+    lora_log_reader_load(reader, current); // The buffer was used for the search
+    return false;
+}
+
+bool lora_log_reader_seek(LoRaLogReader* reader, uint64_t position) {
+    uint64_t offset = reader->offset;
+
+    if(position > 0 && position < reader->size) {
+        // Skip the rest of the line position falls in
+        char buffer[LORA_LOG_SCAN_CHUNK];
+        uint64_t scan = position - 1;
+        while(scan < reader->size) {
+            size_t count = lora_log_reader_read(reader, scan, buffer, sizeof(buffer));
+            char* newline = count ? memchr(buffer, '\n', count) : NULL;
+            if(newline) {
+                position = scan + (newline - buffer) + 1;
+                break;
+            }
+            scan += count ? count : reader->size;
+            position = scan;
+        }
+    }
+
+    if(lora_log_reader_load(reader, position) &&
+       (reader->length > 0 || lora_log_reader_next(reader))) {
+        return true;
+    }
+    lora_log_reader_load(reader, offset);
+    return false;
+}
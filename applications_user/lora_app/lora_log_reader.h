@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <storage/storage.h>
+
+#include "lora_record.h"
+
+// Longest line kept, enough for any line the sniffer writes
+#define LORA_LOG_LINE_MAX LORA_RECORD_LINE_MAX
+
+/**
+ * Walks the lines of a capture log one at a time.  Only the current line is in memory, moving
+ * to the next or previous line reads around the current position, so the memory used does not
+ * depend on the size of the file and nothing is scanned when the file is opened.
+*/
+typedef struct {
+    File* file;
+    uint64_t size;
+    uint64_t offset; // Start of the current line
+    uint64_t next; // Start of the line after it
+    size_t length; // Characters in line, the line was cut if it is longer than LORA_LOG_LINE_MAX
+    char line[LORA_LOG_LINE_MAX + 1]; // NULL terminated, without the line ending
+} LoRaLogReader;
+
+/**
+ * @brief      Start reading a file and load its first line.
+ * @param      reader  The reader.
+ * @param      file    A file opened for reading, it stays owned by the caller.
+ * @return     false if the file holds no line.
+*/
+bool lora_log_reader_open(LoRaLogReader* reader, File* file);
+
+/**
+ * @brief      Move to the next line that is not empty.
+ * @param      reader  The reader.
+ * @return     false at the end of the file, the current line is kept.
+*/
+bool lora_log_reader_next(LoRaLogReader* reader);
+
+/**
+ * @brief      Move to the previous line that is not empty.
+ * @param      reader  The reader.
+ * @return     false at the start of the file, the current line is kept.
+*/
+bool lora_log_reader_prev(LoRaLogReader* reader);
+
+/**
+ * @brief      Move to the first line starting at or after a position of the file.
+ * @param      reader    The reader.
+ * @param      position  Byte position in the file.
+ * @return     false if no line starts there, the current line is kept.
+*/
+bool lora_log_reader_seek(LoRaLogReader* reader, uint64_t position);
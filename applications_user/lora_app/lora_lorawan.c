@@ -0,0 +1,113 @@
+#include "lora_lorawan.h"
+
+#include <string.h>
+
+#define LORA_LORAWAN_MHDR_MAJOR       0x03 // Major version, 0 for LoRaWAN R1
+#define LORA_LORAWAN_MHDR_RFU         0x1C
+#define LORA_LORAWAN_MIC_LEN          4
+#define LORA_LORAWAN_FHDR_LEN         7 // DevAddr, FCtrl and FCnt
+#define LORA_LORAWAN_JOIN_REQUEST_LEN 23 // MHDR, JoinEUI, DevEUI, DevNonce and MIC
+
+static const char* const lora_lorawan_names[] = {
+    "JoinRequest",
+    "JoinAccept",
+    "UnconfirmedUp",
+    "UnconfirmedDown",
+    "ConfirmedUp",
+    "ConfirmedDown",
+    "RejoinRequest",
+    "Proprietary",
+};
+
+static const char* const lora_lorawan_short_names[] = {
+    "JReq",
+    "JAcc",
+    "UUp",
+    "UDown",
+    "CUp",
+    "CDown",
+    "Rejoin",
+    "Prop",
+};
+
+static uint16_t lora_lorawan_get16(const uint8_t* data) {
+    return data[0] | data[1] << 8;
+}
+
+static uint32_t lora_lorawan_get32(const uint8_t* data) {
+    return data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24;
+}
+
+bool lora_lorawan_decode(const uint8_t* payload, size_t length, LoRaWANFrame* frame) {
+    memset(frame, 0, sizeof(LoRaWANFrame));
+
+    if(length < 1 + LORA_LORAWAN_MIC_LEN ||
+       (payload[0] & (LORA_LORAWAN_MHDR_MAJOR | LORA_LORAWAN_MHDR_RFU)) != 0) {
+        return false;
+    }
+    frame->mtype = payload[0] >> 5;
+    frame->mic = lora_lorawan_get32(payload + length - LORA_LORAWAN_MIC_LEN);
+
+    switch(frame->mtype) {
+    case LoRaWANMTypeJoinRequest:
+        if(length != LORA_LORAWAN_JOIN_REQUEST_LEN) {
+            return false;
+        }
+        frame->join_eui = payload + 1;
+        frame->dev_eui = payload + 1 + LORA_LORAWAN_EUI_LEN;
+        frame->dev_nonce = lora_lorawan_get16(payload + 1 + 2 * LORA_LORAWAN_EUI_LEN);
+        return true;
+    case LoRaWANMTypeJoinAccept:
+        // With or without the CFList
+        return length == 17 || length == 33;
+    case LoRaWANMTypeRejoinRequest:
+        // Types 0 and 2, or type 1
+        return length == 19 || length == 24;
+    case LoRaWANMTypeProprietary:
+        return true;
+    default:
+        break;
+    }
+
+    // Data frame: MHDR, FHDR (DevAddr, FCtrl, FCnt, FOpts), optional FPort and FRMPayload, MIC
+    const uint8_t* cursor = payload + 1;
+    const uint8_t* end = payload + length - LORA_LORAWAN_MIC_LEN;
+    if(end - cursor < LORA_LORAWAN_FHDR_LEN) {
+        return false;
+    }
+    frame->dev_addr = lora_lorawan_get32(cursor);
+    frame->fctrl = cursor[4];
+    frame->fcnt = lora_lorawan_get16(cursor + 5);
+    cursor += LORA_LORAWAN_FHDR_LEN;
+
+    frame->fopts_len = frame->fctrl & 0x0F;
+    if(end - cursor < frame->fopts_len) {
+        return false;
+    }
+    frame->fopts = frame->fopts_len ? cursor : NULL;
+    cursor += frame->fopts_len;
+
+    if(cursor < end) {
+        frame->has_port = true;
+        frame->fport = *cursor++;
+        // MAC commands go either in FOpts or in the payload of port 0, never both
+        if(frame->fport == 0 && frame->fopts_len > 0) {
+            return false;
+        }
+        frame->frm_payload = cursor;
+        frame->frm_payload_len = end - cursor;
+    }
+    return true;
+}
+
+bool lora_lorawan_is_data(LoRaWANMType mtype) {
+    return mtype >= LoRaWANMTypeUnconfirmedUp && mtype <= LoRaWANMTypeConfirmedDown;
+}
+
+const char* lora_lorawan_mtype_name(LoRaWANMType mtype) {
+    return lora_lorawan_names[mtype & 0x07];
+}
+
+const char* lora_lorawan_mtype_short_name(LoRaWANMType mtype) {
+    return lora_lorawan_short_names[mtype & 0x07];
+}
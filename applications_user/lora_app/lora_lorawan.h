@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LORA_LORAWAN_FOPTS_MAX 15 // Longest FOpts, FOptsLen is 4 bits
+#define LORA_LORAWAN_EUI_LEN   8
+#define LORA_LORAWAN_NAME_MAX  15 // Longest name returned by lora_lorawan_mtype_name
+
+// Message types, the top 3 bits of MHDR
+typedef enum {
+    LoRaWANMTypeJoinRequest,
+    LoRaWANMTypeJoinAccept,
+    LoRaWANMTypeUnconfirmedUp,
+    LoRaWANMTypeUnconfirmedDown,
+    LoRaWANMTypeConfirmedUp,
+    LoRaWANMTypeConfirmedDown,
+    LoRaWANMTypeRejoinRequest,
+    LoRaWANMTypeProprietary,
+} LoRaWANMType;
+
+/**
+ * Plain header fields of a LoRaWAN R1 frame.  Pointers go into the payload the frame was
+ * decoded from, nothing is copied, so the frame is only valid as long as that payload.
+ * Multi-byte numbers are converted from the little endian order of the air, the EUIs are left
+ * as they are sent (least significant byte first).  Join-Accept frames are encrypted after MHDR
+ * so only their type is known.
+*/
+typedef struct {
+    LoRaWANMType mtype;
+    uint32_t mic;
+
+    // Data frames (Unconfirmed/Confirmed Up/Down)
+    uint32_t dev_addr;
+    uint8_t fctrl; // ADR, ADRACKReq or RFU, ACK, ClassB or FPending, FOptsLen
+    uint16_t fcnt; // Low 16 bits of the frame counter
+    const uint8_t* fopts; // MAC commands in the header, fopts_len bytes
+    uint8_t fopts_len;
+    bool has_port; // false when the frame ends after FOpts
+    uint8_t fport; // 0 for MAC commands in FRMPayload
+    const uint8_t* frm_payload; // Encrypted application payload
+    size_t frm_payload_len;
+
+    // Join-Request
+    const uint8_t* join_eui; // LORA_LORAWAN_EUI_LEN bytes, also called AppEUI
+    const uint8_t* dev_eui; // LORA_LORAWAN_EUI_LEN bytes
+    uint16_t dev_nonce;
+} LoRaWANFrame;
+
+/**
+ * @brief      Decode the plain header fields of a LoRaWAN frame.
+ * @details    The fields are read in one forward pass, each one only after checking it fits in
+ *           what is left of the payload, so any received packet can be handed over.  A frame
+ *           is refused if its MHDR is not LoRaWAN R1, its length does not match its type, or
+ *           its FOpts do not fit, which keeps most packets of other protocols out.
+ * @param      payload  The received packet.
+ * @param      length   Bytes in payload.
+ * @param      frame    Filled with the decoded fields, fields the type doesn't have are zero.
+ * @return     true if the packet looks like a LoRaWAN frame.
+*/
+bool lora_lorawan_decode(const uint8_t* payload, size_t length, LoRaWANFrame* frame);
+
+/**
+ * @brief      Check if a message type carries DevAddr, FCtrl, FCnt and FOpts.
+ * @param      mtype  The message type.
+ * @return     true for Unconfirmed and Confirmed Up and Down.
+*/
+bool lora_lorawan_is_data(LoRaWANMType mtype);
+
+/**
+ * @brief      Name of a message type, as written in capture logs ("UnconfirmedUp").
+ * @param      mtype  The message type.
+ * @return     The name, at most LORA_LORAWAN_NAME_MAX characters.
+*/
+const char* lora_lorawan_mtype_name(LoRaWANMType mtype);
+
+/**
+ * @brief      Short name of a message type for the screen ("UUp").
+ * @param      mtype  The message type.
+ * @return     The name, at most 6 characters.
+*/
+const char* lora_lorawan_mtype_short_name(LoRaWANMType mtype);
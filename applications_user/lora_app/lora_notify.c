@@ -0,0 +1,162 @@
+#include "lora_notify.h"
+
+#include <furi.h>
+#include <string.h>
+#include <notification/notification_messages.h>
+
+#include "lora_hal.h"
+
+#define LORA_NOTIFY_START_TICKS 1 // From a post to the timer starting its pattern
+
+typedef struct {
+    uint8_t outputs; // LoRaNotifyOutput bits
+    uint8_t pulses;
+    uint16_t on_ms;
+    uint16_t off_ms; // Also the pause before the next pattern, it caps the pattern rate
+} LoRaNotifyPattern;
+
+static struct {
+    FuriTimer* timer; // NULL when not initialized
+    FuriMutex* mutex;
+    NotificationApp* notifications;
+    LoRaNotifyPattern patterns[LoRaNotifyEventCount];
+    bool playing;
+    LoRaNotifyEvent current;
+    uint8_t step; // Even steps turn the outputs on, odd ones off
+    bool pending; // Recorded by lora_notify_post, started by the timer
+    LoRaNotifyEvent pending_event;
+} lora_notify;
+
+static const LoRaNotifyPattern lora_notify_defaults[LoRaNotifyEventCount] = {
+    [LoRaNotifyEventRx] = {LoRaNotifyOutputBeacon, 1, 50, 150},
+    [LoRaNotifyEventTx] = {LoRaNotifyOutputBeacon, 1, 50, 150},
+    [LoRaNotifyEventRadio] = {LoRaNotifyOutputBeacon, 2, 100, 100},
+};
+
+static const NotificationSequence lora_notify_led_on = {&message_green_255, NULL};
+static const NotificationSequence lora_notify_led_off = {&message_green_0, NULL};
+static const NotificationSequence lora_notify_vibro_on = {&message_vibro_on, NULL};
+static const NotificationSequence lora_notify_vibro_off = {&message_vibro_off, NULL};
+static const NotificationSequence lora_notify_speaker_on = {&message_note_c7, NULL};
+static const NotificationSequence lora_notify_speaker_off = {&message_sound_off, NULL};
+
+// Only called from the timer, lora_notify_set_outputs and lora_notify_deinit: the message queue
+// of the notification service can be full, the radio thread must not wait on it
+static void lora_notify_outputs(uint8_t outputs, bool on) {
+    if(outputs & LoRaNotifyOutputBeacon) {
+        lora_hal_beacon(on);
+    }
+    if(outputs & LoRaNotifyOutputLed) {
+        notification_message(
+            lora_notify.notifications, on ? &lora_notify_led_on : &lora_notify_led_off);
+    }
+    if(outputs & LoRaNotifyOutputVibro) {
+        notification_message(
+            lora_notify.notifications, on ? &lora_notify_vibro_on : &lora_notify_vibro_off);
+    }
+    if(outputs & LoRaNotifyOutputSpeaker) {
+        notification_message(
+            lora_notify.notifications, on ? &lora_notify_speaker_on : &lora_notify_speaker_off);
+    }
+}
+
+// Called from the timer with the mutex held
+static void lora_notify_start(LoRaNotifyEvent event) {
+    const LoRaNotifyPattern* pattern = &lora_notify.patterns[event];
+    lora_notify.current = event;
+    lora_notify.step = 0;
+    lora_notify.playing = true;
+    lora_notify_outputs(pattern->outputs, true);
+    furi_timer_start(lora_notify.timer, furi_ms_to_ticks(pattern->on_ms));
+}
+
+static void lora_notify_timer_callback(void* context) {
+    UNUSED(context);
+    furi_mutex_acquire(lora_notify.mutex, FURI_WAIT_FOREVER);
+    if(!lora_notify.timer) {
+        furi_mutex_release(lora_notify.mutex); // Fired while lora_notify_deinit stops it
+        return;
+    }
+
+    if(lora_notify.playing) {
+        const LoRaNotifyPattern* pattern = &lora_notify.patterns[lora_notify.current];
+        lora_notify.step++;
+        if(lora_notify.step < pattern->pulses * 2) {
+            bool on = (lora_notify.step % 2) == 0;
+            lora_notify_outputs(pattern->outputs, on);
+            furi_timer_start(
+                lora_notify.timer, furi_ms_to_ticks(on ? pattern->on_ms : pattern->off_ms));
+        } else {
+            lora_notify.playing = false;
+        }
+    }
+    if(!lora_notify.playing && lora_notify.pending) {
+        lora_notify.pending = false;
+        lora_notify_start(lora_notify.pending_event);
+    }
+
+    furi_mutex_release(lora_notify.mutex);
+}
+
+void lora_notify_init(void) {
+    furi_assert(lora_notify.timer == NULL);
+    memcpy(lora_notify.patterns, lora_notify_defaults, sizeof(lora_notify_defaults));
+    lora_notify.playing = false;
+    lora_notify.pending = false;
+    lora_notify.notifications = furi_record_open(RECORD_NOTIFICATION);
+    lora_notify.mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    lora_notify.timer = furi_timer_alloc(lora_notify_timer_callback, FuriTimerTypeOnce, NULL);
+}
+
+void lora_notify_deinit(void) {
+    if(!lora_notify.timer) {
+        return;
+    }
+    furi_mutex_acquire(lora_notify.mutex, FURI_WAIT_FOREVER);
+    FuriTimer* timer = lora_notify.timer;
+    lora_notify.timer = NULL; // Posts are ignored from now on
+    furi_mutex_release(lora_notify.mutex);
+
+    furi_timer_stop(timer);
+    furi_timer_free(timer);
+    if(lora_notify.playing) {
+        lora_notify_outputs(lora_notify.patterns[lora_notify.current].outputs, false);
+        lora_notify.playing = false;
+    }
+    furi_mutex_free(lora_notify.mutex);
+    furi_record_close(RECORD_NOTIFICATION);
+}
+
+void lora_notify_set_outputs(LoRaNotifyEvent event, uint8_t outputs) {
+    furi_assert(event < LoRaNotifyEventCount);
+    if(!lora_notify.timer) {
+        return;
+    }
+    furi_mutex_acquire(lora_notify.mutex, FURI_WAIT_FOREVER);
+    if(lora_notify.playing && lora_notify.current == event) {
+        // Outputs dropped from the pattern would stay on
+        lora_notify_outputs(lora_notify.patterns[event].outputs & ~outputs, false);
+    }
+    lora_notify.patterns[event].outputs = outputs;
+    furi_mutex_release(lora_notify.mutex);
+}
+
+void lora_notify_post(LoRaNotifyEvent event) {
+    furi_assert(event < LoRaNotifyEventCount);
+    if(!lora_notify.timer || lora_notify.patterns[event].outputs == 0) {
+        return;
+    }
+    if(furi_mutex_acquire(lora_notify.mutex, 0) != FuriStatusOk) {
+        return;
+    }
+    // Check again, deinit may have run while we were not holding the mutex
+    if(lora_notify.timer) {
+        // While a pattern plays the timer starts the event when it ends, otherwise wake it
+        if(!lora_notify.playing && !lora_notify.pending) {
+            furi_timer_start(lora_notify.timer, LORA_NOTIFY_START_TICKS);
+        }
+        lora_notify.pending = true;
+        lora_notify.pending_event = event;
+    }
+    furi_mutex_release(lora_notify.mutex);
+}
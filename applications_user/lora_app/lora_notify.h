@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Activity feedback (LED, vibration, sound) played by a timer, so the radio and storage code
+ * only post an event and never wait for a blink to end.  An event posted while a pattern plays
+ * is kept and played after it, later ones replace it, so a burst of packets blinks at the
+ * pattern rate instead of queueing up.
+*/
+typedef enum {
+    LoRaNotifyEventRx, // Packet received
+    LoRaNotifyEventTx, // Packet sent
+    LoRaNotifyEventRadio, // Radio answered its sanity check, at start or after a reset
+    LoRaNotifyEventCount,
+} LoRaNotifyEvent;
+
+typedef enum {
+    LoRaNotifyOutputBeacon = (1 << 0), // LED of the LoRa module
+    LoRaNotifyOutputLed = (1 << 1), // Flipper LED
+    LoRaNotifyOutputVibro = (1 << 2),
+    LoRaNotifyOutputSpeaker = (1 << 3),
+} LoRaNotifyOutput;
+
+/**
+ * @brief      Start the notification timer, events posted before are ignored.
+*/
+void lora_notify_init(void);
+
+/**
+ * @brief      Stop the notification timer and turn every output off.
+*/
+void lora_notify_deinit(void);
+
+/**
+ * @brief      Choose the outputs used for an event.
+ * @param      event    The event.
+ * @param      outputs  LoRaNotifyOutput bits, 0 to stay silent.
+*/
+void lora_notify_set_outputs(LoRaNotifyEvent event, uint8_t outputs);
+
+/**
+ * @brief      Play the pattern of an event, returns at once.
+ * @details    Safe from any thread.  The event is only recorded, the timer plays it, so the
+ *           caller never talks to the notification service.  The event is dropped if another
+ *           thread is posting at the same moment, feedback is never worth a wait.
+ * @param      event  The event.
+*/
+void lora_notify_post(LoRaNotifyEvent event);
@@ -0,0 +1,109 @@
+#include "lora_perf.h"
+
+#if LORA_PERF
+
+#include <stdio.h>
+#include <string.h>
+
+// Updated without locking: the replay thread and the GUI thread can both measure, a lost
+// update only skews the statistics a little.
+static LoRaPerfStat lora_perf_stats[LoRaPerfProbeCount];
+
+static const char* const lora_perf_names[LoRaPerfProbeCount] = {
+    [LoRaPerfProbeSetStandby] = "SetStandby",
+    [LoRaPerfProbeSetRx] = "SetRx",
+    [LoRaPerfProbeSetTx] = "SetTx",
+    [LoRaPerfProbeSetRfFrequency] = "SetRfFreq",
+    [LoRaPerfProbeSetModulation] = "SetModParams",
+    [LoRaPerfProbeSetPacketParams] = "SetPktParams",
+    [LoRaPerfProbeWriteRegister] = "WriteReg",
+    [LoRaPerfProbeClearIrq] = "ClearIrq",
+    [LoRaPerfProbeOtherCommand] = "Other cmd",
+    [LoRaPerfProbeWriteBuffer] = "WriteBuffer",
+    [LoRaPerfProbeReadBuffer] = "ReadBuffer",
+    [LoRaPerfProbeBusyWait] = "BUSY wait",
+    [LoRaPerfProbeCommandWait] = "Cmd wait",
+    [LoRaPerfProbeLogWrite] = "Log write",
+    [LoRaPerfProbeSnifferDraw] = "Sniffer draw",
+    [LoRaPerfProbeTransmitterDraw] = "TX draw",
+};
+
+void lora_perf_stop(LoRaPerfProbe probe, uint32_t start) {
+    uint32_t cycles = DWT->CYCCNT - start; // Wraps every ~67 s at 64 MHz, fine for one call
+    LoRaPerfStat* stat = &lora_perf_stats[probe];
+
+    if(stat->count == 0 || cycles < stat->min) {
+        stat->min = cycles;
+    }
+    if(cycles > stat->max) {
+        stat->max = cycles;
+    }
+    stat->total += cycles;
+    stat->count++;
+}
+
+LoRaPerfProbe lora_perf_opcode_probe(uint8_t opcode) {
+    switch(opcode) {
+    case 0x80:
+        return LoRaPerfProbeSetStandby;
+    case 0x82:
+        return LoRaPerfProbeSetRx;
+    case 0x83:
+        return LoRaPerfProbeSetTx;
+    case 0x86:
+        return LoRaPerfProbeSetRfFrequency;
+    case 0x8B:
+        return LoRaPerfProbeSetModulation;
+    case 0x8C:
+        return LoRaPerfProbeSetPacketParams;
+    case 0x0D:
+        return LoRaPerfProbeWriteRegister;
+    case 0x02:
+        return LoRaPerfProbeClearIrq;
+    default:
+        return LoRaPerfProbeOtherCommand;
+    }
+}
+
+void lora_perf_reset(void) {
+    memset(lora_perf_stats, 0, sizeof(lora_perf_stats));
+}
+
+size_t lora_perf_format(char* out, size_t size) {
+    uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    size_t length = 0;
+
+    if(size) {
+        out[0] = '\0';
+    }
+
+    for(size_t i = 0; i < LoRaPerfProbeCount; i++) {
+        const LoRaPerfStat* stat = &lora_perf_stats[i];
+        if(stat->count == 0) {
+            continue;
+        }
+
+        int written = snprintf(
+            length < size ? out + length : NULL,
+            length < size ? size - length : 0,
+            "%s x%lu\n us %lu/%lu/%lu\n",
+            lora_perf_names[i],
+            (unsigned long)stat->count,
+            (unsigned long)(stat->min / cycles_per_us),
+            (unsigned long)(stat->total / stat->count / cycles_per_us),
+            (unsigned long)(stat->max / cycles_per_us));
+        if(written < 0) {
+            break;
+        }
+        length += written;
+    }
+
+    if(length == 0) {
+        int written = snprintf(out, size, "No measurements yet\n");
+        length = written > 0 ? written : 0;
+    }
+
+    return length;
+}
+
+#endif
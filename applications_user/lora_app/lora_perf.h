@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Cycle counting probes for the hot paths of the driver and the views.  Build with
+ * LORA_PERF=1 (cdefines in application.fam, or -DLORA_PERF=1) to enable them, otherwise the
+ * probes compile to nothing and the Profiling menu is left out.
+*/
+#ifndef LORA_PERF
+#define LORA_PERF 0
+#endif
+
+typedef enum {
+    // One probe per SPI command sent by the driver, selected by opcode
+    LoRaPerfProbeSetStandby, // 0x80
+    LoRaPerfProbeSetRx, // 0x82
+    LoRaPerfProbeSetTx, // 0x83
+    LoRaPerfProbeSetRfFrequency, // 0x86
+    LoRaPerfProbeSetModulation, // 0x8B
+    LoRaPerfProbeSetPacketParams, // 0x8C
+    LoRaPerfProbeWriteRegister, // 0x0D
+    LoRaPerfProbeClearIrq, // 0x02
+    LoRaPerfProbeOtherCommand, // Any other opcode
+
+    LoRaPerfProbeWriteBuffer, // Payload written for transmit
+    LoRaPerfProbeReadBuffer, // Payload read after receive
+    LoRaPerfProbeBusyWait, // checkBusy
+    LoRaPerfProbeCommandWait, // waitForRadioCommandCompletion
+    LoRaPerfProbeLogWrite, // One record written to the sniffer log
+    LoRaPerfProbeSnifferDraw,
+    LoRaPerfProbeTransmitterDraw,
+
+    LoRaPerfProbeCount,
+} LoRaPerfProbe;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min; // Cycles
+    uint32_t max; // Cycles
+    uint64_t total; // Cycles, for the average
+} LoRaPerfStat;
+
+#if LORA_PERF
+
+#include <furi_hal.h>
+
+/**
+ * @brief      Start a measurement.
+ * @return     The cycle counter, to be passed to lora_perf_stop.
+*/
+static inline uint32_t lora_perf_start(void) {
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief      Add one measurement to a probe.
+ * @param      probe  The probe.
+ * @param      start  The value returned by lora_perf_start.
+*/
+void lora_perf_stop(LoRaPerfProbe probe, uint32_t start);
+
+/**
+ * @brief      The probe of an SPI command.
+ * @param      opcode  The opcode, first byte of the command.
+ * @return     The probe, LoRaPerfProbeOtherCommand for opcodes without their own probe.
+*/
+LoRaPerfProbe lora_perf_opcode_probe(uint8_t opcode);
+
+/**
+ * @brief      Clear every probe.
+*/
+void lora_perf_reset(void);
+
+/**
+ * @brief      Write the statistics of every probe that has measurements, in microseconds.
+ * @param      out   Output buffer, always NULL terminated if size is not 0.
+ * @param      size  Size of the output buffer.
+ * @return     Length of the full text, the output was truncated if this is size or more.
+*/
+size_t lora_perf_format(char* out, size_t size);
+
+#define LORA_PERF_BEGIN(name)       uint32_t name = lora_perf_start()
+#define LORA_PERF_END(probe, name) lora_perf_stop(probe, name)
+
+#else
+
+#define LORA_PERF_BEGIN(name)
+#define LORA_PERF_END(probe, name)
+
+#endif
@@ -0,0 +1,251 @@
+#include "lora_profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+const LoRaProfile lora_profile_builtin[] = {
+    // The app defaults, also used for keys missing from a profile file
+    {"Private net", 915000000, 0x04, 8, 0x01, 0x1424, 12, 0x00, 0x00, 0x00},
+    {"TTN EU868 DR5", 868100000, 0x04, 7, 0x01, 0x3444, 8, 0x00, 0x01, 0x00},
+    {"Meshtastic LongFast", 906875000, 0x05, 11, 0x01, 0x24B4, 16, 0x00, 0x01, 0x00},
+};
+
+const size_t lora_profile_builtin_count = COUNT(lora_profile_builtin);
+
+// Bandwidth in Hz for each SX126x bandwidth code, as written in profile files
+static const struct {
+    uint8_t code;
+    uint32_t hz;
+} profile_bandwidths[] = {
+    {0x00, 7810},
+    {0x08, 10420},
+    {0x01, 15630},
+    {0x09, 20830},
+    {0x02, 31250},
+    {0x0A, 41670},
+    {0x03, 62500},
+    {0x04, 125000},
+    {0x05, 250000},
+    {0x06, 500000},
+};
+
+static uint32_t lora_profile_bandwidth_hz(uint8_t code) {
+    for(size_t i = 0; i < COUNT(profile_bandwidths); i++) {
+        if(profile_bandwidths[i].code == code) {
+            return profile_bandwidths[i].hz;
+        }
+    }
+    return 0;
+}
+
+bool lora_profile_is_valid(const LoRaProfile* profile) {
+    return profile->name[0] != '\0' && profile->frequency >= 150000000 &&
+           profile->frequency <= 960000000 && lora_profile_bandwidth_hz(profile->bw) != 0 &&
+           profile->sf >= 5 && profile->sf <= 12 && profile->cr >= 1 && profile->cr <= 4 &&
+           profile->header_type <= 1 && profile->crc <= 1 && profile->iq <= 1;
+}
+
+static bool lora_profile_parse_number(const char* text, const char* end, uint32_t* value) {
+    uint32_t base = 10;
+    uint32_t result = 0;
+
+    if(end - text > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text += 2;
+    }
+    if(text == end) {
+        return false;
+    }
+
+    for(; text < end; text++) {
+        uint32_t digit;
+        if(*text >= '0' && *text <= '9') {
+            digit = *text - '0';
+        } else if(base == 16 && *text >= 'a' && *text <= 'f') {
+            digit = *text - 'a' + 10;
+        } else if(base == 16 && *text >= 'A' && *text <= 'F') {
+            digit = *text - 'A' + 10;
+        } else {
+            return false;
+        }
+        if(result > (UINT32_MAX - digit) / base) {
+            return false; // Doesn't fit in 32 bits
+        }
+        result = result * base + digit;
+    }
+
+    *value = result;
+    return true;
+}
+
+static bool lora_profile_key_is(const char* key, size_t key_len, const char* text) {
+    return strlen(text) == key_len && memcmp(key, text, key_len) == 0;
+}
+
+// Apply one key=value line, false if the key is unknown or the value doesn't fit its field
+static bool lora_profile_parse_value(
+    LoRaProfile* profile,
+    const char* key,
+    size_t key_len,
+    const char* value,
+    const char* end) {
+    uint32_t number;
+    if(!lora_profile_parse_number(value, end, &number)) {
+        return false;
+    }
+
+    if(lora_profile_key_is(key, key_len, "frequency")) {
+        profile->frequency = number;
+    } else if(lora_profile_key_is(key, key_len, "bw")) {
+        for(size_t i = 0; i < COUNT(profile_bandwidths); i++) {
+            if(profile_bandwidths[i].hz == number) {
+                profile->bw = profile_bandwidths[i].code;
+                return true;
+            }
+        }
+        return false;
+    } else if(lora_profile_key_is(key, key_len, "sf")) {
+        if(number < 5 || number > 12) {
+            return false;
+        }
+        profile->sf = number;
+    } else if(lora_profile_key_is(key, key_len, "cr")) {
+        if(number < 5 || number > 8) {
+            return false;
+        }
+        profile->cr = number - 4; // 4/5 is code 1
+    } else if(lora_profile_key_is(key, key_len, "sync")) {
+        if(number > 0xFFFF) {
+            return false;
+        }
+        if(number <= 0xFF) {
+            // One byte sync word of the SX127x and other libraries, each nibble goes to one
+            // register followed by the control bits 0x4: 0x2B is 0x24B4, 0x34 is 0x3444
+            number = (number & 0xF0) << 8 | (number & 0x0F) << 4 | 0x0404;
+        }
+        profile->sync_word = number;
+    } else if(lora_profile_key_is(key, key_len, "preamble")) {
+        if(number < 1 || number > 0xFFFF) {
+            return false;
+        }
+        profile->preamble = number;
+    } else if(number > 1) {
+        return false; // The remaining keys are all flags
+    } else if(lora_profile_key_is(key, key_len, "header")) {
+        profile->header_type = number;
+    } else if(lora_profile_key_is(key, key_len, "crc")) {
+        profile->crc = number;
+    } else if(lora_profile_key_is(key, key_len, "iq")) {
+        profile->iq = number;
+    } else {
+        return false; // Most likely a typo, don't silently use a default instead
+    }
+    return true;
+}
+
+size_t lora_profile_parse(const char* text, size_t length, LoRaProfile* profiles, size_t max) {
+    const char* end = text + length;
+    size_t count = 0;
+    bool open = false; // A profile is being parsed
+    bool valid = false;
+
+    while(text < end) {
+        const char* line = text;
+        const char* line_end = memchr(text, '\n', end - text);
+        if(!line_end) {
+            line_end = end;
+        }
+        text = line_end + 1;
+
+        // Trim blanks and the '\r' of CRLF files
+        while(line < line_end && (*line == ' ' || *line == '\t')) {
+            line++;
+        }
+        while(line_end > line &&
+              (line_end[-1] == ' ' || line_end[-1] == '\t' || line_end[-1] == '\r')) {
+            line_end--;
+        }
+        if(line == line_end || *line == '#') {
+            continue;
+        }
+
+        if(*line == '[' && line_end[-1] == ']') {
+            // Close the previous profile before starting a new one
+            if(open && valid && lora_profile_is_valid(&profiles[count])) {
+                count++;
+            }
+            open = count < max;
+            if(!open) {
+                break;
+            }
+
+            size_t name_len = line_end - line - 2;
+            if(name_len >= LORA_PROFILE_NAME_LEN) {
+                name_len = LORA_PROFILE_NAME_LEN - 1;
+            }
+            profiles[count] = lora_profile_builtin[0];
+            memcpy(profiles[count].name, line + 1, name_len);
+            profiles[count].name[name_len] = '\0';
+            valid = true;
+            continue;
+        }
+
+        const char* equals = memchr(line, '=', line_end - line);
+        if(!open || !equals) {
+            continue;
+        }
+
+        const char* key_end = equals;
+        while(key_end > line && (key_end[-1] == ' ' || key_end[-1] == '\t')) {
+            key_end--;
+        }
+        const char* value = equals + 1;
+        while(value < line_end && (*value == ' ' || *value == '\t')) {
+            value++;
+        }
+
+        if(!lora_profile_parse_value(&profiles[count], line, key_end - line, value, line_end)) {
+            valid = false;
+        }
+    }
+
+    if(open && valid && lora_profile_is_valid(&profiles[count])) {
+        count++;
+    }
+    return count;
+}
+
+size_t lora_profile_format(const LoRaProfile* profiles, size_t count, char* out, size_t size) {
+    size_t length = 0;
+
+    if(size) {
+        out[0] = '\0';
+    }
+
+    for(size_t i = 0; i < count; i++) {
+        const LoRaProfile* profile = &profiles[i];
+        int written = snprintf(
+            length < size ? out + length : NULL,
+            length < size ? size - length : 0,
+            "[%s]\nfrequency=%lu\nbw=%lu\nsf=%u\ncr=%u\nsync=0x%04X\npreamble=%u\n"
+            "header=%u\ncrc=%u\niq=%u\n\n",
+            profile->name,
+            (unsigned long)profile->frequency,
+            (unsigned long)lora_profile_bandwidth_hz(profile->bw),
+            profile->sf,
+            profile->cr + 4,
+            profile->sync_word,
+            profile->preamble,
+            profile->header_type,
+            profile->crc,
+            profile->iq);
+        if(written < 0) {
+            break;
+        }
+        length += written;
+    }
+
+    return length;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LORA_PROFILE_MAX      8
+#define LORA_PROFILE_NAME_LEN 24
+
+/**
+ * A complete radio configuration that can be switched to in one step.  Values are the ones
+ * written to the radio, not indices of the configuration screen, so a profile file means the
+ * same thing to every build.
+*/
+typedef struct {
+    char name[LORA_PROFILE_NAME_LEN];
+    uint32_t frequency; // Hz
+    uint8_t bw; // SX126x bandwidth code
+    uint8_t sf; // Spreading factor, 5-12
+    uint8_t cr; // Coding rate code, 1-4 for 4/5-4/8
+    uint16_t sync_word;
+    uint16_t preamble; // Preamble length in symbols
+    uint8_t header_type; // 0x00 = Variable Len, 0x01 = Fixed Length
+    uint8_t crc; // 0x00 = Off, 0x01 = On
+    uint8_t iq; // 0x00 = Standard, 0x01 = Inverted
+} LoRaProfile;
+
+extern const LoRaProfile lora_profile_builtin[];
+extern const size_t lora_profile_builtin_count;
+
+/**
+ * @brief      Check that every value of a profile can be written to the radio.
+ * @param      profile  The profile.
+ * @return     true if the profile is usable.
+*/
+bool lora_profile_is_valid(const LoRaProfile* profile);
+
+/**
+ * @brief      Parse profiles from text.
+ * @details    Each profile starts with its name in brackets, followed by key=value lines:
+ *              [Meshtastic LongFast]
+ *              frequency=906875000
+ *              bw=250000
+ *              sf=11
+ *              cr=5
+ *              sync=0x2B
+ *              preamble=16
+ *              header=0
+ *              crc=1
+ *              iq=0
+ *            A sync word up to 0xFF is the one byte form used by other radios and libraries,
+ *            0x2B is stored as the register value 0x24B4.  Missing keys keep the values of the
+ *            first built-in profile.  Lines starting with '#' are comments.  Profiles with an
+ *            unknown key or a value out of range are skipped.
+ * @param      text      The text, does not need to be NULL terminated.
+ * @param      length    Number of characters in text.
+ * @param      profiles  Output array.
+ * @param      max       Size of the output array.
+ * @return     Number of profiles parsed.
+*/
+size_t lora_profile_parse(const char* text, size_t length, LoRaProfile* profiles, size_t max);
+
+/**
+ * @brief      Write profiles in the format read by lora_profile_parse.
+ * @param      profiles  The profiles.
+ * @param      count     Number of profiles.
+ * @param      out       Output buffer, always NULL terminated if size is not 0.
+ * @param      size      Size of the output buffer.
+ * @return     Length of the full text, the output was truncated if this is size or more.
+*/
+size_t lora_profile_format(const LoRaProfile* profiles, size_t count, char* out, size_t size);
@@ -0,0 +1,326 @@
+#include "lora_record.h"
+
+#include <string.h>
+
+#define LORA_RECORD_KEY(key) key, sizeof(key) - 1
+
+typedef struct {
+    const char* key;
+    size_t key_len;
+    size_t offset;
+} LoRaRecordKey;
+
+static const LoRaRecordKey lora_record_keys[] = {
+    {LORA_RECORD_KEY("date"), offsetof(LoRaRecord, date)},
+    {LORA_RECORD_KEY("time"), offsetof(LoRaRecord, time)},
+    {LORA_RECORD_KEY("frequency"), offsetof(LoRaRecord, frequency)},
+    {LORA_RECORD_KEY("bw"), offsetof(LoRaRecord, bw)},
+    {LORA_RECORD_KEY("sf"), offsetof(LoRaRecord, sf)},
+    {LORA_RECORD_KEY("RSSI"), offsetof(LoRaRecord, rssi)},
+    {LORA_RECORD_KEY("payload"), offsetof(LoRaRecord, payload)},
+    {LORA_RECORD_KEY("mtype"), offsetof(LoRaRecord, mtype)},
+    {LORA_RECORD_KEY("devaddr"), offsetof(LoRaRecord, devaddr)},
+    {LORA_RECORD_KEY("fctrl"), offsetof(LoRaRecord, fctrl)},
+    {LORA_RECORD_KEY("fcnt"), offsetof(LoRaRecord, fcnt)},
+    {LORA_RECORD_KEY("fopts"), offsetof(LoRaRecord, fopts)},
+    {LORA_RECORD_KEY("fport"), offsetof(LoRaRecord, fport)},
+    {LORA_RECORD_KEY("joineui"), offsetof(LoRaRecord, joineui)},
+    {LORA_RECORD_KEY("deveui"), offsetof(LoRaRecord, deveui)},
+    {LORA_RECORD_KEY("devnonce"), offsetof(LoRaRecord, devnonce)},
+};
+
+static LoRaRecordField* lora_record_lookup(LoRaRecord* record, const char* key, size_t key_len) {
+    for(size_t i = 0; i < sizeof(lora_record_keys) / sizeof(lora_record_keys[0]); i++) {
+        if(lora_record_keys[i].key_len == key_len &&
+           memcmp(lora_record_keys[i].key, key, key_len) == 0) {
+            return (LoRaRecordField*)((uint8_t*)record + lora_record_keys[i].offset);
+        }
+    }
+    return NULL;
+}
+
+bool lora_record_parse(const char* line, size_t length, LoRaRecord* record) {
+    const char* cursor = line;
+    const char* line_end = line + length;
+
+    memset(record, 0, sizeof(LoRaRecord));
+
+    while(cursor < line_end) {
+        // "key"
+        const char* key = memchr(cursor, '"', line_end - cursor);
+        if(!key) break;
+        key++;
+        const char* key_end = memchr(key, '"', line_end - key);
+        if(!key_end) break;
+
+        // : "value"
+        cursor = key_end + 1;
+        while(cursor < line_end && (*cursor == ' ' || *cursor == ':')) {
+            cursor++;
+        }
+        if(cursor >= line_end || *cursor != '"') continue;
+        const char* value = cursor + 1;
+        const char* value_end = memchr(value, '"', line_end - value);
+        if(!value_end) break;
+        cursor = value_end + 1;
+
+        LoRaRecordField* field = lora_record_lookup(record, key, key_end - key);
+        if(field) {
+            field->ptr = value;
+            field->len = value_end - value;
+        }
+    }
+
+    return record->payload.ptr != NULL;
+}
+
+// Parse exactly count decimal digits
+static bool lora_record_parse_digits(const char* text, size_t count, uint32_t* value) {
+    uint32_t result = 0;
+    for(size_t i = 0; i < count; i++) {
+        if(text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        result = result * 10 + (text[i] - '0');
+    }
+    *value = result;
+    return true;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+static uint32_t lora_record_days_from_civil(uint32_t year, uint32_t month, uint32_t day) {
+    year -= month <= 2;
+    uint32_t era = year / 400;
+    uint32_t year_of_era = year - era * 400;
+    uint32_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+bool lora_record_get_timestamp(const LoRaRecord* record, uint32_t* seconds) {
+    // "YYYY-MM-DD" and "HH:MM:SS"
+    const char* date = record->date.ptr;
+    const char* time = record->time.ptr;
+    if(record->date.len != 10 || record->time.len != 8 || date[4] != '-' || date[7] != '-' ||
+       time[2] != ':' || time[5] != ':') {
+        return false;
+    }
+
+    uint32_t year, month, day, hour, minute, second;
+    if(!lora_record_parse_digits(date, 4, &year) || !lora_record_parse_digits(date + 5, 2, &month) ||
+       !lora_record_parse_digits(date + 8, 2, &day) || !lora_record_parse_digits(time, 2, &hour) ||
+       !lora_record_parse_digits(time + 3, 2, &minute) ||
+       !lora_record_parse_digits(time + 6, 2, &second)) {
+        return false;
+    }
+    if(year < 1970 || month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 ||
+       minute > 59 || second > 59) {
+        return false;
+    }
+
+    *seconds = lora_record_days_from_civil(year, month, day) * 86400 + hour * 3600 +
+               minute * 60 + second;
+    return true;
+}
+
+bool lora_record_get_frequency(const LoRaRecord* record, uint32_t* hz) {
+    const char* text = record->frequency.ptr;
+    const char* end = text + record->frequency.len;
+    uint32_t mhz = 0;
+    uint32_t fraction = 0;
+    uint32_t scale = 1000000;
+
+    if(!text || text == end || *text < '0' || *text > '9') {
+        return false;
+    }
+
+    // Whole MHz, then up to six decimals, anything after that (" MHz") is ignored
+    for(; text < end && *text >= '0' && *text <= '9'; text++) {
+        mhz = mhz * 10 + (*text - '0');
+        if(mhz > 10000) {
+            return false;
+        }
+    }
+    if(text < end && *text == '.') {
+        for(text++; text < end && *text >= '0' && *text <= '9'; text++) {
+            if(scale > 1) {
+                scale /= 10;
+                fraction += (*text - '0') * scale;
+            }
+        }
+    }
+
+    *hz = mhz * 1000000 + fraction;
+    return true;
+}
+
+bool lora_record_get_spreading_factor(const LoRaRecord* record, uint8_t* sf) {
+    uint32_t value;
+    const char* text = record->sf.ptr;
+    size_t length = record->sf.len;
+
+    if(length < 3 || length > 4 || text[0] != 'S' || text[1] != 'F' ||
+       !lora_record_parse_digits(text + 2, length - 2, &value)) {
+        return false;
+    }
+
+    *sf = value;
+    return true;
+}
+
+bool lora_record_get_rssi(const LoRaRecord* record, int16_t* rssi) {
+    uint32_t value;
+    const char* text = record->rssi.ptr;
+    size_t length = record->rssi.len;
+    bool negative = length > 0 && text[0] == '-';
+
+    if(negative) {
+        text++;
+        length--;
+    }
+    if(length < 1 || length > 3 || !lora_record_parse_digits(text, length, &value)) {
+        return false;
+    }
+
+    *rssi = negative ? -(int16_t)value : (int16_t)value;
+    return true;
+}
+
+bool lora_record_field_equals(const LoRaRecordField* field, const char* text) {
+    return field->ptr && strlen(text) == field->len && memcmp(field->ptr, text, field->len) == 0;
+}
+
+// Append a literal without its NULL
+#define LORA_RECORD_PUT(cursor, text)       \
+    do {                                        \
+        memcpy(cursor, text, sizeof(text) - 1); \
+        cursor += sizeof(text) - 1;             \
+    } while(0)
+
+static char* lora_record_put_digits(char* cursor, uint32_t value, size_t count) {
+    for(size_t i = count; i > 0; i--) {
+        cursor[i - 1] = '0' + value % 10;
+        value /= 10;
+    }
+    return cursor + count;
+}
+
+static char* lora_record_put_text(char* cursor, const char* text) {
+    for(size_t i = 0; text && text[i] && i < LORA_RECORD_TEXT_MAX; i++) {
+        char c = text[i];
+        *cursor++ = (c == '"' || c == '\\' || (unsigned char)c < ' ') ? '?' : c;
+    }
+    return cursor;
+}
+
+static char* lora_record_put_int(char* cursor, int32_t value) {
+    char digits[10];
+    size_t count = 0;
+    uint32_t magnitude = value < 0 ? -(uint32_t)value : (uint32_t)value;
+
+    if(value < 0) {
+        *cursor++ = '-';
+    }
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while(magnitude > 0);
+    while(count > 0) {
+        *cursor++ = digits[--count];
+    }
+    return cursor;
+}
+
+// Append bytes as hex with the most significant byte first, the order they are usually shown
+static char* lora_record_put_reversed(char* cursor, const uint8_t* data, size_t length) {
+    static const char digits[] = "0123456789ABCDEF";
+    for(size_t i = length; i > 0; i--) {
+        *cursor++ = digits[data[i - 1] >> 4];
+        *cursor++ = digits[data[i - 1] & 0x0F];
+    }
+    return cursor;
+}
+
+static char* lora_record_put_lorawan(char* cursor, const LoRaWANFrame* frame) {
+    uint8_t bytes[4];
+
+    LORA_RECORD_PUT(cursor, ", \"mtype\":\"");
+    const char* name = lora_lorawan_mtype_name(frame->mtype);
+    size_t name_len = strlen(name);
+    memcpy(cursor, name, name_len);
+    cursor += name_len;
+
+    if(lora_lorawan_is_data(frame->mtype)) {
+        LORA_RECORD_PUT(cursor, "\", \"devaddr\":\"");
+        for(size_t i = 0; i < sizeof(bytes); i++) {
+            bytes[i] = frame->dev_addr >> (8 * i);
+        }
+        cursor = lora_record_put_reversed(cursor, bytes, sizeof(bytes));
+        LORA_RECORD_PUT(cursor, "\", \"fctrl\":\"");
+        cursor = lora_record_put_reversed(cursor, &frame->fctrl, 1);
+        LORA_RECORD_PUT(cursor, "\", \"fcnt\":\"");
+        cursor = lora_record_put_int(cursor, frame->fcnt);
+        if(frame->fopts_len > 0) {
+            // Sent order, MAC commands are read from the first byte
+            LORA_RECORD_PUT(cursor, "\", \"fopts\":\"");
+            for(size_t i = 0; i < frame->fopts_len; i++) {
+                cursor = lora_record_put_reversed(cursor, &frame->fopts[i], 1);
+            }
+        }
+        if(frame->has_port) {
+            LORA_RECORD_PUT(cursor, "\", \"fport\":\"");
+            cursor = lora_record_put_int(cursor, frame->fport);
+        }
+    } else if(frame->mtype == LoRaWANMTypeJoinRequest) {
+        LORA_RECORD_PUT(cursor, "\", \"joineui\":\"");
+        cursor = lora_record_put_reversed(cursor, frame->join_eui, LORA_LORAWAN_EUI_LEN);
+        LORA_RECORD_PUT(cursor, "\", \"deveui\":\"");
+        cursor = lora_record_put_reversed(cursor, frame->dev_eui, LORA_LORAWAN_EUI_LEN);
+        LORA_RECORD_PUT(cursor, "\", \"devnonce\":\"");
+        cursor = lora_record_put_int(cursor, frame->dev_nonce);
+    }
+
+    *cursor++ = '"';
+    return cursor;
+}
+
+size_t lora_record_format(const LoRaRecordPacket* packet, char* out, size_t out_size) {
+    if(out_size < LORA_RECORD_LINE_MAX) {
+        return 0;
+    }
+    size_t payload_len = packet->payload_len < LORA_RECORD_PAYLOAD_MAX ?
+                             packet->payload_len :
+                             LORA_RECORD_PAYLOAD_MAX;
+    char* cursor = out;
+
+    LORA_RECORD_PUT(cursor, "{\"date\":\"");
+    cursor = lora_record_put_digits(cursor, packet->year % 10000, 4);
+    *cursor++ = '-';
+    cursor = lora_record_put_digits(cursor, packet->month % 100, 2);
+    *cursor++ = '-';
+    cursor = lora_record_put_digits(cursor, packet->day % 100, 2);
+    LORA_RECORD_PUT(cursor, "\", \"time\":\"");
+    cursor = lora_record_put_digits(cursor, packet->hour % 100, 2);
+    *cursor++ = ':';
+    cursor = lora_record_put_digits(cursor, packet->minute % 100, 2);
+    *cursor++ = ':';
+    cursor = lora_record_put_digits(cursor, packet->second % 100, 2);
+    LORA_RECORD_PUT(cursor, "\", \"frequency\":\"");
+    cursor = lora_record_put_text(cursor, packet->frequency);
+    LORA_RECORD_PUT(cursor, "\", \"bw\":\"");
+    cursor = lora_record_put_text(cursor, packet->bw);
+    LORA_RECORD_PUT(cursor, "\", \"sf\":\"");
+    cursor = lora_record_put_text(cursor, packet->sf);
+    LORA_RECORD_PUT(cursor, "\", \"RSSI\":\"");
+    cursor = lora_record_put_int(cursor, packet->rssi);
+    LORA_RECORD_PUT(cursor, "\", \"payload\":\"");
+    // The hex encoder ends with a NULL, the closing quote goes over it
+    cursor += lora_hex_encode(packet->payload, payload_len, cursor, out + out_size - cursor);
+    *cursor++ = '"';
+    if(packet->lorawan) {
+        cursor = lora_record_put_lorawan(cursor, packet->lorawan);
+    }
+    LORA_RECORD_PUT(cursor, "}\n");
+
+    return cursor - out;
+}
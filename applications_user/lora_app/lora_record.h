@@ -0,0 +1,162 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lora_hex.h"
+#include "lora_lorawan.h"
+
+/**
+ * One line of a capture log, as written by the sniffer:
+ *
+ *   {"date":"2024-05-01", "time":"12:00:03", "frequency":"915.0", "bw":"125 kHz",
+ *    "sf":"SF8", "RSSI":"-71", "payload":"40F17DBE4900020001954378762B11FF0D",
+ *    "mtype":"UnconfirmedUp", "devaddr":"49BE7DF1", "fctrl":"00", "fcnt":"2", "fport":"1"}
+ *
+ * The LoRaWAN fields after the payload are only written for packets that decode as LoRaWAN:
+ * mtype for all of them, devaddr, fctrl, fcnt, fopts (when not empty) and fport (when present)
+ * for data frames, joineui, deveui and devnonce for Join-Requests.  Numbers are decimal,
+ * DevAddr and the EUIs are hex with the most significant byte first.
+ *
+ * Every field points into the line it was parsed from, nothing is copied.  Fields that are
+ * missing from the line have a NULL pointer and a zero length.
+*/
+typedef struct {
+    const char* ptr;
+    size_t len;
+} LoRaRecordField;
+
+typedef struct {
+    LoRaRecordField date;
+    LoRaRecordField time;
+    LoRaRecordField frequency;
+    LoRaRecordField bw;
+    LoRaRecordField sf;
+    LoRaRecordField rssi;
+    LoRaRecordField payload;
+    LoRaRecordField mtype;
+    LoRaRecordField devaddr;
+    LoRaRecordField fctrl;
+    LoRaRecordField fcnt;
+    LoRaRecordField fopts;
+    LoRaRecordField fport;
+    LoRaRecordField joineui;
+    LoRaRecordField deveui;
+    LoRaRecordField devnonce;
+} LoRaRecord;
+
+/**
+ * @brief      Parse a capture log line in a single pass.
+ * @details    Unknown keys are skipped so newer log lines stay readable by older parsers.
+ * @param      line    The line, does not need to be NULL terminated.
+ * @param      length  Number of characters in line.
+ * @param      record  Filled with the fields found in the line.
+ * @return     true if the line holds a payload field.
+*/
+bool lora_record_parse(const char* line, size_t length, LoRaRecord* record);
+
+/**
+ * @brief      Convert the record date and time into seconds since 1970-01-01.
+ * @param      record   A parsed record.
+ * @param      seconds  The capture time, only written on success.
+ * @return     true if both date and time are present and well formed.
+*/
+bool lora_record_get_timestamp(const LoRaRecord* record, uint32_t* seconds);
+
+/**
+ * @brief      Convert the record frequency ("915.0" or "868.1 MHz") into Hz.
+ * @param      record  A parsed record.
+ * @param      hz      The frequency, only written on success.
+ * @return     true if the frequency is present and well formed.
+*/
+bool lora_record_get_frequency(const LoRaRecord* record, uint32_t* hz);
+
+/**
+ * @brief      Convert the record spreading factor ("SF7") into its number.
+ * @param      record  A parsed record.
+ * @param      sf      The spreading factor, only written on success.
+ * @return     true if the spreading factor is present and well formed.
+*/
+bool lora_record_get_spreading_factor(const LoRaRecord* record, uint8_t* sf);
+
+/**
+ * @brief      Convert the record RSSI ("-71") into dBm.
+ * @param      record  A parsed record.
+ * @param      rssi    The RSSI, only written on success.
+ * @return     true if the RSSI is present and well formed.
+*/
+bool lora_record_get_rssi(const LoRaRecord* record, int16_t* rssi);
+
+/**
+ * @brief      Compare a record field against a string.
+ * @param      field  A field of a parsed record.
+ * @param      text   NULL terminated text to compare with.
+ * @return     true if the field holds exactly text.
+*/
+bool lora_record_field_equals(const LoRaRecordField* field, const char* text);
+
+#define LORA_RECORD_TEXT_MAX    16 // Longest frequency, bandwidth or spreading factor text written
+#define LORA_RECORD_PAYLOAD_MAX 255 // Largest LoRa payload
+
+// Line written by lora_record_format with empty texts and payload and the widest numbers
+#define LORA_RECORD_LINE_SKELETON                                                        \
+    "{\"date\":\"0000-00-00\", \"time\":\"00:00:00\", \"frequency\":\"\", \"bw\":\"\", " \
+    "\"sf\":\"\", \"RSSI\":\"-32768\", \"payload\":\"\"}\n"
+
+// LoRaWAN fields of a data frame with empty mtype and FOpts and the widest numbers
+#define LORA_RECORD_DATA_SKELETON                                                        \
+    ", \"mtype\":\"\", \"devaddr\":\"00000000\", \"fctrl\":\"00\", \"fcnt\":\"65535\", " \
+    "\"fopts\":\"\", \"fport\":\"255\""
+
+// LoRaWAN fields of a Join-Request with an empty mtype
+#define LORA_RECORD_JOIN_SKELETON                                                           \
+    ", \"mtype\":\"\", \"joineui\":\"0000000000000000\", \"deveui\":\"0000000000000000\", " \
+    "\"devnonce\":\"65535\""
+
+#define LORA_RECORD_DATA_MAX                                                               \
+    (sizeof(LORA_RECORD_DATA_SKELETON) - 1 + LORA_HEX_ENCODED_LEN(LORA_LORAWAN_FOPTS_MAX))
+#define LORA_RECORD_JOIN_MAX (sizeof(LORA_RECORD_JOIN_SKELETON) - 1)
+
+// Longest LoRaWAN fields lora_record_format writes
+#define LORA_RECORD_LORAWAN_MAX                                             \
+    (LORA_LORAWAN_NAME_MAX + (LORA_RECORD_DATA_MAX > LORA_RECORD_JOIN_MAX ? \
+                                  LORA_RECORD_DATA_MAX :                    \
+                                  LORA_RECORD_JOIN_MAX))
+
+// Longest line lora_record_format writes, plus room for a NULL
+#define LORA_RECORD_LINE_MAX                                                  \
+    (sizeof(LORA_RECORD_LINE_SKELETON) + 3 * LORA_RECORD_TEXT_MAX +           \
+     LORA_HEX_ENCODED_LEN(LORA_RECORD_PAYLOAD_MAX) + LORA_RECORD_LORAWAN_MAX)
+
+/**
+ * A received packet, as lora_record_format writes it.
+*/
+typedef struct {
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    const char* frequency; // Text as configured ("915.0"), cut to LORA_RECORD_TEXT_MAX
+    const char* bw; // Bandwidth name ("125 kHz"), cut to LORA_RECORD_TEXT_MAX
+    const char* sf; // Spreading factor name ("SF8"), cut to LORA_RECORD_TEXT_MAX
+    int16_t rssi; // dBm
+    const uint8_t* payload;
+    size_t payload_len; // Cut to LORA_RECORD_PAYLOAD_MAX
+    const LoRaWANFrame* lorawan; // Decoded from payload, NULL if it is not LoRaWAN
+} LoRaRecordPacket;
+
+/**
+ * @brief      Write a packet as a capture log line in a single pass.
+ * @details    The line ends with a newline and can be handed to the file as it is.  The buffer
+ *           size is only checked once, against LORA_RECORD_LINE_MAX, so nothing is measured or
+ *           copied twice.  Quotes, backslashes and control characters in the texts become '?'
+ *           so the line stays valid JSON.
+ * @param      packet    The packet.
+ * @param      out       Destination buffer, the line is not NULL terminated.
+ * @param      out_size  Size of out, must be at least LORA_RECORD_LINE_MAX.
+ * @return     Number of characters written, 0 if out is too small.
+*/
+size_t lora_record_format(const LoRaRecordPacket* packet, char* out, size_t out_size);
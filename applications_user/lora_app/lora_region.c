@@ -0,0 +1,167 @@
+#include "lora_region.h"
+
+#include <stdio.h>
+
+#define COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+// Channel plans and data rates from the LoRaWAN Regional Parameters (RP002-1.0.3)
+
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// DR0-DR5 SF12-SF7 at 125 kHz, DR6 SF7 at 250 kHz (EU868, EU433, AS923, RU864)
+static const LoRaRegionDataRate data_rates_eu[] = {
+    {0, 12, LORA_REGION_BW_125, "SF12/125kHz"},
+    {1, 11, LORA_REGION_BW_125, "SF11/125kHz"},
+    {2, 10, LORA_REGION_BW_125, "SF10/125kHz"},
+    {3, 9, LORA_REGION_BW_125, "SF9/125kHz"},
+    {4, 8, LORA_REGION_BW_125, "SF8/125kHz"},
+    {5, 7, LORA_REGION_BW_125, "SF7/125kHz"},
+    {6, 7, LORA_REGION_BW_250, "SF7/250kHz"},
+};
+
+// DR0-DR5 SF12-SF7 at 125 kHz only (KR920, IN865, CN470)
+#define DATA_RATES_125K_COUNT 6
+
+static const LoRaRegionDataRate data_rates_us915[] = {
+    {0, 10, LORA_REGION_BW_125, "SF10/125kHz"},
+    {1, 9, LORA_REGION_BW_125, "SF9/125kHz"},
+    {2, 8, LORA_REGION_BW_125, "SF8/125kHz"},
+    {3, 7, LORA_REGION_BW_125, "SF7/125kHz"},
+    {4, 8, LORA_REGION_BW_500, "SF8/500kHz"},
+    {8, 12, LORA_REGION_BW_500, "SF12/500kHz"},
+    {9, 11, LORA_REGION_BW_500, "SF11/500kHz"},
+    {10, 10, LORA_REGION_BW_500, "SF10/500kHz"},
+    {11, 9, LORA_REGION_BW_500, "SF9/500kHz"},
+    {12, 8, LORA_REGION_BW_500, "SF8/500kHz"},
+    {13, 7, LORA_REGION_BW_500, "SF7/500kHz"},
+};
+
+static const LoRaRegionDataRate data_rates_au915[] = {
+    {0, 12, LORA_REGION_BW_125, "SF12/125kHz"},
+    {1, 11, LORA_REGION_BW_125, "SF11/125kHz"},
+    {2, 10, LORA_REGION_BW_125, "SF10/125kHz"},
+    {3, 9, LORA_REGION_BW_125, "SF9/125kHz"},
+    {4, 8, LORA_REGION_BW_125, "SF8/125kHz"},
+    {5, 7, LORA_REGION_BW_125, "SF7/125kHz"},
+    {6, 8, LORA_REGION_BW_500, "SF8/500kHz"},
+    {8, 12, LORA_REGION_BW_500, "SF12/500kHz"},
+    {9, 11, LORA_REGION_BW_500, "SF11/500kHz"},
+    {10, 10, LORA_REGION_BW_500, "SF10/500kHz"},
+    {11, 9, LORA_REGION_BW_500, "SF9/500kHz"},
+    {12, 8, LORA_REGION_BW_500, "SF8/500kHz"},
+    {13, 7, LORA_REGION_BW_500, "SF7/500kHz"},
+};
+
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+static const LoRaRegionChannelGroup groups_eu868[] = {
+    {"Uplink 125 kHz", 868100000, 200000, NULL, 3},
+    {"Uplink 250 kHz", 868300000, 0, NULL, 1},
+    {"Downlink RX1", 868100000, 200000, NULL, 3},
+    {"Extra 125 kHz", 867100000, 200000, NULL, 5}, // Depending on local regulations
+};
+
+static const LoRaRegionChannelGroup groups_us915[] = {
+    {"Uplink 125 kHz", 902300000, 200000, NULL, 64},
+    {"Uplink 500 kHz", 903000000, 1600000, NULL, 8},
+    {"Downlink 500 kHz", 923300000, 600000, NULL, 8},
+};
+
+static const LoRaRegionChannelGroup groups_au915[] = {
+    {"Uplink 125 kHz", 915200000, 200000, NULL, 64},
+    {"Uplink 500 kHz", 915900000, 1600000, NULL, 8},
+    {"Downlink 500 kHz", 923300000, 600000, NULL, 8},
+};
+
+static const LoRaRegionChannelGroup groups_cn470[] = {
+    {"Uplink 125 kHz", 470300000, 200000, NULL, 96},
+    {"Downlink 125 kHz", 500300000, 200000, NULL, 48},
+};
+
+static const LoRaRegionChannelGroup groups_eu433[] = {
+    {"Uplink 125 kHz", 433175000, 200000, NULL, 3},
+    {"Downlink RX1", 433175000, 200000, NULL, 3},
+};
+
+// AS923 sub-bands are the AS923-1 channels moved by a fixed offset.  Only the two default
+// channels are defined, the others are set by each network with NewChannelReq or the CFList
+#define AS923_GROUPS(name, offset)                                 \
+    static const LoRaRegionChannelGroup name[] = {                 \
+        {"Uplink 125 kHz", 923200000 + (offset), 200000, NULL, 2}, \
+        {"Downlink RX1", 923200000 + (offset), 200000, NULL, 2},   \
+    }
+
+AS923_GROUPS(groups_as923_1, 0);
+AS923_GROUPS(groups_as923_2, -1800000);
+AS923_GROUPS(groups_as923_3, -6600000);
+AS923_GROUPS(groups_as923_4, -5900000);
+
+static const LoRaRegionChannelGroup groups_kr920[] = {
+    {"Uplink 125 kHz", 922100000, 200000, NULL, 3},
+    {"Downlink RX1", 922100000, 200000, NULL, 3},
+    {"Extra 125 kHz", 920900000, 200000, NULL, 13},
+};
+
+static const uint32_t channels_in865[] = {865062500, 865402500, 865985000};
+
+static const LoRaRegionChannelGroup groups_in865[] = {
+    {"Uplink 125 kHz", 0, 0, channels_in865, COUNT(channels_in865)},
+    {"Downlink RX1", 0, 0, channels_in865, COUNT(channels_in865)},
+};
+
+static const LoRaRegionChannelGroup groups_ru864[] = {
+    {"Uplink 125 kHz", 868900000, 200000, NULL, 2},
+    {"Downlink RX1", 868900000, 200000, NULL, 2},
+};
+
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#define PLAN(name, data_rates, data_rate_count, groups, rx2_hz, rx2_dr) \
+    {name, data_rates, data_rate_count, groups, COUNT(groups), rx2_hz, rx2_dr}
+
+const LoRaRegionPlan lora_region_plans[] = {
+    PLAN("EU868", data_rates_eu, COUNT(data_rates_eu), groups_eu868, 869525000, 0),
+    PLAN("US915", data_rates_us915, COUNT(data_rates_us915), groups_us915, 923300000, 8),
+    PLAN("AU915", data_rates_au915, COUNT(data_rates_au915), groups_au915, 923300000, 8),
+    PLAN("AS923-1", data_rates_eu, COUNT(data_rates_eu), groups_as923_1, 923200000, 2),
+    PLAN("AS923-2", data_rates_eu, COUNT(data_rates_eu), groups_as923_2, 921400000, 2),
+    PLAN("AS923-3", data_rates_eu, COUNT(data_rates_eu), groups_as923_3, 916600000, 2),
+    PLAN("AS923-4", data_rates_eu, COUNT(data_rates_eu), groups_as923_4, 917300000, 2),
+    PLAN("KR920", data_rates_eu, DATA_RATES_125K_COUNT, groups_kr920, 921900000, 0),
+    PLAN("IN865", data_rates_eu, DATA_RATES_125K_COUNT, groups_in865, 866550000, 2),
+    PLAN("RU864", data_rates_eu, COUNT(data_rates_eu), groups_ru864, 869100000, 0),
+    PLAN("EU433", data_rates_eu, COUNT(data_rates_eu), groups_eu433, 434665000, 0),
+    PLAN("CN470", data_rates_eu, DATA_RATES_125K_COUNT, groups_cn470, 505300000, 0),
+};
+
+const size_t lora_region_plan_count = COUNT(lora_region_plans);
+
+uint32_t lora_region_channel_frequency(const LoRaRegionChannelGroup* group, uint8_t index) {
+    if(group->frequencies) {
+        return group->frequencies[index];
+    }
+    return group->first_hz + group->step_hz * index;
+}
+
+const LoRaRegionDataRate* lora_region_find_data_rate(const LoRaRegionPlan* plan, uint8_t dr) {
+    for(uint8_t i = 0; i < plan->data_rate_count; i++) {
+        if(plan->data_rates[i].dr == dr) {
+            return &plan->data_rates[i];
+        }
+    }
+    return NULL;
+}
+
+void lora_region_format_frequency(char* out, size_t size, uint32_t hz) {
+    uint32_t mhz = hz / 1000000;
+    uint32_t fraction = (hz % 1000000) / 100; // 4 decimals, down to 100 Hz
+    int decimals = 4;
+
+    // Keep at least one decimal, "868.1 MHz" and "865.0625 MHz"
+    while(decimals > 1 && fraction % 10 == 0) {
+        fraction /= 10;
+        decimals--;
+    }
+
+    snprintf(out, size, "%lu.%0*lu MHz", (unsigned long)mhz, decimals, (unsigned long)fraction);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LORA_REGION_MAX_GROUPS 4
+
+// SX126x bandwidth codes used by the regional plans
+#define LORA_REGION_BW_125 0x04
+#define LORA_REGION_BW_250 0x05
+#define LORA_REGION_BW_500 0x06
+
+typedef struct {
+    uint8_t dr; // LoRaWAN data rate number
+    uint8_t sf; // Spreading factor, 5-12
+    uint8_t bw; // SX126x bandwidth code
+    const char* name;
+} LoRaRegionDataRate;
+
+/**
+ * A set of channels shown as one setting.  Evenly spaced channels are described by the first
+ * frequency and the spacing, anything else lists its frequencies explicitly.
+*/
+typedef struct {
+    const char* label;
+    uint32_t first_hz;
+    uint32_t step_hz;
+    const uint32_t* frequencies; // Overrides first_hz/step_hz when not NULL
+    uint8_t count;
+} LoRaRegionChannelGroup;
+
+typedef struct {
+    const char* name;
+    const LoRaRegionDataRate* data_rates;
+    uint8_t data_rate_count;
+    const LoRaRegionChannelGroup* groups;
+    uint8_t group_count;
+    uint32_t rx2_hz; // Fixed RX2 downlink frequency
+    uint8_t rx2_dr; // RX2 data rate number
+} LoRaRegionPlan;
+
+extern const LoRaRegionPlan lora_region_plans[];
+extern const size_t lora_region_plan_count;
+
+/**
+ * @brief      Frequency of a channel in a group.
+ * @param      group  The channel group.
+ * @param      index  Channel index, less than group->count.
+ * @return     The frequency in Hz.
+*/
+uint32_t lora_region_channel_frequency(const LoRaRegionChannelGroup* group, uint8_t index);
+
+/**
+ * @brief      Find a data rate of a plan by its LoRaWAN number.
+ * @param      plan  The regional plan.
+ * @param      dr    The data rate number.
+ * @return     The data rate, or NULL if the plan doesn't define it.
+*/
+const LoRaRegionDataRate* lora_region_find_data_rate(const LoRaRegionPlan* plan, uint8_t dr);
+
+/**
+ * @brief      Format a frequency in MHz with as many decimals as needed ("868.1 MHz").
+ * @param      out   Output buffer.
+ * @param      size  Size of the output buffer, 13 fits any sub-GHz frequency.
+ * @param      hz    The frequency in Hz.
+*/
+void lora_region_format_frequency(char* out, size_t size, uint32_t hz);
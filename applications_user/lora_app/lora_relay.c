@@ -8,6 +8,7 @@
 #include <gui/modules/text_input.h>
 #include <gui/modules/byte_input.h>
 #include <gui/modules/widget.h>
+#include <gui/modules/text_box.h>
 #include <gui/modules/variable_item_list.h>
 #include <notification/notification.h>
 #include <notification/notification_messages.h>
@@ -17,17 +18,53 @@
 #include <storage/storage.h>
 
 #include "lora_app_icons.h"
+#include "lora_devices.h"
+#include "lora_hex.h"
+#include "lora_history.h"
+#include "lora_log_reader.h"
+#include "lora_lorawan.h"
+#include "lora_notify.h"
+#include "lora_perf.h"
+#include "lora_profile.h"
+#include "lora_record.h"
+#include "lora_region.h"
+#include "lora_replay.h"
+#include "lora_settings.h"
+#include "lora_stream.h"
+#include "lora_trace.h"
+#include "lora_transform.h"
 
 #define PATHAPP                 "apps_data/lora"
 #define PATHAPPEXT              EXT_PATH(PATHAPP)
 #define PATHLORA                PATHAPPEXT "/data_%d.log"
 #define LORA_LOG_FILE_EXTENSION ".log"
+#define PATHTRANSFORM           PATHAPPEXT "/transform.txt"
+#define PATHPROFILES            PATHAPPEXT "/profiles.txt"
+#define PATHPERF                PATHAPPEXT "/perf.txt"
+#define PATHTRACE               PATHAPPEXT "/spi_trace.bin"
+
+#define LORA_PROFILE_FILE_MAX 2048 // Largest profiles file read, more than LORA_PROFILE_MAX need
+#define LORA_PERF_TEXT_MAX    1024 // Profiling report, about 40 characters per probe
+
+#define LORA_SNIFFER_QUEUE_LEN        8 // Packets waiting to be added to the history
+#define LORA_SNIFFER_POLL_MS          2 // Sleep of the sniffer job between two reads of DIO1
+#define LORA_SNIFFER_REDRAW_MIN_MS    100 // Shortest time between two sniffer redraws
+#define LORA_SNIFFER_REDRAW_IDLE_MS   1000 // Redraw of the screens showing how long ago
+#define LORA_SNIFFER_LIVE_CHARS       17 // Payload characters on the live screen
+#define LORA_SNIFFER_HISTORY_ROWS     6 // Packets on a history page
+#define LORA_SNIFFER_HISTORY_BYTES    5 // Payload bytes on a history row
+#define LORA_SNIFFER_DETAIL_ROWS      4 // Hex dump rows on the detail screen
+#define LORA_SNIFFER_DETAIL_ROW_BYTES 7 // Bytes per hex dump row
+#define LORA_SNIFFER_LORAWAN_ROWS     2 // Rows above the hex dump for a LoRaWAN packet
+#define LORA_SNIFFER_DEVICE_ROWS      5 // Devices on a page of the device list
+
+#define LORA_LOG_VIEWER_PAYLOAD_MAX 255 // Largest LoRa payload
+#define LORA_LOG_VIEWER_ROW_BYTES   6 // Bytes per hex dump row
+#define LORA_LOG_VIEWER_ROWS        4 // Hex dump rows on screen
+#define LORA_LOG_VIEWER_JUMP        10 // Percent of the file skipped by a long press
 
 #define MAX_LINE_LENGTH 256
 
-#define TIME_LEN 12
-#define DATE_LEN 14
-
 #define CLOCK_TIME_FORMAT     "%.2d:%.2d:%.2d"
 #define CLOCK_ISO_DATE_FORMAT "%.4d-%.2d-%.2d"
 
@@ -41,21 +78,38 @@ const GpioPin* const pin_back = &gpio_button_back;
 #define TAG "LoRa"
 
 uint8_t receiveBuff[255];
-char asciiBuff[512];
 
 void abandone();
 int16_t getRSSI();
+int8_t getSNR();
+uint32_t getFrequency();
 void configureRadioEssentials();
 bool begin();
+void end();
 bool sanityCheck();
 void checkBusy();
 void setModeReceive();
 int lora_receive_async(uint8_t* buff, int buffMaxLen);
+bool radioWatchdog(uint32_t* outageMs);
+uint32_t getRadioOutages();
+uint32_t getRadioRecoveryMs();
 bool configSetFrequency(long frequencyInHz);
 bool configSetBandwidth(int bw);
 bool configSetSpreadingFactor(int sf);
 bool configSetCodingRate(int cr);
 bool configSetSyncWord(uint16_t sw);
+bool configSetChannel(long frequencyInHz, int bw, int sf);
+bool configPreload(long frequencyInHz, int bw, int sf, int cr, uint16_t sw);
+bool configApply(long frequencyInHz, int bw, int sf, int cr, uint16_t sw);
+bool configSetTxPower(int power, int ramp);
+bool configPreloadTxPower(int power, int ramp);
+void configPreloadPacketParams(
+    uint16_t preamble,
+    uint8_t headerType,
+    uint8_t payloadLength,
+    uint8_t crc,
+    uint8_t invertIQ);
+uint16_t getPacketPreamble();
 void setPacketParams(
     uint16_t packetParam1,
     uint8_t packetParam2,
@@ -64,6 +118,8 @@ void setPacketParams(
     uint8_t packetParam5);
 
 void transmit(uint8_t* data, int dataLen);
+uint32_t getTimeOnAir(uint8_t payloadLen);
+uint32_t getTxEnergy(uint32_t airtimeMs);
 
 // Change this to BACKLIGHT_AUTO if you don't want the backlight to be continuously on.
 #define BACKLIGHT_ON 1
@@ -72,13 +128,27 @@ void transmit(uint8_t* data, int dataLen);
 typedef enum {
     LoRaSubmenuIndexConfigure,
     LoRaSubmenuIndexLoRaWAN,
+    LoRaSubmenuIndexProfiles,
     LoRaSubmenuIndexSniffer,
     LoRaSubmenuIndexTransmitter,
+    LoRaSubmenuIndexLogViewer,
     LoRaSubmenuIndexManualTX,
     LoRaSubmenuIndexLinkerSubGHZ,
+    LoRaSubmenuIndexTrace,
+#if LORA_PERF
+    LoRaSubmenuIndexPerf,
+#endif
     LoRaSubmenuIndexAbout,
 } LoRaSubmenuIndex;
 
+#if LORA_PERF
+typedef enum {
+    LoRaPerfIndexView,
+    LoRaPerfIndexSave,
+    LoRaPerfIndexReset,
+} LoRaPerfIndex;
+#endif
+
 // Each view is a screen we show the user.
 typedef enum {
     LoRaViewSubmenu, // The menu when the app starts
@@ -86,20 +156,94 @@ typedef enum {
     LoRaViewByteInput, // Input for send data (bytes)
     LoRaViewConfigure, // The configuration screen
     LoRaViewLoRaWAN, // The presets LoRaWAN screen
+    LoRaViewProfiles, // The saved profiles screen
     LoRaViewSniffer, // Sniffer
     LoraViewTransmitter, // Transmitter
+    LoRaViewLogViewer, // Pages through the packets of a capture log
+#if LORA_PERF
+    LoRaViewPerf, // The profiling menu
+    LoRaViewPerfStats, // The profiling report
+#endif
     LoRaViewAbout, // The about screen with directions, link to social channel, etc.
 } LoRaView;
 
 typedef enum {
     LoRaEventIdRedrawScreen = 0, // Custom event to redraw the screen
     LoRaEventIdOkPressed = 42, // Custom event to process OK button getting pressed down
+    LoRaEventIdReplayStart, // Custom event to pick a log file and start replaying it
+    LoRaEventIdReplayProgress, // Custom event from the replay job with new status
+    LoRaEventIdReplayDone, // Custom event from the replay job when it has finished
+    LoRaEventIdSnifferUpdate, // Custom event from the sniffer job with new packets or radio status
 } LoRaEventId;
 
+typedef enum {
+    LoRaReplayStateIdle,
+    LoRaReplayStateRunning,
+    LoRaReplayStatePaused,
+    LoRaReplayStateDone,
+    LoRaReplayStateCancelled,
+} LoRaReplayState;
+
+// Thread flags understood by the replay job
+typedef enum {
+    LoRaReplayFlagPause = (1 << 0), // Toggle pause/resume
+    LoRaReplayFlagCancel = (1 << 1), // Stop after the current packet
+} LoRaReplayFlag;
+
+// Progress of a replay job, written by the job thread and published to the transmitter model
+typedef struct {
+    LoRaReplayState state;
+    uint32_t packets; // Packets sent
+    uint32_t bytes; // Payload bytes sent
+    uint32_t file_pos; // Bytes of the log read so far
+    uint32_t file_size; // Size of the log
+    uint32_t elapsed_ms; // Time spent replaying, pauses excluded
+    uint32_t energy_mj; // Estimated radio energy spent transmitting
+    uint32_t jitter_avg_ms;
+    uint32_t jitter_max_ms;
+} LoRaReplayStatus;
+
+typedef struct {
+    FuriThread* thread; // Runs the replay, NULL when no job is active
+    File* file; // The log being replayed
+    uint16_t speed_percent; // Replay speed, see replay_speed_values
+    LoRaReplayScheduler scheduler; // Timing of the replay
+    uint32_t last_capture_s; // Capture time of the last replayed packet
+    uint32_t last_event_tick; // When the last progress event was sent
+    uint32_t started_tick; // When the job started
+    uint32_t paused_ms; // Total time spent paused
+    uint64_t energy_uj; // Estimated radio energy spent transmitting
+    LoRaTransformPipeline transforms; // Applied to every payload, loaded from PATHTRANSFORM
+    LoRaReplayStatus status; // Only touched by the job thread while it runs
+    LoRaReplayStatus published; // Last status handed to the view, guarded by status_mutex
+    FuriMutex* status_mutex;
+    char line[LORA_RECORD_LINE_MAX]; // Line being read, kept off the small job thread stack
+} LoRaReplayJob;
+
+// Thread flags understood by the sniffer job
+typedef enum {
+    LoRaSnifferFlagStop = (1 << 0), // Leave the receive loop
+} LoRaSnifferFlag;
+
+// A received packet on its way from the sniffer job to the sniffer history
+typedef struct {
+    LoRaHistoryEntry entry;
+    uint8_t length;
+    uint8_t payload[LORA_HISTORY_PAYLOAD_MAX];
+} LoRaSnifferPacket;
+
+typedef struct {
+    FuriThread* thread; // Receives, logs and streams packets, NULL when the sniffer is not shown
+    FuriMessageQueue* packets; // LoRaSnifferPacket, emptied into the model by the GUI thread
+    FuriMutex* log_mutex; // Held while the capture log is written, opened or closed
+    char line[LORA_RECORD_LINE_MAX]; // Capture log line being written
+} LoRaSnifferJob;
+
 typedef struct {
     ViewDispatcher* view_dispatcher; // Switches between our views
     NotificationApp* notifications; // Used for controlling the backlight
     Submenu* submenu; // The application menu
+    Submenu* submenu_profiles; // The profiles menu
     TextInput* frequency_input; // The text input screen
     ByteInput* byte_input; // The byte input screen
 
@@ -113,20 +257,22 @@ typedef struct {
     VariableItem* item_header_type;
     VariableItem* item_crc;
     VariableItem* item_iq;
+    VariableItem* item_txpower;
+    VariableItem* item_ramp;
 
     VariableItem* item_region;
-    VariableItem* item_eu_dr;
-    VariableItem* item_eu868_ul_channels_125k;
-    VariableItem* item_eu868_ul_channels_250k;
-    VariableItem* item_eu868_dl_channels_rx1;
-    VariableItem* item_us_dr;
-    VariableItem* item_us915_ul_channels_125k;
-    VariableItem* item_us915_ul_channels_500k;
-    VariableItem* item_us915_dl_channels_500k;
+    VariableItem* item_dr;
+    VariableItem* item_channels[LORA_REGION_MAX_GROUPS]; // One per channel group of the plan
 
     View* view_sniffer; // The sniffer screen
     View* view_transmitter; // The transmitter screen
+    View* view_log_viewer; // The capture log viewer screen
     Widget* widget_about; // The about screen
+#if LORA_PERF
+    Submenu* submenu_perf; // The profiling menu
+    TextBox* text_box_perf; // The profiling report
+    char* perf_text; // Text shown by text_box_perf
+#endif
 
     VariableItem* config_freq_item; // The frequency setting item (so we can update the frequency)
     char* temp_buffer; // Temporary buffer for text input
@@ -135,10 +281,10 @@ typedef struct {
     uint8_t* byte_buffer; // Temporary buffer for text input
     uint32_t byte_buffer_size; // Size of temporary buffer
 
-    FuriTimer* timer_rx; // Timer for redrawing the sniffer screen
     FuriTimer* timer_tx; // Timer for redrawing the transmitter screen
 
     uint32_t config_frequency;
+    uint16_t config_sw_other; // Sync word of the option past config_sw_values
 
     // Order is preamble, header type, packet length, CRC, IQ
     uint16_t packetPreamble;
@@ -147,8 +293,23 @@ typedef struct {
     uint8_t packetCRC;
     uint8_t packetInvertIQ;
 
+    LoRaReplayJob replay; // Background replay of a log file
+    LoRaSnifferJob sniffer; // Background reception while the sniffer screen is shown
+
+    LoRaSettings settings; // Settings loaded at startup, saved again on exit if they changed
+
+    LoRaProfile profiles[LORA_PROFILE_MAX]; // Profiles of the profiles menu
+    uint8_t profile_count;
+
 } LoRaApp;
 
+typedef enum {
+    LoRaSnifferScreenLive, // Latest packet and radio status
+    LoRaSnifferScreenHistory, // List of the last packets
+    LoRaSnifferScreenDetail, // Metadata and hex dump of one packet
+    LoRaSnifferScreenDevices, // LoRaWAN devices seen, in the chosen order
+} LoRaSnifferScreen;
+
 typedef struct {
     FuriString* config_freq_name; // The frequency setting
     uint32_t config_bw_index; // Bandwidth setting index
@@ -159,39 +320,63 @@ typedef struct {
     uint32_t config_header_type_index; // Header Type setting index
     uint32_t config_crc_index; // CRC setting index
     uint32_t config_iq_index; // IQ setting index
+    uint32_t config_txpower_index; // TX power setting index
+    uint32_t config_ramp_index; // PA ramp time setting index
+    uint32_t config_rx_alert_index; // Received packet feedback setting index
+    uint32_t config_tx_alert_index; // Sent packet feedback setting index
 
-    uint32_t config_region_index; // Frequency plan setting index
-    uint32_t config_bw_region_index; // BW region setting index
-    uint32_t config_us_dr_index; // US915 Data Rate setting index
-    uint32_t config_eu_dr_index; // EU868 Data Rate setting index
+    uint32_t config_region_index; // Index in lora_region_plans
+    uint32_t config_dr_index; // Data rate setting index
+    uint32_t config_channel_index[LORA_REGION_MAX_GROUPS]; // Channel setting index per group
 
-    uint32_t config_us915_ul_channels_125k_index;
-    uint32_t config_us915_ul_channels_500k_index;
-    uint32_t config_eu868_ul_channels_125k_index;
+    uint8_t x; // The x coordinate (dummy variable)
 
-    uint32_t config_eu868_ul_channels_250k_index;
-    uint32_t config_us915_dl_channels_500k_index;
-    uint32_t config_eu868_dl_channels_rx1_index;
+    LoRaHistory history; // Last packets received
+    LoRaSnifferScreen screen;
+    uint32_t history_selected; // Number of the packet selected in the history
+    uint8_t detail_scroll; // First hex dump row of the detail screen
 
-    uint8_t x; // The x coordinate (dummy variable)
+    LoRaDevices devices; // LoRaWAN devices seen
+    uint16_t device_order[LORA_DEVICES_MAX]; // Device list, indexes in devices.devices
+    uint16_t device_listed; // Devices in device_order
+    uint16_t device_selected; // Position in device_order
+    LoRaDevicesSort device_sort;
+
+    // Radio status copied from the sniffer job with the packets, so drawing reads only the model
+    uint32_t radio_outages;
+    uint32_t radio_recovery_ms;
+    uint32_t stream_dropped;
 
     bool flag_file;
+    LoRaStream* stream; // Packets streamed over USB, NULL when streaming is off
     DialogsApp* dialogs_rx;
     Storage* storage_rx;
     File* file_rx;
 } LoRaSnifferModel;
 
 typedef struct {
-    uint32_t test;
-    bool flag_tx_file;
-    bool flag_signal;
     FuriString* text;
     DialogsApp* dialogs_tx;
     Storage* storage_tx;
     File* file_tx;
     uint8_t x; // The x coordinate
+
+    uint8_t replay_speed_index; // Replay speed setting index
+    LoRaReplayStatus status; // Last status reported by the replay job
 } LoRaTransmitterModel;
 
+typedef struct {
+    DialogsApp* dialogs;
+    Storage* storage;
+    File* file;
+    LoRaLogReader reader; // Holds only the line on screen
+    LoRaRecord record; // Fields of the line on screen, they point into reader.line
+    bool is_packet; // The line on screen has a payload
+    uint8_t payload[LORA_LOG_VIEWER_PAYLOAD_MAX];
+    int32_t payload_len; // -1 if the payload is not valid hex
+    uint8_t scroll; // First hex dump row on screen
+} LoRaLogViewerModel;
+
 void makePaths(void* context) {
     LoRaApp* app = (LoRaApp*)context;
     LoRaSnifferModel* model = view_get_model(app->view_sniffer);
@@ -253,6 +438,29 @@ static uint32_t lora_navigation_configure_callback(void* _context) {
 //     return LoRaViewLoRaWAN;
 // }
 
+/**
+ * @brief      Write the SPI trace to the SD card and tell the user how it went.
+ * @details    The file is decoded on a computer with tools/lora_trace_decode.py.
+*/
+static void lora_trace_save(void) {
+    char text[64];
+    int32_t count = lora_trace_dump(PATHTRACE);
+    if(count < 0) {
+        snprintf(text, sizeof(text), "Cannot write\nspi_trace.bin");
+    } else {
+        snprintf(text, sizeof(text), "Saved %ld SPI\ntransactions to\nspi_trace.bin", count);
+    }
+
+    DialogsApp* dialogs = furi_record_open(RECORD_DIALOGS);
+    DialogMessage* message = dialog_message_alloc();
+    dialog_message_set_text(message, text, 64, 32, AlignCenter, AlignCenter);
+    dialog_message_show(dialogs, message);
+    dialog_message_free(message);
+    furi_record_close(RECORD_DIALOGS);
+}
+
+static void lora_log_viewer_open(LoRaApp* app);
+
 /**
  * @brief      Handle submenu item selection.
  * @details    This function is called when user selects an item from the submenu.
@@ -268,12 +476,18 @@ static void lora_submenu_callback(void* context, uint32_t index) {
     case LoRaSubmenuIndexLoRaWAN:
         view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewLoRaWAN);
         break;
+    case LoRaSubmenuIndexProfiles:
+        view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewProfiles);
+        break;
     case LoRaSubmenuIndexSniffer:
         view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewSniffer);
         break;
     case LoRaSubmenuIndexTransmitter:
         view_dispatcher_switch_to_view(app->view_dispatcher, LoraViewTransmitter);
         break;
+    case LoRaSubmenuIndexLogViewer:
+        lora_log_viewer_open(app);
+        break;
     case LoRaSubmenuIndexManualTX:
         view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewByteInput);
         break;
@@ -301,6 +515,14 @@ static void lora_submenu_callback(void* context, uint32_t index) {
 
         furi_record_close(RECORD_LOADER);
         break;
+    case LoRaSubmenuIndexTrace:
+        lora_trace_save();
+        break;
+#if LORA_PERF
+    case LoRaSubmenuIndexPerf:
+        view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewPerf);
+        break;
+#endif
     case LoRaSubmenuIndexAbout:
         view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewAbout);
         break;
@@ -309,6 +531,69 @@ static void lora_submenu_callback(void* context, uint32_t index) {
     }
 }
 
+#if LORA_PERF
+/**
+ * @brief      Callback for returning to the profiling menu.
+ * @param      _context  The context - unused
+ * @return     next view id
+*/
+static uint32_t lora_navigation_perf_callback(void* _context) {
+    UNUSED(_context);
+    return LoRaViewPerf;
+}
+
+/**
+ * @brief      Write the profiling report to the SD card.
+ * @param      app  The LoRa application object.
+ * @return     true if the file was written.
+*/
+static bool lora_perf_save(LoRaApp* app) {
+    size_t length = lora_perf_format(app->perf_text, LORA_PERF_TEXT_MAX);
+    if(length >= LORA_PERF_TEXT_MAX) {
+        length = LORA_PERF_TEXT_MAX - 1;
+    }
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool saved = storage_file_open(file, PATHPERF, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+                 storage_file_write(file, app->perf_text, length) == length;
+    if(!saved) {
+        FURI_LOG_E(TAG, "Failed to write file %s", PATHPERF);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return saved;
+}
+
+/**
+ * @brief      Handle profiling menu selection.
+ * @param      context  The context - LoRaApp object.
+ * @param      index    The LoRaPerfIndex item that was clicked.
+*/
+static void lora_perf_callback(void* context, uint32_t index) {
+    LoRaApp* app = (LoRaApp*)context;
+
+    switch(index) {
+    case LoRaPerfIndexView:
+        lora_perf_format(app->perf_text, LORA_PERF_TEXT_MAX);
+        text_box_set_text(app->text_box_perf, app->perf_text);
+        view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewPerfStats);
+        break;
+    case LoRaPerfIndexSave:
+        submenu_set_header(
+            app->submenu_perf, lora_perf_save(app) ? "Saved perf.txt" : "Save failed");
+        break;
+    case LoRaPerfIndexReset:
+        lora_perf_reset();
+        submenu_set_header(app->submenu_perf, "Cleared");
+        break;
+    default:
+        break;
+    }
+}
+#endif
+
 // Bandwidth configuration
 const uint8_t config_bw_values[] = {
     0x00,
@@ -372,183 +657,61 @@ const char* const config_cr_names[] = {
     "4/8",
 };
 
-// Sync Word configuration
+// Sync Word configuration, register values.  One more option past the table shows the sync word
+// of a profile that is not in it, see lora_config_sw_value
 const uint16_t config_sw_values[] = {
-    0x002B, // Meshtastic
+    0x24B4, // Meshtastic, 0x2B on other radios
     0x1424, // Private
     0x3444, // Public (LoRaWAN/TTN)
 };
 
 const char* const config_sw_names[] = {
     "Meshtastic (0x2B)",
-    "Public (0x3444)",
     "Private (0x1424)",
+    "Public (0x3444)",
 };
 
-const uint8_t config_region_values[] = {
-    0x01,
-    0x02
-    //,
-    // 0x03,
-    // 0x04,
-    // 0x05,
-    // 0x06,
-    // 0x07,
-    // 0x08,
-    // 0x09,
-    // 0x0A,
-    // 0x0B,
-    // 0x0C,
-    // 0x0D
-};
-
-// Regional names
-const char* const config_region_names[] = {
-    "EU868",
-    "US915"
-    //,
-    // "CN779",
-    // "EU433",
-    // "AU915",
-    // "CN470",
-    // "AS923",
-    // "AS923-2",
-    // "AS923-3",
-    // "KR920",
-    // "IN865",
-    // "RU864",
-    // "AS923-4"
-};
+#define CONFIG_SW_OTHER COUNT_OF(config_sw_values) // Option of the sync word in config_sw_other
 
-// Data Rate configuration for US915
-const uint8_t config_us_dr_values[] = {
-    0x00, // DR0
-    0x01, // DR1
-    0x02, // DR2
-    0x03, // DR3
-    0x04, // DR4
-    0x08, // DR8
-    0x09, // DR9
-    0x0A, // DR10
-    0x0B, // DR11
-    0x0C, // DR12
-    0x0D // DR13
-};
-const char* const config_us_dr_names[] = {
-    "SF10/125kHz",
-    "SF9/125kHz",
-    "SF8/125kHz",
-    "SF7/125kHz",
-    "SF8/500kHz",
-    "SF12/500kHz",
-    "SF11/500kHz",
-    "SF10/500kHz",
-    "SF9/500kHz",
-    "SF8/500kHz",
-    "SF7/500kHz"};
-
-// Data Rate configuration for EU868
-const uint8_t config_eu_dr_values[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
-
-const char* const config_eu_dr_names[] = {
-    "SF12/125kHz",
-    "SF11/125kHz",
-    "SF10/125kHz",
-    "SF9/125kHz",
-    "SF8/125kHz",
-    "SF7/125kHz",
-    "SF7/250kHz"};
-
-// Transmit Power configuration for US915
-const uint8_t config_txpower_values[] = {
-    0x00, // 30 dBm
-    0x01, // 28 dBm
-    0x02, // 26 dBm
-    0x03, // 24 dBm
-    0x04, // 22 dBm
-    0x05, // 20 dBm
-    0x06, // 18 dBm
-    0x07, // 16 dBm
-    0x08, // 14 dBm
-    0x09, // 12 dBm
-    0x0A // 10 dBm
-};
+// Transmit Power in dBm, SX1262 high power PA range
+const int8_t config_txpower_values[] = {22, 20, 17, 14, 12, 10, 8, 6, 4, 2, 0, -3, -6, -9};
 const char* const config_txpower_names[] = {
-    "30 dBm",
-    "28 dBm",
-    "26 dBm",
-    "24 dBm",
     "22 dBm",
     "20 dBm",
-    "18 dBm",
-    "16 dBm",
+    "17 dBm",
     "14 dBm",
     "12 dBm",
-    "10 dBm"};
-
-// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-
-// Uplink channel frequencies for US915 (125 kHz channels)
-const uint32_t config_us915_ul_channels_125k[] = {
-    902300000, 902500000, 902700000, 902900000, 903100000, 903300000, 903500000, 903700000,
-    903900000, 904100000, 904300000, 904500000, 904700000, 904900000, 905100000, 905300000,
-    905500000, 905700000, 905900000, 906100000, 906300000, 906500000, 906700000, 906900000,
-    907100000, 907300000, 907500000, 907700000, 907900000, 908100000, 908300000, 908500000,
-    908700000, 908900000, 909100000, 909300000, 909500000, 909700000, 909900000, 910100000,
-    910300000, 910500000, 910700000, 910900000, 911100000, 911300000, 911500000, 911700000,
-    911900000, 912100000, 912300000, 912500000, 912700000, 912900000, 913100000, 913300000,
-    913500000, 913700000, 913900000, 914100000, 914300000, 914500000, 914700000, 914900000};
-
-// Uplink channel frequencies for US915 (500 kHz channels)
-const uint32_t config_us915_ul_channels_500k[] =
-    {903000000, 904600000, 906200000, 907800000, 909400000, 911000000, 912600000, 914200000};
-
-// Downlink channel frequencies for US915
-const uint32_t config_us915_dl_channels_500k[] =
-    {923300000, 923900000, 924500000, 925100000, 925700000, 926300000, 926900000, 927500000};
-
-// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-
-// Uplink channel frequencies for EU868 (125 kHz default channels)
-const uint32_t config_eu868_ul_channels_125k[] = {868100000, 868300000, 868500000};
-
-// Uplink channel frequencies for EU868 (250 kHz channel)
-const uint32_t config_eu868_ul_channels_250k[] = {868300000};
-
-// Additional uplink channel frequencies for EU868 (may be used depending on local regulations)
-const uint32_t config_eu868_ul_channels_additional[] =
-    {867100000, 867300000, 867500000, 867700000, 867900000};
-
-// Downlink channel frequencies for EU868 (RX1 - same as uplink)
-const uint32_t config_eu868_dl_channels_rx1[] = {868100000, 868300000, 868500000};
-
-// Downlink channel frequency for EU868 (RX2 - fixed frequency)
-const uint32_t config_eu868_dl_channel_rx2 = 869525000;
-
-// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-
-// Uplink channel frequencies for AS923 (125 kHz default channels)
-const uint32_t config_as923_ul_channels_125k[] = {923200000, 923400000};
-
-// Additional uplink channel frequencies for AS923 (may be used depending on local regulations)
-const uint32_t config_as923_ul_channels_additional[] =
-    {923600000, 923800000, 924000000, 924200000, 924400000, 924600000};
-
-// Downlink channel frequencies for AS923 (RX1 - same as uplink)
-const uint32_t config_as923_dl_channels_rx1[] = {923200000, 923400000};
-
-// Downlink channel frequency for AS923 (RX2 - fixed frequency)
-const uint32_t config_as923_dl_channel_rx2 = 923200000;
-
-// Frequency offsets for different AS923 sub-bands
-const int32_t config_as923_frequency_offsets[] = {
-    0, // AS923-1
-    -1800000, // AS923-2
-    -6600000, // AS923-3
-    -5900000 // AS923-4
+    "10 dBm",
+    "8 dBm",
+    "6 dBm",
+    "4 dBm",
+    "2 dBm",
+    "0 dBm",
+    "-3 dBm",
+    "-6 dBm",
+    "-9 dBm"};
+
+// PA ramp time. See datasheet table 13-41
+const uint8_t config_ramp_values[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
+const char* const config_ramp_names[] = {
+    "10 us",
+    "20 us",
+    "40 us",
+    "80 us",
+    "200 us",
+    "800 us",
+    "1.7 ms",
+    "3.4 ms"};
+
+// Feedback for received and sent packets, played by lora_notify without blocking the radio
+const uint8_t config_alert_values[] = {
+    0,
+    LoRaNotifyOutputBeacon,
+    LoRaNotifyOutputBeacon | LoRaNotifyOutputLed,
+    LoRaNotifyOutputBeacon | LoRaNotifyOutputLed | LoRaNotifyOutputVibro,
+    LoRaNotifyOutputBeacon | LoRaNotifyOutputLed | LoRaNotifyOutputSpeaker,
 };
-
-// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+const char* const config_alert_names[] = {"Off", "Module LED", "LED", "LED+Vibro", "LED+Sound"};
 
 //Header Type. 0x00 = Variable Len, 0x01 = Fixed Length
 const uint8_t config_header_type_values[] = {
@@ -580,6 +743,26 @@ const char* const config_iq_names[] = {
     "Inverted",
 };
 
+// Replay speed, in percent of the capture timing
+const uint16_t replay_speed_values[] = {
+    25,
+    50,
+    100,
+    200,
+    400,
+    1000,
+    LORA_REPLAY_SPEED_ASAP,
+};
+const char* const replay_speed_names[] = {
+    "x0.25",
+    "x0.5",
+    "x1",
+    "x2",
+    "x4",
+    "x10",
+    "Max",
+};
+
 static const char* config_bw_label = "Bandwidth";
 
 static void lora_config_bw_change(VariableItem* item) {
@@ -618,14 +801,40 @@ static void lora_config_cr_change(VariableItem* item) {
 
 static const char* config_sw_label = "Sync Word";
 
+/**
+ * @brief      Sync word of a sync word option.
+ * @param      app    The LoRa application object.
+ * @param      index  The option, CONFIG_SW_OTHER for the one outside the table.
+ * @return     The register value.
+*/
+static uint16_t lora_config_sw_value(LoRaApp* app, uint8_t index) {
+    return index < COUNT_OF(config_sw_values) ? config_sw_values[index] : app->config_sw_other;
+}
+
+/**
+ * @brief      Show a sync word option, the one outside the table by its value.
+ * @param      app    The LoRa application object.
+ * @param      index  The option.
+*/
+static void lora_config_show_sw(LoRaApp* app, uint8_t index) {
+    char text[8];
+    variable_item_set_current_value_index(app->item_sw, index);
+    if(index < COUNT_OF(config_sw_names)) {
+        variable_item_set_current_value_text(app->item_sw, config_sw_names[index]);
+    } else {
+        snprintf(text, sizeof(text), "0x%04X", app->config_sw_other);
+        variable_item_set_current_value_text(app->item_sw, text);
+    }
+}
+
 static void lora_config_sw_change(VariableItem* item) {
     LoRaApp* app = variable_item_get_context(item);
     uint8_t index = variable_item_get_current_value_index(item);
-    variable_item_set_current_value_text(item, config_sw_names[index]);
+    lora_config_show_sw(app, index);
     LoRaSnifferModel* model = view_get_model(app->view_sniffer);
     model->config_sw_index = index;
 
-    configSetSyncWord(config_sw_values[index]);
+    configSetSyncWord(lora_config_sw_value(app, index));
 }
 
 static const char* config_header_type_label = "Header Type";
@@ -689,708 +898,540 @@ static void lora_config_iq_change(VariableItem* item) {
         app->packetInvertIQ);
 }
 
-static const char* config_eu_dr_label = "EU868 Data Rate";
+static const char* config_region_label = "Frequency Plan";
+static const char* config_dr_label = "Data Rate";
+static const char* config_rx2_label = "Downlink RX2";
 
-static void lora_config_eu_dr_change(VariableItem* item) {
-    LoRaApp* app = variable_item_get_context(item);
-    uint8_t index = variable_item_get_current_value_index(item);
-    variable_item_set_current_value_text(item, config_eu_dr_names[index]);
+// Position of the first channel group in the LoRaWAN list, after the plan and data rate
+#define LORAWAN_ITEM_CHANNELS 2
 
+/**
+ * @brief      Show a channel and data rate on the configuration screen.
+ * @param      app        The LoRa application object.
+ * @param      frequency  The frequency in Hz.
+ * @param      bw         SX126x bandwidth code.
+ * @param      sf         Spreading factor.
+*/
+static void lora_config_show_channel(LoRaApp* app, uint32_t frequency, uint8_t bw, uint8_t sf) {
     LoRaSnifferModel* model = view_get_model(app->view_sniffer);
-    model->config_eu_dr_index = index;
-
-    switch(index) {
-    case 0: // SF12/125kHz
-        configSetSpreadingFactor(0xC);
-        configSetBandwidth(0x04);
+    char text_buf[16] = {0};
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 7);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[7]);
-        model->config_bw_index = 7;
-
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 7);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[7]);
-        model->config_sf_index = 7;
+    app->config_frequency = frequency;
+    lora_region_format_frequency(text_buf, sizeof(text_buf), frequency);
+    furi_string_set(model->config_freq_name, text_buf);
+    variable_item_set_current_value_text(app->config_freq_item, text_buf);
 
-        break;
-    case 1: // SF11/125kHz
-        configSetSpreadingFactor(0x0B);
-        configSetBandwidth(0x04);
+    for(uint8_t i = 0; i < COUNT_OF(config_bw_values); i++) {
+        if(config_bw_values[i] == bw) {
+            model->config_bw_index = i;
+            variable_item_set_current_value_index(app->item_bw, i);
+            variable_item_set_current_value_text(app->item_bw, config_bw_names[i]);
+        }
+    }
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 7);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[7]);
-        model->config_bw_index = 7;
+    model->config_sf_index = sf - config_sf_values[0];
+    variable_item_set_current_value_index(app->item_sf, model->config_sf_index);
+    variable_item_set_current_value_text(app->item_sf, config_sf_names[model->config_sf_index]);
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 6);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[6]);
-        model->config_sf_index = 6;
+    FURI_LOG_E(TAG, "Frequency = %lu", app->config_frequency);
+}
 
-        break;
-    case 2: // SF10/125kHz
-        configSetSpreadingFactor(0x0A);
-        configSetBandwidth(0x04);
+/**
+ * @brief      Tune to a channel and data rate and show it on the configuration screen.
+ * @details    The radio is updated in one batch, settings that don't change are not written.
+ * @param      app        The LoRa application object.
+ * @param      frequency  The frequency in Hz.
+ * @param      bw         SX126x bandwidth code.
+ * @param      sf         Spreading factor.
+*/
+static void lora_config_apply_channel(LoRaApp* app, uint32_t frequency, uint8_t bw, uint8_t sf) {
+    lora_config_show_channel(app, frequency, bw, sf);
+    configSetChannel(frequency, bw, sf);
+}
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 7);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[7]);
-        model->config_bw_index = 7;
+static void lora_config_dr_change(VariableItem* item) {
+    LoRaApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 5);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[5]);
-        model->config_sf_index = 5;
+    LoRaSnifferModel* model = view_get_model(app->view_sniffer);
+    const LoRaRegionPlan* plan = &lora_region_plans[model->config_region_index];
+    const LoRaRegionDataRate* data_rate = &plan->data_rates[index];
 
-        break;
-    case 3: // SF9/125kHz
-        configSetSpreadingFactor(0x09);
-        configSetBandwidth(0x04);
+    variable_item_set_current_value_text(item, data_rate->name);
+    model->config_dr_index = index;
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 7);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[7]);
-        model->config_bw_index = 7;
+    lora_config_apply_channel(app, app->config_frequency, data_rate->bw, data_rate->sf);
+}
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 4);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[4]);
-        model->config_sf_index = 4;
+static void lora_config_channel_change(VariableItem* item) {
+    LoRaApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
 
-        break;
-    case 4: // SF8/125kHz
-        configSetSpreadingFactor(0x08);
-        configSetBandwidth(0x04);
+    LoRaSnifferModel* model = view_get_model(app->view_sniffer);
+    const LoRaRegionPlan* plan = &lora_region_plans[model->config_region_index];
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 7);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[7]);
-        model->config_bw_index = 7;
+    // Every channel group shares this callback, find the one that changed
+    uint8_t group = 0;
+    while(group < plan->group_count && app->item_channels[group] != item) {
+        group++;
+    }
+    if(group == plan->group_count) {
+        return;
+    }
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 3);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[3]);
-        model->config_sf_index = 3;
+    uint32_t frequency = lora_region_channel_frequency(&plan->groups[group], index);
+    char text_buf[16] = {0};
+    lora_region_format_frequency(text_buf, sizeof(text_buf), frequency);
+    variable_item_set_current_value_text(item, text_buf);
+    model->config_channel_index[group] = index;
 
-        break;
-    case 5: // SF7/125kHz
-        configSetSpreadingFactor(0x07);
-        configSetBandwidth(0x04);
+    lora_config_apply_channel(
+        app,
+        frequency,
+        config_bw_values[model->config_bw_index],
+        config_sf_values[model->config_sf_index]);
+}
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 7);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[7]);
-        model->config_bw_index = 7;
+static void lora_config_region_change(VariableItem* item);
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 2);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[2]);
-        model->config_sf_index = 2;
+/**
+ * @brief      Fill the LoRaWAN screen with the settings of a regional plan.
+ * @param      app           The LoRa application object.
+ * @param      region_index  Index in lora_region_plans.
+*/
+static void lora_lorawan_list_build(LoRaApp* app, uint8_t region_index) {
+    LoRaSnifferModel* model = view_get_model(app->view_sniffer);
+    const LoRaRegionPlan* plan = &lora_region_plans[region_index];
+    char text_buf[16] = {0};
 
-        break;
-    case 6: // SF7/250kHz
-        configSetSpreadingFactor(0x07);
-        configSetBandwidth(0x06);
+    variable_item_list_reset(app->variable_item_list_lorawan);
+    model->config_region_index = region_index;
+    model->config_dr_index = 0;
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 9);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[9]);
-        model->config_bw_index = 9;
+    // Frequency Plan
+    app->item_region = variable_item_list_add(
+        app->variable_item_list_lorawan,
+        config_region_label,
+        lora_region_plan_count,
+        lora_config_region_change,
+        app);
+    variable_item_set_current_value_index(app->item_region, region_index);
+    variable_item_set_current_value_text(app->item_region, plan->name);
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 1);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[1]);
-        model->config_sf_index = 1;
+    // Data Rate
+    app->item_dr = variable_item_list_add(
+        app->variable_item_list_lorawan,
+        config_dr_label,
+        plan->data_rate_count,
+        lora_config_dr_change,
+        app);
+    variable_item_set_current_value_index(app->item_dr, 0);
+    variable_item_set_current_value_text(app->item_dr, plan->data_rates[0].name);
 
-        break;
+    // Channels
+    for(uint8_t i = 0; i < LORA_REGION_MAX_GROUPS; i++) {
+        app->item_channels[i] = NULL;
+        model->config_channel_index[i] = 0;
+    }
+    for(uint8_t i = 0; i < plan->group_count; i++) {
+        app->item_channels[i] = variable_item_list_add(
+            app->variable_item_list_lorawan,
+            plan->groups[i].label,
+            plan->groups[i].count,
+            lora_config_channel_change,
+            app);
+        variable_item_set_current_value_index(app->item_channels[i], 0);
+        lora_region_format_frequency(
+            text_buf, sizeof(text_buf), lora_region_channel_frequency(&plan->groups[i], 0));
+        variable_item_set_current_value_text(app->item_channels[i], text_buf);
     }
-}
 
-static const char* config_us_dr_label = "US915 Data Rate";
+    // RX2, tuned when clicked
+    VariableItem* item =
+        variable_item_list_add(app->variable_item_list_lorawan, config_rx2_label, 1, NULL, app);
+    lora_region_format_frequency(text_buf, sizeof(text_buf), plan->rx2_hz);
+    variable_item_set_current_value_text(item, text_buf);
+}
 
-static void lora_config_us_dr_change(VariableItem* item) {
+static void lora_config_region_change(VariableItem* item) {
     LoRaApp* app = variable_item_get_context(item);
     uint8_t index = variable_item_get_current_value_index(item);
-    variable_item_set_current_value_text(item, config_us_dr_names[index]);
-
-    LoRaSnifferModel* model = view_get_model(app->view_sniffer);
-    model->config_us_dr_index = index;
-
-    switch(index) {
-    case 0: // SF10/125kHz
-        configSetSpreadingFactor(0x0A);
-        configSetBandwidth(0x04);
-
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 7);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[7]);
-        model->config_bw_index = 7;
-
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 5);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[5]);
-        model->config_sf_index = 5;
-
-        break;
-    case 1: // SF9/125kHz
-        configSetSpreadingFactor(0x09);
-        configSetBandwidth(0x04);
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 7);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[7]);
-        model->config_bw_index = 7;
+    lora_lorawan_list_build(app, index);
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 4);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[4]);
-        model->config_sf_index = 4;
-
-        break;
-    case 2: // SF8/125kHz
-        configSetSpreadingFactor(0x08);
-        configSetBandwidth(0x04);
-
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 7);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[7]);
-        model->config_bw_index = 7;
-
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 3);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[3]);
-        model->config_sf_index = 3;
+    // Start on the first channel of the plan at its first data rate
+    const LoRaRegionPlan* plan = &lora_region_plans[index];
+    lora_config_apply_channel(
+        app,
+        lora_region_channel_frequency(&plan->groups[0], 0),
+        plan->data_rates[0].bw,
+        plan->data_rates[0].sf);
+}
 
-        break;
-    case 3: // SF7/125kHz
-        configSetSpreadingFactor(0x07);
-        configSetBandwidth(0x04);
+/**
+ * @brief      Callback when an item in the LoRaWAN screen is clicked.
+ * @details    Clicking the RX2 item tunes to the RX2 frequency and data rate of the plan.
+ * @param      context  The context - LoRaApp object.
+ * @param      index    The index of the item that was clicked.
+*/
+static void lora_lorawan_item_clicked(void* context, uint32_t index) {
+    LoRaApp* app = (LoRaApp*)context;
+    LoRaSnifferModel* model = view_get_model(app->view_sniffer);
+    const LoRaRegionPlan* plan = &lora_region_plans[model->config_region_index];
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 7);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[7]);
-        model->config_bw_index = 7;
+    uint32_t rx2_index = LORAWAN_ITEM_CHANNELS + plan->group_count;
+    if(index != rx2_index) {
+        return;
+    }
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 2);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[2]);
-        model->config_sf_index = 2;
+    const LoRaRegionDataRate* data_rate = lora_region_find_data_rate(plan, plan->rx2_dr);
+    if(data_rate) {
+        model->config_dr_index = data_rate - plan->data_rates;
+        variable_item_set_current_value_index(app->item_dr, model->config_dr_index);
+        variable_item_set_current_value_text(app->item_dr, data_rate->name);
+        lora_config_apply_channel(app, plan->rx2_hz, data_rate->bw, data_rate->sf);
+    }
+}
 
-        break;
-    case 4: // SF8/500kHz
-        configSetSpreadingFactor(0x08);
-        configSetBandwidth(0x06);
+/**
+ * @brief      Find the option of a configuration table holding a value.
+ * @param      values  The option values.
+ * @param      count   Number of options.
+ * @param      value   The value to look for.
+ * @return     Index of the option, count if no option holds the value.
+*/
+static uint8_t lora_config_find_index(const uint8_t* values, size_t count, uint8_t value) {
+    uint8_t index = 0;
+    while(index < count && values[index] != value) {
+        index++;
+    }
+    return index;
+}
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 9);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[9]);
-        model->config_bw_index = 9;
+/**
+ * @brief      Show a table option on a configuration item.
+ * @param      item   The configuration item.
+ * @param      names  The option names.
+ * @param      count  Number of options.
+ * @param      index  The option, ignored if it is not less than count.
+ * @return     true if the item was updated.
+*/
+static bool lora_config_show_option(
+    VariableItem* item,
+    const char* const* names,
+    size_t count,
+    uint32_t index) {
+    if(index >= count) {
+        return false;
+    }
+    variable_item_set_current_value_index(item, index);
+    variable_item_set_current_value_text(item, names[index]);
+    return true;
+}
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 3);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[3]);
-        model->config_sf_index = 3;
+/**
+ * @brief      Switch to a profile.
+ * @details    The whole configuration goes to the radio in one configApply and one packet
+ *            parameter write, then the configuration screen is updated to match.
+ * @param      app      The LoRa application object.
+ * @param      profile  The profile.
+ * @return     Time the radio took to switch, in ms.
+*/
+static uint32_t lora_profile_apply(LoRaApp* app, const LoRaProfile* profile) {
+    LoRaSnifferModel* model = view_get_model(app->view_sniffer);
+    uint32_t start = furi_get_tick();
 
-        break;
-    case 5: // SF12/500kHz
-        configSetSpreadingFactor(0x0C);
-        configSetBandwidth(0x06);
+    configApply(profile->frequency, profile->bw, profile->sf, profile->cr, profile->sync_word);
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 9);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[9]);
-        model->config_bw_index = 9;
+    app->packetPreamble = profile->preamble;
+    app->packetHeaderType = profile->header_type;
+    app->packetCRC = profile->crc;
+    app->packetInvertIQ = profile->iq;
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 7);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[7]);
-        model->config_sf_index = 7;
+    // Order is preamble, header type, packet length, CRC, IQ
+    setPacketParams(
+        app->packetPreamble,
+        app->packetHeaderType,
+        app->packetPayloadLength,
+        app->packetCRC,
+        app->packetInvertIQ);
 
-        break;
-    case 6: // SF11/500kHz
-        configSetSpreadingFactor(0x0B);
-        configSetBandwidth(0x06);
+    uint32_t elapsed_ms = furi_get_tick() - start;
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 9);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[9]);
-        model->config_bw_index = 9;
+    lora_config_show_channel(app, profile->frequency, profile->bw, profile->sf);
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 6);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[6]);
-        model->config_sf_index = 6;
+    uint8_t index =
+        lora_config_find_index(config_cr_values, COUNT_OF(config_cr_values), profile->cr);
+    if(lora_config_show_option(app->item_cr, config_cr_names, COUNT_OF(config_cr_names), index)) {
+        model->config_cr_index = index;
+    }
 
-        break;
-    case 7: // SF10/500kHz
-        configSetSpreadingFactor(0x0A);
-        configSetBandwidth(0x06);
+    // A sync word missing from the table becomes the extra option, the settings keep it
+    index = 0;
+    while(index < COUNT_OF(config_sw_values) && config_sw_values[index] != profile->sync_word) {
+        index++;
+    }
+    if(index == CONFIG_SW_OTHER) {
+        app->config_sw_other = profile->sync_word;
+    }
+    lora_config_show_sw(app, index);
+    model->config_sw_index = index;
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 9);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[9]);
-        model->config_bw_index = 9;
+    index = lora_config_find_index(
+        config_header_type_values, COUNT_OF(config_header_type_values), profile->header_type);
+    if(lora_config_show_option(
+           app->item_header_type,
+           config_header_type_names,
+           COUNT_OF(config_header_type_names),
+           index)) {
+        model->config_header_type_index = index;
+    }
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 5);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[5]);
-        model->config_sf_index = 5;
+    index = lora_config_find_index(config_crc_values, COUNT_OF(config_crc_values), profile->crc);
+    if(lora_config_show_option(
+           app->item_crc, config_crc_names, COUNT_OF(config_crc_names), index)) {
+        model->config_crc_index = index;
+    }
 
-        break;
-    case 8: // SF9/500kHz
-        configSetSpreadingFactor(0x09);
-        configSetBandwidth(0x06);
+    index = lora_config_find_index(config_iq_values, COUNT_OF(config_iq_values), profile->iq);
+    if(lora_config_show_option(app->item_iq, config_iq_names, COUNT_OF(config_iq_names), index)) {
+        model->config_iq_index = index;
+    }
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 9);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[9]);
-        model->config_bw_index = 9;
+    FURI_LOG_I(TAG, "Profile %s applied in %lu ms", profile->name, elapsed_ms);
+    return elapsed_ms;
+}
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 4);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[4]);
-        model->config_sf_index = 4;
+/**
+ * @brief      Read the current configuration into a profile.
+ * @param      app      The LoRa application object.
+ * @param      profile  Filled with the current configuration, the name is left alone.
+*/
+static void lora_profile_capture(LoRaApp* app, LoRaProfile* profile) {
+    LoRaSnifferModel* model = view_get_model(app->view_sniffer);
 
-        break;
-    case 9: // SF8/500kHz
-        configSetSpreadingFactor(0x08);
-        configSetBandwidth(0x06);
+    profile->frequency = app->config_frequency;
+    profile->bw = config_bw_values[model->config_bw_index];
+    profile->sf = config_sf_values[model->config_sf_index];
+    profile->cr = config_cr_values[model->config_cr_index];
+    profile->sync_word = lora_config_sw_value(app, model->config_sw_index);
+    profile->preamble = app->packetPreamble;
+    profile->header_type = app->packetHeaderType;
+    profile->crc = app->packetCRC;
+    profile->iq = app->packetInvertIQ;
+}
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 9);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[9]);
-        model->config_bw_index = 9;
+/**
+ * @brief      Write the profiles to the SD card.
+ * @param      app  The LoRa application object.
+*/
+static void lora_profiles_save(LoRaApp* app) {
+    size_t size =
+        lora_profile_format(app->profiles, app->profile_count, NULL, 0) + 1; // NULL terminator
+    char* text = malloc(size);
+    lora_profile_format(app->profiles, app->profile_count, text, size);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, PATHPROFILES, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        storage_file_write(file, text, size - 1);
+    } else {
+        FURI_LOG_E(TAG, "Failed to open file %s", PATHPROFILES);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 3);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[3]);
-        model->config_sf_index = 3;
+    free(text);
+}
 
-        break;
-    case 10: // SF7/500kHz
-        configSetSpreadingFactor(0x07);
-        configSetBandwidth(0x06);
+/**
+ * @brief      Load the profiles from the SD card.
+ * @details    The first time the file is created with the built-in profiles, so they can be
+ *            edited on a computer.
+ * @param      app  The LoRa application object.
+*/
+static void lora_profiles_load(LoRaApp* app) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool loaded = false;
+
+    if(storage_file_open(file, PATHPROFILES, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        size_t size = storage_file_size(file);
+        if(size > LORA_PROFILE_FILE_MAX) {
+            size = LORA_PROFILE_FILE_MAX;
+        }
+        char* text = malloc(size);
+        size = storage_file_read(file, text, size);
+        app->profile_count = lora_profile_parse(text, size, app->profiles, LORA_PROFILE_MAX);
+        free(text);
+        loaded = true;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 1);
-        variable_item_set_current_value_index(app->item_bw, 9);
-        variable_item_set_current_value_text(app->item_bw, config_bw_names[9]);
-        model->config_bw_index = 9;
+    if(!loaded) {
+        app->profile_count = lora_profile_builtin_count;
+        memcpy(app->profiles, lora_profile_builtin, sizeof(LoRaProfile) * app->profile_count);
+        lora_profiles_save(app);
+    }
+}
 
-        variable_item_list_set_selected_item(app->variable_item_list_config, 2);
-        variable_item_set_current_value_index(app->item_sf, 2);
-        variable_item_set_current_value_text(app->item_sf, config_sf_names[2]);
-        model->config_sf_index = 2;
+static void lora_profiles_callback(void* context, uint32_t index);
 
-        break;
+/**
+ * @brief      Fill the profiles menu.
+ * @param      app  The LoRa application object.
+*/
+static void lora_profiles_menu_build(LoRaApp* app) {
+    submenu_reset(app->submenu_profiles);
+    submenu_set_header(app->submenu_profiles, "Profiles");
+    for(uint8_t i = 0; i < app->profile_count; i++) {
+        submenu_add_item(
+            app->submenu_profiles, app->profiles[i].name, i, lora_profiles_callback, app);
+    }
+    if(app->profile_count < LORA_PROFILE_MAX) {
+        submenu_add_item(
+            app->submenu_profiles,
+            "+ Save current config",
+            LORA_PROFILE_MAX,
+            lora_profiles_callback,
+            app);
     }
 }
 
-static const char* config_us915_ul_channels_125k_label = "Uplink 125 kHz";
+/**
+ * @brief      Callback when a profile is selected.
+ * @details    Selecting a profile switches to it, the last item saves the current configuration
+ *            as a new profile.
+ * @param      context  The context - LoRaApp object.
+ * @param      index    The profile index, LORA_PROFILE_MAX for the save item.
+*/
+static void lora_profiles_callback(void* context, uint32_t index) {
+    LoRaApp* app = (LoRaApp*)context;
+    char header[32];
+
+    if(index < app->profile_count) {
+        uint32_t elapsed_ms = lora_profile_apply(app, &app->profiles[index]);
+        snprintf(header, sizeof(header), "Loaded in %lu ms", elapsed_ms);
+        submenu_set_header(app->submenu_profiles, header);
+    } else if(app->profile_count < LORA_PROFILE_MAX) {
+        LoRaProfile* profile = &app->profiles[app->profile_count];
+        snprintf(profile->name, sizeof(profile->name), "Custom %u", app->profile_count + 1);
+        lora_profile_capture(app, profile);
+        app->profile_count++;
+        lora_profiles_save(app);
+        lora_profiles_menu_build(app);
+        submenu_set_selected_item(app->submenu_profiles, app->profile_count - 1);
+    }
+}
 
-static void lora_config_us915_ul_channels_125k_change(VariableItem* item) {
-    LoRaApp* app = variable_item_get_context(item);
-    uint8_t index = variable_item_get_current_value_index(item);
-
-    char text_buf[11] = {0};
-    snprintf(
-        text_buf,
-        sizeof(text_buf),
-        "%3lu.%1lu MHz",
-        config_us915_ul_channels_125k[index] / 1000000,
-        (config_us915_ul_channels_125k[index] % 1000000) / 100000);
-    variable_item_set_current_value_text(item, text_buf);
-
-    LoRaSnifferModel* model = view_get_model(app->view_sniffer);
-    model->config_us915_ul_channels_125k_index = index;
-
-    app->config_frequency = (int)config_us915_ul_channels_125k[index];
-    // setting text for configure frequency
-    furi_string_set(model->config_freq_name, text_buf);
-    variable_item_set_current_value_text(app->config_freq_item, text_buf);
+/**
+ * When the user clicks OK on the configuration frequencysetting we use a text input screen to allow
+ * the user to enter a frequency.  This function is called when the user clicks OK on the text input screen.
+*/
+static const char* config_freq_config_label = "Frequency";
+static const char* config_freq_entry_text = "Enter frequency (MHz)";
+static const char* config_freq_default_value = "915.0";
+static void lora_config_freq_text_updated(void* context) {
+    LoRaApp* app = (LoRaApp*)context;
+    bool redraw = true;
+    with_view_model(
+        app->view_sniffer,
+        LoRaSnifferModel * model,
+        {
+            furi_string_set(model->config_freq_name, app->temp_buffer);
+            variable_item_set_current_value_text(
+                app->config_freq_item, furi_string_get_cstr(model->config_freq_name));
 
-    FURI_LOG_E(TAG, "Frequency = %lu", app->config_frequency);
+            const char* freq_str = furi_string_get_cstr(model->config_freq_name);
+            app->config_frequency = (int)(strtof(freq_str, NULL) * 1000000);
+            FURI_LOG_E(TAG, "Frequency = %lu", app->config_frequency);
+        },
+        redraw);
 
+    view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewConfigure);
     configSetFrequency(app->config_frequency);
 }
 
-static const char* config_us915_ul_channels_500k_label = "Uplink 500 kHz";
+static const char* config_txpower_label = "TX Power";
 
-static void lora_config_us915_ul_channels_500k_change(VariableItem* item) {
+static void lora_config_txpower_change(VariableItem* item) {
     LoRaApp* app = variable_item_get_context(item);
     uint8_t index = variable_item_get_current_value_index(item);
 
-    char text_buf[11] = {0};
-    snprintf(
-        text_buf,
-        sizeof(text_buf),
-        "%3lu.%1lu MHz",
-        config_us915_ul_channels_500k[index] / 1000000,
-        (config_us915_ul_channels_500k[index] % 1000000) / 100000);
-    variable_item_set_current_value_text(item, text_buf);
-
+    variable_item_set_current_value_text(item, config_txpower_names[index]);
     LoRaSnifferModel* model = view_get_model(app->view_sniffer);
-    model->config_us915_ul_channels_500k_index = index;
-
-    app->config_frequency = (int)config_us915_ul_channels_500k[index];
-    // setting text for configure frequency
-    furi_string_set(model->config_freq_name, text_buf);
-    variable_item_set_current_value_text(app->config_freq_item, text_buf);
-
-    FURI_LOG_E(TAG, "Frequency = %lu", app->config_frequency);
-
-    configSetFrequency(app->config_frequency);
+    model->config_txpower_index = index;
+
+    configSetTxPower(config_txpower_values[index], config_ramp_values[model->config_ramp_index]);
+
+    uint32_t airtime_ms = getTimeOnAir(app->packetPayloadLength);
+    FURI_LOG_I(
+        TAG,
+        "TX power %s, %lu ms and %lu uJ per %u byte packet",
+        config_txpower_names[index],
+        airtime_ms,
+        getTxEnergy(airtime_ms),
+        app->packetPayloadLength);
 }
 
-static const char* config_us915_dl_channels_500k_label = "Downlink 500 kHz";
+static const char* config_ramp_label = "PA Ramp";
 
-static void lora_config_us915_dl_channels_500k_change(VariableItem* item) {
+static void lora_config_ramp_change(VariableItem* item) {
     LoRaApp* app = variable_item_get_context(item);
     uint8_t index = variable_item_get_current_value_index(item);
 
-    char text_buf[11] = {0};
-    snprintf(
-        text_buf,
-        sizeof(text_buf),
-        "%3lu.%1lu MHz",
-        config_us915_dl_channels_500k[index] / 1000000,
-        (config_us915_dl_channels_500k[index] % 1000000) / 100000);
-    variable_item_set_current_value_text(item, text_buf);
-
+    variable_item_set_current_value_text(item, config_ramp_names[index]);
     LoRaSnifferModel* model = view_get_model(app->view_sniffer);
-    model->config_us915_dl_channels_500k_index = index;
+    model->config_ramp_index = index;
 
-    app->config_frequency = (int)config_us915_dl_channels_500k[index];
-    // setting text for configure frequency
-    furi_string_set(model->config_freq_name, text_buf);
-    variable_item_set_current_value_text(app->config_freq_item, text_buf);
-
-    FURI_LOG_E(TAG, "Frequency = %lu", app->config_frequency);
-
-    configSetFrequency(app->config_frequency);
+    configSetTxPower(
+        config_txpower_values[model->config_txpower_index], config_ramp_values[index]);
 }
 
-static const char* config_eu868_ul_channels_125k_label = "Uplink 125 kHz";
+static const char* config_rx_alert_label = "RX Alert";
 
-static void lora_config_eu868_ul_channels_125k_change(VariableItem* item) {
+static void lora_config_rx_alert_change(VariableItem* item) {
     LoRaApp* app = variable_item_get_context(item);
     uint8_t index = variable_item_get_current_value_index(item);
 
-    char text_buf[11] = {0};
-    snprintf(
-        text_buf,
-        sizeof(text_buf),
-        "%3lu.%1lu MHz",
-        config_eu868_ul_channels_125k[index] / 1000000,
-        (config_eu868_ul_channels_125k[index] % 1000000) / 100000);
-    variable_item_set_current_value_text(item, text_buf);
-
-    LoRaSnifferModel* model = view_get_model(app->view_sniffer);
-    model->config_eu868_ul_channels_125k_index = index;
-
-    app->config_frequency = (int)config_eu868_ul_channels_125k[index];
-    // setting text for configure frequency
-    furi_string_set(model->config_freq_name, text_buf);
-    variable_item_set_current_value_text(app->config_freq_item, text_buf);
-
-    FURI_LOG_E(TAG, "Frequency = %lu", app->config_frequency);
-
-    configSetFrequency(app->config_frequency);
-}
-
-static const char* config_eu868_ul_channels_250k_label = "Uplink 250 kHz";
-
-static void lora_config_eu868_ul_channels_250k_change(VariableItem* item) {
-    LoRaApp* app = variable_item_get_context(item);
-    uint8_t index = variable_item_get_current_value_index(item);
-
-    char text_buf[11] = {0};
-    snprintf(
-        text_buf,
-        sizeof(text_buf),
-        "%3lu.%1lu MHz",
-        config_eu868_ul_channels_250k[index] / 1000000,
-        (config_eu868_ul_channels_250k[index] % 1000000) / 100000);
-    variable_item_set_current_value_text(item, text_buf);
-
+    variable_item_set_current_value_text(item, config_alert_names[index]);
     LoRaSnifferModel* model = view_get_model(app->view_sniffer);
-    model->config_eu868_ul_channels_250k_index = index;
+    model->config_rx_alert_index = index;
 
-    app->config_frequency = (int)config_eu868_ul_channels_250k[index];
-    // setting text for configure frequency
-    furi_string_set(model->config_freq_name, text_buf);
-    variable_item_set_current_value_text(app->config_freq_item, text_buf);
-
-    FURI_LOG_E(TAG, "Frequency = %lu", app->config_frequency);
-
-    configSetFrequency(app->config_frequency);
+    lora_notify_set_outputs(LoRaNotifyEventRx, config_alert_values[index]);
 }
 
-static const char* config_eu868_dl_channels_rx1_label = "Downlink RX1";
+static const char* config_tx_alert_label = "TX Alert";
 
-static void lora_config_eu868_dl_channels_rx1_change(VariableItem* item) {
+static void lora_config_tx_alert_change(VariableItem* item) {
     LoRaApp* app = variable_item_get_context(item);
     uint8_t index = variable_item_get_current_value_index(item);
 
-    char text_buf[11] = {0};
-    snprintf(
-        text_buf,
-        sizeof(text_buf),
-        "%3lu.%1lu MHz",
-        config_eu868_dl_channels_rx1[index] / 1000000,
-        (config_eu868_dl_channels_rx1[index] % 1000000) / 100000);
-    variable_item_set_current_value_text(item, text_buf);
-
+    variable_item_set_current_value_text(item, config_alert_names[index]);
     LoRaSnifferModel* model = view_get_model(app->view_sniffer);
-    model->config_eu868_dl_channels_rx1_index = index;
-
-    app->config_frequency = (int)config_eu868_dl_channels_rx1[index];
-    // setting text for configure frequency
-    furi_string_set(model->config_freq_name, text_buf);
-    variable_item_set_current_value_text(app->config_freq_item, text_buf);
-
-    FURI_LOG_E(TAG, "Frequency = %lu", app->config_frequency);
+    model->config_tx_alert_index = index;
 
-    configSetFrequency(app->config_frequency);
+    lora_notify_set_outputs(LoRaNotifyEventTx, config_alert_values[index]);
 }
 
-static const char* config_region_label = "Frequency Plan";
+static const char* config_stream_label = "USB Stream";
+static const char* const config_stream_names[] = {"Off", "On"};
 
-static void lora_config_region_change(VariableItem* item) {
+static void lora_config_stream_change(VariableItem* item) {
     LoRaApp* app = variable_item_get_context(item);
     uint8_t index = variable_item_get_current_value_index(item);
-    variable_item_set_current_value_text(item, config_region_names[index]);
 
+    variable_item_set_current_value_text(item, config_stream_names[index]);
     LoRaSnifferModel* model = view_get_model(app->view_sniffer);
-    model->config_region_index = index;
-
-    variable_item_list_reset(app->variable_item_list_lorawan);
-
-    char text_buf[11] = {0};
-
-    if(index == 0) {
-        app->config_frequency = 868100000;
-        // setting text for configure frequency
-        snprintf(
-            text_buf,
-            sizeof(text_buf),
-            "%3lu.%1lu MHz",
-            app->config_frequency / 1000000,
-            (app->config_frequency % 1000000) / 100000);
-        variable_item_set_current_value_text(app->config_freq_item, text_buf);
-
-        FURI_LOG_E(TAG, "Frequency = %lu", app->config_frequency);
-
-        configSetFrequency(app->config_frequency);
-
-        // Frequency Plan
-        app->item_region = variable_item_list_add(
-            app->variable_item_list_lorawan,
-            config_region_label,
-            COUNT_OF(config_region_values),
-            lora_config_region_change,
-            app);
-        uint8_t config_region_index = 0;
-        variable_item_set_current_value_index(app->item_region, config_region_index);
-        variable_item_set_current_value_text(
-            app->item_region, config_region_names[config_region_index]);
-
-        // EU868 Data Rate
-        app->item_eu_dr = variable_item_list_add(
-            app->variable_item_list_lorawan,
-            config_eu_dr_label,
-            COUNT_OF(config_eu_dr_values),
-            lora_config_eu_dr_change,
-            app);
-        uint8_t config_eu_dr_index = 0;
-        variable_item_set_current_value_index(app->item_eu_dr, config_eu_dr_index);
-        variable_item_set_current_value_text(
-            app->item_eu_dr, config_eu_dr_names[config_eu_dr_index]);
-
-        // Uplink EU868 Channel 125K
-        app->item_eu868_ul_channels_125k = variable_item_list_add(
-            app->variable_item_list_lorawan,
-            config_eu868_ul_channels_125k_label,
-            COUNT_OF(config_eu868_ul_channels_125k),
-            lora_config_eu868_ul_channels_125k_change,
-            app);
-        uint8_t config_eu868_ul_channels_125k_index = 0;
-        variable_item_set_current_value_index(
-            app->item_eu868_ul_channels_125k, config_eu868_ul_channels_125k_index);
-
-        snprintf(
-            text_buf,
-            sizeof(text_buf),
-            "%3lu.%1lu MHz",
-            config_eu868_ul_channels_125k[index] / 1000000,
-            (config_eu868_ul_channels_125k[index] % 1000000) / 100000);
-        variable_item_set_current_value_text(app->item_eu868_ul_channels_125k, text_buf);
-
-        // Uplink EU868 Channel 250K
-        app->item_eu868_ul_channels_250k = variable_item_list_add(
-            app->variable_item_list_lorawan,
-            config_eu868_ul_channels_250k_label,
-            COUNT_OF(config_eu868_ul_channels_250k),
-            lora_config_eu868_ul_channels_250k_change,
-            app);
-        uint8_t config_eu868_ul_channels_250k_index = 0;
-        variable_item_set_current_value_index(
-            app->item_eu868_ul_channels_250k, config_eu868_ul_channels_250k_index);
-
-        snprintf(
-            text_buf,
-            sizeof(text_buf),
-            "%3lu.%1lu MHz",
-            config_eu868_ul_channels_250k[index] / 1000000,
-            (config_eu868_ul_channels_250k[index] % 1000000) / 100000);
-        variable_item_set_current_value_text(app->item_eu868_ul_channels_250k, text_buf);
-
-        // Downlink EU868 Channel RX1
-        app->item_eu868_dl_channels_rx1 = variable_item_list_add(
-            app->variable_item_list_lorawan,
-            config_eu868_dl_channels_rx1_label,
-            COUNT_OF(config_eu868_dl_channels_rx1),
-            lora_config_eu868_dl_channels_rx1_change,
-            app);
-        uint8_t config_eu868_dl_channels_rx1_index = 0;
-        variable_item_set_current_value_index(
-            app->item_eu868_dl_channels_rx1, config_eu868_dl_channels_rx1_index);
-
-        snprintf(
-            text_buf,
-            sizeof(text_buf),
-            "%3lu.%1lu MHz",
-            config_eu868_dl_channels_rx1[index] / 1000000,
-            (config_eu868_dl_channels_rx1[index] % 1000000) / 100000);
-        variable_item_set_current_value_text(app->item_eu868_dl_channels_rx1, text_buf);
-
-    } else if(index == 1) {
-        app->config_frequency = 902300000; //first channel
-        // setting text for configure frequency
-        snprintf(
-            text_buf,
-            sizeof(text_buf),
-            "%3lu.%1lu MHz",
-            app->config_frequency / 1000000,
-            (app->config_frequency % 1000000) / 100000);
-        variable_item_set_current_value_text(app->config_freq_item, text_buf);
-
-        FURI_LOG_E(TAG, "Frequency = %lu", app->config_frequency);
-
-        configSetFrequency(app->config_frequency);
-
-        // Frequency Plan
-        app->item_region = variable_item_list_add(
-            app->variable_item_list_lorawan,
-            config_region_label,
-            COUNT_OF(config_region_values),
-            lora_config_region_change,
-            app);
-        uint8_t config_region_index = 1;
-        variable_item_set_current_value_index(app->item_region, config_region_index);
-        variable_item_set_current_value_text(
-            app->item_region, config_region_names[config_region_index]);
-
-        // US915 Data Rate
-        app->item_us_dr = variable_item_list_add(
-            app->variable_item_list_lorawan,
-            config_us_dr_label,
-            COUNT_OF(config_us_dr_values),
-            lora_config_us_dr_change,
-            app);
-        uint8_t config_us_dr_index = 0;
-        variable_item_set_current_value_index(app->item_us_dr, config_us_dr_index);
-        variable_item_set_current_value_text(
-            app->item_us_dr, config_us_dr_names[config_us_dr_index]);
-
-        // Uplink US915 Channel 125K
-        app->item_us915_ul_channels_125k = variable_item_list_add(
-            app->variable_item_list_lorawan,
-            config_us915_ul_channels_125k_label,
-            COUNT_OF(config_us915_ul_channels_125k),
-            lora_config_us915_ul_channels_125k_change,
-            app);
-        uint8_t config_us915_ul_channels_125k_index = 0;
-        variable_item_set_current_value_index(
-            app->item_us915_ul_channels_125k, config_us915_ul_channels_125k_index);
-
-        snprintf(
-            text_buf,
-            sizeof(text_buf),
-            "%3lu.%1lu MHz",
-            config_us915_ul_channels_125k[index] / 1000000,
-            (config_us915_ul_channels_125k[index] % 1000000) / 100000);
-        variable_item_set_current_value_text(app->item_us915_ul_channels_125k, text_buf);
-
-        // Uplink US915 Channel 500K
-        app->item_us915_ul_channels_500k = variable_item_list_add(
-            app->variable_item_list_lorawan,
-            config_us915_ul_channels_500k_label,
-            COUNT_OF(config_us915_ul_channels_500k),
-            lora_config_us915_ul_channels_500k_change,
-            app);
-        uint8_t config_us915_ul_channels_500k_index = 0;
-        variable_item_set_current_value_index(
-            app->item_us915_ul_channels_500k, config_us915_ul_channels_500k_index);
-
-        snprintf(
-            text_buf,
-            sizeof(text_buf),
-            "%3lu.%1lu MHz",
-            config_us915_ul_channels_500k[index] / 1000000,
-            (config_us915_ul_channels_500k[index] % 1000000) / 100000);
-        variable_item_set_current_value_text(app->item_us915_ul_channels_500k, text_buf);
-
-        // Downlink US915 Channel 500K
-        app->item_us915_dl_channels_500k = variable_item_list_add(
-            app->variable_item_list_lorawan,
-            config_us915_dl_channels_500k_label,
-            COUNT_OF(config_us915_dl_channels_500k),
-            lora_config_us915_dl_channels_500k_change,
-            app);
-        uint8_t config_us915_dl_channels_500k_index = 0;
-        variable_item_set_current_value_index(
-            app->item_us915_dl_channels_500k, config_us915_dl_channels_500k_index);
-
-        snprintf(
-            text_buf,
-            sizeof(text_buf),
-            "%3lu.%1lu MHz",
-            config_us915_dl_channels_500k[index] / 1000000,
-            (config_us915_dl_channels_500k[index] % 1000000) / 100000);
-        variable_item_set_current_value_text(app->item_us915_dl_channels_500k, text_buf);
+    if(index && !model->stream) {
+        model->stream = lora_stream_alloc();
+    } else if(!index && model->stream) {
+        lora_stream_free(model->stream);
+        model->stream = NULL;
     }
-
-    //configSetSpreadingFactor(config_sf_values[index]);
-}
-
-/**
- * When the user clicks OK on the configuration frequencysetting we use a text input screen to allow
- * the user to enter a frequency.  This function is called when the user clicks OK on the text input screen.
-*/
-static const char* config_freq_config_label = "Frequency";
-static const char* config_freq_entry_text = "Enter frequency (MHz)";
-static const char* config_freq_default_value = "915.0";
-static void lora_config_freq_text_updated(void* context) {
-    LoRaApp* app = (LoRaApp*)context;
-    bool redraw = true;
-    with_view_model(
-        app->view_sniffer,
-        LoRaSnifferModel * model,
-        {
-            furi_string_set(model->config_freq_name, app->temp_buffer);
-            variable_item_set_current_value_text(
-                app->config_freq_item, furi_string_get_cstr(model->config_freq_name));
-
-            const char* freq_str = furi_string_get_cstr(model->config_freq_name);
-            app->config_frequency = (int)(strtof(freq_str, NULL) * 1000000);
-            FURI_LOG_E(TAG, "Frequency = %lu", app->config_frequency);
-        },
-        redraw);
-
-    view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewConfigure);
-    configSetFrequency(app->config_frequency);
 }
 
 static void set_value(void* context) {
@@ -1399,6 +1440,9 @@ static void set_value(void* context) {
     FURI_LOG_E(TAG, "Byte buffer: %s", (char*)app->byte_buffer);
     view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewSubmenu);
     transmit(app->byte_buffer, app->byte_buffer_size);
+
+    uint32_t airtime_ms = getTimeOnAir(app->byte_buffer_size);
+    FURI_LOG_I(TAG, "Sent %lu ms, about %lu uJ", airtime_ms, getTxEnergy(airtime_ms));
 }
 
 /**
@@ -1449,119 +1493,670 @@ static void lora_setting_item_clicked(void* context, uint32_t index) {
     }
 }
 
-void bytesToAsciiHex(uint8_t* buffer, uint8_t length) {
-    uint8_t i;
-    for(i = 0; i < length; ++i) {
-        asciiBuff[i * 2] = "0123456789ABCDEF"[buffer[i] >> 4]; // High nibble
-        asciiBuff[i * 2 + 1] = "0123456789ABCDEF"[buffer[i] & 0x0F]; // Low nibble
+/**
+ * @brief      Record a radio recovery in the capture log.
+ * @details    The line has no payload, so replaying the log skips it.
+ * @param      my_model   The sniffer model, with the log file open.
+ * @param      outage_ms  How long the radio was lost.
+*/
+static void lora_sniffer_log_recovery(LoRaSnifferModel* my_model, uint32_t outage_ms) {
+    DateTime curr_dt;
+    furi_hal_rtc_get_datetime(&curr_dt);
+
+    char line[128];
+    int length = snprintf(
+        line,
+        sizeof(line),
+        "{\"date\":\"" CLOCK_ISO_DATE_FORMAT "\", \"time\":\"" CLOCK_TIME_FORMAT
+        "\", \"event\":\"radio_reset\", \"outage_ms\":\"%lu\", \"outages\":\"%lu\"}\n",
+        curr_dt.year,
+        curr_dt.month,
+        curr_dt.day,
+        curr_dt.hour,
+        curr_dt.minute,
+        curr_dt.second,
+        outage_ms,
+        getRadioOutages());
+    if(length > 0 && (size_t)length < sizeof(line)) {
+        storage_file_write(my_model->file_rx, line, length);
     }
-    asciiBuff[length * 2] = '\0'; // Null-terminate the string
-    FURI_LOG_E(TAG, "OUT bytesToAsciiHex ");
 }
 
-void asciiHexToBytes(const char* hex, uint8_t* bytes, size_t length) {
-    for(size_t i = 0; i < length; i++) {
-        sscanf(hex + 2 * i, "%02hhx", &bytes[i]);
+/**
+ * @brief      Get the packet selected in the history, following it to the oldest kept packet
+ *           if it was dropped.
+ * @param      my_model  The sniffer model.
+ * @param      payload   Set to the payload of the packet.
+ * @return     The packet, NULL if the history is empty.
+*/
+static const LoRaHistoryEntry*
+    lora_sniffer_history_selected(LoRaSnifferModel* my_model, const uint8_t** payload) {
+    LoRaHistory* history = &my_model->history;
+    size_t count = lora_history_count(history);
+    if(count == 0) {
+        return NULL;
     }
+    uint32_t newest = history->total - 1;
+    if(newest - my_model->history_selected >= count) {
+        my_model->history_selected = history->total - count;
+    }
+    return lora_history_get(history, newest - my_model->history_selected, payload);
 }
 
 /**
- * @brief      Callback for drawing the sniffer screen.
- * @details    This function is called when the screen needs to be redrawn, like when the model gets updated.
- * @param      canvas  The canvas to draw on.
- * @param      model   The model - MyModel object.
+ * @brief      Move through the sniffer screens with Up and Down.
+ * @details    Up from the live screen opens the history on the newest packet, Down past the
+ *           newest packet goes back to the live screen.  On the detail screen the hex dump
+ *           scrolls, on the devices screen the selection moves.
+ * @param      my_model  The sniffer model.
+ * @param      up        true for Up, false for Down.
 */
-static void lora_view_sniffer_draw_callback(Canvas* canvas, void* model) {
-    LoRaSnifferModel* my_model = (LoRaSnifferModel*)model;
+static void lora_sniffer_history_move(LoRaSnifferModel* my_model, bool up) {
+    LoRaHistory* history = &my_model->history;
+    const uint8_t* payload;
+    const LoRaHistoryEntry* entry = lora_sniffer_history_selected(my_model, &payload);
+    if(!entry) {
+        return;
+    }
+
+    switch(my_model->screen) {
+    case LoRaSnifferScreenLive:
+        if(up) {
+            my_model->screen = LoRaSnifferScreenHistory;
+            my_model->history_selected = history->total - 1;
+        }
+        break;
+    case LoRaSnifferScreenHistory:
+        if(up) {
+            if(my_model->history_selected > history->total - lora_history_count(history)) {
+                my_model->history_selected--;
+            }
+        } else if(my_model->history_selected + 1 < history->total) {
+            my_model->history_selected++;
+        } else {
+            my_model->screen = LoRaSnifferScreenLive;
+        }
+        break;
+    case LoRaSnifferScreenDetail: {
+        LoRaWANFrame frame;
+        uint8_t rows = (entry->length + LORA_SNIFFER_DETAIL_ROW_BYTES - 1) /
+                       LORA_SNIFFER_DETAIL_ROW_BYTES;
+        if(lora_lorawan_decode(payload, entry->length, &frame)) {
+            rows += LORA_SNIFFER_LORAWAN_ROWS;
+        }
+        if(up) {
+            if(my_model->detail_scroll > 0) {
+                my_model->detail_scroll--;
+            }
+        } else if(my_model->detail_scroll + LORA_SNIFFER_DETAIL_ROWS < rows) {
+            my_model->detail_scroll++;
+        }
+        break;
+    }
+    case LoRaSnifferScreenDevices:
+        if(up) {
+            if(my_model->device_selected > 0) {
+                my_model->device_selected--;
+            }
+        } else if(my_model->device_selected + 1 < my_model->device_listed) {
+            my_model->device_selected++;
+        }
+        break;
+    }
+}
+
+/**
+ * @brief      Order the device list again, the selection keeps its position.
+ * @param      my_model  The sniffer model.
+*/
+static void lora_sniffer_devices_sort(LoRaSnifferModel* my_model) {
+    my_model->device_listed =
+        lora_devices_sort(&my_model->devices, my_model->device_sort, my_model->device_order);
+    if(my_model->device_selected >= my_model->device_listed) {
+        my_model->device_selected = my_model->device_listed ? my_model->device_listed - 1 : 0;
+    }
+}
 
-    bool flag_file = my_model->flag_file;
+/**
+ * @brief      Draw the latest packet and the radio status.
+ * @param      canvas    The canvas to draw on.
+ * @param      my_model  The sniffer model.
+*/
+static void lora_sniffer_draw_live(Canvas* canvas, LoRaSnifferModel* my_model) {
+    char text[32];
 
     canvas_draw_icon(canvas, 0, 17, &I_flippers_cat);
 
-    //Receive a packet over radio
-    int bytesRead = lora_receive_async(receiveBuff, sizeof(receiveBuff));
+    if(my_model->flag_file) {
+        canvas_draw_icon(canvas, 110, 1, &I_write);
+        canvas_draw_str(canvas, 60, 20, "Recording...");
+    } else {
+        canvas_draw_icon(canvas, 110, 1, &I_no_write);
+    }
 
-    if(bytesRead > -1) {
-        FURI_LOG_E(TAG, "Packet received... ");
-        receiveBuff[bytesRead] = '\0';
-        bytesToAsciiHex(receiveBuff, bytesRead);
+    // LoRaWAN type and address, or the start of the latest payload as text, the payload itself
+    // is left untouched
+    const uint8_t* payload;
+    const LoRaHistoryEntry* entry = lora_history_get(&my_model->history, 0, &payload);
+    LoRaWANFrame frame;
+    if(entry && lora_lorawan_decode(payload, entry->length, &frame)) {
+        if(lora_lorawan_is_data(frame.mtype)) {
+            snprintf(
+                text,
+                sizeof(text),
+                "%s %08lX",
+                lora_lorawan_mtype_short_name(frame.mtype),
+                frame.dev_addr);
+        } else {
+            snprintf(text, sizeof(text), "%s", lora_lorawan_mtype_name(frame.mtype));
+        }
+        canvas_draw_str(canvas, 1, 10, text);
+    } else if(entry) {
+        size_t length = 0;
+        for(; length < entry->length && length < LORA_SNIFFER_LIVE_CHARS; length++) {
+            char c = payload[length];
+            text[length] = (c >= ' ' && c <= '~') ? c : '.';
+        }
+        if(entry->length > LORA_SNIFFER_LIVE_CHARS) {
+            memcpy(&text[length], "...", 3);
+            length += 3;
+        }
+        text[length] = '\0';
+        canvas_draw_str(canvas, 1, 10, text);
+    }
 
-        if(flag_file) {
-            DateTime curr_dt;
-            furi_hal_rtc_get_datetime(&curr_dt);
+    snprintf(text, sizeof(text), "RSSI: %d  ", entry ? entry->rssi : 0);
+    canvas_draw_str(canvas, 1, 19, text);
 
-            char time_string[TIME_LEN];
-            char date_string[DATE_LEN];
+    snprintf(text, sizeof(text), "BW:%s", config_bw_names[my_model->config_bw_index]);
+    canvas_draw_str(canvas, 1, 28, text);
 
+    snprintf(text, sizeof(text), "FQ:%s MHz", furi_string_get_cstr(my_model->config_freq_name));
+    canvas_draw_str(canvas, 60, 28, text);
+
+    if(my_model->radio_outages > 0) {
+        snprintf(
+            text,
+            sizeof(text),
+            "Resets:%lu %lus",
+            my_model->radio_outages,
+            my_model->radio_recovery_ms / 1000);
+        canvas_draw_str(canvas, 60, 37, text);
+    }
+
+    if(my_model->stream) {
+        snprintf(text, sizeof(text), "USB drop:%lu", my_model->stream_dropped);
+        canvas_draw_str(canvas, 60, 46, text);
+    }
+}
+
+/**
+ * @brief      Draw the page of the history holding the selected packet.
+ * @details    Only the rows on screen are read from the history.
+ * @param      canvas    The canvas to draw on.
+ * @param      my_model  The sniffer model.
+*/
+static void lora_sniffer_draw_history(Canvas* canvas, LoRaSnifferModel* my_model) {
+    LoRaHistory* history = &my_model->history;
+    const uint8_t* payload;
+    char text[32];
+
+    canvas_set_font(canvas, FontSecondary);
+    if(my_model->flag_file) {
+        canvas_draw_str_aligned(canvas, 127, 8, AlignRight, AlignBottom, "REC");
+    }
+    if(!lora_sniffer_history_selected(my_model, &payload)) {
+        canvas_draw_str(canvas, 1, 8, "No packets yet");
+        return;
+    }
+
+    size_t count = lora_history_count(history);
+    size_t selected = history->total - 1 - my_model->history_selected;
+    snprintf(text, sizeof(text), "History %u/%u", selected + 1, count);
+    canvas_draw_str(canvas, 1, 8, text);
+
+    size_t first = selected - selected % LORA_SNIFFER_HISTORY_ROWS;
+    for(size_t row = 0; row < LORA_SNIFFER_HISTORY_ROWS; row++) {
+        const LoRaHistoryEntry* entry = lora_history_get(history, first + row, &payload);
+        if(!entry) {
+            break;
+        }
+        LoRaWANFrame frame;
+        bool lorawan = lora_lorawan_decode(payload, entry->length, &frame);
+        if(lorawan && lora_lorawan_is_data(frame.mtype)) {
             snprintf(
-                time_string,
-                TIME_LEN,
-                CLOCK_TIME_FORMAT,
-                curr_dt.hour,
-                curr_dt.minute,
-                curr_dt.second);
-            snprintf(
-                date_string,
-                DATE_LEN,
-                CLOCK_ISO_DATE_FORMAT,
-                curr_dt.year,
-                curr_dt.month,
-                curr_dt.day);
+                text,
+                sizeof(text),
+                "%4d %-5s %08lX %u",
+                entry->rssi,
+                lora_lorawan_mtype_short_name(frame.mtype),
+                frame.dev_addr,
+                frame.fcnt);
+        } else {
+            int length = snprintf(text, sizeof(text), "%4d %3uB ", entry->rssi, entry->length);
+            if(lorawan) {
+                snprintf(
+                    text + length,
+                    sizeof(text) - length,
+                    "%s",
+                    lora_lorawan_mtype_name(frame.mtype));
+            } else {
+                size_t shown = entry->length < LORA_SNIFFER_HISTORY_BYTES ?
+                                   entry->length :
+                                   LORA_SNIFFER_HISTORY_BYTES;
+                lora_hex_encode(payload, shown, text + length, sizeof(text) - length);
+            }
+        }
 
-            char final_string[400];
-            const char* freq_str = furi_string_get_cstr(my_model->config_freq_name);
+        uint8_t y = 17 + row * 9;
+        if(first + row == selected) {
+            canvas_draw_box(canvas, 0, y - 8, 128, 9);
+            canvas_set_color(canvas, ColorWhite);
+            canvas_draw_str(canvas, 1, y, text);
+            canvas_set_color(canvas, ColorBlack);
+        } else {
+            canvas_draw_str(canvas, 1, y, text);
+        }
+    }
+}
 
-            //JSON format
+/**
+ * @brief      Describe the LoRaWAN header of a packet on a row of the detail screen.
+ * @param      frame  The decoded frame.
+ * @param      row    Row number, less than LORA_SNIFFER_LORAWAN_ROWS.
+ * @param      text   Filled with the row.
+ * @param      size   Size of text.
+*/
+static void
+    lora_sniffer_lorawan_row(const LoRaWANFrame* frame, uint8_t row, char* text, size_t size) {
+    if(row == 0) {
+        if(lora_lorawan_is_data(frame->mtype)) {
             snprintf(
-                final_string,
-                666,
-                "{\"date\":\"%s\", \"time\":\"%s\", \"frequency\":\"%s\", \"bw\":\"%s\", \"sf\":\"%s\", \"RSSI\":\"%d\", \"payload\":\"%s\"}",
-                date_string,
-                time_string,
-                freq_str,
-                config_bw_names[my_model->config_bw_index],
-                config_sf_names[my_model->config_sf_index],
-                getRSSI(),
-                asciiBuff);
-
-            FURI_LOG_E(TAG, "TS: %s", final_string);
-            FURI_LOG_E(TAG, "Length: %d", strlen(final_string) + 1);
-
-            storage_file_write(my_model->file_rx, final_string, strlen(final_string));
-            storage_file_write(my_model->file_rx, "\n", 1);
+                text,
+                size,
+                "%s %08lX FCnt %u",
+                lora_lorawan_mtype_short_name(frame->mtype),
+                frame->dev_addr,
+                frame->fcnt);
+        } else if(frame->mtype == LoRaWANMTypeJoinRequest) {
+            snprintf(text, size, "JoinRequest Nonce %u", frame->dev_nonce);
+        } else {
+            snprintf(text, size, "%s", lora_lorawan_mtype_name(frame->mtype));
         }
-        FURI_LOG_E(TAG, "%s", receiveBuff);
+    } else if(lora_lorawan_is_data(frame->mtype)) {
+        int length = snprintf(text, size, "FCtrl %02X Opts %u", frame->fctrl, frame->fopts_len);
+        if(frame->has_port) {
+            snprintf(text + length, size - length, " Port %u", frame->fport);
+        }
+    } else if(frame->mtype == LoRaWANMTypeJoinRequest) {
+        // The EUI is sent least significant byte first
+        int length = snprintf(text, size, "DevEUI ");
+        for(size_t i = LORA_LORAWAN_EUI_LEN; i > 0; i--) {
+            length += snprintf(text + length, size - length, "%02X", frame->dev_eui[i - 1]);
+        }
+    } else {
+        snprintf(text, size, "MIC %08lX", frame->mic);
     }
+}
 
-    FuriString* xstr = furi_string_alloc();
+/**
+ * @brief      Draw the metadata, the LoRaWAN header and the hex dump of the selected packet.
+ * @param      canvas    The canvas to draw on.
+ * @param      my_model  The sniffer model.
+*/
+static void lora_sniffer_draw_detail(Canvas* canvas, LoRaSnifferModel* my_model) {
+    const uint8_t* payload;
+    char text[32];
+
+    canvas_set_font(canvas, FontSecondary);
+    const LoRaHistoryEntry* entry = lora_sniffer_history_selected(my_model, &payload);
+    if(!entry) {
+        return;
+    }
 
-    if(flag_file) {
-        canvas_draw_icon(canvas, 110, 1, &I_write);
-        furi_string_printf(xstr, "Recording...");
-        canvas_draw_str(canvas, 60, 20, furi_string_get_cstr(xstr));
-    } else {
-        canvas_draw_icon(canvas, 110, 1, &I_no_write);
-        furi_string_printf(xstr, "            ");
-        canvas_draw_str(canvas, 60, 20, furi_string_get_cstr(xstr));
+    snprintf(
+        text,
+        sizeof(text),
+        "#%lu  %lus ago",
+        entry->number,
+        (furi_get_tick() - entry->tick) / furi_kernel_get_tick_frequency());
+    canvas_draw_str(canvas, 1, 8, text);
+    snprintf(text, sizeof(text), "%uB", entry->length);
+    canvas_draw_str_aligned(canvas, 127, 8, AlignRight, AlignBottom, text);
+
+    snprintf(
+        text,
+        sizeof(text),
+        "%lu.%03lu MHz SF%u",
+        entry->frequency / 1000000,
+        entry->frequency / 1000 % 1000,
+        entry->sf);
+    canvas_draw_str(canvas, 1, 17, text);
+
+    snprintf(text, sizeof(text), "RSSI %d  SNR %d", entry->rssi, entry->snr);
+    canvas_draw_str(canvas, 1, 26, text);
+
+    // The LoRaWAN rows scroll with the hex dump
+    LoRaWANFrame frame;
+    uint8_t lorawan_rows =
+        lora_lorawan_decode(payload, entry->length, &frame) ? LORA_SNIFFER_LORAWAN_ROWS : 0;
+
+    for(uint8_t row = 0; row < LORA_SNIFFER_DETAIL_ROWS; row++) {
+        uint8_t index = my_model->detail_scroll + row;
+        if(index < lorawan_rows) {
+            lora_sniffer_lorawan_row(&frame, index, text, sizeof(text));
+            canvas_draw_str(canvas, 1, 35 + row * 9, text);
+            continue;
+        }
+        size_t start = (index - lorawan_rows) * LORA_SNIFFER_DETAIL_ROW_BYTES;
+        if(start >= entry->length) {
+            break;
+        }
+        size_t end = start + LORA_SNIFFER_DETAIL_ROW_BYTES;
+        if(end > entry->length) {
+            end = entry->length;
+        }
+        size_t length = 0;
+        for(size_t i = start; i < end; i++) {
+            length += snprintf(text + length, sizeof(text) - length, "%02X ", payload[i]);
+        }
+        canvas_draw_str(canvas, 1, 35 + row * 9, text);
     }
+}
 
-    receiveBuff[17] = '.';
-    receiveBuff[18] = '.';
-    receiveBuff[19] = '.';
-    receiveBuff[20] = '\0';
+/**
+ * @brief      Draw the page of the device list holding the selected device.
+ * @details    Each row is DevAddr, uplinks, average RSSI and the share of uplinks missed
+ *           going by FCnt.  The last line has more about the selected device.
+ * @param      canvas    The canvas to draw on.
+ * @param      my_model  The sniffer model.
+*/
+static void lora_sniffer_draw_devices(Canvas* canvas, LoRaSnifferModel* my_model) {
+    const LoRaDevices* devices = &my_model->devices;
+    char text[32];
+
+    canvas_set_font(canvas, FontSecondary);
+    if(my_model->device_listed == 0) {
+        canvas_draw_str(canvas, 1, 8, "No LoRaWAN devices yet");
+        return;
+    }
 
-    canvas_draw_str(canvas, 1, 10, (const char*)receiveBuff);
+    snprintf(
+        text,
+        sizeof(text),
+        "Devices %u/%u",
+        my_model->device_selected + 1,
+        my_model->device_listed);
+    canvas_draw_str(canvas, 1, 8, text);
+    snprintf(text, sizeof(text), "by %s", lora_devices_sort_name(my_model->device_sort));
+    canvas_draw_str_aligned(canvas, 127, 8, AlignRight, AlignBottom, text);
+
+    size_t selected = my_model->device_selected;
+    size_t first = selected - selected % LORA_SNIFFER_DEVICE_ROWS;
+    for(size_t row = 0; row < LORA_SNIFFER_DEVICE_ROWS; row++) {
+        if(first + row >= my_model->device_listed) {
+            break;
+        }
+        const LoRaDevice* device = &devices->devices[my_model->device_order[first + row]];
+        uint32_t expected = device->uplinks + device->fcnt_lost;
+        snprintf(
+            text,
+            sizeof(text),
+            "%08lX %4lu %4d %3lu%%",
+            device->dev_addr,
+            device->uplinks,
+            lora_devices_rssi_average(device),
+            expected ? device->fcnt_lost * 100 / expected : 0);
+
+        uint8_t y = 17 + row * 9;
+        if(first + row == selected) {
+            canvas_draw_box(canvas, 0, y - 8, 128, 9);
+            canvas_set_color(canvas, ColorWhite);
+            canvas_draw_str(canvas, 1, y, text);
+            canvas_set_color(canvas, ColorBlack);
+        } else {
+            canvas_draw_str(canvas, 1, y, text);
+        }
+    }
 
-    furi_string_printf(xstr, "RSSI: %d  ", getRSSI());
-    canvas_draw_str(canvas, 1, 19, furi_string_get_cstr(xstr));
+    // Age, most used spreading factor, channels and downlinks of the selected device
+    const LoRaDevice* device = &devices->devices[my_model->device_order[selected]];
+    uint8_t sf = 0;
+    uint16_t sf_uplinks = 0;
+    for(uint8_t i = 0; i < 8; i++) {
+        if(device->sf_uplinks[i] > sf_uplinks) {
+            sf_uplinks = device->sf_uplinks[i];
+            sf = i + 5;
+        }
+    }
+    uint8_t channels = 0;
+    for(uint8_t i = 0; i < LORA_DEVICES_CHANNELS; i++) {
+        channels += device->channel_uplinks[i] > 0;
+    }
+    snprintf(
+        text,
+        sizeof(text),
+        "%lus ago SF%u %u%sch Dn %lu",
+        (furi_get_tick() - device->last_seen) / furi_kernel_get_tick_frequency(),
+        sf,
+        channels,
+        device->channel_other ? "+" : "",
+        device->downlinks);
+    canvas_draw_str(canvas, 1, 62, text);
+}
 
-    furi_string_printf(xstr, "BW:%s", config_bw_names[my_model->config_bw_index]);
-    canvas_draw_str(canvas, 1, 28, furi_string_get_cstr(xstr));
+/**
+ * @brief      Stream, log and queue for the history a packet the sniffer job received.
+ * @param      app        The LoRa application object.
+ * @param      my_model   The sniffer model.
+ * @param      packet     Scratch space for the packet queued for the history.
+ * @param      bytesRead  Bytes of the packet in receiveBuff.
+*/
+static void lora_sniffer_job_handle_packet(
+    LoRaApp* app,
+    LoRaSnifferModel* my_model,
+    LoRaSnifferPacket* packet,
+    int bytesRead) {
+    FURI_LOG_D(TAG, "Packet received, %d bytes", bytesRead);
+
+    // A full queue only costs the history this packet, it is still streamed and logged
+    packet->entry = (LoRaHistoryEntry){
+        .tick = furi_get_tick(),
+        .frequency = getFrequency(),
+        .rssi = getRSSI(),
+        .snr = getSNR(),
+        .sf = config_sf_values[my_model->config_sf_index],
+    };
+    packet->length = bytesRead;
+    memcpy(packet->payload, receiveBuff, bytesRead);
+    furi_message_queue_put(app->sniffer.packets, packet, 0);
+
+    if(my_model->stream) {
+        LoRaFrameMeta meta = {
+            .timestamp = furi_hal_rtc_get_timestamp(),
+            .tick = furi_get_tick(),
+            .frequency = getFrequency(),
+            .bw = config_bw_values[my_model->config_bw_index],
+            .sf = config_sf_values[my_model->config_sf_index],
+            .cr = config_cr_values[my_model->config_cr_index],
+            .snr = getSNR(),
+            .rssi = getRSSI(),
+        };
+        lora_stream_send(my_model->stream, &meta, receiveBuff, bytesRead);
+    }
 
-    furi_string_printf(xstr, "FQ:%s MHz", furi_string_get_cstr(my_model->config_freq_name));
-    canvas_draw_str(canvas, 60, 28, furi_string_get_cstr(xstr));
+    furi_mutex_acquire(app->sniffer.log_mutex, FURI_WAIT_FOREVER);
+    if(my_model->flag_file) {
+        DateTime curr_dt;
+        furi_hal_rtc_get_datetime(&curr_dt);
+
+        LoRaRecordPacket record = {
+            .year = curr_dt.year,
+            .month = curr_dt.month,
+            .day = curr_dt.day,
+            .hour = curr_dt.hour,
+            .minute = curr_dt.minute,
+            .second = curr_dt.second,
+            .frequency = furi_string_get_cstr(my_model->config_freq_name),
+            .bw = config_bw_names[my_model->config_bw_index],
+            .sf = config_sf_names[my_model->config_sf_index],
+            .rssi = getRSSI(),
+            .payload = receiveBuff,
+            .payload_len = bytesRead,
+        };
+        LoRaWANFrame frame;
+        if(lora_lorawan_decode(receiveBuff, bytesRead, &frame)) {
+            record.lorawan = &frame;
+        }
 
-    furi_string_free(xstr);
+        LORA_PERF_BEGIN(perf_log);
+        size_t length = lora_record_format(&record, app->sniffer.line, sizeof(app->sniffer.line));
+        storage_file_write(my_model->file_rx, app->sniffer.line, length);
+        LORA_PERF_END(LoRaPerfProbeLogWrite, perf_log);
+    }
+    furi_mutex_release(app->sniffer.log_mutex);
+}
+
+/**
+ * @brief      Thread receiving packets while the sniffer screen is shown.
+ * @details    DIO1 has no interrupt (see lora_hal_init), so it is read every
+ *           LORA_SNIFFER_POLL_MS.  The job sleeps on its thread flags in between, a stop request
+ *           wakes it at once.
+ *           Redraws are asked with LoRaEventIdSnifferUpdate when something changed, at most
+ *           once per LORA_SNIFFER_REDRAW_MIN_MS so a burst of packets does not redraw for each.
+ * @param      context  The context - LoRaApp object.
+ * @return     0
+*/
+static int32_t lora_sniffer_job_worker(void* context) {
+    LoRaApp* app = (LoRaApp*)context;
+    LoRaSnifferModel* my_model = view_get_model(app->view_sniffer);
+    LoRaSnifferPacket* packet = malloc(sizeof(LoRaSnifferPacket));
+    uint32_t redraw_min = furi_ms_to_ticks(LORA_SNIFFER_REDRAW_MIN_MS);
+    uint32_t last_event_tick = furi_get_tick() - redraw_min;
+    bool pending = true; // Something changed since the last redraw
+
+    while(!(furi_thread_flags_get() & LoRaSnifferFlagStop)) {
+        // Bring the radio back if it stopped answering, the log stays open meanwhile
+        uint32_t outage_ms;
+        if(radioWatchdog(&outage_ms)) {
+            furi_mutex_acquire(app->sniffer.log_mutex, FURI_WAIT_FOREVER);
+            if(my_model->flag_file) {
+                lora_sniffer_log_recovery(my_model, outage_ms);
+            }
+            furi_mutex_release(app->sniffer.log_mutex);
+            pending = true;
+        }
+
+        int bytesRead = lora_receive_async(receiveBuff, sizeof(receiveBuff));
+        if(bytesRead > -1) {
+            lora_sniffer_job_handle_packet(app, my_model, packet, bytesRead);
+            pending = true;
+        }
+
+        uint32_t since = furi_get_tick() - last_event_tick;
+        // Packet and device ages change without new packets
+        if((my_model->screen == LoRaSnifferScreenDetail ||
+            my_model->screen == LoRaSnifferScreenDevices) &&
+           since >= furi_ms_to_ticks(LORA_SNIFFER_REDRAW_IDLE_MS)) {
+            pending = true;
+        }
+        if(pending && since >= redraw_min) {
+            view_dispatcher_send_custom_event(app->view_dispatcher, LoRaEventIdSnifferUpdate);
+            last_event_tick += since;
+            pending = false;
+            since = 0;
+        }
+
+        if(bytesRead < 0) {
+            // Nothing received, look at DIO1 again after a short sleep
+            furi_thread_flags_wait(
+                LoRaSnifferFlagStop,
+                FuriFlagWaitAny | FuriFlagNoClear,
+                furi_ms_to_ticks(LORA_SNIFFER_POLL_MS));
+        }
+    }
+
+    free(packet);
+    return 0;
+}
+
+/**
+ * @brief      Move the packets received by the sniffer job into the history and the device
+ *           table.
+ * @details    Runs on the GUI thread, the only one changing what the sniffer screen draws.
+ * @param      app       The LoRa application object.
+ * @param      my_model  The sniffer model.
+*/
+static void lora_sniffer_job_collect(LoRaApp* app, LoRaSnifferModel* my_model) {
+    LoRaSnifferPacket* packet = malloc(sizeof(LoRaSnifferPacket));
+    LoRaWANFrame frame;
+    while(furi_message_queue_get(app->sniffer.packets, packet, 0) == FuriStatusOk) {
+        lora_history_push(&my_model->history, &packet->entry, packet->payload, packet->length);
+        if(lora_lorawan_decode(packet->payload, packet->length, &frame)) {
+            lora_devices_update(&my_model->devices, &frame, &packet->entry);
+        }
+    }
+    free(packet);
+    if(my_model->screen == LoRaSnifferScreenDevices) {
+        lora_sniffer_devices_sort(my_model);
+    }
+
+    my_model->radio_outages = getRadioOutages();
+    my_model->radio_recovery_ms = getRadioRecoveryMs();
+    my_model->stream_dropped = my_model->stream ? lora_stream_get_dropped(my_model->stream) : 0;
+}
+
+/**
+ * @brief      Start receiving in the background.
+ * @param      app  The LoRa application object.
+*/
+static void lora_sniffer_job_start(LoRaApp* app) {
+    LoRaSnifferJob* job = &app->sniffer;
+    furi_assert(job->thread == NULL);
+    job->thread = furi_thread_alloc_ex("LoRaSniffer", 3 * 1024, lora_sniffer_job_worker, app);
+    furi_thread_start(job->thread);
+}
+
+/**
+ * @brief      Stop receiving and wait for the sniffer job to end.
+ * @param      app  The LoRa application object.
+*/
+static void lora_sniffer_job_stop(LoRaApp* app) {
+    LoRaSnifferJob* job = &app->sniffer;
+    if(!job->thread) {
+        return;
+    }
+    furi_thread_flags_set(furi_thread_get_id(job->thread), LoRaSnifferFlagStop);
+    furi_thread_join(job->thread);
+    furi_thread_free(job->thread);
+    job->thread = NULL;
+}
+
+/**
+ * @brief      Callback for drawing the sniffer screen.
+ * @details    Only draws the model, packets reach it through LoRaEventIdSnifferUpdate.
+ * @param      canvas  The canvas to draw on.
+ * @param      model   The model - LoRaSnifferModel object.
+*/
+static void lora_view_sniffer_draw_callback(Canvas* canvas, void* model) {
+    LoRaSnifferModel* my_model = (LoRaSnifferModel*)model;
+    LORA_PERF_BEGIN(perf_draw);
+
+    switch(my_model->screen) {
+    case LoRaSnifferScreenLive:
+        lora_sniffer_draw_live(canvas, my_model);
+        break;
+    case LoRaSnifferScreenHistory:
+        lora_sniffer_draw_history(canvas, my_model);
+        break;
+    case LoRaSnifferScreenDetail:
+        lora_sniffer_draw_detail(canvas, my_model);
+        break;
+    case LoRaSnifferScreenDevices:
+        lora_sniffer_draw_devices(canvas, my_model);
+        break;
+    }
+    LORA_PERF_END(LoRaPerfProbeSnifferDraw, perf_draw);
 }
 
 /**
@@ -1572,28 +2167,376 @@ static void lora_view_sniffer_draw_callback(Canvas* canvas, void* model) {
 */
 static void lora_view_transmitter_draw_callback(Canvas* canvas, void* model) {
     LoRaTransmitterModel* my_model = (LoRaTransmitterModel*)model;
+    const LoRaReplayStatus* status = &my_model->status;
+    LORA_PERF_BEGIN(perf);
 
     my_model->x = 0;
 
     canvas_draw_icon(canvas, 1, 3, &I_kitty_tx);
 
-    canvas_draw_str(canvas, 1, 10, "Press central");
-    canvas_draw_str(canvas, 1, 20, "button to");
-    canvas_draw_str(canvas, 1, 30, "browser");
-
     FuriString* xstr = furi_string_alloc();
-    canvas_draw_str(canvas, 1, 50, furi_string_get_cstr(xstr));
+
+    if(status->state == LoRaReplayStateRunning || status->state == LoRaReplayStatePaused) {
+        furi_string_printf(xstr, "Sent %lu pk %lu B", status->packets, status->bytes);
+        canvas_draw_str(canvas, 1, 10, furi_string_get_cstr(xstr));
+
+        uint32_t elapsed_s = status->elapsed_ms / 1000;
+        uint32_t rate = elapsed_s ? status->bytes / elapsed_s : 0;
+        furi_string_printf(xstr, "%lu B/s %lu mJ", rate, status->energy_mj);
+        canvas_draw_str(canvas, 1, 20, furi_string_get_cstr(xstr));
+
+        // Estimate the remaining time from how fast the log has been consumed so far
+        if(status->file_pos > 0 && status->file_size > status->file_pos) {
+            uint32_t eta_s = (uint32_t)((uint64_t)(status->file_size - status->file_pos) *
+                                        status->elapsed_ms / status->file_pos / 1000);
+            furi_string_printf(xstr, "ETA %lu:%02lu", eta_s / 60, eta_s % 60);
+            canvas_draw_str(canvas, 1, 30, furi_string_get_cstr(xstr));
+        }
+
+        canvas_draw_str(
+            canvas, 1, 62, status->state == LoRaReplayStatePaused ? "OK resume" : "OK pause");
+    } else {
+        canvas_draw_str(canvas, 1, 10, "Press central");
+        canvas_draw_str(canvas, 1, 20, "button to");
+        canvas_draw_str(canvas, 1, 30, "browser");
+
+        if(status->state == LoRaReplayStateDone || status->state == LoRaReplayStateCancelled) {
+            furi_string_printf(
+                xstr,
+                "%s %lu pk",
+                status->state == LoRaReplayStateDone ? "Done" : "Stopped",
+                status->packets);
+            canvas_draw_str(canvas, 1, 62, furi_string_get_cstr(xstr));
+        }
+    }
+
+    furi_string_printf(xstr, "< Speed: %s >", replay_speed_names[my_model->replay_speed_index]);
+    canvas_draw_str(canvas, 1, 42, furi_string_get_cstr(xstr));
+
+    if(status->packets > 0) {
+        furi_string_printf(xstr, "Jit %lu/%lu ms", status->jitter_avg_ms, status->jitter_max_ms);
+        canvas_draw_str(canvas, 1, 52, furi_string_get_cstr(xstr));
+    }
     furi_string_free(xstr);
+    LORA_PERF_END(LoRaPerfProbeTransmitterDraw, perf);
 }
 
 /**
- * @brief      Callback for timer elapsed.
- * @details    This function is called when the timer is elapsed.  We use this to queue a redraw event.
- * @param      context  The context - LoRaApp object.
+ * @brief      Send a progress event to the transmitter view.
+ * @details    Events are rate limited so a fast replay doesn't flood the view dispatcher queue.
+ * @param      app    The LoRa application object.
+ * @param      force  Send even if the last event was sent recently.
+*/
+static void lora_replay_job_notify(LoRaApp* app, bool force) {
+    LoRaReplayJob* job = &app->replay;
+    uint32_t now = furi_get_tick();
+    if(force || now - job->last_event_tick >= furi_ms_to_ticks(200)) {
+        job->last_event_tick = now;
+        job->status.jitter_avg_ms = lora_replay_scheduler_jitter_avg(&job->scheduler);
+        job->status.jitter_max_ms = job->scheduler.jitter_max_ms;
+
+        // The view copies the published status, never the one this thread keeps writing
+        furi_mutex_acquire(job->status_mutex, FURI_WAIT_FOREVER);
+        job->published = job->status;
+        furi_mutex_release(job->status_mutex);
+
+        view_dispatcher_send_custom_event(app->view_dispatcher, LoRaEventIdReplayProgress);
+    }
+}
+
+/**
+ * @brief      Sleep on the replay thread while honouring pause and cancel requests.
+ * @details    Time spent paused is added to the replay timeline so the remaining packets keep
+ *            their spacing.
+ * @param      app      The LoRa application object.
+ * @param      wait_ms  How long to wait, 0 just checks for pending requests.
+ * @return     false if the job was cancelled.
+*/
+static bool lora_replay_job_wait(LoRaApp* app, uint32_t wait_ms) {
+    LoRaReplayJob* job = &app->replay;
+    uint32_t deadline = furi_get_tick() + wait_ms;
+
+    while(true) {
+        int32_t remaining = (int32_t)(deadline - furi_get_tick());
+        uint32_t flags = furi_thread_flags_wait(
+            LoRaReplayFlagPause | LoRaReplayFlagCancel,
+            FuriFlagWaitAny,
+            remaining > 0 ? (uint32_t)remaining : 0);
+
+        if(flags & FuriFlagError) {
+            return true; // Nothing requested before the deadline
+        }
+        if(flags & LoRaReplayFlagCancel) {
+            return false;
+        }
+
+        // Paused, wait for the next toggle
+        uint32_t paused_at = furi_get_tick();
+        job->status.state = LoRaReplayStatePaused;
+        lora_replay_job_notify(app, true);
+
+        flags = furi_thread_flags_wait(
+            LoRaReplayFlagPause | LoRaReplayFlagCancel, FuriFlagWaitAny, FURI_WAIT_FOREVER);
+        if(flags & LoRaReplayFlagCancel) {
+            return false;
+        }
+
+        uint32_t paused_ms = furi_get_tick() - paused_at;
+        job->scheduler.origin_end_ms += paused_ms;
+        job->scheduler.last_end_ms += paused_ms;
+        job->paused_ms += paused_ms;
+        deadline += paused_ms;
+        job->status.state = LoRaReplayStateRunning;
+        lora_replay_job_notify(app, true);
+    }
+}
+
+/**
+ * @brief      Replay one capture log line.
+ * @details    The payload is sent when the replay scheduler says so, which reproduces the gap
+ *            to the previous packet from the capture timestamps (scaled by the replay speed).
+ * @param      app     The LoRa application object.
+ * @param      line    The log line.
+ * @param      length  Number of characters in line.
+ * @return     false if the job was cancelled while waiting for the packet's turn.
+*/
+bool tx_payload(LoRaApp* app, const char* line, size_t length) {
+    LoRaReplayJob* job = &app->replay;
+    LoRaRecord record;
+    if(!lora_record_parse(line, length, &record)) {
+        return true;
+    }
+
+    uint8_t bytes[255];
+
+    // Convert hex string to bytes straight from the line, no copy needed
+    int32_t byte_length =
+        lora_hex_decode(record.payload.ptr, record.payload.len, bytes, sizeof(bytes));
+    if(byte_length < 0) {
+        FURI_LOG_E(TAG, "Invalid payload: %.*s", (int)record.payload.len, record.payload.ptr);
+        return true;
+    }
+
+    byte_length = lora_transform_apply(&job->transforms, bytes, byte_length);
+
+    // Lines without a usable timestamp are sent right after the previous packet
+    lora_record_get_timestamp(&record, &job->last_capture_s);
+
+    // Retune to the channel the packet was captured on, lines without one use the current channel
+    uint32_t frequency;
+    uint8_t sf;
+    if(lora_record_get_frequency(&record, &frequency) &&
+       lora_record_get_spreading_factor(&record, &sf)) {
+        for(size_t i = 0; i < COUNT_OF(config_bw_names); i++) {
+            if(lora_record_field_equals(&record.bw, config_bw_names[i])) {
+                configSetChannel(frequency, config_bw_values[i], sf);
+                break;
+            }
+        }
+    }
+
+    uint32_t airtime_ms = getTimeOnAir(byte_length);
+    uint32_t start_ms = lora_replay_scheduler_next(
+        &job->scheduler, job->last_capture_s, airtime_ms, furi_get_tick());
+
+    int32_t wait_ms = (int32_t)(start_ms - furi_get_tick());
+    if(!lora_replay_job_wait(app, wait_ms > 0 ? (uint32_t)wait_ms : 0)) {
+        return false;
+    }
+
+    start_ms = furi_get_tick();
+    transmit(bytes, byte_length);
+    lora_replay_scheduler_done(&job->scheduler, start_ms, furi_get_tick(), airtime_ms);
+
+    job->status.packets++;
+    job->status.bytes += byte_length;
+    job->energy_uj += getTxEnergy(airtime_ms);
+    job->status.energy_mj = job->energy_uj / 1000;
+    return true;
+}
+
+/**
+ * @brief      Replay job thread.
+ * @details    Reads the log in chunks, splits it into lines and replays them one by one.  A line
+ *            longer than any the sniffer writes is skipped whole, up to its '\n'.
+ * @param      context  The LoRa application object.
+ * @return     0
+*/
+static int32_t lora_replay_job_worker(void* context) {
+    LoRaApp* app = (LoRaApp*)context;
+    LoRaReplayJob* job = &app->replay;
+
+    char chunk[64];
+    size_t line_length = 0;
+    bool too_long = false;
+    size_t chunk_length;
+    bool running = true;
+
+    while(running && (chunk_length = storage_file_read(job->file, chunk, sizeof(chunk))) > 0) {
+        for(size_t i = 0; i < chunk_length && running; i++) {
+            if(chunk[i] == '\n') {
+                if(too_long) {
+                    FURI_LOG_W(TAG, "Skipping a line longer than %u", (unsigned)sizeof(job->line));
+                } else {
+                    running = tx_payload(app, job->line, line_length);
+                }
+                line_length = 0;
+                too_long = false;
+
+                job->status.elapsed_ms = furi_get_tick() - job->started_tick - job->paused_ms;
+                lora_replay_job_notify(app, false);
+            } else if(line_length < sizeof(job->line)) {
+                job->line[line_length++] = chunk[i];
+            } else {
+                too_long = true;
+            }
+        }
+        job->status.file_pos += chunk_length;
+    }
+
+    // The last line might not end with a newline
+    if(running && line_length > 0 && !too_long) {
+        running = tx_payload(app, job->line, line_length);
+    }
+
+    FURI_LOG_I(
+        TAG,
+        "Replayed %lu packets, jitter avg %lu ms max %lu ms",
+        job->status.packets,
+        lora_replay_scheduler_jitter_avg(&job->scheduler),
+        job->scheduler.jitter_max_ms);
+
+    job->status.state = running ? LoRaReplayStateDone : LoRaReplayStateCancelled;
+    lora_replay_job_notify(app, true);
+    view_dispatcher_send_custom_event(app->view_dispatcher, LoRaEventIdReplayDone);
+    return 0;
+}
+
+/**
+ * @brief      Load the payload transforms for the next replay.
+ * @details    The file is optional, without it payloads are replayed untouched.  Malformed lines
+ *            are logged and skipped.
+ * @param      app      The LoRa application object.
+ * @param      storage  The storage record to open the file with.
+*/
+static void lora_replay_job_load_transforms(LoRaApp* app, Storage* storage) {
+    LoRaTransformPipeline* transforms = &app->replay.transforms;
+    lora_transform_clear(transforms);
+
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, PATHTRANSFORM, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        char chunk[64];
+        char line[MAX_LINE_LENGTH];
+        size_t line_length = 0;
+        uint32_t line_number = 1;
+        size_t chunk_length;
+
+        while((chunk_length = storage_file_read(file, chunk, sizeof(chunk))) > 0) {
+            for(size_t i = 0; i < chunk_length; i++) {
+                if(chunk[i] == '\n' || line_length >= sizeof(line) - 1) {
+                    if(!lora_transform_parse_line(transforms, line, line_length)) {
+                        FURI_LOG_W(TAG, "Ignoring transform line %lu", line_number);
+                    }
+                    line_length = 0;
+                    line_number++;
+                } else {
+                    line[line_length++] = chunk[i];
+                }
+            }
+        }
+
+        // The last line might not end with a newline
+        if(line_length > 0 && !lora_transform_parse_line(transforms, line, line_length)) {
+            FURI_LOG_W(TAG, "Ignoring transform line %lu", line_number);
+        }
+        FURI_LOG_I(TAG, "Loaded %u payload transforms", transforms->count);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+}
+
+/**
+ * @brief      Ask the user for a log file and start replaying it in the background.
+ * @param      app  The LoRa application object.
+*/
+static void lora_replay_job_start(LoRaApp* app) {
+    LoRaReplayJob* job = &app->replay;
+    LoRaTransmitterModel* model = view_get_model(app->view_transmitter);
+
+    if(job->thread) {
+        return; // Already replaying
+    }
+
+    FuriString* predefined_filepath = furi_string_alloc_set_str(PATHAPP);
+    FuriString* selected_filepath = furi_string_alloc();
+    DialogsFileBrowserOptions browser_options;
+    dialog_file_browser_set_basic_options(&browser_options, LORA_LOG_FILE_EXTENSION, NULL);
+    browser_options.base_path = PATHAPP;
+
+    if(dialog_file_browser_show(
+           model->dialogs_tx, selected_filepath, predefined_filepath, &browser_options)) {
+        if(storage_file_open(
+               model->file_tx,
+               furi_string_get_cstr(selected_filepath),
+               FSAM_READ,
+               FSOM_OPEN_EXISTING)) {
+            memset(&job->status, 0, sizeof(job->status));
+            job->status.state = LoRaReplayStateRunning;
+            job->status.file_size = storage_file_size(model->file_tx);
+            job->file = model->file_tx;
+            job->speed_percent = replay_speed_values[model->replay_speed_index];
+            job->last_capture_s = 0;
+            job->last_event_tick = 0;
+            job->started_tick = furi_get_tick();
+            job->paused_ms = 0;
+            job->energy_uj = 0;
+            lora_replay_scheduler_reset(&job->scheduler, job->speed_percent);
+            lora_replay_job_load_transforms(app, model->storage_tx);
+
+            // No job thread yet, nothing else touches the status
+            job->published = job->status;
+            model->status = job->status;
+
+            job->thread =
+                furi_thread_alloc_ex("LoRaReplay", 3 * 1024, lora_replay_job_worker, app);
+            furi_thread_start(job->thread);
+        } else {
+            dialog_message_show_storage_error(model->dialogs_tx, "Cannot open File");
+            storage_file_close(model->file_tx);
+        }
+    }
+
+    furi_string_free(selected_filepath);
+    furi_string_free(predefined_filepath);
+}
+
+/**
+ * @brief      Wait for the replay thread to end and release the log file.
+ * @param      app     The LoRa application object.
+ * @param      cancel  Ask the job to stop first.
 */
-static void lora_view_sniffer_timer_callback(void* context) {
-    LoRaApp* app = (LoRaApp*)context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, LoRaEventIdRedrawScreen);
+static void lora_replay_job_stop(LoRaApp* app, bool cancel) {
+    LoRaReplayJob* job = &app->replay;
+    if(!job->thread) {
+        return;
+    }
+
+    if(cancel) {
+        furi_thread_flags_set(furi_thread_get_id(job->thread), LoRaReplayFlagCancel);
+    }
+    furi_thread_join(job->thread);
+    furi_thread_free(job->thread);
+    job->thread = NULL;
+
+    storage_file_close(job->file);
+    job->file = NULL;
+
+    // The replay may have retuned the radio, go back to the configured channel
+    LoRaSnifferModel* model = view_get_model(app->view_sniffer);
+    configSetChannel(
+        app->config_frequency,
+        config_bw_values[model->config_bw_index],
+        config_sf_values[model->config_sf_index]);
 }
 
 /**
@@ -1609,17 +2552,13 @@ static void lora_view_transmitter_timer_callback(void* context) {
 
 /**
  * @brief      Callback when the user starts the sniffer screen.
- * @details    This function is called when the user enters the sniffer screen.  We start a timer to
- *           redraw the screen periodically (so the random number is refreshed).
+ * @details    This function is called when the user enters the sniffer screen.  We start the
+ *           sniffer job, it asks for a redraw whenever a packet arrives.
  * @param      context  The context - LoRaApp object.
 */
 static void lora_view_sniffer_enter_callback(void* context) {
-    uint32_t period = furi_ms_to_ticks(1000);
     LoRaApp* app = (LoRaApp*)context;
-    furi_assert(app->timer_rx == NULL);
-    app->timer_rx =
-        furi_timer_alloc(lora_view_sniffer_timer_callback, FuriTimerTypePeriodic, context);
-    furi_timer_start(app->timer_rx, period);
+    lora_sniffer_job_start(app);
 }
 
 /**
@@ -1639,15 +2578,13 @@ static void lora_view_transmitter_enter_callback(void* context) {
 
 /**
  * @brief      Callback when the user exits the sniffer screen.
- * @details    This function is called when the user exits the sniffer screen.  We stop the timer.
+ * @details    This function is called when the user exits the sniffer screen.  We stop the
+ *           sniffer job.
  * @param      context  The context - LoRaApp object.
 */
 static void lora_view_sniffer_exit_callback(void* context) {
     LoRaApp* app = (LoRaApp*)context;
-    furi_timer_stop(app->timer_rx);
-    furi_timer_free(app->timer_rx);
-    app->timer_rx = NULL;
-    FURI_LOG_E(TAG, "Stop timer rx");
+    lora_sniffer_job_stop(app);
 }
 
 /**
@@ -1657,6 +2594,7 @@ static void lora_view_sniffer_exit_callback(void* context) {
 */
 static void lora_view_transmitter_exit_callback(void* context) {
     LoRaApp* app = (LoRaApp*)context;
+    lora_replay_job_stop(app, true);
     furi_timer_stop(app->timer_tx);
     furi_timer_free(app->timer_tx);
     app->timer_tx = NULL;
@@ -1680,6 +2618,17 @@ static bool lora_view_sniffer_custom_event_callback(uint32_t event, void* contex
                 app->view_sniffer, LoRaSnifferModel * _model, { UNUSED(_model); }, redraw);
             return true;
         }
+    case LoRaEventIdSnifferUpdate:
+        // Only this event changes what the sniffer screen shows about received packets
+        {
+            bool redraw = true;
+            with_view_model(
+                app->view_sniffer,
+                LoRaSnifferModel * model,
+                { lora_sniffer_job_collect(app, model); },
+                redraw);
+            return true;
+        }
     case LoRaEventIdOkPressed:
         // Process the OK button.  We play a tone based on the x coordinate.
         if(furi_hal_speaker_acquire(500)) {
@@ -1718,6 +2667,27 @@ static bool lora_view_transmitter_custom_event_callback(uint32_t event, void* co
                 app->view_transmitter, LoRaTransmitterModel * _model, { UNUSED(_model); }, redraw);
             return true;
         }
+    case LoRaEventIdReplayStart:
+        lora_replay_job_start(app);
+        return true;
+    case LoRaEventIdReplayProgress:
+        // Only this event updates the job status shown by the view
+        {
+            bool redraw = true;
+            with_view_model(
+                app->view_transmitter,
+                LoRaTransmitterModel * model,
+                {
+                    furi_mutex_acquire(app->replay.status_mutex, FURI_WAIT_FOREVER);
+                    model->status = app->replay.published;
+                    furi_mutex_release(app->replay.status_mutex);
+                },
+                redraw);
+            return true;
+        }
+    case LoRaEventIdReplayDone:
+        lora_replay_job_stop(app, false);
+        return true;
     case LoRaEventIdOkPressed:
         // Process the OK button.  We play a tone based on the x coordinate.
         if(furi_hal_speaker_acquire(500)) {
@@ -1748,6 +2718,83 @@ static bool lora_view_transmitter_custom_event_callback(uint32_t event, void* co
 */
 static bool lora_view_sniffer_input_callback(InputEvent* event, void* context) {
     LoRaApp* app = (LoRaApp*)context;
+    LoRaSnifferModel* sniffer = view_get_model(app->view_sniffer);
+
+    if((event->type == InputTypeShort || event->type == InputTypeRepeat) &&
+       (event->key == InputKeyUp || event->key == InputKeyDown)) {
+        bool redraw = true;
+        with_view_model(
+            app->view_sniffer,
+            LoRaSnifferModel * model,
+            { lora_sniffer_history_move(model, event->key == InputKeyUp); },
+            redraw);
+        return true;
+    }
+
+    if(event->type == InputTypeShort && event->key == InputKeyBack &&
+       sniffer->screen != LoRaSnifferScreenLive) {
+        // Back steps out of the detail and history screens before leaving the sniffer
+        bool redraw = true;
+        with_view_model(
+            app->view_sniffer,
+            LoRaSnifferModel * model,
+            {
+                model->screen = model->screen == LoRaSnifferScreenDetail ?
+                                    LoRaSnifferScreenHistory :
+                                    LoRaSnifferScreenLive;
+            },
+            redraw);
+        return true;
+    }
+
+    if(event->type == InputTypeShort && event->key == InputKeyRight &&
+       sniffer->screen == LoRaSnifferScreenLive) {
+        // Right opens the device list, ordered from the most recently seen device
+        bool redraw = true;
+        with_view_model(
+            app->view_sniffer,
+            LoRaSnifferModel * model,
+            {
+                model->screen = LoRaSnifferScreenDevices;
+                model->device_sort = LoRaDevicesSortRecent;
+                model->device_selected = 0;
+                lora_sniffer_devices_sort(model);
+            },
+            redraw);
+        return true;
+    }
+
+    if(event->type == InputTypePress && event->key == InputKeyOk &&
+       sniffer->screen == LoRaSnifferScreenDevices) {
+        // OK changes the order of the device list
+        bool redraw = true;
+        with_view_model(
+            app->view_sniffer,
+            LoRaSnifferModel * model,
+            {
+                model->device_sort = (model->device_sort + 1) % LoRaDevicesSortCount;
+                model->device_selected = 0;
+                lora_sniffer_devices_sort(model);
+            },
+            redraw);
+        return true;
+    }
+
+    if(event->type == InputTypePress && event->key == InputKeyOk &&
+       sniffer->screen != LoRaSnifferScreenLive) {
+        // OK opens the selected packet, recording is only started from the live screen
+        bool redraw = true;
+        with_view_model(
+            app->view_sniffer,
+            LoRaSnifferModel * model,
+            {
+                model->screen = LoRaSnifferScreenDetail;
+                model->detail_scroll = 0;
+            },
+            redraw);
+        return true;
+    }
+
     if(event->type == InputTypeShort) {
         if(event->key == InputKeyLeft) {
             // Left button clicked, reduce x coordinate.
@@ -1779,6 +2826,8 @@ static bool lora_view_sniffer_input_callback(InputEvent* event, void* context) {
             // handle our LoRaEventIdOkPressed event.  We could have just put the code from
             // lora_custom_event_callback here, it's a matter of preference.
 
+            // The sniffer job writes the log, wait for it to finish the current line
+            furi_mutex_acquire(app->sniffer.log_mutex, FURI_WAIT_FOREVER);
             bool redraw = true;
             with_view_model(
                 app->view_sniffer,
@@ -1804,9 +2853,10 @@ static bool lora_view_sniffer_input_callback(InputEvent* event, void* context) {
                         if(!storage_file_open(
                                model->file_rx, filename, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
                             FURI_LOG_E(TAG, "Failed to open file %s", filename);
-                            return 0;
+                            model->flag_file = false;
+                        } else {
+                            FURI_LOG_E(TAG, "OPEN FILE ");
                         }
-                        FURI_LOG_E(TAG, "OPEN FILE ");
 
                     } else {
                         storage_file_close(model->file_rx);
@@ -1814,6 +2864,7 @@ static bool lora_view_sniffer_input_callback(InputEvent* event, void* context) {
                     }
                 },
                 redraw);
+            furi_mutex_release(app->sniffer.log_mutex);
 
             view_dispatcher_send_custom_event(app->view_dispatcher, LoRaEventIdOkPressed);
             return true;
@@ -1823,89 +2874,6 @@ static bool lora_view_sniffer_input_callback(InputEvent* event, void* context) {
     return false;
 }
 
-void tx_payload(const char* line) {
-    const char* key = "\"payload\":\"";
-    char* start = strstr(line, key);
-    if(start) {
-        start += strlen(key); // Advance the pointer to the end of “payload”:
-        char* end = strchr(start, '"'); // find next "
-        if(end) {
-            // Calculates the length of the substring
-            size_t length = end - start;
-            char payload[length + 1]; // +1 to end in NULL
-            strncpy(payload, start, length);
-            payload[length] = '\0'; // adds the NULL
-
-            FURI_LOG_E(TAG, "%s\n", payload);
-
-            size_t byte_length = length / 2;
-            uint8_t bytes[byte_length];
-
-            // Convert hex string to bytes
-            asciiHexToBytes(payload, bytes, byte_length);
-
-            FURI_LOG_E(TAG, "%s\n", payload);
-            transmit(bytes, byte_length);
-            furi_delay_ms(10);
-        }
-    }
-}
-
-void send_data(void* context) {
-    LoRaApp* app = (LoRaApp*)context;
-    LoRaTransmitterModel* model = view_get_model(app->view_transmitter);
-
-    //uint8_t transmitBuff[64];
-    FuriString* predefined_filepath = furi_string_alloc_set_str(PATHAPP);
-    FuriString* selected_filepath = furi_string_alloc();
-    DialogsFileBrowserOptions browser_options;
-    dialog_file_browser_set_basic_options(&browser_options, LORA_LOG_FILE_EXTENSION, NULL);
-    browser_options.base_path = PATHAPP;
-
-    dialog_file_browser_show(
-        model->dialogs_tx, selected_filepath, predefined_filepath, &browser_options);
-
-    if(storage_file_open(
-           model->file_tx,
-           furi_string_get_cstr(selected_filepath),
-           FSAM_READ,
-           FSOM_OPEN_EXISTING)) {
-        model->flag_tx_file = true;
-        model->test = 1;
-
-        char buffer[256];
-        size_t buffer_index = 0;
-        size_t bytes_read;
-        char c;
-
-        while((bytes_read = storage_file_read(model->file_tx, &c, 1)) > 0 && model->flag_signal) {
-            if(c == '\n' || buffer_index >= 256 - 1) {
-                buffer[buffer_index] = '\0';
-
-                FURI_LOG_E(TAG, "%s\n", buffer);
-
-                tx_payload(buffer);
-                buffer_index = 0;
-            } else {
-                buffer[buffer_index++] = c;
-            }
-        }
-
-    } else {
-        dialog_message_show_storage_error(model->dialogs_tx, "Cannot open File");
-    }
-    storage_file_close(model->file_tx);
-    model->test = 0;
-    furi_string_free(selected_filepath);
-    furi_string_free(predefined_filepath);
-
-    furi_hal_gpio_write(pin_led, true);
-    furi_delay_ms(50);
-    furi_hal_gpio_write(pin_led, false);
-
-    model->flag_tx_file = false;
-}
-
 /**
  * @brief      Callback for sniffer screen input.
  * @details    This function is called when the user presses a button while on the transmitter screen.
@@ -1922,12 +2890,17 @@ static bool lora_view_transmitter_input_callback(InputEvent* event, void* contex
             app->view_transmitter,
             LoRaTransmitterModel * model,
             {
-                if(event->key == InputKeyLeft && model->test > 0) {
-                    //model->test--;
+                if(event->key == InputKeyLeft) {
+                    // Slower replay
+                    if(model->replay_speed_index > 0) {
+                        model->replay_speed_index--;
+                    }
                     consumed = true;
-                } else if(event->key == InputKeyRight) { //&&
-                    //model->test < (COUNT_OF(view_lora_tx_tests) - 1)) {
-                    //model->test++;
+                } else if(event->key == InputKeyRight) {
+                    // Faster replay
+                    if(model->replay_speed_index < COUNT_OF(replay_speed_values) - 1) {
+                        model->replay_speed_index++;
+                    }
                     consumed = true;
                 } else if(event->key == InputKeyDown) { //&& model->size > 0) {
                     //model->size--;
@@ -1936,16 +2909,24 @@ static bool lora_view_transmitter_input_callback(InputEvent* event, void* contex
                     //model->size++;
                     consumed = true;
                 } else if(event->key == InputKeyOk) {
-                    uint32_t period = furi_ms_to_ticks(1000);
-                    furi_timer_stop(app->timer_tx);
-                    model->flag_signal = 1;
-                    send_data(app);
-                    furi_timer_start(app->timer_tx, period);
+                    if(app->replay.thread) {
+                        // Pause or resume the replay in progress
+                        furi_thread_flags_set(
+                            furi_thread_get_id(app->replay.thread), LoRaReplayFlagPause);
+                    } else {
+                        // The file browser is shown from the custom event handler
+                        view_dispatcher_send_custom_event(
+                            app->view_dispatcher, LoRaEventIdReplayStart);
+                    }
                     consumed = true;
                 } else if(event->key == InputKeyBack) {
-                    // FLAG TO STOP TRANSMISSION
-                    model->flag_signal = 0;
-                    view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewSubmenu);
+                    if(app->replay.thread) {
+                        // Stop the replay, stay on this screen
+                        furi_thread_flags_set(
+                            furi_thread_get_id(app->replay.thread), LoRaReplayFlagCancel);
+                    } else {
+                        view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewSubmenu);
+                    }
                     consumed = true;
                 }
             },
@@ -1955,6 +2936,212 @@ static bool lora_view_transmitter_input_callback(InputEvent* event, void* contex
     return consumed;
 }
 
+/**
+ * @brief      Decode the line the log viewer shows.
+ * @details    Only the line on screen is parsed, the rest of the log stays on the SD card.
+ * @param      model  The log viewer model.
+*/
+static void lora_log_viewer_decode(LoRaLogViewerModel* model) {
+    LoRaLogReader* reader = &model->reader;
+    model->is_packet = lora_record_parse(reader->line, reader->length, &model->record);
+    model->payload_len = -1;
+    if(model->is_packet) {
+        model->payload_len = lora_hex_decode(
+            model->record.payload.ptr,
+            model->record.payload.len,
+            model->payload,
+            sizeof(model->payload));
+    }
+    model->scroll = 0;
+}
+
+/**
+ * @brief      Ask for a capture log and show its first packet.
+ * @param      app  The LoRa application object.
+*/
+static void lora_log_viewer_open(LoRaApp* app) {
+    LoRaLogViewerModel* model = view_get_model(app->view_log_viewer);
+
+    FuriString* predefined_filepath = furi_string_alloc_set_str(PATHAPP);
+    FuriString* selected_filepath = furi_string_alloc();
+    DialogsFileBrowserOptions browser_options;
+    dialog_file_browser_set_basic_options(&browser_options, LORA_LOG_FILE_EXTENSION, NULL);
+    browser_options.base_path = PATHAPP;
+
+    if(dialog_file_browser_show(
+           model->dialogs, selected_filepath, predefined_filepath, &browser_options)) {
+        if(!storage_file_open(
+               model->file,
+               furi_string_get_cstr(selected_filepath),
+               FSAM_READ,
+               FSOM_OPEN_EXISTING)) {
+            dialog_message_show_storage_error(model->dialogs, "Cannot open File");
+            storage_file_close(model->file);
+        } else if(!lora_log_reader_open(&model->reader, model->file)) {
+            dialog_message_show_storage_error(model->dialogs, "Empty log file");
+            storage_file_close(model->file);
+        } else {
+            lora_log_viewer_decode(model);
+            view_dispatcher_switch_to_view(app->view_dispatcher, LoRaViewLogViewer);
+        }
+    }
+
+    furi_string_free(selected_filepath);
+    furi_string_free(predefined_filepath);
+}
+
+/**
+ * @brief      Callback for drawing the log viewer screen.
+ * @param      canvas  The canvas to draw on.
+ * @param      model   The model - LoRaLogViewerModel object.
+*/
+static void lora_view_log_viewer_draw_callback(Canvas* canvas, void* model) {
+    LoRaLogViewerModel* my_model = (LoRaLogViewerModel*)model;
+    LoRaLogReader* reader = &my_model->reader;
+    LoRaRecord* record = &my_model->record;
+    char text[32];
+
+    canvas_set_font(canvas, FontSecondary);
+
+    uint32_t percent = reader->size ? (uint32_t)(reader->offset * 100 / reader->size) : 0;
+    snprintf(text, sizeof(text), "%lu%%", percent);
+    canvas_draw_str_aligned(canvas, 127, 8, AlignRight, AlignBottom, text);
+
+    if(!my_model->is_packet) {
+        // Not a sniffer packet, show the start of the line as it is
+        canvas_draw_str(canvas, 1, 8, "Not a packet");
+        for(uint8_t row = 0; row < 5; row++) {
+            size_t start = row * 20;
+            if(start >= reader->length) {
+                break;
+            }
+            snprintf(text, sizeof(text), "%.20s", reader->line + start);
+            canvas_draw_str(canvas, 1, 17 + row * 9, text);
+        }
+        return;
+    }
+
+    snprintf(
+        text,
+        sizeof(text),
+        "%.*s %.*s",
+        (int)record->date.len,
+        record->date.ptr ? record->date.ptr : "",
+        (int)record->time.len,
+        record->time.ptr ? record->time.ptr : "");
+    canvas_draw_str(canvas, 1, 8, text);
+
+    snprintf(
+        text,
+        sizeof(text),
+        "%.*s %.*s RSSI %.*s",
+        (int)record->frequency.len,
+        record->frequency.ptr ? record->frequency.ptr : "",
+        (int)record->sf.len,
+        record->sf.ptr ? record->sf.ptr : "",
+        (int)record->rssi.len,
+        record->rssi.ptr ? record->rssi.ptr : "");
+    canvas_draw_str(canvas, 1, 17, text);
+
+    if(my_model->payload_len < 0) {
+        canvas_draw_str(canvas, 1, 26, "Bad payload");
+        return;
+    }
+    snprintf(
+        text,
+        sizeof(text),
+        "%ld bytes %.*s",
+        my_model->payload_len,
+        (int)record->bw.len,
+        record->bw.ptr ? record->bw.ptr : "");
+    canvas_draw_str(canvas, 1, 26, text);
+
+    for(uint8_t row = 0; row < LORA_LOG_VIEWER_ROWS; row++) {
+        int32_t start = (my_model->scroll + row) * LORA_LOG_VIEWER_ROW_BYTES;
+        if(start >= my_model->payload_len) {
+            break;
+        }
+        int32_t end = start + LORA_LOG_VIEWER_ROW_BYTES;
+        if(end > my_model->payload_len) {
+            end = my_model->payload_len;
+        }
+        size_t length = snprintf(text, sizeof(text), "%02lX", start);
+        for(int32_t i = start; i < end; i++) {
+            length +=
+                snprintf(text + length, sizeof(text) - length, " %02X", my_model->payload[i]);
+        }
+        canvas_draw_str(canvas, 1, 35 + row * 9, text);
+    }
+}
+
+/**
+ * @brief      Close the log when leaving the log viewer screen.
+ * @param      context  The context - LoRaApp object.
+*/
+static void lora_view_log_viewer_exit_callback(void* context) {
+    LoRaApp* app = (LoRaApp*)context;
+    LoRaLogViewerModel* model = view_get_model(app->view_log_viewer);
+    storage_file_close(model->file);
+}
+
+/**
+ * @brief      Callback for log viewer screen input.
+ * @details    Left and right step through the packets, a long press jumps a tenth of the file.
+ *           Up and down scroll the hex dump.
+ * @param      event    The event - InputEvent object.
+ * @param      context  The context - LoRaApp object.
+ * @return     true if the event was handled, false otherwise.
+*/
+static bool lora_view_log_viewer_input_callback(InputEvent* event, void* context) {
+    LoRaApp* app = (LoRaApp*)context;
+    bool consumed = false;
+
+    if(event->type != InputTypeShort && event->type != InputTypeLong &&
+       event->type != InputTypeRepeat) {
+        return false;
+    }
+
+    with_view_model(
+        app->view_log_viewer,
+        LoRaLogViewerModel * model,
+        {
+            LoRaLogReader* reader = &model->reader;
+            uint64_t jump = reader->size * LORA_LOG_VIEWER_JUMP / 100;
+            bool moved = false;
+            bool step = event->type == InputTypeShort;
+
+            if(event->key == InputKeyRight) {
+                moved = step ? lora_log_reader_next(reader) :
+                               lora_log_reader_seek(reader, reader->offset + jump);
+                consumed = true;
+            } else if(event->key == InputKeyLeft) {
+                moved = step ? lora_log_reader_prev(reader) :
+                               lora_log_reader_seek(
+                                   reader, reader->offset > jump ? reader->offset - jump : 0);
+                consumed = true;
+            } else if(event->key == InputKeyUp) {
+                if(model->scroll > 0) {
+                    model->scroll--;
+                }
+                consumed = true;
+            } else if(event->key == InputKeyDown) {
+                int32_t rows = (model->payload_len + LORA_LOG_VIEWER_ROW_BYTES - 1) /
+                               LORA_LOG_VIEWER_ROW_BYTES;
+                if(model->scroll + LORA_LOG_VIEWER_ROWS < rows) {
+                    model->scroll++;
+                }
+                consumed = true;
+            }
+
+            if(moved) {
+                lora_log_viewer_decode(model);
+            }
+        },
+        consumed);
+
+    return consumed;
+}
+
 static void lora_app_config_set_payload_length(VariableItem* item) {
     LoRaApp* app = variable_item_get_context(item);
     uint8_t index = variable_item_get_current_value_index(item);
@@ -1981,15 +3168,66 @@ static void lora_app_config_set_payload_length(VariableItem* item) {
         app->packetInvertIQ);
 }
 
+/**
+ * @brief      Check that loaded settings fit the option tables of this build.
+ * @details    A settings file from another build may reference options that no longer exist,
+ *            in that case the defaults are used instead.
+ * @param      settings  The settings, replaced by the defaults if invalid.
+ * @return     true if the settings were valid.
+*/
+static bool lora_app_settings_validate(LoRaSettings* settings) {
+    if(settings->frequency < 150000000 || settings->frequency > 960000000 ||
+       settings->bw_index >= COUNT_OF(config_bw_values) ||
+       settings->sf_index >= COUNT_OF(config_sf_values) ||
+       settings->cr_index >= COUNT_OF(config_cr_values) ||
+       settings->sw_index > CONFIG_SW_OTHER ||
+       settings->header_type_index >= COUNT_OF(config_header_type_values) ||
+       settings->crc_index >= COUNT_OF(config_crc_values) ||
+       settings->iq_index >= COUNT_OF(config_iq_values) || settings->payload_length >= 64 ||
+       settings->region_index >= lora_region_plan_count ||
+       settings->txpower_index >= COUNT_OF(config_txpower_values) ||
+       settings->ramp_index >= COUNT_OF(config_ramp_values) ||
+       settings->rx_alert_index >= COUNT_OF(config_alert_values) ||
+       settings->tx_alert_index >= COUNT_OF(config_alert_values)) {
+        lora_settings_default(settings);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief      Read the current configuration back from the configuration screens.
+ * @param      app       The LoRa application object.
+ * @param      settings  Filled with the current configuration.
+*/
+static void lora_app_settings_collect(LoRaApp* app, LoRaSettings* settings) {
+    LoRaSnifferModel* model = view_get_model(app->view_sniffer);
+
+    memset(settings, 0, sizeof(LoRaSettings));
+    settings->frequency = app->config_frequency;
+    settings->bw_index = model->config_bw_index;
+    settings->sf_index = model->config_sf_index;
+    settings->cr_index = model->config_cr_index;
+    settings->sw_index = model->config_sw_index;
+    settings->sw_other = app->config_sw_other;
+    settings->header_type_index = model->config_header_type_index;
+    settings->crc_index = model->config_crc_index;
+    settings->iq_index = model->config_iq_index;
+    settings->payload_length = app->packetPayloadLength;
+    settings->region_index = model->config_region_index;
+    settings->txpower_index = model->config_txpower_index;
+    settings->ramp_index = model->config_ramp_index;
+    settings->rx_alert_index = model->config_rx_alert_index;
+    settings->tx_alert_index = model->config_tx_alert_index;
+}
+
 /**
  * @brief      Allocate the LoRa application.
  * @details    This function allocates the LoRa application resources.
+ * @param      settings  The configuration to show in the configuration screens.
  * @return     LoRaApp object.
 */
-static LoRaApp* lora_app_alloc() {
-    UNUSED(lora_config_eu_dr_change);
-    UNUSED(config_eu_dr_label);
-
+static LoRaApp* lora_app_alloc(const LoRaSettings* settings) {
     LoRaApp* app = (LoRaApp*)malloc(sizeof(LoRaApp));
     VariableItem* item;
     Gui* gui = furi_record_open(RECORD_GUI);
@@ -2003,13 +3241,22 @@ static LoRaApp* lora_app_alloc() {
     submenu_add_item(
         app->submenu, "Config", LoRaSubmenuIndexConfigure, lora_submenu_callback, app);
     submenu_add_item(app->submenu, "LoRaWAN", LoRaSubmenuIndexLoRaWAN, lora_submenu_callback, app);
+    submenu_add_item(
+        app->submenu, "Profiles", LoRaSubmenuIndexProfiles, lora_submenu_callback, app);
     submenu_add_item(app->submenu, "Sniffer", LoRaSubmenuIndexSniffer, lora_submenu_callback, app);
     submenu_add_item(
         app->submenu, "Transmitter", LoRaSubmenuIndexTransmitter, lora_submenu_callback, app);
+    submenu_add_item(
+        app->submenu, "Log viewer", LoRaSubmenuIndexLogViewer, lora_submenu_callback, app);
     submenu_add_item(
         app->submenu, "Send LoRa byte", LoRaSubmenuIndexManualTX, lora_submenu_callback, app);
     submenu_add_item(
         app->submenu, "Linker Sub-GHz", LoRaSubmenuIndexLinkerSubGHZ, lora_submenu_callback, app);
+    submenu_add_item(
+        app->submenu, "Dump SPI trace", LoRaSubmenuIndexTrace, lora_submenu_callback, app);
+#if LORA_PERF
+    submenu_add_item(app->submenu, "Profiling", LoRaSubmenuIndexPerf, lora_submenu_callback, app);
+#endif
     submenu_add_item(app->submenu, "About", LoRaSubmenuIndexAbout, lora_submenu_callback, app);
     view_set_previous_callback(submenu_get_view(app->submenu), lora_navigation_exit_callback);
     view_dispatcher_add_view(
@@ -2022,7 +3269,7 @@ static LoRaApp* lora_app_alloc() {
     app->temp_buffer_size = 32;
     app->temp_buffer = (char*)malloc(app->temp_buffer_size);
 
-    app->byte_buffer_size = 16;
+    app->byte_buffer_size = settings->payload_length;
     app->byte_buffer = (uint8_t*)malloc(app->byte_buffer_size);
 
     app->byte_input = byte_input_alloc();
@@ -2037,7 +3284,15 @@ static LoRaApp* lora_app_alloc() {
     view_set_previous_callback(
         byte_input_get_view(app->byte_input), lora_navigation_submenu_callback);
 
-    app->packetPayloadLength = 16;
+    app->settings = *settings;
+    app->config_frequency = settings->frequency; // Set on the radio by begin(), see configPreload
+
+    // Order is preamble, header type, packet length, CRC, IQ
+    app->packetPreamble = getPacketPreamble(); // Preloaded in main_lora_app
+    app->packetHeaderType = config_header_type_values[settings->header_type_index];
+    app->packetPayloadLength = settings->payload_length;
+    app->packetCRC = config_crc_values[settings->crc_index];
+    app->packetInvertIQ = config_iq_values[settings->iq_index];
 
     app->variable_item_list_config = variable_item_list_alloc();
     variable_item_list_reset(app->variable_item_list_config);
@@ -2047,7 +3302,13 @@ static LoRaApp* lora_app_alloc() {
 
     // frequency
     FuriString* config_freq_name = furi_string_alloc();
-    furi_string_set_str(config_freq_name, config_freq_default_value);
+    if(settings->frequency == 915000000) {
+        furi_string_set_str(config_freq_name, config_freq_default_value);
+    } else {
+        char text_buf[16] = {0};
+        lora_region_format_frequency(text_buf, sizeof(text_buf), settings->frequency);
+        furi_string_set_str(config_freq_name, text_buf);
+    }
     app->config_freq_item = variable_item_list_add(
         app->variable_item_list_config, config_freq_config_label, 1, NULL, NULL);
     variable_item_set_current_value_text(
@@ -2060,7 +3321,7 @@ static LoRaApp* lora_app_alloc() {
         COUNT_OF(config_bw_values),
         lora_config_bw_change,
         app);
-    uint8_t config_bw_index = 7;
+    uint8_t config_bw_index = settings->bw_index;
     variable_item_set_current_value_index(app->item_bw, config_bw_index);
     variable_item_set_current_value_text(app->item_bw, config_bw_names[config_bw_index]);
 
@@ -2071,7 +3332,7 @@ static LoRaApp* lora_app_alloc() {
         COUNT_OF(config_sf_values),
         lora_config_sf_change,
         app);
-    uint8_t config_sf_index = 3;
+    uint8_t config_sf_index = settings->sf_index;
     variable_item_set_current_value_index(app->item_sf, config_sf_index);
     variable_item_set_current_value_text(app->item_sf, config_sf_names[config_sf_index]);
 
@@ -2082,7 +3343,7 @@ static LoRaApp* lora_app_alloc() {
         COUNT_OF(config_cr_values),
         lora_config_cr_change,
         app);
-    uint8_t config_cr_index = 0;
+    uint8_t config_cr_index = settings->cr_index;
     variable_item_set_current_value_index(app->item_cr, config_cr_index);
     variable_item_set_current_value_text(app->item_cr, config_cr_names[config_cr_index]);
 
@@ -2090,12 +3351,12 @@ static LoRaApp* lora_app_alloc() {
     app->item_sw = variable_item_list_add(
         app->variable_item_list_config,
         config_sw_label,
-        COUNT_OF(config_sw_values),
+        CONFIG_SW_OTHER + 1,
         lora_config_sw_change,
         app);
-    uint8_t config_sw_index = 0;
-    variable_item_set_current_value_index(app->item_sw, config_sw_index);
-    variable_item_set_current_value_text(app->item_sw, config_sw_names[config_sw_index]);
+    uint8_t config_sw_index = settings->sw_index;
+    app->config_sw_other = settings->sw_other;
+    lora_config_show_sw(app, config_sw_index);
 
     // Payload length
     item = variable_item_list_add(
@@ -2104,8 +3365,10 @@ static LoRaApp* lora_app_alloc() {
         64,
         lora_app_config_set_payload_length,
         app);
-    variable_item_set_current_value_index(item, 16);
-    variable_item_set_current_value_text(item, "16");
+    char payload_length_text[4];
+    snprintf(payload_length_text, sizeof(payload_length_text), "%d", settings->payload_length);
+    variable_item_set_current_value_index(item, settings->payload_length);
+    variable_item_set_current_value_text(item, payload_length_text);
 
     // Header Type
     app->item_header_type = variable_item_list_add(
@@ -2114,7 +3377,7 @@ static LoRaApp* lora_app_alloc() {
         COUNT_OF(config_header_type_values),
         lora_config_header_type_change,
         app);
-    uint8_t config_header_type_index = 0;
+    uint8_t config_header_type_index = settings->header_type_index;
     variable_item_set_current_value_index(app->item_header_type, config_header_type_index);
     variable_item_set_current_value_text(
         app->item_header_type, config_header_type_names[config_header_type_index]);
@@ -2126,7 +3389,7 @@ static LoRaApp* lora_app_alloc() {
         COUNT_OF(config_crc_values),
         lora_config_crc_change,
         app);
-    uint8_t config_crc_index = 0;
+    uint8_t config_crc_index = settings->crc_index;
     variable_item_set_current_value_index(app->item_crc, config_crc_index);
     variable_item_set_current_value_text(app->item_crc, config_crc_names[config_crc_index]);
 
@@ -2137,91 +3400,64 @@ static LoRaApp* lora_app_alloc() {
         COUNT_OF(config_iq_values),
         lora_config_iq_change,
         app);
-    uint8_t config_iq_index = 0;
+    uint8_t config_iq_index = settings->iq_index;
     variable_item_set_current_value_index(app->item_iq, config_iq_index);
     variable_item_set_current_value_text(app->item_iq, config_iq_names[config_iq_index]);
 
-    // Frequency Plan
-    app->item_region = variable_item_list_add(
-        app->variable_item_list_lorawan,
-        config_region_label,
-        COUNT_OF(config_region_values),
-        lora_config_region_change,
+    // TX Power
+    app->item_txpower = variable_item_list_add(
+        app->variable_item_list_config,
+        config_txpower_label,
+        COUNT_OF(config_txpower_values),
+        lora_config_txpower_change,
         app);
-    uint8_t config_region_index = 1;
-    variable_item_set_current_value_index(app->item_region, config_region_index);
+    uint8_t config_txpower_index = settings->txpower_index;
+    variable_item_set_current_value_index(app->item_txpower, config_txpower_index);
     variable_item_set_current_value_text(
-        app->item_region, config_region_names[config_region_index]);
+        app->item_txpower, config_txpower_names[config_txpower_index]);
 
-    // Data Rate
-    app->item_us_dr = variable_item_list_add(
-        app->variable_item_list_lorawan,
-        config_us_dr_label,
-        COUNT_OF(config_us_dr_values),
-        lora_config_us_dr_change,
+    // PA ramp time
+    app->item_ramp = variable_item_list_add(
+        app->variable_item_list_config,
+        config_ramp_label,
+        COUNT_OF(config_ramp_values),
+        lora_config_ramp_change,
         app);
-    uint8_t config_us_dr_index = 0;
-    variable_item_set_current_value_index(app->item_us_dr, config_us_dr_index);
-    variable_item_set_current_value_text(app->item_us_dr, config_us_dr_names[config_us_dr_index]);
-
-    char text_buf[11] = {0};
+    uint8_t config_ramp_index = settings->ramp_index;
+    variable_item_set_current_value_index(app->item_ramp, config_ramp_index);
+    variable_item_set_current_value_text(app->item_ramp, config_ramp_names[config_ramp_index]);
 
-    // Uplink Channel 125K
-    app->item_us915_ul_channels_125k = variable_item_list_add(
-        app->variable_item_list_lorawan,
-        config_us915_ul_channels_125k_label,
-        COUNT_OF(config_us915_ul_channels_125k),
-        lora_config_us915_ul_channels_125k_change,
+    uint8_t config_rx_alert_index = settings->rx_alert_index;
+    item = variable_item_list_add(
+        app->variable_item_list_config,
+        config_rx_alert_label,
+        COUNT_OF(config_alert_values),
+        lora_config_rx_alert_change,
         app);
-    uint8_t config_us915_ul_channels_125k_index = 0;
-    variable_item_set_current_value_index(
-        app->item_us915_ul_channels_125k, config_us915_ul_channels_125k_index);
+    variable_item_set_current_value_index(item, config_rx_alert_index);
+    variable_item_set_current_value_text(item, config_alert_names[config_rx_alert_index]);
+    lora_notify_set_outputs(LoRaNotifyEventRx, config_alert_values[config_rx_alert_index]);
 
-    snprintf(
-        text_buf,
-        sizeof(text_buf),
-        "%3lu.%1lu MHz",
-        config_us915_ul_channels_125k[config_us915_ul_channels_125k_index] / 1000000,
-        (config_us915_ul_channels_125k[config_us915_ul_channels_125k_index] % 1000000) / 100000);
-    variable_item_set_current_value_text(app->item_us915_ul_channels_125k, text_buf);
-
-    // Uplink Channel 500K
-    app->item_us915_ul_channels_500k = variable_item_list_add(
-        app->variable_item_list_lorawan,
-        config_us915_ul_channels_500k_label,
-        COUNT_OF(config_us915_ul_channels_500k),
-        lora_config_us915_ul_channels_500k_change,
+    uint8_t config_tx_alert_index = settings->tx_alert_index;
+    item = variable_item_list_add(
+        app->variable_item_list_config,
+        config_tx_alert_label,
+        COUNT_OF(config_alert_values),
+        lora_config_tx_alert_change,
         app);
-    uint8_t config_us915_ul_channels_500k_index = 0;
-    variable_item_set_current_value_index(
-        app->item_us915_ul_channels_500k, config_us915_ul_channels_500k_index);
+    variable_item_set_current_value_index(item, config_tx_alert_index);
+    variable_item_set_current_value_text(item, config_alert_names[config_tx_alert_index]);
+    lora_notify_set_outputs(LoRaNotifyEventTx, config_alert_values[config_tx_alert_index]);
 
-    snprintf(
-        text_buf,
-        sizeof(text_buf),
-        "%3lu.%1lu MHz",
-        config_us915_ul_channels_500k[config_us915_ul_channels_500k_index] / 1000000,
-        (config_us915_ul_channels_500k[config_us915_ul_channels_500k_index] % 1000000) / 100000);
-    variable_item_set_current_value_text(app->item_us915_ul_channels_500k, text_buf);
-
-    // Downlink Channel 500K
-    app->item_us915_dl_channels_500k = variable_item_list_add(
-        app->variable_item_list_lorawan,
-        config_us915_dl_channels_500k_label,
-        COUNT_OF(config_us915_dl_channels_500k),
-        lora_config_us915_dl_channels_500k_change,
+    // USB streaming, always off at start since it changes the USB configuration
+    item = variable_item_list_add(
+        app->variable_item_list_config,
+        config_stream_label,
+        COUNT_OF(config_stream_names),
+        lora_config_stream_change,
         app);
-    uint8_t config_us915_dl_channels_500k_index = 0;
-    variable_item_set_current_value_index(
-        app->item_us915_dl_channels_500k, config_us915_dl_channels_500k_index);
-
-    snprintf(
-        text_buf,
-        sizeof(text_buf),
-        "%3lu.%1lu MHz",
-        config_us915_dl_channels_500k[config_us915_dl_channels_500k_index] / 1000000,
-        (config_us915_dl_channels_500k[config_us915_dl_channels_500k_index] % 1000000) / 100000);
-    variable_item_set_current_value_text(app->item_us915_dl_channels_500k, text_buf);
+    variable_item_set_current_value_index(item, 0);
+    variable_item_set_current_value_text(item, config_stream_names[0]);
 
     variable_item_list_set_enter_callback(
         app->variable_item_list_config, lora_setting_item_clicked, app);
@@ -2230,6 +3466,9 @@ static LoRaApp* lora_app_alloc() {
         variable_item_list_get_view(app->variable_item_list_config),
         lora_navigation_submenu_callback);
 
+    variable_item_list_set_enter_callback(
+        app->variable_item_list_lorawan, lora_lorawan_item_clicked, app);
+
     view_set_previous_callback(
         variable_item_list_get_view(app->variable_item_list_lorawan),
         lora_navigation_submenu_callback);
@@ -2258,14 +3497,40 @@ static LoRaApp* lora_app_alloc() {
     model_s->config_freq_name = config_freq_name;
     model_s->config_bw_index = config_bw_index;
     model_s->config_sf_index = config_sf_index;
-    model_s->config_cr_index = config_sf_index;
+    model_s->config_cr_index = config_cr_index;
+    model_s->config_sw_index = config_sw_index;
 
     model_s->config_header_type_index = config_header_type_index;
     model_s->config_crc_index = config_crc_index;
     model_s->config_iq_index = config_iq_index;
+    model_s->config_txpower_index = config_txpower_index;
+    model_s->config_ramp_index = config_ramp_index;
+    model_s->config_rx_alert_index = config_rx_alert_index;
+    model_s->config_tx_alert_index = config_tx_alert_index;
 
     model_s->x = 0;
 
+    lora_history_reset(&model_s->history);
+    model_s->screen = LoRaSnifferScreenLive;
+    model_s->history_selected = 0;
+    model_s->detail_scroll = 0;
+    lora_devices_reset(&model_s->devices);
+    model_s->device_listed = 0;
+    model_s->device_selected = 0;
+    model_s->device_sort = LoRaDevicesSortRecent;
+    model_s->radio_outages = 0;
+    model_s->radio_recovery_ms = 0;
+    model_s->stream_dropped = 0;
+
+    app->sniffer.thread = NULL;
+    app->sniffer.packets =
+        furi_message_queue_alloc(LORA_SNIFFER_QUEUE_LEN, sizeof(LoRaSnifferPacket));
+    app->sniffer.log_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+
+    // The radio is not retuned until a LoRaWAN setting is changed
+    lora_lorawan_list_build(app, settings->region_index);
+
+    model_s->stream = NULL;
     model_s->dialogs_rx = furi_record_open(RECORD_DIALOGS);
     model_s->storage_rx = furi_record_open(RECORD_STORAGE);
     model_s->file_rx = storage_file_alloc(model_s->storage_rx);
@@ -2285,6 +3550,11 @@ static LoRaApp* lora_app_alloc() {
     LoRaTransmitterModel* model_t = view_get_model(app->view_transmitter);
 
     model_t->x = 0;
+    model_t->replay_speed_index = COUNT_OF(replay_speed_values) - 1; // As fast as possible
+    model_t->status.state = LoRaReplayStateIdle;
+
+    app->replay.thread = NULL;
+    app->replay.status_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
 
     model_t->dialogs_tx = furi_record_open(RECORD_DIALOGS);
     model_t->storage_tx = furi_record_open(RECORD_STORAGE);
@@ -2292,8 +3562,50 @@ static LoRaApp* lora_app_alloc() {
 
     makePaths(app);
 
+    app->submenu_profiles = submenu_alloc();
+    lora_profiles_load(app);
+    lora_profiles_menu_build(app);
+    view_set_previous_callback(
+        submenu_get_view(app->submenu_profiles), lora_navigation_submenu_callback);
+    view_dispatcher_add_view(
+        app->view_dispatcher, LoRaViewProfiles, submenu_get_view(app->submenu_profiles));
+
     view_dispatcher_add_view(app->view_dispatcher, LoraViewTransmitter, app->view_transmitter);
 
+    app->view_log_viewer = view_alloc();
+    view_set_draw_callback(app->view_log_viewer, lora_view_log_viewer_draw_callback);
+    view_set_input_callback(app->view_log_viewer, lora_view_log_viewer_input_callback);
+    view_set_previous_callback(app->view_log_viewer, lora_navigation_submenu_callback);
+    view_set_exit_callback(app->view_log_viewer, lora_view_log_viewer_exit_callback);
+    view_set_context(app->view_log_viewer, app);
+    view_allocate_model(app->view_log_viewer, ViewModelTypeLockFree, sizeof(LoRaLogViewerModel));
+    LoRaLogViewerModel* model_l = view_get_model(app->view_log_viewer);
+    model_l->dialogs = furi_record_open(RECORD_DIALOGS);
+    model_l->storage = furi_record_open(RECORD_STORAGE);
+    model_l->file = storage_file_alloc(model_l->storage);
+    view_dispatcher_add_view(app->view_dispatcher, LoRaViewLogViewer, app->view_log_viewer);
+
+#if LORA_PERF
+    app->perf_text = malloc(LORA_PERF_TEXT_MAX);
+    app->perf_text[0] = '\0';
+    app->submenu_perf = submenu_alloc();
+    submenu_set_header(app->submenu_perf, "Profiling");
+    submenu_add_item(app->submenu_perf, "View stats", LoRaPerfIndexView, lora_perf_callback, app);
+    submenu_add_item(app->submenu_perf, "Save to SD", LoRaPerfIndexSave, lora_perf_callback, app);
+    submenu_add_item(app->submenu_perf, "Reset", LoRaPerfIndexReset, lora_perf_callback, app);
+    view_set_previous_callback(
+        submenu_get_view(app->submenu_perf), lora_navigation_submenu_callback);
+    view_dispatcher_add_view(
+        app->view_dispatcher, LoRaViewPerf, submenu_get_view(app->submenu_perf));
+
+    app->text_box_perf = text_box_alloc();
+    text_box_set_font(app->text_box_perf, TextBoxFontText);
+    view_set_previous_callback(
+        text_box_get_view(app->text_box_perf), lora_navigation_perf_callback);
+    view_dispatcher_add_view(
+        app->view_dispatcher, LoRaViewPerfStats, text_box_get_view(app->text_box_perf));
+#endif
+
     app->widget_about = widget_alloc();
     widget_add_text_scroll_element(
         app->widget_about,
@@ -2327,7 +3639,15 @@ static void lora_app_free(LoRaApp* app) {
 #endif
     furi_record_close(RECORD_NOTIFICATION);
 
+    lora_sniffer_job_stop(app);
+    furi_message_queue_free(app->sniffer.packets);
+    furi_mutex_free(app->sniffer.log_mutex);
+    furi_mutex_free(app->replay.status_mutex);
+
     LoRaSnifferModel* model = view_get_model(app->view_sniffer);
+    if(model->stream) {
+        lora_stream_free(model->stream);
+    }
     storage_file_free(model->file_rx);
     furi_record_close(RECORD_STORAGE);
     furi_record_close(RECORD_DIALOGS);
@@ -2337,6 +3657,11 @@ static void lora_app_free(LoRaApp* app) {
     furi_record_close(RECORD_STORAGE);
     furi_record_close(RECORD_DIALOGS);
 
+    LoRaLogViewerModel* model_l = view_get_model(app->view_log_viewer);
+    storage_file_free(model_l->file);
+    furi_record_close(RECORD_STORAGE);
+    furi_record_close(RECORD_DIALOGS);
+
     view_dispatcher_remove_view(app->view_dispatcher, LoRaViewFrequencyInput);
     text_input_free(app->frequency_input);
 
@@ -2348,14 +3673,25 @@ static void lora_app_free(LoRaApp* app) {
 
     view_dispatcher_remove_view(app->view_dispatcher, LoRaViewAbout);
     widget_free(app->widget_about);
+#if LORA_PERF
+    view_dispatcher_remove_view(app->view_dispatcher, LoRaViewPerfStats);
+    text_box_free(app->text_box_perf);
+    view_dispatcher_remove_view(app->view_dispatcher, LoRaViewPerf);
+    submenu_free(app->submenu_perf);
+    free(app->perf_text);
+#endif
     view_dispatcher_remove_view(app->view_dispatcher, LoRaViewSniffer);
     view_free(app->view_sniffer);
     view_dispatcher_remove_view(app->view_dispatcher, LoraViewTransmitter);
     view_free(app->view_transmitter);
+    view_dispatcher_remove_view(app->view_dispatcher, LoRaViewLogViewer);
+    view_free(app->view_log_viewer);
     view_dispatcher_remove_view(app->view_dispatcher, LoRaViewConfigure);
     variable_item_list_free(app->variable_item_list_config);
     view_dispatcher_remove_view(app->view_dispatcher, LoRaViewLoRaWAN);
     variable_item_list_free(app->variable_item_list_lorawan);
+    view_dispatcher_remove_view(app->view_dispatcher, LoRaViewProfiles);
+    submenu_free(app->submenu_profiles);
     view_dispatcher_remove_view(app->view_dispatcher, LoRaViewSubmenu);
     submenu_free(app->submenu);
     view_dispatcher_free(app->view_dispatcher);
@@ -2385,6 +3721,36 @@ int32_t main_lora_app(void* _p) {
 
     abandone();
 
+    // Start on the configuration of the last session, applied by begin() in one pass
+    LoRaSettings settings;
+    if(lora_settings_load(&settings) && lora_app_settings_validate(&settings)) {
+        uint16_t sync_word = settings.sw_other;
+        if(settings.sw_index < COUNT_OF(config_sw_values)) {
+            sync_word = config_sw_values[settings.sw_index];
+        }
+        configPreload(
+            settings.frequency,
+            config_bw_values[settings.bw_index],
+            config_sf_values[settings.sf_index],
+            config_cr_values[settings.cr_index],
+            sync_word);
+        configPreloadTxPower(
+            config_txpower_values[settings.txpower_index],
+            config_ramp_values[settings.ramp_index]);
+    }
+
+    // The packet options shown by the configuration screen, defaults included, are the ones the
+    // driver receives and transmits with.  The preamble isn't saved, the driver default is kept.
+    configPreloadPacketParams(
+        getPacketPreamble(),
+        config_header_type_values[settings.header_type_index],
+        settings.payload_length,
+        config_crc_values[settings.crc_index],
+        config_iq_values[settings.iq_index]);
+
+    // Before begin(), so the radio sanity check blinks the module LED
+    lora_notify_init();
+
     if(!begin()) {
         DialogsApp* dialogs_msg = furi_record_open(RECORD_DIALOGS);
         DialogMessage* message = dialog_message_alloc();
@@ -2398,20 +3764,23 @@ int32_t main_lora_app(void* _p) {
         dialog_message_show(dialogs_msg, message);
         dialog_message_free(message);
         furi_record_close(RECORD_DIALOGS);
+        lora_notify_deinit();
+        end();
         return 0;
     }
 
-    LoRaApp* app = lora_app_alloc();
-
-    app->packetPreamble = 0x0010;
-    app->packetHeaderType = 0x00;
-    app->packetPayloadLength = 0xFF;
-    app->packetCRC = 0x00;
-    app->packetInvertIQ = 0x00;
+    LoRaApp* app = lora_app_alloc(&settings);
 
     view_dispatcher_run(app->view_dispatcher);
 
+    lora_app_settings_collect(app, &settings);
+    if(memcmp(&settings, &app->settings, sizeof(LoRaSettings)) != 0) {
+        lora_settings_save(&settings);
+    }
+
     lora_app_free(app);
+    lora_notify_deinit();
+    end();
 
     furi_hal_spi_bus_handle_deinit(spi);
 
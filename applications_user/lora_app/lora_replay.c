@@ -0,0 +1,75 @@
+#include "lora_replay.h"
+
+#include <string.h>
+
+// Starting guess for the radio turnaround, refined after every packet
+#define LORA_REPLAY_TURNAROUND_MS 20
+
+void lora_replay_scheduler_reset(LoRaReplayScheduler* scheduler, uint16_t speed_percent) {
+    memset(scheduler, 0, sizeof(LoRaReplayScheduler));
+    scheduler->speed_percent = speed_percent;
+    scheduler->turnaround_ms = LORA_REPLAY_TURNAROUND_MS;
+}
+
+uint32_t lora_replay_scheduler_next(
+    LoRaReplayScheduler* scheduler,
+    uint32_t capture_s,
+    uint32_t airtime_ms,
+    uint32_t now_ms) {
+    uint32_t lead_ms = airtime_ms + scheduler->turnaround_ms;
+
+    if(scheduler->speed_percent == LORA_REPLAY_SPEED_ASAP) {
+        uint32_t start_ms = scheduler->last_end_ms + LORA_REPLAY_ASAP_GAP_MS;
+        if(!scheduler->started || (int32_t)(start_ms - now_ms) < 0) {
+            start_ms = now_ms;
+        }
+        scheduler->started = true;
+        scheduler->target_end_ms = start_ms + lead_ms;
+        return start_ms;
+    }
+
+    // Going back in time means the capture was not monotonic, restart the timeline here
+    if(!scheduler->started || capture_s < scheduler->origin_capture_s) {
+        scheduler->started = true;
+        scheduler->origin_capture_s = capture_s;
+        scheduler->origin_end_ms = now_ms + lead_ms;
+    }
+
+    uint64_t offset_ms = (uint64_t)(capture_s - scheduler->origin_capture_s) * 1000 * 100 /
+                         scheduler->speed_percent;
+    scheduler->target_end_ms = scheduler->origin_end_ms + (uint32_t)offset_ms;
+
+    uint32_t start_ms = scheduler->target_end_ms - lead_ms;
+    if((int32_t)(start_ms - now_ms) < 0) {
+        start_ms = now_ms; // Running late, send right away
+    }
+    return start_ms;
+}
+
+void lora_replay_scheduler_done(
+    LoRaReplayScheduler* scheduler,
+    uint32_t start_ms,
+    uint32_t end_ms,
+    uint32_t airtime_ms) {
+    int32_t error_ms = (int32_t)(end_ms - scheduler->target_end_ms);
+    uint32_t jitter_ms = error_ms < 0 ? -error_ms : error_ms;
+
+    scheduler->packets++;
+    scheduler->jitter_sum_ms += jitter_ms;
+    if(jitter_ms > scheduler->jitter_max_ms) {
+        scheduler->jitter_max_ms = jitter_ms;
+    }
+    scheduler->last_end_ms = end_ms;
+
+    // Whatever transmit() spent beyond the time-on-air is radio turnaround, smooth it out
+    uint32_t elapsed_ms = end_ms - start_ms;
+    uint32_t overhead_ms = elapsed_ms > airtime_ms ? elapsed_ms - airtime_ms : 0;
+    scheduler->turnaround_ms = (scheduler->turnaround_ms * 3 + overhead_ms) / 4;
+}
+
+uint32_t lora_replay_scheduler_jitter_avg(const LoRaReplayScheduler* scheduler) {
+    if(!scheduler->packets) {
+        return 0;
+    }
+    return scheduler->jitter_sum_ms / scheduler->packets;
+}
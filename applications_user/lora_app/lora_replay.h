@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Replay speed in percent of the original capture timing, 0 sends as fast as possible
+#define LORA_REPLAY_SPEED_ASAP 0
+
+// Gap kept between packets when replaying as fast as possible
+#define LORA_REPLAY_ASAP_GAP_MS 10
+
+/**
+ * Schedules replayed packets so their end of transmission lands at the same relative time as
+ * the end of reception in the capture (the sniffer stamps a packet once it is fully received).
+ * The start of each transmission is pulled forward by the packet time-on-air and by the radio
+ * turnaround (SPI setup before the PA ramps), which is learned from the previous packets.
+ *
+ * All times are in milliseconds of the caller's clock, capture times are in seconds.
+*/
+typedef struct {
+    uint16_t speed_percent; // 100 = original timing, 200 = twice as fast, 50 = half speed
+
+    bool started;
+    uint32_t origin_capture_s; // Capture time of the first packet
+    uint32_t origin_end_ms; // Local time the first packet finished
+    uint32_t target_end_ms; // When the current packet should finish
+    uint32_t last_end_ms; // When the previous packet finished
+    uint32_t turnaround_ms; // Learned overhead of transmit() on top of time-on-air
+
+    uint32_t packets;
+    uint32_t jitter_sum_ms;
+    uint32_t jitter_max_ms;
+} LoRaReplayScheduler;
+
+/**
+ * @brief      Start a new replay session.
+ * @param      scheduler      The scheduler.
+ * @param      speed_percent  Playback speed or LORA_REPLAY_SPEED_ASAP.
+*/
+void lora_replay_scheduler_reset(LoRaReplayScheduler* scheduler, uint16_t speed_percent);
+
+/**
+ * @brief      Compute when the next packet has to be handed to the radio.
+ * @param      scheduler   The scheduler.
+ * @param      capture_s   Capture time of the packet.
+ * @param      airtime_ms  Time-on-air of the packet with the current radio settings.
+ * @param      now_ms      Current time.
+ * @return     Time at which to start the transmission, never earlier than now_ms.
+*/
+uint32_t lora_replay_scheduler_next(
+    LoRaReplayScheduler* scheduler,
+    uint32_t capture_s,
+    uint32_t airtime_ms,
+    uint32_t now_ms);
+
+/**
+ * @brief      Report a finished transmission, updates jitter and turnaround estimates.
+ * @param      scheduler   The scheduler.
+ * @param      start_ms    Time transmit() was called.
+ * @param      end_ms      Time transmit() returned.
+ * @param      airtime_ms  Time-on-air of the packet.
+*/
+void lora_replay_scheduler_done(
+    LoRaReplayScheduler* scheduler,
+    uint32_t start_ms,
+    uint32_t end_ms,
+    uint32_t airtime_ms);
+
+/**
+ * @brief      Average absolute difference between scheduled and actual end of transmission.
+ * @param      scheduler  The scheduler.
+ * @return     Jitter in milliseconds, 0 before the first packet.
+*/
+uint32_t lora_replay_scheduler_jitter_avg(const LoRaReplayScheduler* scheduler);
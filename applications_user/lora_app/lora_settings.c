@@ -0,0 +1,46 @@
+#include "lora_settings.h"
+
+#include <string.h>
+#include <storage/storage.h>
+#include <toolbox/saved_struct.h>
+
+#define LORA_SETTINGS_PATH    EXT_PATH("apps_data/lora/settings.bin")
+#define LORA_SETTINGS_MAGIC   0x4C // 'L'
+#define LORA_SETTINGS_VERSION 4
+
+void lora_settings_default(LoRaSettings* settings) {
+    memset(settings, 0, sizeof(LoRaSettings));
+    settings->frequency = 915000000;
+    settings->bw_index = 7; // 125 kHz
+    settings->sf_index = 3; // SF8
+    settings->sw_other = 0x1424; // Private
+    settings->payload_length = 16;
+    settings->region_index = 1; // US915
+    settings->txpower_index = 0; // 22 dBm
+    settings->ramp_index = 2; // 40 us
+    settings->rx_alert_index = 1; // Module LED
+    settings->tx_alert_index = 1;
+}
+
+bool lora_settings_load(LoRaSettings* settings) {
+    // saved_struct checks the size, magic, version and checksum
+    if(saved_struct_load(
+           LORA_SETTINGS_PATH,
+           settings,
+           sizeof(LoRaSettings),
+           LORA_SETTINGS_MAGIC,
+           LORA_SETTINGS_VERSION)) {
+        return true;
+    }
+    lora_settings_default(settings);
+    return false;
+}
+
+bool lora_settings_save(const LoRaSettings* settings) {
+    return saved_struct_save(
+        LORA_SETTINGS_PATH,
+        settings,
+        sizeof(LoRaSettings),
+        LORA_SETTINGS_MAGIC,
+        LORA_SETTINGS_VERSION);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Radio configuration restored at startup.  Settings are stored as indices into the option
+ * tables of the configuration screen, so the file stays a few bytes long.
+*/
+typedef struct {
+    uint32_t frequency; // Hz
+    uint16_t sw_other; // Sync word of a profile, used when sw_index is past the sync word table
+    uint8_t bw_index;
+    uint8_t sf_index;
+    uint8_t cr_index;
+    uint8_t sw_index;
+    uint8_t header_type_index;
+    uint8_t crc_index;
+    uint8_t iq_index;
+    uint8_t payload_length;
+    uint8_t region_index; // Frequency plan of the LoRaWAN screen
+    uint8_t txpower_index;
+    uint8_t ramp_index; // PA ramp time
+    uint8_t rx_alert_index; // Feedback for received packets
+    uint8_t tx_alert_index; // Feedback for sent packets
+} LoRaSettings;
+
+/**
+ * @brief      Fill the settings with the defaults of a first launch.
+ * @param      settings  The settings.
+*/
+void lora_settings_default(LoRaSettings* settings);
+
+/**
+ * @brief      Load the settings saved by the last session.
+ * @param      settings  The settings, set to the defaults if there is nothing to load.
+ * @return     true if the settings were loaded from the SD card.
+*/
+bool lora_settings_load(LoRaSettings* settings);
+
+/**
+ * @brief      Save the settings for the next session.
+ * @param      settings  The settings.
+ * @return     true on success.
+*/
+bool lora_settings_save(const LoRaSettings* settings);
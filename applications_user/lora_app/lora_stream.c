@@ -0,0 +1,145 @@
+#include "lora_stream.h"
+
+#include <furi.h>
+#include <furi_hal.h>
+
+#define TAG "LoRaStream"
+
+#define LORA_STREAM_CDC_CHANNEL 1 // Second serial port, the CLI uses the first one
+#define LORA_STREAM_QUEUE_LEN   8 // Frames waiting for the computer
+#define LORA_STREAM_TX_TIMEOUT  100 // A computer not reading for this long loses the frame
+
+typedef struct {
+    uint16_t length; // 0 asks the worker to stop
+    uint8_t data[LORA_FRAME_MAX_LEN];
+} LoRaStreamItem;
+
+typedef enum {
+    LoRaStreamFlagTxDone = (1 << 0), // The USB endpoint took the last chunk
+} LoRaStreamFlag;
+
+struct LoRaStream {
+    FuriHalUsbInterface* usb_previous; // Restored when streaming stops
+    FuriMessageQueue* queue; // LoRaStreamItem
+    FuriThread* thread;
+    uint32_t sequence; // Only used by lora_stream_send
+    LoRaStreamItem item; // Only used by lora_stream_send, kept to not allocate per packet
+    // One counter per thread that drops, each only written by its thread, read as their sum
+    volatile uint32_t dropped_queue; // Queue full, counted by lora_stream_send
+    volatile uint32_t dropped_usb; // Not taken by the computer, counted by the worker
+};
+
+static void lora_stream_tx_done(void* context) {
+    LoRaStream* stream = context;
+    furi_thread_flags_set(furi_thread_get_id(stream->thread), LoRaStreamFlagTxDone);
+}
+
+static CdcCallbacks lora_stream_cdc_callbacks = {
+    .tx_ep_callback = lora_stream_tx_done,
+    .rx_ep_callback = NULL,
+    .state_callback = NULL,
+    .ctrl_line_callback = NULL,
+    .config_callback = NULL,
+};
+
+/* Send one USB packet, false if the computer did not take it in time */
+static bool lora_stream_write_chunk(uint8_t* data, uint16_t length) {
+    furi_thread_flags_clear(LoRaStreamFlagTxDone);
+    furi_hal_cdc_send(LORA_STREAM_CDC_CHANNEL, data, length);
+    uint32_t flags = furi_thread_flags_wait(
+        LoRaStreamFlagTxDone, FuriFlagWaitAny, furi_ms_to_ticks(LORA_STREAM_TX_TIMEOUT));
+    return !(flags & FuriFlagError);
+}
+
+/* Send one frame in USB packet sized chunks, false if the computer stopped reading */
+static bool lora_stream_write(uint8_t* data, size_t length) {
+    uint16_t chunk = 0;
+    while(length > 0) {
+        chunk = length > CDC_DATA_SZ ? CDC_DATA_SZ : length;
+        if(!lora_stream_write_chunk(data, chunk)) {
+            return false;
+        }
+        data += chunk;
+        length -= chunk;
+    }
+    // A full last packet does not end the transfer, the host waits for more until a zero
+    // length packet, as the CLI serial port sends
+    if(chunk == CDC_DATA_SZ) {
+        return lora_stream_write_chunk(data, 0);
+    }
+    return true;
+}
+
+static int32_t lora_stream_worker(void* context) {
+    LoRaStream* stream = context;
+    LoRaStreamItem* item = malloc(sizeof(LoRaStreamItem));
+
+    while(furi_message_queue_get(stream->queue, item, FURI_WAIT_FOREVER) == FuriStatusOk &&
+          item->length > 0) {
+        // Without DTR no terminal has the port open, nobody would read the frame
+        bool connected =
+            furi_hal_cdc_get_ctrl_line_state(LORA_STREAM_CDC_CHANNEL) & CdcCtrlLineDTR;
+        if(!connected || !lora_stream_write(item->data, item->length)) {
+            stream->dropped_usb++;
+        }
+    }
+
+    free(item);
+    return 0;
+}
+
+LoRaStream* lora_stream_alloc(void) {
+    LoRaStream* stream = malloc(sizeof(LoRaStream));
+    stream->sequence = 0;
+    stream->dropped_queue = 0;
+    stream->dropped_usb = 0;
+    stream->queue = furi_message_queue_alloc(LORA_STREAM_QUEUE_LEN, sizeof(LoRaStreamItem));
+
+    stream->usb_previous = furi_hal_usb_get_config();
+    furi_hal_usb_unlock();
+    if(!furi_hal_usb_set_config(&usb_cdc_dual, NULL)) {
+        FURI_LOG_E(TAG, "Cannot switch USB to two serial ports");
+    }
+
+    stream->thread = furi_thread_alloc_ex("LoRaStream", 1024, lora_stream_worker, stream);
+    furi_thread_start(stream->thread);
+    furi_hal_cdc_set_callbacks(LORA_STREAM_CDC_CHANNEL, &lora_stream_cdc_callbacks, stream);
+    return stream;
+}
+
+void lora_stream_free(LoRaStream* stream) {
+    // An empty item stops the worker once the queued frames are out
+    LoRaStreamItem* stop = malloc(sizeof(LoRaStreamItem));
+    stop->length = 0;
+    furi_message_queue_put(stream->queue, stop, FURI_WAIT_FOREVER);
+    free(stop);
+    furi_thread_join(stream->thread);
+    furi_thread_free(stream->thread);
+    furi_message_queue_free(stream->queue);
+
+    furi_hal_cdc_set_callbacks(LORA_STREAM_CDC_CHANNEL, NULL, NULL);
+    furi_hal_usb_set_config(stream->usb_previous, NULL);
+    free(stream);
+}
+
+bool lora_stream_send(
+    LoRaStream* stream,
+    LoRaFrameMeta* meta,
+    const uint8_t* payload,
+    size_t payload_len) {
+    LoRaStreamItem* item = &stream->item;
+    meta->sequence = stream->sequence++;
+    meta->dropped = lora_stream_get_dropped(stream);
+    item->length = lora_frame_encode(meta, payload, payload_len, item->data, sizeof(item->data));
+
+    bool queued = item->length > 0 &&
+                  furi_message_queue_put(stream->queue, item, 0) == FuriStatusOk;
+    if(!queued) {
+        stream->dropped_queue++;
+    }
+    return queued;
+}
+
+uint32_t lora_stream_get_dropped(const LoRaStream* stream) {
+    return stream->dropped_queue + stream->dropped_usb;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lora_frame.h"
+
+/**
+ * Streams captured packets over the second USB serial port, framed as described in
+ * lora_frame.h.  The CLI keeps the first port.  Packets are queued and sent by a worker
+ * thread, so the sniffer never waits for the computer; packets that do not fit in the queue,
+ * or that the computer does not read, are counted as dropped.
+*/
+typedef struct LoRaStream LoRaStream;
+
+/**
+ * @brief      Switch USB to two serial ports and start streaming.
+ * @return     The stream.
+*/
+LoRaStream* lora_stream_alloc(void);
+
+/**
+ * @brief      Stop streaming and give USB back its previous configuration.
+ * @param      stream  The stream.
+*/
+void lora_stream_free(LoRaStream* stream);
+
+/**
+ * @brief      Queue a captured packet, never blocks.
+ * @param      stream       The stream.
+ * @param      meta         The packet metadata, sequence and dropped are filled in here.
+ * @param      payload      The packet payload.
+ * @param      payload_len  Number of bytes in payload, at most 255.
+ * @return     false if the packet was dropped.
+*/
+bool lora_stream_send(
+    LoRaStream* stream,
+    LoRaFrameMeta* meta,
+    const uint8_t* payload,
+    size_t payload_len);
+
+/**
+ * @brief      Number of packets that could not be sent.
+ * @param      stream  The stream.
+ * @return     The dropped packets.
+*/
+uint32_t lora_stream_get_dropped(const LoRaStream* stream);
@@ -0,0 +1,87 @@
+#include "lora_trace.h"
+
+#include <furi.h>
+#include <furi_hal.h>
+#include <string.h>
+#include <storage/storage.h>
+
+// LORA_TRACE_SIZE must be a power of two for the index mask
+_Static_assert((LORA_TRACE_SIZE & (LORA_TRACE_SIZE - 1)) == 0, "LORA_TRACE_SIZE");
+_Static_assert(sizeof(LoRaTraceEntry) == 16, "LoRaTraceEntry is part of the dump format");
+
+/* The driver runs on the GUI thread and on the sniffer and replay workers, and the dump is
+written from the GUI thread.  Entries are only touched with interrupts off, which costs less
+than a mutex for a few stores and also keeps one thread from overwriting a half written entry.
+*/
+static LoRaTraceEntry lora_trace_ring[LORA_TRACE_SIZE];
+static uint32_t lora_trace_total; // Entries recorded since the last clear
+
+void lora_trace_record(uint8_t opcode, const uint8_t* data, size_t length) {
+    LoRaTraceEntry recorded = {
+        .opcode = opcode,
+        .length = length > 255 ? 255 : length,
+    };
+    memcpy(recorded.data, data, length < sizeof(recorded.data) ? length : sizeof(recorded.data));
+
+    FURI_CRITICAL_ENTER();
+    recorded.tick = furi_get_tick();
+    recorded.cycles = DWT->CYCCNT;
+    lora_trace_ring[lora_trace_total & (LORA_TRACE_SIZE - 1)] = recorded;
+    lora_trace_total++;
+    FURI_CRITICAL_EXIT();
+}
+
+uint32_t lora_trace_busy_begin(void) {
+    return DWT->CYCCNT;
+}
+
+void lora_trace_busy_end(uint32_t start) {
+    uint32_t us = (DWT->CYCCNT - start) / furi_hal_cortex_instructions_per_microsecond();
+
+    FURI_CRITICAL_ENTER();
+    if(lora_trace_total > 0) {
+        LoRaTraceEntry* entry = &lora_trace_ring[(lora_trace_total - 1) & (LORA_TRACE_SIZE - 1)];
+        entry->busy_us = us > UINT16_MAX ? UINT16_MAX : us;
+    }
+    FURI_CRITICAL_EXIT();
+}
+
+void lora_trace_clear(void) {
+    FURI_CRITICAL_ENTER();
+    lora_trace_total = 0;
+    FURI_CRITICAL_EXIT();
+}
+
+int32_t lora_trace_dump(const char* path) {
+    // Snapshot first, the radio keeps being used while the file is written
+    LoRaTraceEntry* entries = malloc(sizeof(LoRaTraceEntry) * LORA_TRACE_SIZE);
+    FURI_CRITICAL_ENTER();
+    uint32_t total = lora_trace_total;
+    uint32_t count = total < LORA_TRACE_SIZE ? total : LORA_TRACE_SIZE;
+    for(uint32_t i = 0; i < count; i++) {
+        entries[i] = lora_trace_ring[(total - count + i) & (LORA_TRACE_SIZE - 1)];
+    }
+    FURI_CRITICAL_EXIT();
+
+    LoRaTraceHeader header = {
+        .magic = LORA_TRACE_MAGIC,
+        .version = LORA_TRACE_VERSION,
+        .entry_size = sizeof(LoRaTraceEntry),
+        .count = count,
+        .dropped = total - count,
+        .cycles_per_us = furi_hal_cortex_instructions_per_microsecond(),
+    };
+    size_t entries_size = sizeof(LoRaTraceEntry) * count;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool written = storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+                   storage_file_write(file, &header, sizeof(header)) == sizeof(header) &&
+                   storage_file_write(file, entries, entries_size) == entries_size;
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    free(entries);
+    return written ? (int32_t)count : -1;
+}
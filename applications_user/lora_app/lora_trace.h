@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LORA_TRACE_SIZE    128 // Entries kept, a power of two
+#define LORA_TRACE_MAGIC   "LTRC"
+#define LORA_TRACE_VERSION 1
+
+/**
+ * One SPI transaction with the radio.  Recording one costs a few stores, so every transaction
+ * of the driver is traced instead of logged.  The functions below can be called from any thread.
+*/
+typedef struct {
+    uint32_t tick; // furi_get_tick when the transaction ended
+    uint32_t cycles; // Cycle counter at the same time, for spacing below one tick
+    uint16_t busy_us; // Time BUSY stayed high after the transaction, 0 if not waited for
+    uint8_t opcode;
+    uint8_t length; // Bytes after the opcode, 255 for 255 or more
+    uint8_t data[4]; // First parameters sent, or first bytes answered for reads
+} LoRaTraceEntry;
+
+/**
+ * Dump file layout, little endian:
+ *   LoRaTraceHeader
+ *   LoRaTraceEntry[count], oldest first
+*/
+typedef struct {
+    char magic[4]; // LORA_TRACE_MAGIC
+    uint16_t version; // LORA_TRACE_VERSION
+    uint16_t entry_size; // sizeof(LoRaTraceEntry)
+    uint32_t count; // Entries in the file
+    uint32_t dropped; // Older entries overwritten before the dump
+    uint32_t cycles_per_us; // To convert LoRaTraceEntry.cycles
+} LoRaTraceHeader;
+
+/**
+ * @brief      Record an SPI transaction.
+ * @param      opcode  The opcode of the command.
+ * @param      data    Parameters sent after the opcode, or bytes answered by the radio.
+ * @param      length  Number of bytes in data, only the first ones are kept.
+*/
+void lora_trace_record(uint8_t opcode, const uint8_t* data, size_t length);
+
+/**
+ * @brief      Start measuring a BUSY wait.
+ * @return     A value to pass to lora_trace_busy_end.
+*/
+uint32_t lora_trace_busy_begin(void);
+
+/**
+ * @brief      Add the BUSY wait to the last recorded transaction, the one that caused it.
+ * @param      start  The value returned by lora_trace_busy_begin.
+*/
+void lora_trace_busy_end(uint32_t start);
+
+/**
+ * @brief      Forget every recorded transaction.
+*/
+void lora_trace_clear(void);
+
+/**
+ * @brief      Write the recorded transactions to a file, see LoRaTraceHeader.
+ * @param      path  Path of the file, replaced if it exists.
+ * @return     Number of entries written, -1 if the file could not be written.
+*/
+int32_t lora_trace_dump(const char* path);
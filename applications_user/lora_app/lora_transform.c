@@ -0,0 +1,263 @@
+#include "lora_transform.h"
+
+#include <string.h>
+
+#include "lora_hex.h"
+
+#define LORA_TRANSFORM_DEFAULT_SEED 0x2545F491
+#define LORA_TRANSFORM_MAX_TOKENS   6
+
+typedef struct {
+    const char* ptr;
+    size_t len;
+} LoRaTransformToken;
+
+void lora_transform_clear(LoRaTransformPipeline* pipeline) {
+    memset(pipeline, 0, sizeof(LoRaTransformPipeline));
+    pipeline->seed = LORA_TRANSFORM_DEFAULT_SEED;
+    lora_transform_reset(pipeline);
+}
+
+void lora_transform_reset(LoRaTransformPipeline* pipeline) {
+    // xorshift gets stuck on zero
+    pipeline->rng = pipeline->seed ? pipeline->seed : LORA_TRANSFORM_DEFAULT_SEED;
+    pipeline->packet_index = 0;
+}
+
+static uint32_t lora_transform_random(LoRaTransformPipeline* pipeline) {
+    uint32_t x = pipeline->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    pipeline->rng = x;
+    return x;
+}
+
+static bool lora_transform_token_is(const LoRaTransformToken* token, const char* text) {
+    return strlen(text) == token->len && memcmp(token->ptr, text, token->len) == 0;
+}
+
+// Reads an optional '-' and a decimal or 0x prefixed number of up to 32 bits
+static bool lora_transform_parse_magnitude(
+    const LoRaTransformToken* token,
+    bool* negative,
+    uint32_t* magnitude) {
+    const char* text = token->ptr;
+    const char* end = text + token->len;
+    uint32_t base = 10;
+    uint32_t result = 0;
+
+    *negative = false;
+    if(text < end && *text == '-') {
+        *negative = true;
+        text++;
+    }
+    if(end - text > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text += 2;
+    }
+    if(text == end) {
+        return false;
+    }
+
+    for(; text < end; text++) {
+        uint32_t digit;
+        if(*text >= '0' && *text <= '9') {
+            digit = *text - '0';
+        } else if(base == 16 && *text >= 'a' && *text <= 'f') {
+            digit = *text - 'a' + 10;
+        } else if(base == 16 && *text >= 'A' && *text <= 'F') {
+            digit = *text - 'A' + 10;
+        } else {
+            return false;
+        }
+        if(result > (UINT32_MAX - digit) / base) {
+            return false; // Doesn't fit in 32 bits
+        }
+        result = result * base + digit;
+    }
+
+    *magnitude = result;
+    return true;
+}
+
+static bool lora_transform_parse_number(const LoRaTransformToken* token, int32_t* value) {
+    bool negative;
+    uint32_t magnitude;
+    if(!lora_transform_parse_magnitude(token, &negative, &magnitude) ||
+       magnitude > (negative ? (uint32_t)INT32_MAX + 1 : (uint32_t)INT32_MAX)) {
+        return false;
+    }
+    *value = negative ? (int32_t)(0 - magnitude) : (int32_t)magnitude;
+    return true;
+}
+
+static bool lora_transform_parse_byte(const LoRaTransformToken* token, uint8_t* value) {
+    int32_t number;
+    if(!lora_transform_parse_number(token, &number) || number < 0 || number > 255) {
+        return false;
+    }
+    *value = number;
+    return true;
+}
+
+bool lora_transform_parse_line(LoRaTransformPipeline* pipeline, const char* line, size_t length) {
+    LoRaTransformToken tokens[LORA_TRANSFORM_MAX_TOKENS];
+    size_t count = 0;
+    const char* end = line + length;
+
+    // Split on blanks
+    while(line < end) {
+        while(line < end && (*line == ' ' || *line == '\t' || *line == '\r')) {
+            line++;
+        }
+        if(line == end || *line == '#') break;
+        if(count == LORA_TRANSFORM_MAX_TOKENS) {
+            return false;
+        }
+        tokens[count].ptr = line;
+        while(line < end && *line != ' ' && *line != '\t' && *line != '\r') {
+            line++;
+        }
+        tokens[count].len = line - tokens[count].ptr;
+        count++;
+    }
+
+    if(count == 0) {
+        return true;
+    }
+
+    if(lora_transform_token_is(&tokens[0], "seed")) {
+        bool negative;
+        uint32_t seed;
+        if(count != 2 || !lora_transform_parse_magnitude(&tokens[1], &negative, &seed) ||
+           negative) {
+            return false;
+        }
+        pipeline->seed = seed;
+        lora_transform_reset(pipeline);
+        return true;
+    }
+
+    if(pipeline->count == LORA_TRANSFORM_MAX_STAGES) {
+        return false;
+    }
+
+    LoRaTransformStage stage;
+    memset(&stage, 0, sizeof(stage));
+
+    if(lora_transform_token_is(&tokens[0], "patch")) {
+        int32_t patch_length;
+        if(count != 3 || !lora_transform_parse_byte(&tokens[1], &stage.offset)) {
+            return false;
+        }
+        patch_length =
+            lora_hex_decode(tokens[2].ptr, tokens[2].len, stage.data, sizeof(stage.data));
+        if(patch_length <= 0) {
+            return false;
+        }
+        stage.type = LoRaTransformPatch;
+        stage.length = patch_length;
+    } else if(lora_transform_token_is(&tokens[0], "counter")) {
+        if(count < 4 || count > 5 || !lora_transform_parse_byte(&tokens[1], &stage.offset) ||
+           !lora_transform_parse_byte(&tokens[2], &stage.length) || stage.length < 1 ||
+           stage.length > 4 || !lora_transform_parse_number(&tokens[3], &stage.delta)) {
+            return false;
+        }
+        if(count == 5 && !lora_transform_parse_number(&tokens[4], &stage.step)) {
+            return false;
+        }
+        stage.type = LoRaTransformCounter;
+    } else if(
+        lora_transform_token_is(&tokens[0], "mutate-bytes") ||
+        lora_transform_token_is(&tokens[0], "mutate-bits")) {
+        if(count < 2 || count > 3 || !lora_transform_parse_byte(&tokens[1], &stage.length)) {
+            return false;
+        }
+        if(count == 3 && !lora_transform_parse_byte(&tokens[2], &stage.offset)) {
+            return false;
+        }
+        stage.type = tokens[0].len == strlen("mutate-bits") ? LoRaTransformMutateBits :
+                                                              LoRaTransformMutateBytes;
+    } else if(lora_transform_token_is(&tokens[0], "truncate")) {
+        if(count != 2 || !lora_transform_parse_byte(&tokens[1], &stage.length)) {
+            return false;
+        }
+        stage.type = LoRaTransformTruncate;
+    } else {
+        return false;
+    }
+
+    pipeline->stages[pipeline->count++] = stage;
+    return true;
+}
+
+static void lora_transform_counter(
+    const LoRaTransformStage* stage,
+    uint32_t packet_index,
+    uint8_t* data,
+    size_t length) {
+    if(stage->offset + stage->length > length) {
+        return; // Counter doesn't fit in this packet
+    }
+
+    uint8_t* field = data + stage->offset;
+    uint32_t value = 0;
+    for(uint8_t i = 0; i < stage->length; i++) {
+        value |= (uint32_t)field[i] << (8 * i);
+    }
+
+    value += (uint32_t)stage->delta + (uint32_t)stage->step * packet_index;
+
+    // Wraps around within the counter width, like the counter on the device would
+    for(uint8_t i = 0; i < stage->length; i++) {
+        field[i] = value >> (8 * i);
+    }
+}
+
+size_t lora_transform_apply(LoRaTransformPipeline* pipeline, uint8_t* data, size_t length) {
+    for(uint8_t i = 0; i < pipeline->count; i++) {
+        const LoRaTransformStage* stage = &pipeline->stages[i];
+
+        switch(stage->type) {
+        case LoRaTransformPatch:
+            if(stage->offset < length) {
+                size_t patch_length = length - stage->offset;
+                if(patch_length > stage->length) {
+                    patch_length = stage->length;
+                }
+                memcpy(data + stage->offset, stage->data, patch_length);
+            }
+            break;
+        case LoRaTransformCounter:
+            lora_transform_counter(stage, pipeline->packet_index, data, length);
+            break;
+        case LoRaTransformMutateBytes:
+            if(stage->offset < length) {
+                size_t span = length - stage->offset;
+                for(uint8_t n = 0; n < stage->length; n++) {
+                    uint32_t random = lora_transform_random(pipeline);
+                    data[stage->offset + (random >> 8) % span] = random & 0xFF;
+                }
+            }
+            break;
+        case LoRaTransformMutateBits:
+            if(stage->offset < length) {
+                size_t span = (length - stage->offset) * 8;
+                for(uint8_t n = 0; n < stage->length; n++) {
+                    uint32_t bit = lora_transform_random(pipeline) % span;
+                    data[stage->offset + bit / 8] ^= 1 << (bit % 8);
+                }
+            }
+            break;
+        case LoRaTransformTruncate:
+            if(length > stage->length) {
+                length = stage->length;
+            }
+            break;
+        }
+    }
+
+    pipeline->packet_index++;
+    return length;
+}
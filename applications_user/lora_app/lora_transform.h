@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LORA_TRANSFORM_MAX_STAGES 8
+#define LORA_TRANSFORM_PATCH_MAX  16
+
+typedef enum {
+    LoRaTransformPatch, // Overwrite bytes at an offset
+    LoRaTransformCounter, // Add to a little-endian counter at an offset
+    LoRaTransformMutateBytes, // Replace random bytes with random values
+    LoRaTransformMutateBits, // Flip random bits
+    LoRaTransformTruncate, // Cut the payload to a maximum length
+} LoRaTransformType;
+
+typedef struct {
+    LoRaTransformType type;
+    uint8_t offset; // First byte the stage touches
+    uint8_t length; // Patch length, counter width (1-4), mutation count or truncate length
+    int32_t delta; // Counter: added to every packet
+    int32_t step; // Counter: added once more for every packet already sent
+    uint8_t data[LORA_TRANSFORM_PATCH_MAX]; // Patch: bytes to write
+} LoRaTransformStage;
+
+/**
+ * Per-packet payload transforms for replay.  Stages run in order, in place on the decoded
+ * payload.  Random stages draw from a xorshift generator seeded by the pipeline seed, so the
+ * same seed and capture always produce the same packets.
+*/
+typedef struct {
+    LoRaTransformStage stages[LORA_TRANSFORM_MAX_STAGES];
+    uint8_t count;
+    uint32_t seed;
+
+    uint32_t rng; // Generator state
+    uint32_t packet_index; // Packets transformed since the last reset
+} LoRaTransformPipeline;
+
+/**
+ * @brief      Remove all stages and set the default seed.
+ * @param      pipeline  The pipeline.
+*/
+void lora_transform_clear(LoRaTransformPipeline* pipeline);
+
+/**
+ * @brief      Rewind the pipeline to its first packet, keeps the stages.
+ * @param      pipeline  The pipeline.
+*/
+void lora_transform_reset(LoRaTransformPipeline* pipeline);
+
+/**
+ * @brief      Add a stage described by one line of text.
+ * @details    Lines look like:
+ *              seed <n>
+ *              patch <offset> <hex bytes>
+ *              counter <offset> <width> <delta> [step]
+ *              mutate-bytes <count> [offset]
+ *              mutate-bits <count> [offset]
+ *              truncate <length>
+ *            Numbers are decimal or 0x prefixed hex and must fit in an int32_t, the seed in a
+ *            uint32_t.  Blank lines and lines starting with '#' are accepted and ignored.
+ * @param      pipeline  The pipeline.
+ * @param      line      The line, does not need to be NULL terminated.
+ * @param      length    Number of characters in line.
+ * @return     false if the line is malformed or the pipeline is full.
+*/
+bool lora_transform_parse_line(LoRaTransformPipeline* pipeline, const char* line, size_t length);
+
+/**
+ * @brief      Run every stage on a payload.
+ * @param      pipeline  The pipeline.
+ * @param      data      The payload, modified in place.
+ * @param      length    Length of the payload.
+ * @return     New length of the payload, never more than length.
+*/
+size_t lora_transform_apply(LoRaTransformPipeline* pipeline, uint8_t* data, size_t length);
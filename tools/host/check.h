@@ -0,0 +1,61 @@
+#pragma once
+
+/*
+What the checks and benchmarks of tools/ share: the CHECK macro, a seeded random generator, a
+clock and the -n/-s options.  Included as "host/check.h" from tools/, no extra -I is needed.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Stop the program with the failed condition and where it is
+#define CHECK(condition)                                                               \
+    do {                                                                               \
+        if(!(condition)) {                                                             \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                   \
+        }                                                                              \
+    } while(0)
+
+static uint64_t rng_state = 1;
+
+// xorshift64*, repeatable from the seed on every platform
+static inline uint32_t rng(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (rng_state * 0x2545F4914F6CDD1DULL) >> 32;
+}
+
+// 0 would keep xorshift at 0 forever, it seeds like 1
+static inline void rng_seed(unsigned long seed) {
+    rng_state = seed ? seed : 1;
+}
+
+// Monotonic time, for benchmarks
+static inline double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+Handle an option every tool reads the same way, inside its getopt loop: -n sets count (iterations
+or packets) and -s seeds rng.  Returns false for the tool's own options.
+*/
+static inline bool check_option(int option, unsigned long* count) {
+    switch(option) {
+    case 'n':
+        *count = strtoul(optarg, NULL, 10);
+        return true;
+    case 's':
+        rng_seed(strtoul(optarg, NULL, 10));
+        return true;
+    default:
+        return false;
+    }
+}
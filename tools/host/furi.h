@@ -0,0 +1,29 @@
+#pragma once
+
+/*
+The part of furi.h used by the radio driver, lora.c, so it can be built on a computer against
+the simulated radio of tools/lora_hal_sim.c.  Time is the simulated clock of the radio model,
+a delay moves it forward and lets the radio run.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+#define UNUSED(x)   (void)(x)
+
+uint32_t furi_get_tick(void);
+uint32_t furi_ms_to_ticks(uint32_t milliseconds);
+void furi_delay_ms(uint32_t milliseconds);
+
+// Printed with -v, the format is not checked since the driver uses %lu for uint32_t
+void lora_sim_log(char level, const char* tag, const char* format, ...);
+
+#define FURI_LOG_E(tag, ...) lora_sim_log('E', tag, __VA_ARGS__)
+#define FURI_LOG_W(tag, ...) lora_sim_log('W', tag, __VA_ARGS__)
+#define FURI_LOG_I(tag, ...) lora_sim_log('I', tag, __VA_ARGS__)
+#define FURI_LOG_D(tag, ...) lora_sim_log('D', tag, __VA_ARGS__)
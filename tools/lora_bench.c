@@ -0,0 +1,245 @@
+/*
+Benchmark of the app's hot paths on a computer, with a regression threshold.
+
+Covers the frequency to PLL conversion of the driver (every retune), the payload hex codec,
+formatting a capture log line (every sniffed packet) and parsing one back (replay and the log
+reader), and the packet history ring of the sniffer.  Each benchmark runs its loop several times
+and keeps the fastest run, which is the number least disturbed by the rest of the computer.  It
+is printed in ns per operation and bytes per second of the data handled.
+
+Every benchmark has a limit in ns per operation, about ten times what an -O2 build takes on a
+current laptop.  Going over it means a change made the path much slower, the program then fails.
+Use -f to scale the limits for slower computers or sanitizer builds.
+
+Build from the repository root:
+    cc -O2 -Itools/host -Iapplications_user/lora_app -o lora_bench tools/lora_bench.c \
+        tools/lora_hal_sim.c applications_user/lora_app/lora.c \
+        applications_user/lora_app/lora_hex.c applications_user/lora_app/lora_record.c \
+        applications_user/lora_app/lora_lorawan.c applications_user/lora_app/lora_history.c -lm
+A sanitizer build (-fsanitize=address,undefined -g) needs about -f 10.
+
+Usage:
+    lora_bench [-n iterations] [-r runs] [-f limit factor]
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host/check.h"
+#include "lora_hex.h"
+#include "lora_history.h"
+#include "lora_notify.h"
+#include "lora_record.h"
+#include "lora_trace.h"
+
+#define PAYLOAD_LEN     51 // A typical LoRaWAN uplink
+#define HEX_LEN         255 // Longest payload
+#define FREQUENCIES_LEN 64
+
+uint32_t frequencyToPLL(long rfFreq);
+
+// lora.c is linked for frequencyToPLL, these are the app modules it calls
+void lora_notify_post(LoRaNotifyEvent event) {
+    (void)event;
+}
+
+void lora_trace_record(uint8_t opcode, const uint8_t* data, size_t length) {
+    (void)opcode;
+    (void)data;
+    (void)length;
+}
+
+uint32_t lora_trace_busy_begin(void) {
+    return 0;
+}
+
+void lora_trace_busy_end(uint32_t start) {
+    (void)start;
+}
+
+typedef struct {
+    const char* name;
+    double limit_ns; // Per operation
+    size_t (*run)(unsigned long iterations); // Returns the bytes handled, 0 if not about bytes
+} Bench;
+
+static long frequencies[FREQUENCIES_LEN];
+static uint8_t payload[HEX_LEN];
+static char hex[LORA_HEX_ENCODED_LEN(HEX_LEN) + 1];
+static LoRaWANFrame frame;
+static LoRaRecordPacket packet;
+static char line[LORA_RECORD_LINE_MAX];
+static size_t line_len;
+static LoRaHistory history;
+static volatile uint32_t sink; // Keeps the results from being optimised away
+
+static void setup(void) {
+    for(size_t i = 0; i < FREQUENCIES_LEN; i++) {
+        frequencies[i] = 150000000 + rng() % (960000000 - 150000000 + 1);
+    }
+    for(size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = rng();
+    }
+    lora_hex_encode(payload, sizeof(payload), hex, sizeof(hex));
+
+    // An Unconfirmed Data Up with FPort, the most common line of a LoRaWAN capture
+    payload[0] = 0x40;
+    payload[5] = 0x00;
+    if(!lora_lorawan_decode(payload, PAYLOAD_LEN, &frame)) {
+        fprintf(stderr, "benchmark payload is not LoRaWAN\n");
+        exit(1);
+    }
+    packet = (LoRaRecordPacket){
+        .year = 2024,
+        .month = 5,
+        .day = 1,
+        .hour = 12,
+        .minute = 0,
+        .second = 3,
+        .frequency = "868.1",
+        .bw = "125 kHz",
+        .sf = "SF8",
+        .rssi = -71,
+        .payload = payload,
+        .payload_len = PAYLOAD_LEN,
+        .lorawan = &frame,
+    };
+    line_len = lora_record_format(&packet, line, sizeof(line));
+    lora_history_reset(&history);
+}
+
+static size_t run_pll(unsigned long iterations) {
+    for(unsigned long n = 0; n < iterations; n++) {
+        sink += frequencyToPLL(frequencies[n % FREQUENCIES_LEN]);
+    }
+    return 0;
+}
+
+static size_t run_hex_encode(unsigned long iterations) {
+    static char out[sizeof(hex)];
+    size_t bytes = 0;
+    for(unsigned long n = 0; n < iterations; n++) {
+        lora_hex_encode(payload, HEX_LEN, out, sizeof(out));
+        sink += out[n % HEX_LEN];
+        bytes += HEX_LEN;
+    }
+    return bytes;
+}
+
+static size_t run_hex_decode(unsigned long iterations) {
+    static uint8_t out[HEX_LEN];
+    size_t bytes = 0;
+    for(unsigned long n = 0; n < iterations; n++) {
+        bytes += lora_hex_decode(hex, HEX_LEN * 2, out, sizeof(out)) * 2;
+        sink += out[n % HEX_LEN];
+    }
+    return bytes;
+}
+
+static size_t run_record_format(unsigned long iterations) {
+    static char out[LORA_RECORD_LINE_MAX];
+    size_t bytes = 0;
+    for(unsigned long n = 0; n < iterations; n++) {
+        packet.rssi = -(int16_t)(n & 0x7F);
+        bytes += lora_record_format(&packet, out, sizeof(out));
+    }
+    return bytes;
+}
+
+static size_t run_record_parse(unsigned long iterations) {
+    LoRaRecord record;
+    for(unsigned long n = 0; n < iterations; n++) {
+        sink += lora_record_parse(line, line_len, &record);
+        sink += record.payload.len;
+    }
+    return line_len * iterations;
+}
+
+static size_t run_history(unsigned long iterations) {
+    LoRaHistoryEntry meta = {.frequency = 868100000, .rssi = -71, .sf = 8};
+    const uint8_t* kept;
+    for(unsigned long n = 0; n < iterations; n++) {
+        meta.tick = n;
+        lora_history_push(&history, &meta, payload, PAYLOAD_LEN);
+        sink += lora_history_get(&history, n % LORA_HISTORY_LEN, &kept)->length;
+    }
+    return PAYLOAD_LEN * iterations;
+}
+
+static const Bench benches[] = {
+    {"frequencyToPLL", 50, run_pll},
+    {"hex encode 255 B", 3000, run_hex_encode},
+    {"hex decode 510 chars", 4000, run_hex_decode},
+    {"record format", 2000, run_record_format},
+    {"record parse", 3500, run_record_parse},
+    {"history push + get", 700, run_history},
+};
+
+int main(int argc, char** argv) {
+    unsigned long iterations = 200000;
+    unsigned long runs = 5;
+    double factor = 1.0;
+    int option;
+
+    while((option = getopt(argc, argv, "n:r:f:")) != -1) {
+        if(check_option(option, &iterations)) {
+            continue;
+        }
+        switch(option) {
+        case 'r':
+            runs = strtoul(optarg, NULL, 10);
+            break;
+        case 'f':
+            factor = strtod(optarg, NULL);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n iterations] [-r runs] [-f limit factor]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(iterations == 0) {
+        iterations = 1;
+    }
+    if(runs == 0) {
+        runs = 1;
+    }
+
+    setup();
+
+    int failed = 0;
+    for(size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+        const Bench* bench = &benches[b];
+        double best_ns = 0;
+        size_t bytes = 0;
+        for(unsigned long r = 0; r < runs; r++) {
+            double start = now_ns();
+            bytes = bench->run(iterations);
+            double elapsed = now_ns() - start;
+            if(r == 0 || elapsed < best_ns) {
+                best_ns = elapsed;
+            }
+        }
+
+        double op_ns = best_ns / iterations;
+        double limit_ns = bench->limit_ns * factor;
+        char rate[32] = "-";
+        if(bytes) {
+            snprintf(rate, sizeof(rate), "%.1f MB/s", bytes / best_ns * 1e3);
+        }
+        printf(
+            "bench: %-22s %9.1f ns/op  %13s  limit %6.0f ns%s\n",
+            bench->name,
+            op_ns,
+            rate,
+            limit_ns,
+            op_ns > limit_ns ? "  REGRESSION" : "");
+        failed |= op_ns > limit_ns;
+    }
+
+    return failed;
+}
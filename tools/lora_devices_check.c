@@ -0,0 +1,288 @@
+/*
+Checks the LoRaWAN device table of the app, lora_devices.c, on a computer: collisions and probe
+runs that wrap around the end of the slots, least recently seen eviction, FCnt gap counting and
+ordering, then random traffic compared against a plain list, and the time of an update.
+
+Build from the repository root:
+    cc -O2 -Iapplications_user/lora_app -o lora_devices_check tools/lora_devices_check.c \
+        applications_user/lora_app/lora_devices.c applications_user/lora_app/lora_lorawan.c
+Add -fsanitize=address,undefined -g for the checks.
+
+Usage:
+    lora_devices_check [-n iterations] [-s seed]
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host/check.h"
+#include "lora_devices.h"
+
+static LoRaDevices table;
+static LoRaDevice* send(uint32_t dev_addr, LoRaWANMType mtype, uint16_t fcnt, int16_t rssi) {
+    static uint32_t tick;
+    LoRaWANFrame frame = {.mtype = mtype, .dev_addr = dev_addr, .fcnt = fcnt};
+    LoRaHistoryEntry meta = {
+        .tick = ++tick,
+        .frequency = 868100000 + (fcnt % 3) * 200000,
+        .rssi = rssi,
+        .snr = 7,
+        .sf = 7 + fcnt % 2,
+    };
+    return lora_devices_update(&table, &frame, &meta);
+}
+
+static LoRaDevice* uplink(uint32_t dev_addr, uint16_t fcnt) {
+    return send(dev_addr, LoRaWANMTypeUnconfirmedUp, fcnt, -80);
+}
+
+// Slot an address takes in an empty table, its home slot
+static int home_slot(uint32_t dev_addr) {
+    lora_devices_reset(&table);
+    uplink(dev_addr, 0);
+    for(int slot = 0; slot < LORA_DEVICES_SLOTS; slot++) {
+        if(table.slots[slot] != LORA_DEVICES_NONE) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+// Every device is found again, slots and devices match one to one
+static void check_table(void) {
+    size_t used = 0;
+    for(int slot = 0; slot < LORA_DEVICES_SLOTS; slot++) {
+        uint16_t index = table.slots[slot];
+        if(index == LORA_DEVICES_NONE) {
+            continue;
+        }
+        used++;
+        CHECK(index < table.count);
+        CHECK(lora_devices_find(&table, table.devices[index].dev_addr) == &table.devices[index]);
+    }
+    CHECK(used == table.count);
+
+    size_t listed = 0;
+    uint16_t newer = LORA_DEVICES_NONE;
+    for(uint16_t index = table.newest; index != LORA_DEVICES_NONE;
+        index = table.devices[index].older) {
+        CHECK(table.devices[index].newer == newer);
+        newer = index;
+        CHECK(++listed <= table.count);
+    }
+    CHECK(listed == table.count && table.oldest == newer);
+}
+
+static void check_collisions(void) {
+    // Addresses sharing a home slot, and addresses homed at the last slot so runs wrap around
+    uint32_t same[8];
+    uint32_t last[4];
+    size_t same_count = 0;
+    size_t last_count = 0;
+    int target = home_slot(0x26011BDA);
+
+    for(uint32_t dev_addr = 1; same_count < 8 || last_count < 4; dev_addr++) {
+        int slot = home_slot(dev_addr);
+        if(slot == target && same_count < 8) {
+            same[same_count++] = dev_addr;
+        } else if(slot == LORA_DEVICES_SLOTS - 1 && last_count < 4) {
+            last[last_count++] = dev_addr;
+        }
+    }
+
+    lora_devices_reset(&table);
+    for(size_t i = 0; i < 8; i++) {
+        uplink(same[i], i);
+    }
+    for(size_t i = 0; i < 4; i++) {
+        uplink(last[i], i);
+    }
+    check_table();
+    for(size_t i = 0; i < 8; i++) {
+        CHECK(table.slots[(target + i) % LORA_DEVICES_SLOTS] != LORA_DEVICES_NONE);
+    }
+    for(size_t i = 1; i < 4; i++) {
+        CHECK(table.slots[i - 1] != LORA_DEVICES_NONE); // Wrapped to the start of the slots
+    }
+
+    // Fill the table, every colliding device is evicted in turn as the oldest
+    for(uint32_t i = 0; table.count < LORA_DEVICES_MAX; i++) {
+        uplink(0x01000000 + i, 0);
+    }
+    check_table();
+    for(size_t i = 0; i < 8; i++) {
+        uplink(0x02000000 + i, 0);
+        CHECK(lora_devices_find(&table, same[i]) == NULL);
+        check_table();
+        for(size_t j = i + 1; j < 8; j++) {
+            CHECK(lora_devices_find(&table, same[j]) != NULL); // Moved back, still found
+        }
+        for(size_t j = 0; j < 4; j++) {
+            CHECK(lora_devices_find(&table, last[j]) != NULL);
+        }
+    }
+    printf("ok   collisions: 8 devices on slot %d, 4 wrapping from slot %d\n", target,
+           LORA_DEVICES_SLOTS - 1);
+}
+
+static void check_eviction(void) {
+    lora_devices_reset(&table);
+    for(uint32_t i = 0; i < LORA_DEVICES_MAX; i++) {
+        uplink(i, 0);
+    }
+    uplink(0, 1); // 0 is now the most recent, 1 the least
+    uplink(1000, 0);
+    CHECK(table.count == LORA_DEVICES_MAX && table.evicted == 1);
+    CHECK(lora_devices_find(&table, 0) && !lora_devices_find(&table, 1));
+    send(2, LoRaWANMTypeConfirmedDown, 0, -40); // Downlinks count as activity too
+    uplink(1001, 0);
+    CHECK(lora_devices_find(&table, 2) && !lora_devices_find(&table, 3));
+    check_table();
+    printf("ok   eviction of the least recently seen device\n");
+}
+
+static void check_fcnt(void) {
+    lora_devices_reset(&table);
+    uplink(7, 1);
+    uplink(7, 2);
+    uplink(7, 2); // Retransmission
+    LoRaDevice* device = uplink(7, 5);
+    CHECK(device->uplinks == 4 && device->fcnt_lost == 2 && device->fcnt_resets == 0);
+    send(7, LoRaWANMTypeUnconfirmedDown, 900, -30); // Own counter, not an uplink
+    CHECK(device->downlinks == 1 && device->fcnt == 5 && device->rssi_max == -80);
+    uplink(7, 0x7000);
+    CHECK(device->fcnt_lost == 2 + 0x7000 - 6 && device->fcnt_resets == 0);
+    uplink(7, 3); // Counter restarted
+    CHECK(device->fcnt_resets == 1 && device->fcnt == 3 && device->fcnt_lost == 0x7000 - 4);
+    LoRaDevice* wrapped = uplink(8, 65534);
+    uplink(8, 1); // The 16 bits on air wrap, 65535 and 0 are missing
+    CHECK(wrapped->fcnt_lost == 2 && wrapped->fcnt_resets == 0);
+    CHECK(device->sf_uplinks[7 - 5] + device->sf_uplinks[8 - 5] == device->uplinks);
+    CHECK(
+        (uint32_t)(device->channel_uplinks[0] + device->channel_uplinks[1] +
+                   device->channel_uplinks[2]) == device->uplinks);
+    printf("ok   FCnt gaps, retransmissions, wraps and restarts\n");
+}
+
+static void check_sort(void) {
+    static uint16_t order[LORA_DEVICES_MAX];
+    lora_devices_reset(&table);
+    for(uint32_t i = 0; i < 50; i++) {
+        uint32_t dev_addr = rng();
+        for(uint32_t n = rng() % 5; n < 5; n++) {
+            send(dev_addr, LoRaWANMTypeConfirmedUp, n * (1 + rng() % 3), -120 + rng() % 90);
+        }
+    }
+    for(int sort = 0; sort < LoRaDevicesSortCount; sort++) {
+        size_t count = lora_devices_sort(&table, sort, order);
+        CHECK(count == table.count);
+        for(size_t i = 1; i < count; i++) {
+            const LoRaDevice* a = &table.devices[order[i - 1]];
+            const LoRaDevice* b = &table.devices[order[i]];
+            switch(sort) {
+            case LoRaDevicesSortRecent:
+                CHECK(a->last_seen > b->last_seen);
+                break;
+            case LoRaDevicesSortUplinks:
+                CHECK(a->uplinks >= b->uplinks);
+                break;
+            case LoRaDevicesSortRssi:
+                CHECK(lora_devices_rssi_average(a) >= lora_devices_rssi_average(b));
+                break;
+            case LoRaDevicesSortLost:
+                CHECK(a->fcnt_lost >= b->fcnt_lost);
+                break;
+            case LoRaDevicesSortAddress:
+                CHECK(a->dev_addr < b->dev_addr);
+                break;
+            }
+        }
+    }
+    printf("ok   orders\n");
+}
+
+// Random traffic against a plain list ordered from the most recent device
+static void check_random(unsigned long iterations) {
+    static uint32_t reference[LORA_DEVICES_MAX];
+    static uint32_t uplinks[LORA_DEVICES_MAX];
+    size_t count = 0;
+
+    lora_devices_reset(&table);
+    for(unsigned long n = 0; n < iterations; n++) {
+        // Few addresses, with the same top bits as one network, so evictions are frequent
+        uint32_t dev_addr = 0x26000000 | rng() % (rng() % 2 ? 64 : 600);
+        bool down = rng() % 8 == 0;
+        send(dev_addr, down ? LoRaWANMTypeUnconfirmedDown : LoRaWANMTypeUnconfirmedUp, n, -90);
+
+        size_t i = 0;
+        while(i < count && reference[i] != dev_addr) {
+            i++;
+        }
+        uint32_t kept = 0;
+        if(i == count) {
+            if(count == LORA_DEVICES_MAX) {
+                i = --count;
+            }
+            count++;
+        } else {
+            kept = uplinks[i];
+        }
+        memmove(&reference[1], &reference[0], i * sizeof(reference[0]));
+        memmove(&uplinks[1], &uplinks[0], i * sizeof(uplinks[0]));
+        reference[0] = dev_addr;
+        uplinks[0] = kept + !down;
+
+        if(n % 97 == 0 || n + 1 == iterations) {
+            check_table();
+            CHECK(table.count == count);
+            uint16_t index = table.newest;
+            for(size_t j = 0; j < count; j++, index = table.devices[index].older) {
+                CHECK(table.devices[index].dev_addr == reference[j]);
+                CHECK(table.devices[index].uplinks == uplinks[j]);
+            }
+        }
+    }
+    printf("ok   %lu random packets, %lu evictions\n", iterations, (unsigned long)table.evicted);
+}
+
+static void bench(unsigned long iterations) {
+    volatile uint32_t sink = 0;
+    lora_devices_reset(&table);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(unsigned long n = 0; n < iterations; n++) {
+        sink += uplink(0x26000000 | rng() % 384, n)->uplinks;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ns = ((end.tv_sec - start.tv_sec) * 1e9 + end.tv_nsec - start.tv_nsec) / iterations;
+    (void)sink;
+    printf("bench: %.1f ns per update, %u devices kept of 384 sending\n", ns, table.count);
+}
+
+int main(int argc, char** argv) {
+    unsigned long iterations = 200000;
+    int option;
+
+    while((option = getopt(argc, argv, "n:s:")) != -1) {
+        if(!check_option(option, &iterations)) {
+            fprintf(stderr, "usage: %s [-n iterations] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(iterations == 0) {
+        iterations = 1;
+    }
+    check_collisions();
+    check_eviction();
+    check_fcnt();
+    check_sort();
+    check_random(iterations);
+    bench(iterations * 10);
+    return 0;
+}
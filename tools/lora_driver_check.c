@@ -0,0 +1,440 @@
+/*
+Runs the SX1262 driver of the app, lora.c, on a computer against the simulated radio of
+tools/lora_hal_sim.c.
+
+Each check starts from a powered off radio and goes through the driver's public functions:
+startup with and without a preloaded configuration, retuning, receiving scripted packets,
+transmitting, the time on air against the radio's own, and the watchdog bringing back a radio
+that stopped answering.  The radio model reports anything the driver does wrong on the wire,
+a single report fails the check.
+
+Build from the repository root:
+    cc -O2 -Itools/host -Iapplications_user/lora_app -o lora_driver_check \
+        tools/lora_driver_check.c tools/lora_hal_sim.c applications_user/lora_app/lora.c -lm
+Add -fsanitize=address,undefined -g for the checks.
+
+Usage:
+    lora_driver_check [-v]
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "furi.h"
+#include "host/check.h"
+#include "lora_hal.h"
+#include "lora_hal_sim.h"
+#include "lora_notify.h"
+#include "lora_trace.h"
+
+// The driver has no header, the app declares what it uses the same way
+extern bool inReceiveMode;
+bool begin();
+void end();
+bool configPreload(long frequencyInHz, int bw, int sf, int cr, uint16_t sw);
+bool configPreloadTxPower(int power, int ramp);
+void configPreloadPacketParams(
+    uint16_t preamble,
+    uint8_t headerType,
+    uint8_t payloadLength,
+    uint8_t crc,
+    uint8_t invertIQ);
+bool configApply(long frequencyInHz, int bw, int sf, int cr, uint16_t sw);
+bool configSetChannel(long frequencyInHz, int bw, int sf);
+void setPacketParams(
+    uint16_t packetParam1,
+    uint8_t packetParam2,
+    uint8_t packetParam3,
+    uint8_t packetParam4,
+    uint8_t packetParam5);
+void setModeReceive();
+int lora_receive_async(uint8_t* buff, int buffMaxLen);
+void transmit(uint8_t* data, int dataLen);
+uint32_t getTimeOnAir(uint8_t payloadLen);
+uint32_t getFrequency();
+uint32_t getFreqInt();
+int16_t getRSSI();
+int8_t getSNR();
+bool radioWatchdog(uint32_t* outageMs);
+uint32_t getRadioOutages();
+
+static const uint8_t bandwidths[] = {0x00, 0x08, 0x01, 0x09, 0x02, 0x0A, 0x03, 0x04, 0x05, 0x06};
+
+static uint32_t notified[LoRaNotifyEventCount];
+
+void lora_notify_post(LoRaNotifyEvent event) {
+    notified[event]++;
+}
+
+// Last traced transaction per opcode, copied like lora_trace.c so a short read shows with ASan
+static uint8_t traced[256][4];
+static size_t traced_length[256];
+
+void lora_trace_record(uint8_t opcode, const uint8_t* data, size_t length) {
+    memset(traced[opcode], 0, sizeof(traced[opcode]));
+    memcpy(traced[opcode], data, length < 4 ? length : 4);
+    traced_length[opcode] = length;
+}
+
+uint32_t lora_trace_busy_begin(void) {
+    return 0;
+}
+
+void lora_trace_busy_end(uint32_t start) {
+    UNUSED(start);
+}
+
+// A radio that was never powered, and an app that was just loaded
+static void power_on(void) {
+    lora_sim_power_on();
+    inReceiveMode = false;
+    memset(notified, 0, sizeof(notified));
+}
+
+// WriteBuffer and ReadBuffer keep the payload, zero padded, and count the bytes before it
+static bool traced_payload(uint8_t opcode, const uint8_t* payload, size_t length, size_t header) {
+    uint8_t expected[4] = {0};
+    memcpy(expected, payload, length < sizeof(expected) ? length : sizeof(expected));
+    return traced_length[opcode] == length + header &&
+           memcmp(traced[opcode], expected, sizeof(expected)) == 0;
+}
+
+// The PLL steps are just under 1 Hz
+static bool tuned_to(uint32_t frequency) {
+    return abs((int32_t)(lora_sim_frequency() - frequency)) <= 1;
+}
+
+// Poll like the sniffer does until a packet is read, -1 if none came before the timeout
+static int receive(uint8_t* buffer, int size, uint32_t timeout_ms) {
+    uint32_t deadline = furi_get_tick() + timeout_ms;
+    int length;
+    while((length = lora_receive_async(buffer, size)) < 0 && furi_get_tick() < deadline) {
+        lora_hal_wait_dio1(deadline - furi_get_tick());
+    }
+    return length;
+}
+
+static void check_begin(void) {
+    power_on();
+    CHECK(begin());
+
+    CHECK(lora_sim.resets == 1 && lora_sim.packet_type == 0x01 && lora_sim.dio2_rf_switch);
+    CHECK(tuned_to(915000000) && getFrequency() == 915000000);
+    uint32_t read_back = getFreqInt();
+    CHECK(read_back > 914999000 && read_back < 915001000);
+    CHECK(lora_sim.sf == 8 && lora_sim.bw == 0x04 && lora_sim.cr == 1 && lora_sim.ldro == 0);
+    CHECK(lora_sim.irq_mask == 0x0003 && lora_sim.dio1_mask == 0xFFFF);
+    CHECK(lora_sim.pa_config[0] == 0x04 && lora_sim.pa_config[1] == 0x07);
+    CHECK(lora_sim.tx_power == 22 && lora_sim.ramp_time == 0x02);
+    CHECK(lora_sim.registers[0x0740] == 0x14 && lora_sim.registers[0x0741] == 0x24);
+    CHECK(notified[LoRaNotifyEventRadio] == 1);
+    CHECK(lora_sim.errors == 0);
+
+    printf(
+        "ok   begin: %lu commands in %.1f ms\n",
+        (unsigned long)lora_sim.commands_total,
+        lora_sim.now_us / 1000.0);
+    end();
+
+    // Without a radio the sanity check fails and nothing else is sent
+    power_on();
+    lora_sim.spi_broken = true;
+    CHECK(!begin());
+    CHECK(lora_sim.commands_total == 0);
+    end();
+}
+
+static void check_preload(void) {
+    power_on();
+    CHECK(!configPreload(959000000, 0x07, 7, 1, 0x3444)); // No bandwidth 0x07
+    CHECK(configPreload(868100000, 0x05, 11, 2, 0x3444));
+    CHECK(configPreloadTxPower(14, 0x04));
+    configPreloadPacketParams(8, 0x00, 0xFF, 0x01, 0x01);
+    CHECK(begin());
+
+    CHECK(tuned_to(868100000));
+    // SF11 at 250 kHz has 8.2 ms symbols, LowDataRateOptimize stays off like on Meshtastic radios
+    CHECK(lora_sim.sf == 11 && lora_sim.bw == 0x05 && lora_sim.cr == 2 && lora_sim.ldro == 0);
+    CHECK(lora_sim.registers[0x0740] == 0x34 && lora_sim.registers[0x0741] == 0x44);
+    CHECK(lora_sim.pa_config[0] == 0x02 && lora_sim.pa_config[1] == 0x02);
+    CHECK(lora_sim.tx_power == 22 && lora_sim.ramp_time == 0x04);
+    CHECK(lora_sim.commands[0x86] == 1 && lora_sim.commands[0x8B] == 1);
+
+    // Packet parameters are sent when receive mode is entered, with the IQ errata applied
+    CHECK(lora_sim.commands[0x8C] == 0);
+    setModeReceive();
+    static const uint8_t params[] = {0x00, 0x08, 0x00, 0xFF, 0x01, 0x01};
+    CHECK(memcmp(lora_sim.packet_params, params, sizeof(params)) == 0);
+    CHECK((lora_sim.registers[0x0736] & 0x04) == 0);
+    CHECK(lora_sim.mode == LoRaSimModeRx);
+    CHECK(lora_sim.errors == 0);
+    end();
+
+    printf("ok   preloaded configuration\n");
+}
+
+static void check_retune(void) {
+    power_on();
+    CHECK(configPreload(915000000, 0x04, 8, 1, 0x1424));
+    CHECK(begin());
+
+    // The same configuration again sends nothing
+    uint32_t before = lora_sim.commands_total;
+    CHECK(configApply(915000000, 0x04, 8, 1, 0x1424));
+    CHECK(lora_sim.commands_total == before);
+
+    // Only what changed is sent
+    CHECK(configApply(915000000, 0x04, 8, 1, 0x3444));
+    CHECK(lora_sim.commands_total == before + 2 && lora_sim.commands[0x0D] >= 2);
+    before = lora_sim.commands_total;
+    CHECK(configSetChannel(903900000, 0x04, 8));
+    CHECK(lora_sim.commands_total == before + 1 && tuned_to(903900000));
+    CHECK(configSetChannel(903900000, 0x05, 12));
+    CHECK(lora_sim.commands_total == before + 2 && lora_sim.ldro == 1);
+
+    // Invalid values change nothing
+    before = lora_sim.commands_total;
+    CHECK(!configSetChannel(149999999, 0x04, 8));
+    CHECK(!configSetChannel(915000000, 0x07, 8));
+    CHECK(!configApply(915000000, 0x04, 13, 1, 0x1424));
+    CHECK(!configApply(915000000, 0x04, 8, 5, 0x1424));
+    CHECK(lora_sim.commands_total == before && tuned_to(903900000));
+
+    CHECK(lora_sim.errors == 0);
+    end();
+    printf("ok   retune\n");
+}
+
+static void check_receive(void) {
+    uint8_t payload[255];
+    uint8_t buffer[255];
+    for(size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = i * 7 + 3;
+    }
+
+    power_on();
+    CHECK(configPreload(915000000, 0x04, 8, 1, 0x1424));
+    CHECK(begin());
+    setPacketParams(12, 0x00, 16, 0x01, 0x00);
+    CHECK(receive(buffer, sizeof(buffer), 10) == -1);
+
+    uint32_t now = furi_get_tick();
+    LoRaSimPacket* packet =
+        lora_sim_inject(now + 50, 915000000, 8, 0x04, payload, 20, -71, 7);
+    CHECK(receive(buffer, sizeof(buffer), 1000) == 20);
+    CHECK(packet->received && memcmp(buffer, payload, 20) == 0);
+    CHECK(getRSSI() == -71 && getSNR() == 7);
+    CHECK(notified[LoRaNotifyEventRx] == 1);
+    CHECK(!lora_hal_dio1()); // Cleared for the next one
+
+    // Read as soon as the radio has it, the sniffer sleeps on DIO1
+    now = furi_get_tick();
+    packet = lora_sim_inject(now + 30, 915000000, 8, 0x04, payload, 51, -100, -12);
+    CHECK(lora_hal_wait_dio1(1000));
+    CHECK(lora_sim.now_us - (now + 30) * 1000ULL == lora_sim_time_on_air_us(51));
+    CHECK(lora_receive_async(buffer, sizeof(buffer)) == 51 && getSNR() == -12);
+    CHECK(memcmp(buffer, payload, 51) == 0);
+
+    // Every length, and a buffer smaller than the packet
+    static const uint8_t lengths[] = {0, 1, 2, 3, 254, 255};
+    for(size_t i = 0; i < sizeof(lengths); i++) {
+        uint8_t* exact = malloc(lengths[i] ? lengths[i] : 1);
+        packet = lora_sim_inject(
+            furi_get_tick() + 5, 915000000, 8, 0x04, payload, lengths[i], -80, 0);
+        CHECK(receive(exact, lengths[i], 2000) == lengths[i]);
+        CHECK(memcmp(exact, payload, lengths[i]) == 0);
+        CHECK(traced_payload(0x1E, payload, lengths[i], 2));
+        free(exact);
+    }
+    memset(buffer, 0, sizeof(buffer));
+    lora_sim_inject(furi_get_tick() + 5, 915000000, 8, 0x04, payload, 40, -80, 0);
+    CHECK(receive(buffer, 10, 1000) == 10);
+    CHECK(memcmp(buffer, payload, 10) == 0 && buffer[10] == 0);
+
+    // Another channel is not heard
+    packet = lora_sim_inject(furi_get_tick() + 5, 916000000, 8, 0x04, payload, 20, -60, 5);
+    CHECK(receive(buffer, sizeof(buffer), 500) == -1 && packet->over && !packet->received);
+    packet = lora_sim_inject(furi_get_tick() + 5, 915000000, 9, 0x04, payload, 20, -60, 5);
+    CHECK(receive(buffer, sizeof(buffer), 500) == -1 && !packet->received);
+
+    CHECK(lora_sim.errors == 0);
+    end();
+    printf("ok   receive\n");
+}
+
+static void check_transmit(void) {
+    uint8_t payload[255];
+    uint8_t buffer[255];
+    for(size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = 0xFF - i;
+    }
+
+    power_on();
+    CHECK(configPreload(915000000, 0x04, 8, 1, 0x1424));
+    CHECK(begin());
+    setPacketParams(12, 0x00, 16, 0x01, 0x00);
+    setModeReceive();
+
+    static const uint8_t lengths[] = {0, 1, 2, 32, 255};
+    for(size_t i = 0; i < sizeof(lengths); i++) {
+        // Sent from a buffer of exactly the payload, nothing may be read past it
+        uint8_t* data = malloc(lengths[i] ? lengths[i] : 1);
+        memcpy(data, payload, lengths[i]);
+        uint64_t start = lora_sim.now_us;
+        transmit(data, lengths[i]);
+        uint64_t elapsed = lora_sim.now_us - start;
+        uint64_t airtime = lora_sim_time_on_air_us(lengths[i]);
+        free(data);
+
+        CHECK(lora_sim.transmitted == i + 1 && lora_sim.last_tx_length == lengths[i]);
+        CHECK(memcmp(lora_sim.last_tx, payload, lengths[i]) == 0);
+        CHECK(traced_payload(0x0E, payload, lengths[i], 1));
+        CHECK(elapsed >= airtime && elapsed < airtime + 2000); // Returns right after TxDone
+        CHECK(lora_sim.mode == LoRaSimModeStandbyRc && !lora_hal_dio1());
+    }
+    CHECK(notified[LoRaNotifyEventTx] == sizeof(lengths));
+
+    // Packets longer than a second on air are waited for too
+    CHECK(configSetChannel(915000000, 0x04, 12));
+    uint64_t start = lora_sim.now_us;
+    transmit(payload, 64);
+    uint64_t airtime = lora_sim_time_on_air_us(64);
+    CHECK(airtime > 2000000 && lora_sim.now_us - start >= airtime);
+    CHECK(lora_sim.mode == LoRaSimModeStandbyRc);
+    CHECK(notified[LoRaNotifyEventTx] == sizeof(lengths) + 1);
+
+    // Receiving again accepts any length again, the header gives it
+    CHECK(lora_receive_async(buffer, sizeof(buffer)) == -1);
+    CHECK(lora_sim.mode == LoRaSimModeRx && lora_sim.packet_params[3] == 0xFF);
+
+    // Inverted IQ needs the errata bit cleared, standard IQ needs it set
+    setPacketParams(12, 0x00, 16, 0x01, 0x01);
+    CHECK((lora_sim.registers[0x0736] & 0x04) == 0);
+    setPacketParams(12, 0x00, 16, 0x01, 0x00);
+    CHECK((lora_sim.registers[0x0736] & 0x04) != 0);
+
+    CHECK(lora_sim.errors == 0);
+    end();
+    printf("ok   transmit\n");
+}
+
+static void check_time_on_air(void) {
+    static const uint8_t lengths[] = {0, 1, 12, 51, 222, 255};
+    uint32_t checked = 0;
+
+    power_on();
+    CHECK(begin());
+    for(uint8_t sf = 5; sf <= 12; sf++) {
+        for(size_t b = 0; b < sizeof(bandwidths); b++) {
+            for(uint8_t options = 0; options < 8; options++) {
+                CHECK(configApply(915000000, bandwidths[b], sf, 1 + options % 4, 0x1424));
+                // LowDataRateOptimize from 16.38 ms symbols on, datasheet section 6.1.1.4
+                CHECK(lora_sim.ldro == (lora_sim_symbol_ms() >= 16.38));
+                setPacketParams(6 + options, options & 1, 16, (options >> 1) & 1, 0x00);
+                for(size_t l = 0; l < sizeof(lengths); l++) {
+                    // Rounded up to the millisecond, the radio's microseconds may be 1 over
+                    uint64_t airtime = lora_sim_time_on_air_us(lengths[l]);
+                    uint32_t ms = getTimeOnAir(lengths[l]);
+                    if(ms != (airtime + 999) / 1000 && ms != (airtime + 998) / 1000) {
+                        fprintf(
+                            stderr,
+                            "SF%u bw 0x%02X options %u length %u: %lu ms, radio %.3f ms\n",
+                            sf,
+                            bandwidths[b],
+                            options,
+                            lengths[l],
+                            (unsigned long)ms,
+                            airtime / 1000.0);
+                        exit(1);
+                    }
+                    checked++;
+                }
+            }
+        }
+    }
+    CHECK(lora_sim.errors == 0);
+    end();
+    printf("ok   time on air of %lu packets\n", (unsigned long)checked);
+}
+
+static void check_watchdog(void) {
+    uint8_t buffer[255];
+    uint32_t outage_ms = 0;
+
+    power_on();
+    CHECK(configPreload(868300000, 0x04, 9, 1, 0x3444));
+    CHECK(begin());
+    setPacketParams(12, 0x00, 16, 0x01, 0x00);
+    setModeReceive();
+    CHECK(!radioWatchdog(&outage_ms));
+
+    // The radio hangs: commands time out on BUSY until the watchdog resets it
+    uint8_t payload[] = {1, 2, 3};
+    lora_sim.stuck = true;
+    uint32_t resets = lora_sim.resets;
+    for(int i = 0; i < 3; i++) {
+        configSetChannel(868100000 + i * 200000, 0x04, 9);
+        transmit(payload, sizeof(payload));
+    }
+    CHECK(radioWatchdog(&outage_ms));
+    CHECK(lora_sim.resets == resets + 1 && getRadioOutages() == 1 && outage_ms > 0);
+    CHECK(tuned_to(868500000) && lora_sim.sf == 9 && lora_sim.ldro == 0);
+    CHECK(lora_sim.registers[0x0740] == 0x34 && lora_sim.registers[0x0741] == 0x44);
+
+    // Packets are heard again, with the receive packet parameters
+    lora_sim_inject(furi_get_tick() + 5, 868500000, 9, 0x04, payload, 3, -90, 1);
+    CHECK(receive(buffer, sizeof(buffer), 1000) == 3);
+    CHECK(lora_sim.mode == LoRaSimModeRx && lora_sim.packet_params[3] == 0xFF);
+
+    // A radio that silently lost its configuration is found when nothing is heard for long
+    lora_sim.mode = LoRaSimModeStandbyRc;
+    furi_delay_ms(29000);
+    CHECK(!radioWatchdog(&outage_ms));
+    furi_delay_ms(1000);
+    CHECK(radioWatchdog(&outage_ms) && getRadioOutages() == 2);
+    CHECK(lora_sim.mode == LoRaSimModeRx && tuned_to(868500000));
+
+    // DIO1 stuck high, like the floating pin of an unplugged module: receiving gives up after a
+    // few ClearIrqStatus and the watchdog resets the radio
+    lora_sim.dio1_high = true;
+    uint32_t clears = lora_sim.commands[0x02];
+    for(int i = 0; i < 2; i++) {
+        CHECK(lora_receive_async(buffer, sizeof(buffer)) == -1);
+    }
+    CHECK(lora_sim.commands[0x02] - clears <= 6);
+    CHECK(radioWatchdog(&outage_ms) && getRadioOutages() == 3);
+    lora_sim.dio1_high = false;
+    lora_sim_inject(furi_get_tick() + 5, 868500000, 9, 0x04, payload, 3, -90, 1);
+    CHECK(receive(buffer, sizeof(buffer), 1000) == 3);
+
+    CHECK(lora_sim.errors == 0);
+    end();
+    printf("ok   watchdog\n");
+}
+
+int main(int argc, char** argv) {
+    int option;
+    while((option = getopt(argc, argv, "v")) != -1) {
+        switch(option) {
+        case 'v':
+            lora_sim_set_verbose(true);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    check_begin();
+    check_preload();
+    check_retune();
+    check_receive();
+    check_transmit();
+    check_time_on_air();
+    check_watchdog();
+    return 0;
+}
@@ -0,0 +1,623 @@
+/*
+Simulated SX1262 behind lora_hal.h, see lora_hal_sim.h.  Built with the driver, lora.c, and the
+furi.h of tools/host by the host driver check, tools/lora_driver_check.c.
+*/
+
+#include "lora_hal_sim.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "furi.h"
+#include "lora_hal.h"
+
+#define SELECT_US       2 // Taking the bus and lowering chip-select
+#define BYTE_US         1 // One byte at 8 MHz
+#define RESET_BUSY_US   3500 // Cold start and calibration after reset
+
+LoRaSim lora_sim;
+
+static bool verbose;
+
+// Bandwidth in Hz by SX126x code, 0 for codes the chip doesn't have
+static const uint32_t bandwidth_hz[] =
+    {7810, 15630, 31250, 62500, 125000, 250000, 500000, 0, 10420, 20830, 41670};
+
+void lora_sim_log(char level, const char* tag, const char* format, ...) {
+    if(!verbose) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "%8.3f [%c][%s] ", lora_sim.now_us / 1000.0, level, tag);
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+}
+
+void lora_sim_set_verbose(bool on) {
+    verbose = on;
+}
+
+static void sim_error(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "sim: %.3f ms: ", lora_sim.now_us / 1000.0);
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    lora_sim.errors++;
+}
+
+// Register values after reset that the driver reads or changes
+static void sim_chip_reset(void) {
+    LoRaSim* sim = &lora_sim;
+
+    memset(sim->registers, 0, sizeof(sim->registers));
+    sim->registers[0x0740] = 0x14; // LoRa sync word, private network
+    sim->registers[0x0741] = 0x24;
+    sim->registers[0x0736] = 0x0D; // IQ polarity setup, see errata 15.4
+    sim->registers[0x08AC] = 0x94; // RX gain
+    sim->registers[0x08E7] = 0x18; // OCP
+
+    memset(sim->buffer, 0, sizeof(sim->buffer));
+    sim->mode = LoRaSimModeStandbyRc;
+    sim->stuck = false;
+    sim->packet_type = 0x00;
+    sim->pll = 0;
+    sim->sf = 7;
+    sim->bw = 0x04;
+    sim->cr = 1;
+    sim->ldro = 0;
+    static const uint8_t packet_params[] = {0x00, 0x08, 0x00, 0xFF, 0x01, 0x00};
+    memcpy(sim->packet_params, packet_params, sizeof(packet_params));
+    sim->tx_power = 0;
+    sim->ramp_time = 0;
+    memset(sim->pa_config, 0, sizeof(sim->pa_config));
+    sim->dio2_rf_switch = false;
+    sim->irq_mask = sim->dio1_mask = sim->irq = 0;
+    sim->tx_base = sim->rx_base = 0;
+    sim->rx_length = sim->rx_start = 0;
+    sim->rx_timeout_us = 0;
+    sim->rx_continuous = false;
+    sim->busy_until_us = sim->now_us + RESET_BUSY_US;
+}
+
+void lora_sim_power_on(void) {
+    memset(&lora_sim, 0, sizeof(lora_sim));
+    sim_chip_reset();
+}
+
+LoRaSimPacket* lora_sim_inject(
+    uint32_t start_ms,
+    uint32_t frequency,
+    uint8_t sf,
+    uint8_t bw,
+    const uint8_t* payload,
+    uint8_t length,
+    int16_t rssi,
+    int8_t snr) {
+    if(lora_sim.packet_count == LORA_SIM_PACKETS_MAX) {
+        return NULL;
+    }
+    LoRaSimPacket* packet = &lora_sim.packets[lora_sim.packet_count++];
+    memset(packet, 0, sizeof(LoRaSimPacket));
+    packet->start_ms = start_ms;
+    packet->frequency = frequency;
+    packet->sf = sf;
+    packet->bw = bw;
+    memcpy(packet->payload, payload, length);
+    packet->length = length;
+    packet->rssi = rssi;
+    packet->snr = snr;
+    return packet;
+}
+
+uint32_t lora_sim_frequency(void) {
+    return (uint32_t)llround(lora_sim.pll * 32e6 / (1 << 25));
+}
+
+double lora_sim_symbol_ms(void) {
+    const LoRaSim* sim = &lora_sim;
+    if(sim->bw >= sizeof(bandwidth_hz) / sizeof(bandwidth_hz[0]) || !bandwidth_hz[sim->bw]) {
+        return 0;
+    }
+    return (double)(1 << sim->sf) * 1000 / bandwidth_hz[sim->bw];
+}
+
+// Datasheet 6.1.4, computed in floating point so it doesn't share code with getTimeOnAir
+uint64_t lora_sim_time_on_air_us(uint8_t length) {
+    const LoRaSim* sim = &lora_sim;
+    if(sim->bw >= sizeof(bandwidth_hz) / sizeof(bandwidth_hz[0]) || !bandwidth_hz[sim->bw]) {
+        return 0;
+    }
+
+    double preamble = (sim->packet_params[0] << 8) | sim->packet_params[1];
+    double header = sim->packet_params[2] ? 0 : 20;
+    double crc = sim->packet_params[4] ? 16 : 0;
+    double sf = sim->sf;
+    double symbols;
+
+    if(sim->sf <= 6) {
+        double bits = fmax(8.0 * length + crc - 4 * sf + header, 0);
+        symbols = preamble + 6.25 + 8 + ceil(bits / (4 * sf)) * (sim->cr + 4);
+    } else {
+        double bits = fmax(8.0 * length + crc - 4 * sf + 8 + header, 0);
+        double per_symbol = 4 * (sim->ldro ? sf - 2 : sf);
+        symbols = preamble + 4.25 + 8 + ceil(bits / per_symbol) * (sim->cr + 4);
+    }
+
+    return (uint64_t)ceil(symbols * (1 << sim->sf) * 1e6 / bandwidth_hz[sim->bw]);
+}
+
+static bool sim_busy(void) {
+    return lora_sim.in_reset || lora_sim.stuck || lora_sim.now_us < lora_sim.busy_until_us;
+}
+
+static void sim_raise(uint16_t irq) {
+    lora_sim.irq |= irq & lora_sim.irq_mask;
+}
+
+static uint64_t sim_packet_end_us(const LoRaSimPacket* packet) {
+    return packet->start_ms * 1000ULL + lora_sim_time_on_air_us(packet->length);
+}
+
+static void sim_packet_end(LoRaSimPacket* packet) {
+    LoRaSim* sim = &lora_sim;
+    packet->over = true;
+
+    int32_t offset = (int32_t)(lora_sim_frequency() - packet->frequency);
+    if(sim->in_reset || sim->mode != LoRaSimModeRx || sim->packet_type != 0x01 ||
+       sim->rx_since_us > packet->start_ms * 1000ULL || offset < -100 || offset > 100 ||
+       packet->sf != sim->sf || packet->bw != sim->bw) {
+        return;
+    }
+
+    // A fixed length header receives the configured length whatever was sent
+    uint8_t length = sim->packet_params[2] ? sim->packet_params[3] : packet->length;
+    for(uint16_t i = 0; i < length; i++) {
+        sim->buffer[(uint8_t)(sim->rx_base + i)] = i < packet->length ? packet->payload[i] : 0;
+    }
+    sim->rx_start = sim->rx_base;
+    sim->rx_length = length;
+    sim->rx_rssi = packet->rssi;
+    sim->rx_snr = packet->snr;
+    packet->received = true;
+    sim_raise(LoRaSimIrqRxDone);
+    if(!sim->rx_continuous) {
+        sim->mode = LoRaSimModeStandbyRc;
+    }
+}
+
+// Earliest event after now, UINT64_MAX if nothing is scheduled
+static uint64_t sim_next_event_us(void) {
+    const LoRaSim* sim = &lora_sim;
+    uint64_t next = UINT64_MAX;
+
+    if(sim->mode == LoRaSimModeTx && sim->tx_done_us < next) {
+        next = sim->tx_done_us;
+    }
+    if(sim->mode == LoRaSimModeRx && sim->rx_timeout_us && sim->rx_timeout_us < next) {
+        next = sim->rx_timeout_us;
+    }
+    for(uint8_t i = 0; i < sim->packet_count; i++) {
+        uint64_t end = sim_packet_end_us(&sim->packets[i]);
+        if(!sim->packets[i].over && end < next) {
+            next = end;
+        }
+    }
+    return next;
+}
+
+// Move the clock forward, handling every event on the way in order
+static void sim_run_until(uint64_t until_us) {
+    LoRaSim* sim = &lora_sim;
+
+    while(true) {
+        uint64_t next = sim_next_event_us();
+        if(next > until_us) {
+            break;
+        }
+        if(next > sim->now_us) {
+            sim->now_us = next;
+        }
+
+        if(sim->mode == LoRaSimModeTx && sim->tx_done_us <= sim->now_us) {
+            sim->mode = LoRaSimModeStandbyRc;
+            sim_raise(LoRaSimIrqTxDone);
+        }
+        if(sim->mode == LoRaSimModeRx && sim->rx_timeout_us &&
+           sim->rx_timeout_us <= sim->now_us) {
+            sim->mode = LoRaSimModeStandbyRc;
+            sim->rx_timeout_us = 0;
+            sim_raise(LoRaSimIrqTimeout);
+        }
+        for(uint8_t i = 0; i < sim->packet_count; i++) {
+            if(!sim->packets[i].over && sim_packet_end_us(&sim->packets[i]) <= sim->now_us) {
+                sim_packet_end(&sim->packets[i]);
+            }
+        }
+    }
+
+    if(until_us > sim->now_us) {
+        sim->now_us = until_us;
+    }
+}
+
+static uint8_t sim_status(void) {
+    return lora_sim.mode << 4;
+}
+
+// Byte sent back by the chip at a position of the transaction, see datasheet 13.5
+static uint8_t sim_miso(uint16_t position) {
+    const LoRaSim* sim = &lora_sim;
+    const uint8_t* mosi = sim->mosi;
+
+    if(sim->stuck || sim->in_reset) {
+        return 0xFF;
+    }
+    if(position == 0) {
+        return sim_status();
+    }
+
+    switch(mosi[0]) {
+    case 0x1D: // ReadRegister: address, status, then data
+        if(position >= 4) {
+            uint16_t address = ((mosi[1] << 8) | mosi[2]) + position - 4;
+            return sim->registers[address & 0x0FFF];
+        }
+        break;
+    case 0x1E: // ReadBuffer: offset, status, then data
+        if(position >= 3) {
+            return sim->buffer[(uint8_t)(mosi[1] + position - 3)];
+        }
+        break;
+    case 0x13: // GetRxBufferStatus
+        if(position == 2) return sim->rx_length;
+        if(position == 3) return sim->rx_start;
+        break;
+    case 0x14: // GetPacketStatus: RssiPkt, SnrPkt, SignalRssiPkt
+        if(position == 2 || position == 4) return (uint8_t)(-sim->rx_rssi * 2);
+        if(position == 3) return (uint8_t)(sim->rx_snr * 4);
+        break;
+    case 0x12: // GetIrqStatus
+        if(position == 2) return sim->irq >> 8;
+        if(position == 3) return sim->irq & 0xFF;
+        break;
+    }
+    return sim_status();
+}
+
+// Number of parameter bytes each opcode takes, -1 for at least the given number
+static int sim_param_count(uint8_t opcode) {
+    switch(opcode) {
+    case 0x80: // SetStandby
+    case 0x8A: // SetPacketType
+    case 0x9D: // SetDIO2AsRfSwitchCtrl
+    case 0x9F: // StopTimerOnPreamble
+    case 0xA0: // SetLoRaSymbNumTimeout
+    case 0xC0: // GetStatus
+        return 1;
+    case 0x02: // ClearIrqStatus
+    case 0x8E: // SetTxParams
+    case 0x8F: // SetBufferBaseAddress
+        return 2;
+    case 0x82: // SetRx
+    case 0x83: // SetTx
+    case 0x12: // GetIrqStatus
+    case 0x13: // GetRxBufferStatus
+        return 3;
+    case 0x86: // SetRfFrequency
+    case 0x8B: // SetModulationParams, LoRa uses the first 4
+    case 0x95: // SetPaConfig
+    case 0x14: // GetPacketStatus
+        return 4;
+    case 0x8C: // SetPacketParams, LoRa
+        return 6;
+    case 0x08: // SetDioIrqParams
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+static uint64_t sim_busy_us(uint8_t opcode) {
+    switch(opcode) {
+    case 0x80:
+        return 50; // Starting the crystal
+    case 0x82:
+    case 0x83:
+        return 100; // PLL lock through FS
+    case 0x86:
+    case 0x8A:
+    case 0x8B:
+    case 0x8C:
+    case 0x8E:
+    case 0x95:
+    case 0x9D:
+    case 0x9F:
+    case 0xA0:
+    case 0x08:
+        return 10;
+    default:
+        return 2; // Register and buffer access
+    }
+}
+
+static void sim_execute(void) {
+    LoRaSim* sim = &lora_sim;
+    const uint8_t* p = sim->mosi + 1;
+    uint8_t opcode = sim->mosi[0];
+    uint16_t n = sim->mosi_length - 1;
+
+    if(sim->mosi_length == 0) {
+        return;
+    }
+    if(sim->in_reset) {
+        sim_error("opcode 0x%02X sent while the chip is in reset", opcode);
+        return;
+    }
+    if(sim->stuck) {
+        return; // Not listening any more, the driver can only tell from BUSY and status
+    }
+    if(opcode != 0xC0 && sim->busy_until_us > sim->selected_us) {
+        sim_error("opcode 0x%02X sent while BUSY is high", opcode);
+        return;
+    }
+
+    sim->commands[opcode]++;
+    sim->commands_total++;
+
+    int count = sim_param_count(opcode);
+    if(count && n != count && !(opcode == 0x8B && n == 8)) {
+        sim_error("opcode 0x%02X with %u parameters instead of %d", opcode, n, count);
+        return;
+    }
+
+    switch(opcode) {
+    case 0x80:
+        sim->mode = p[0] ? LoRaSimModeStandbyXosc : LoRaSimModeStandbyRc;
+        break;
+    case 0x82: {
+        uint32_t timeout = (p[0] << 16) | (p[1] << 8) | p[2];
+        sim->mode = LoRaSimModeRx;
+        sim->rx_since_us = sim->now_us;
+        sim->rx_continuous = timeout == 0xFFFFFF;
+        sim->rx_timeout_us =
+            timeout && !sim->rx_continuous ? sim->now_us + timeout * 15625ULL / 1000 : 0;
+        break;
+    }
+    case 0x83:
+        if(sim->packet_type != 0x01) {
+            sim_error("SetTx before SetPacketType LoRa");
+            return;
+        }
+        sim->last_tx_length = sim->packet_params[3];
+        for(uint16_t i = 0; i < sim->last_tx_length; i++) {
+            sim->last_tx[i] = sim->buffer[(uint8_t)(sim->tx_base + i)];
+        }
+        sim->mode = LoRaSimModeTx;
+        sim->tx_done_us = sim->now_us + lora_sim_time_on_air_us(sim->last_tx_length);
+        sim->transmitted++;
+        break;
+    case 0x86:
+        sim->pll = ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+        memcpy(&sim->registers[0x088B], p, 4);
+        break;
+    case 0x8A:
+        if(sim->mode != LoRaSimModeStandbyRc && sim->mode != LoRaSimModeStandbyXosc) {
+            sim_error("SetPacketType outside standby");
+            return;
+        }
+        sim->packet_type = p[0];
+        break;
+    case 0x8B:
+        if(p[0] < 5 || p[0] > 12 || p[1] >= sizeof(bandwidth_hz) / sizeof(bandwidth_hz[0]) ||
+           !bandwidth_hz[p[1]] || p[2] < 1 || p[2] > 4 || p[3] > 1) {
+            sim_error("SetModulationParams %02X %02X %02X %02X", p[0], p[1], p[2], p[3]);
+            return;
+        }
+        sim->sf = p[0];
+        sim->bw = p[1];
+        sim->cr = p[2];
+        sim->ldro = p[3];
+        break;
+    case 0x8C:
+        memcpy(sim->packet_params, p, 6);
+        break;
+    case 0x8E:
+        if((int8_t)p[0] < -9 || (int8_t)p[0] > 22 || p[1] > 7) {
+            sim_error("SetTxParams %02X %02X", p[0], p[1]);
+            return;
+        }
+        sim->tx_power = p[0];
+        sim->ramp_time = p[1];
+        break;
+    case 0x8F:
+        sim->tx_base = p[0];
+        sim->rx_base = p[1];
+        break;
+    case 0x95:
+        memcpy(sim->pa_config, p, 4);
+        break;
+    case 0x9D:
+        sim->dio2_rf_switch = p[0];
+        break;
+    case 0x08:
+        sim->irq_mask = (p[0] << 8) | p[1];
+        sim->dio1_mask = (p[2] << 8) | p[3];
+        break;
+    case 0x02:
+        sim->irq &= ~((p[0] << 8) | p[1]);
+        break;
+    case 0x0D:
+        if(n < 3) {
+            sim_error("WriteRegister without data");
+            return;
+        }
+        for(uint16_t i = 2; i < n; i++) {
+            sim->registers[(((p[0] << 8) | p[1]) + i - 2) & 0x0FFF] = p[i];
+        }
+        break;
+    case 0x0E:
+        if(n < 1) {
+            sim_error("WriteBuffer without offset");
+            return;
+        }
+        for(uint16_t i = 1; i < n; i++) {
+            sim->buffer[(uint8_t)(p[0] + i - 1)] = p[i];
+        }
+        break;
+    case 0x1D:
+        if(n < 3) {
+            sim_error("ReadRegister without status byte");
+            return;
+        }
+        break;
+    case 0x1E:
+        if(n < 2) {
+            sim_error("ReadBuffer without status byte");
+            return;
+        }
+        break;
+    case 0x9F:
+    case 0xA0:
+    case 0xC0:
+    case 0x12:
+    case 0x13:
+    case 0x14:
+        break;
+    default:
+        sim_error("unknown opcode 0x%02X", opcode);
+        return;
+    }
+
+    sim->busy_until_us = sim->now_us + sim_busy_us(opcode);
+}
+
+static bool sim_transfer(const uint8_t* out, uint8_t* in, size_t size) {
+    LoRaSim* sim = &lora_sim;
+
+    if(!sim->hal_ready || !sim->selected) {
+        sim_error("SPI transfer without %s", sim->hal_ready ? "chip-select" : "lora_hal_init");
+        return false;
+    }
+    if(sim->spi_broken) {
+        return false;
+    }
+
+    for(size_t i = 0; i < size; i++) {
+        uint16_t position = sim->mosi_length;
+        if(position < sizeof(sim->mosi)) {
+            sim->mosi[sim->mosi_length++] = out[i];
+        }
+        if(in) {
+            in[i] = sim_miso(position);
+        }
+    }
+    sim_run_until(sim->now_us + size * BYTE_US);
+    return true;
+}
+
+void lora_hal_init(void) {
+    if(lora_sim.hal_ready) {
+        sim_error("lora_hal_init called twice");
+    }
+    lora_sim.hal_ready = true;
+}
+
+void lora_hal_deinit(void) {
+    lora_sim.hal_ready = false;
+}
+
+void lora_hal_select(void) {
+    if(lora_sim.selected) {
+        sim_error("chip-select already low");
+    }
+    sim_run_until(lora_sim.now_us + SELECT_US);
+    lora_sim.selected = true;
+    lora_sim.selected_us = lora_sim.now_us;
+    lora_sim.mosi_length = 0;
+}
+
+void lora_hal_deselect(void) {
+    if(!lora_sim.selected) {
+        sim_error("chip-select already high");
+    }
+    lora_sim.selected = false;
+    sim_execute();
+}
+
+bool lora_hal_spi_write(const uint8_t* data, size_t size) {
+    return sim_transfer(data, NULL, size);
+}
+
+bool lora_hal_spi_exchange(uint8_t* data, size_t size) {
+    uint8_t out[256];
+    bool success = true;
+    // In chunks, the driver exchanges up to a whole payload
+    for(size_t done = 0; done < size && success; done += sizeof(out)) {
+        size_t chunk = size - done < sizeof(out) ? size - done : sizeof(out);
+        memcpy(out, data + done, chunk);
+        success = sim_transfer(out, data + done, chunk);
+    }
+    return success;
+}
+
+bool lora_hal_busy(void) {
+    return sim_busy();
+}
+
+bool lora_hal_dio1(void) {
+    return lora_sim.dio1_high || (!lora_sim.in_reset && (lora_sim.irq & lora_sim.dio1_mask) != 0);
+}
+
+bool lora_hal_wait_ready(uint32_t timeout_ms) {
+    uint64_t deadline = lora_sim.now_us + timeout_ms * 1000ULL;
+    if(!sim_busy()) {
+        return true;
+    }
+    if(lora_sim.in_reset || lora_sim.stuck || lora_sim.busy_until_us > deadline) {
+        sim_run_until(deadline);
+        return false;
+    }
+    sim_run_until(lora_sim.busy_until_us);
+    return true;
+}
+
+bool lora_hal_wait_dio1(uint32_t timeout_ms) {
+    uint64_t deadline = lora_sim.now_us + timeout_ms * 1000ULL;
+    while(!lora_hal_dio1() && lora_sim.now_us < deadline) {
+        uint64_t next = sim_next_event_us();
+        sim_run_until(next < deadline ? next : deadline);
+    }
+    return lora_hal_dio1();
+}
+
+void lora_hal_reset(bool asserted) {
+    if(asserted) {
+        lora_sim.in_reset = true;
+    } else if(lora_sim.in_reset) {
+        lora_sim.in_reset = false;
+        lora_sim.resets++;
+        sim_chip_reset();
+    }
+}
+
+void lora_hal_beacon(bool on) {
+    lora_sim.beacon = on;
+}
+
+uint32_t furi_get_tick(void) {
+    return lora_sim.now_us / 1000;
+}
+
+uint32_t furi_ms_to_ticks(uint32_t milliseconds) {
+    return milliseconds; // 1 kHz tick, like the Flipper
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    sim_run_until(lora_sim.now_us + milliseconds * 1000ULL);
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+/*
+Behavioural model of the SX1262 behind lora_hal.h, for running the driver on a computer.
+
+The model decodes the opcodes the driver sends, keeps a register file and the 256 byte data
+buffer, raises BUSY for a while after every command and DIO1 for the interrupts enabled with
+SetDioIrqParams.  Time is simulated in microseconds: it only moves when the driver waits or
+sleeps, so a test runs as fast as the computer allows and always the same way.
+
+Packets are scripted with lora_sim_inject.  One that is on air while the radio listens on the
+same frequency, spreading factor and bandwidth is received when it ends, like on the real chip.
+Transmitting takes the time on air of the packet before TxDone is raised.
+
+Everything the driver does wrong on the wire (a command sent while BUSY is high or the chip is in
+reset, a parameter count that doesn't match the opcode, an unknown opcode, values out of range)
+is printed and counted in lora_sim.errors, and the command is ignored like the chip would.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LORA_SIM_PACKETS_MAX 16
+
+typedef enum {
+    LoRaSimModeSleep,
+    LoRaSimModeStandbyRc = 0x2,
+    LoRaSimModeStandbyXosc = 0x3,
+    LoRaSimModeFs = 0x4,
+    LoRaSimModeRx = 0x5,
+    LoRaSimModeTx = 0x6,
+} LoRaSimMode;
+
+// Interrupt bits of SetDioIrqParams and GetIrqStatus
+typedef enum {
+    LoRaSimIrqTxDone = (1 << 0),
+    LoRaSimIrqRxDone = (1 << 1),
+    LoRaSimIrqCrcErr = (1 << 6),
+    LoRaSimIrqTimeout = (1 << 9),
+} LoRaSimIrq;
+
+typedef struct {
+    uint32_t frequency; // Hz
+    uint8_t sf;
+    uint8_t bw; // SX126x bandwidth code
+    uint8_t payload[255];
+    uint8_t length;
+    int16_t rssi; // dBm
+    int8_t snr; // dB
+    uint32_t start_ms; // When the preamble starts
+    bool over; // Ended, received tells whether the radio got it
+    bool received;
+} LoRaSimPacket;
+
+typedef struct {
+    uint64_t now_us;
+
+    // Chip state
+    bool in_reset;
+    LoRaSimMode mode;
+    uint64_t busy_until_us;
+    bool stuck; // Set by the test: BUSY stays high and SPI reads answer 0xFF
+    bool spi_broken; // Set by the test: every SPI transfer fails
+    bool dio1_high; // Set by the test: DIO1 reads high whatever the chip does, a reset included
+    uint8_t registers[0x1000];
+    uint8_t buffer[256];
+    uint8_t packet_type; // 0x00 GFSK, 0x01 LoRa
+    uint32_t pll;
+    uint8_t sf, bw, cr, ldro;
+    uint8_t packet_params[6]; // Preamble MSB/LSB, header type, length, CRC, IQ
+    uint8_t tx_power, ramp_time;
+    uint8_t pa_config[4];
+    bool dio2_rf_switch;
+    uint16_t irq_mask, dio1_mask, irq;
+    uint8_t tx_base, rx_base; // SetBufferBaseAddress
+    uint8_t rx_length, rx_start;
+    int16_t rx_rssi;
+    int8_t rx_snr;
+    uint64_t rx_since_us; // When receive mode was entered
+    uint64_t rx_timeout_us; // 0 for none
+    bool rx_continuous;
+    uint64_t tx_done_us; // When the packet being sent ends
+
+    // Host side
+    bool hal_ready; // Between lora_hal_init and lora_hal_deinit
+    bool beacon;
+    bool selected;
+    uint64_t selected_us;
+    uint8_t mosi[300];
+    uint16_t mosi_length;
+
+    // What the driver did
+    uint32_t commands[256]; // Per opcode
+    uint32_t commands_total;
+    uint32_t errors;
+    uint32_t resets;
+    uint8_t last_tx[255];
+    uint8_t last_tx_length;
+    uint32_t transmitted;
+
+    LoRaSimPacket packets[LORA_SIM_PACKETS_MAX];
+    uint8_t packet_count;
+} LoRaSim;
+
+extern LoRaSim lora_sim;
+
+/**
+ * @brief      Start from a chip that was never powered, at time 0.
+*/
+void lora_sim_power_on(void);
+
+/**
+ * @brief      Schedule a packet on air.
+ * @return     The packet, to check whether it was received.
+*/
+LoRaSimPacket* lora_sim_inject(
+    uint32_t start_ms,
+    uint32_t frequency,
+    uint8_t sf,
+    uint8_t bw,
+    const uint8_t* payload,
+    uint8_t length,
+    int16_t rssi,
+    int8_t snr);
+
+/**
+ * @brief      Time on air of a packet with the current modulation and packet parameters.
+ * @param      length  Payload length.
+ * @return     Microseconds.
+*/
+uint64_t lora_sim_time_on_air_us(uint8_t length);
+
+/**
+ * @brief      Symbol time with the current spreading factor and bandwidth, 2^SF / BW.
+ * @return     Milliseconds.
+*/
+double lora_sim_symbol_ms(void);
+
+/**
+ * @brief      Frequency the chip is tuned to, in Hz.
+*/
+uint32_t lora_sim_frequency(void);
+
+/**
+ * @brief      Print everything logged from now on, driver logs included.
+*/
+void lora_sim_set_verbose(bool verbose);
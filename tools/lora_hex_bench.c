@@ -0,0 +1,199 @@
+/*
+Round-trip check and benchmark for the payload hex codec, lora_hex.c, on a computer.
+
+The check encodes random payloads of every LoRa length, decodes them back in upper and lower
+case, and makes sure odd lengths, invalid digits and short buffers are refused without writing
+past the output.  The benchmark then compares lora_hex_encode and lora_hex_decode with the
+bytesToAsciiHex and sscanf code they replaced.
+
+Build from the repository root:
+    cc -O2 -Iapplications_user/lora_app -o lora_hex_bench tools/lora_hex_bench.c \
+        applications_user/lora_app/lora_hex.c
+Add -fsanitize=address,undefined -g for the check.
+
+Usage:
+    lora_hex_bench [-n iterations] [-s seed]
+*/
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host/check.h"
+#include "lora_hex.h"
+
+#define PAYLOAD_MAX 255 // Largest LoRa payload
+#define GUARD_LEN   16
+#define GUARD_BYTE  0xA5
+
+static bool guard_intact(const uint8_t* guard) {
+    for(size_t i = 0; i < GUARD_LEN; i++) {
+        if(guard[i] != GUARD_BYTE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int check(unsigned long iterations) {
+    uint8_t data[PAYLOAD_MAX];
+    char hex[LORA_HEX_ENCODED_LEN(PAYLOAD_MAX) + 1 + GUARD_LEN];
+    uint8_t decoded[PAYLOAD_MAX + GUARD_LEN];
+
+    for(unsigned long n = 0; n < iterations; n++) {
+        size_t length = n <= PAYLOAD_MAX ? n : rng() % (PAYLOAD_MAX + 1);
+        for(size_t i = 0; i < length; i++) {
+            data[i] = rng();
+        }
+
+        // Encode into a buffer of exactly the needed size
+        size_t size = LORA_HEX_ENCODED_LEN(length) + 1;
+        memset(hex, GUARD_BYTE, sizeof(hex));
+        if(lora_hex_encode(data, length, hex, size) != 2 * length || hex[2 * length] != '\0' ||
+           !guard_intact((uint8_t*)hex + size)) {
+            fprintf(stderr, "iteration %lu: encoding %zu bytes failed\n", n, length);
+            return 1;
+        }
+        for(size_t i = 0; i < 2 * length; i++) {
+            if(!isxdigit((unsigned char)hex[i]) || islower((unsigned char)hex[i])) {
+                fprintf(stderr, "iteration %lu: '%c' is not an upper case digit\n", n, hex[i]);
+                return 1;
+            }
+        }
+        // One byte short must be refused
+        if(lora_hex_encode(data, length, hex, size - 1) != 0 || (size > 1 && hex[0] != '\0')) {
+            fprintf(stderr, "iteration %lu: short encode buffer accepted\n", n);
+            return 1;
+        }
+        lora_hex_encode(data, length, hex, size);
+
+        // Decode back, in lower case every other time
+        if(n % 2) {
+            for(size_t i = 0; i < 2 * length; i++) {
+                hex[i] = tolower((unsigned char)hex[i]);
+            }
+        }
+        memset(decoded, GUARD_BYTE, sizeof(decoded));
+        if(lora_hex_decode(hex, 2 * length, decoded, length) != (int32_t)length ||
+           memcmp(decoded, data, length) != 0 || !guard_intact(decoded + length)) {
+            fprintf(stderr, "iteration %lu: %zu bytes do not decode back\n", n, length);
+            return 1;
+        }
+
+        if(length == 0) {
+            continue;
+        }
+        // Odd length, short buffer and an invalid digit anywhere must be refused
+        if(lora_hex_decode(hex, 2 * length - 1, decoded, length) != -1 ||
+           lora_hex_decode(hex, 2 * length, decoded, length - 1) != -1) {
+            fprintf(stderr, "iteration %lu: bad length accepted\n", n);
+            return 1;
+        }
+        static const char invalid[] = "gGxX /:@`\"\n";
+        size_t position = rng() % (2 * length);
+        hex[position] = invalid[rng() % (sizeof(invalid) - 1)];
+        if(lora_hex_decode(hex, 2 * length, decoded, length) != -1) {
+            fprintf(stderr, "iteration %lu: invalid digit accepted\n", n);
+            return 1;
+        }
+    }
+
+    printf("check: %lu payloads round trip\n", iterations);
+    return 0;
+}
+
+// The sniffer and replay code before lora_hex.c, without its log calls
+static char asciiBuff[512];
+
+static void bytesToAsciiHex(uint8_t* buffer, uint8_t length) {
+    uint8_t i;
+    for(i = 0; i < length; ++i) {
+        asciiBuff[i * 2] = "0123456789ABCDEF"[buffer[i] >> 4]; // High nibble
+        asciiBuff[i * 2 + 1] = "0123456789ABCDEF"[buffer[i] & 0x0F]; // Low nibble
+    }
+    asciiBuff[length * 2] = '\0'; // Null-terminate the string
+}
+
+static void asciiHexToBytes(const char* hex, uint8_t* bytes, size_t length) {
+    for(size_t i = 0; i < length; i++) {
+        sscanf(hex + 2 * i, "%02hhx", &bytes[i]);
+    }
+}
+
+static void bench(unsigned long iterations) {
+    static uint8_t data[PAYLOAD_MAX];
+    static char hex[LORA_HEX_ENCODED_LEN(PAYLOAD_MAX) + 1];
+    static const size_t sizes[] = {12, 51, 255};
+    volatile uint32_t sink = 0;
+
+    for(size_t i = 0; i < sizeof(data); i++) {
+        data[i] = rng();
+    }
+
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t length = sizes[s];
+
+        double start = now_ns();
+        for(unsigned long n = 0; n < iterations; n++) {
+            bytesToAsciiHex(data, length);
+            sink += asciiBuff[n % length];
+        }
+        double old_encode = (now_ns() - start) / iterations;
+
+        start = now_ns();
+        for(unsigned long n = 0; n < iterations; n++) {
+            sink += lora_hex_encode(data, length, hex, sizeof(hex));
+        }
+        double new_encode = (now_ns() - start) / iterations;
+
+        start = now_ns();
+        for(unsigned long n = 0; n < iterations; n++) {
+            asciiHexToBytes(hex, data, length);
+            sink += data[n % length];
+        }
+        double old_decode = (now_ns() - start) / iterations;
+
+        start = now_ns();
+        for(unsigned long n = 0; n < iterations; n++) {
+            sink += lora_hex_decode(hex, 2 * length, data, sizeof(data));
+        }
+        double new_decode = (now_ns() - start) / iterations;
+
+        printf(
+            "bench: %3zu bytes  encode %7.1f -> %6.1f ns (%.1fx)  decode %8.1f -> %6.1f ns "
+            "(%.1fx)\n",
+            length,
+            old_encode,
+            new_encode,
+            old_encode / new_encode,
+            old_decode,
+            new_decode,
+            old_decode / new_decode);
+    }
+    (void)sink;
+}
+
+int main(int argc, char** argv) {
+    unsigned long iterations = 100000;
+    int option;
+
+    while((option = getopt(argc, argv, "n:s:")) != -1) {
+        if(!check_option(option, &iterations)) {
+            fprintf(stderr, "usage: %s [-n iterations] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(iterations == 0) {
+        iterations = 1;
+    }
+    if(check(iterations)) {
+        return 1;
+    }
+    bench(iterations);
+    return 0;
+}
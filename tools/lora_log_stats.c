@@ -0,0 +1,531 @@
+/*
+Statistics over sniffer capture logs (apps_data/lora/data_N.log), for computers.
+
+Lines are parsed with the app's own lora_record.c, so this tool and the replay on the Flipper
+read the format the same way.  Both take lines of any length the sniffer writes, up to
+LORA_RECORD_LINE_MAX.  Files are memory-mapped and cut into chunks at line boundaries,
+worker threads parse the chunks and the results are merged in file order.
+
+Build from the repository root:
+    cc -O2 -pthread -Iapplications_user/lora_app -o lora_log_stats tools/lora_log_stats.c \
+        applications_user/lora_app/lora_record.c applications_user/lora_app/lora_hex.c \
+        applications_user/lora_app/lora_lorawan.c
+
+Usage:
+    lora_log_stats [-j threads] [-n top_devices] data_1.log [data_2.log ...]
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "lora_hex.h"
+#include "lora_record.h"
+
+#define CHUNK_MIN_SIZE (256 * 1024) // Smaller files are not worth splitting
+
+#define RSSI_MIN     -150
+#define RSSI_STEP    5
+#define RSSI_BUCKETS 30 // -150 dBm to 0 dBm
+
+#define DEVICE_OTHER (1ULL << 40) // Key of the packets that are not LoRaWAN data frames
+
+static const uint32_t gap_limits[] = {1, 2, 5, 10, 30, 60, 300, UINT32_MAX};
+static const char* const gap_names[] = {
+    "0 s", "1 s", "2-4 s", "5-9 s", "10-29 s", "30-59 s", "1-5 min", "5 min+"};
+#define GAP_BUCKETS (sizeof(gap_limits) / sizeof(gap_limits[0]))
+
+// Counts per key, the key is never 0
+typedef struct {
+    uint64_t key;
+    uint64_t count;
+    uint32_t first_s; // Capture time of the first and last timed packet
+    uint32_t last_s;
+    bool timed;
+    uint64_t gap_sum; // Seconds between consecutive timed packets
+    uint64_t gaps;
+    uint32_t gap_max;
+} Stat;
+
+typedef struct {
+    Stat* slots;
+    size_t capacity; // Power of two
+    size_t used;
+} StatTable;
+
+typedef struct {
+    const char* begin;
+    const char* end;
+    uint64_t lines;
+    uint64_t records;
+    uint64_t rssi_count;
+    int64_t rssi_sum;
+    int16_t rssi_min;
+    int16_t rssi_max;
+    uint64_t rssi_hist[RSSI_BUCKETS];
+    uint64_t gap_hist[GAP_BUCKETS];
+    Stat timeline; // Every timed packet, key unused
+    StatTable channels; // Key is frequency << 8 | spreading factor
+    StatTable devices; // Key is the LoRaWAN DevAddr | 1 << 32, or DEVICE_OTHER
+} Chunk;
+
+typedef struct {
+    Chunk* chunks;
+    size_t count;
+    atomic_size_t next;
+} Work;
+
+static uint64_t stat_hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return key;
+}
+
+static Stat* stat_table_get(StatTable* table, uint64_t key) {
+    if(table->used * 2 >= table->capacity) {
+        StatTable grown = {
+            .slots = calloc(table->capacity ? table->capacity * 2 : 64, sizeof(Stat)),
+            .capacity = table->capacity ? table->capacity * 2 : 64,
+            .used = 0,
+        };
+        if(!grown.slots) {
+            perror("calloc");
+            exit(1);
+        }
+        for(size_t i = 0; i < table->capacity; i++) {
+            if(table->slots[i].key) {
+                *stat_table_get(&grown, table->slots[i].key) = table->slots[i];
+            }
+        }
+        free(table->slots);
+        *table = grown;
+    }
+
+    size_t mask = table->capacity - 1;
+    for(size_t i = stat_hash(key) & mask;; i = (i + 1) & mask) {
+        if(table->slots[i].key == key) {
+            return &table->slots[i];
+        }
+        if(table->slots[i].key == 0) {
+            table->slots[i].key = key;
+            table->used++;
+            return &table->slots[i];
+        }
+    }
+}
+
+static size_t gap_bucket(uint32_t gap) {
+    size_t bucket = 0;
+    while(gap >= gap_limits[bucket]) {
+        bucket++;
+    }
+    return bucket;
+}
+
+// Count a packet seen at time seconds, returns the gap to the previous one or -1
+static int64_t stat_add_time(Stat* stat, uint32_t seconds) {
+    int64_t gap = -1;
+    if(!stat->timed) {
+        stat->first_s = seconds;
+        stat->timed = true;
+    } else if(seconds >= stat->last_s) {
+        gap = seconds - stat->last_s;
+        stat->gap_sum += gap;
+        stat->gaps++;
+        if(gap > stat->gap_max) {
+            stat->gap_max = gap;
+        }
+    }
+    stat->last_s = seconds;
+    return gap;
+}
+
+// DevAddr of a LoRaWAN data frame (MHDR, FHDR and MIC are at least 12 bytes)
+static uint64_t device_key(const LoRaRecordField* payload) {
+    uint8_t head[5];
+    if(payload->len < 24 || lora_hex_decode(payload->ptr, 10, head, sizeof(head)) < 0) {
+        return DEVICE_OTHER;
+    }
+    uint8_t mtype = head[0] >> 5;
+    if(mtype < 2 || mtype > 5) {
+        return DEVICE_OTHER; // Join messages and proprietary frames have no DevAddr
+    }
+    uint32_t dev_addr = head[1] | head[2] << 8 | head[3] << 16 | (uint32_t)head[4] << 24;
+    return dev_addr | (1ULL << 32);
+}
+
+static void chunk_parse_line(Chunk* chunk, const char* line, size_t length) {
+    LoRaRecord record;
+    chunk->lines++;
+    if(!lora_record_parse(line, length, &record)) {
+        return;
+    }
+    chunk->records++;
+
+    uint32_t seconds;
+    bool timed = lora_record_get_timestamp(&record, &seconds);
+    if(timed) {
+        int64_t gap = stat_add_time(&chunk->timeline, seconds);
+        if(gap >= 0) {
+            chunk->gap_hist[gap_bucket(gap)]++;
+        }
+    }
+
+    uint32_t hz;
+    uint8_t sf;
+    if(lora_record_get_frequency(&record, &hz) &&
+       lora_record_get_spreading_factor(&record, &sf)) {
+        stat_table_get(&chunk->channels, (uint64_t)hz << 8 | sf)->count++;
+    }
+
+    int16_t rssi;
+    if(lora_record_get_rssi(&record, &rssi)) {
+        int bucket = (rssi - RSSI_MIN) / RSSI_STEP;
+        bucket = bucket < 0 ? 0 : bucket >= RSSI_BUCKETS ? RSSI_BUCKETS - 1 : bucket;
+        chunk->rssi_hist[bucket]++;
+        chunk->rssi_sum += rssi;
+        if(chunk->rssi_count == 0 || rssi < chunk->rssi_min) {
+            chunk->rssi_min = rssi;
+        }
+        if(chunk->rssi_count == 0 || rssi > chunk->rssi_max) {
+            chunk->rssi_max = rssi;
+        }
+        chunk->rssi_count++;
+    }
+
+    Stat* device = stat_table_get(&chunk->devices, device_key(&record.payload));
+    device->count++;
+    if(timed) {
+        stat_add_time(device, seconds);
+    }
+}
+
+static void* chunk_worker(void* context) {
+    Work* work = context;
+    size_t index;
+    while((index = atomic_fetch_add(&work->next, 1)) < work->count) {
+        Chunk* chunk = &work->chunks[index];
+        const char* line = chunk->begin;
+        while(line < chunk->end) {
+            const char* newline = memchr(line, '\n', chunk->end - line);
+            const char* line_end = newline ? newline : chunk->end;
+            chunk_parse_line(chunk, line, line_end - line);
+            line = line_end + 1;
+        }
+    }
+    return NULL;
+}
+
+// Add stat b, which comes later in the same capture when continuous, to a
+static void stat_merge(Stat* a, const Stat* b, bool continuous, uint64_t* gap_hist) {
+    a->count += b->count;
+    if(b->timed) {
+        if(a->timed && continuous && b->first_s >= a->last_s) {
+            uint32_t gap = b->first_s - a->last_s;
+            a->gap_sum += gap;
+            a->gaps++;
+            if(gap > a->gap_max) {
+                a->gap_max = gap;
+            }
+            if(gap_hist) {
+                gap_hist[gap_bucket(gap)]++;
+            }
+        }
+        if(!a->timed) {
+            a->first_s = b->first_s;
+            a->timed = true;
+        }
+        a->last_s = b->last_s;
+    }
+    a->gap_sum += b->gap_sum;
+    a->gaps += b->gaps;
+    if(b->gap_max > a->gap_max) {
+        a->gap_max = b->gap_max;
+    }
+}
+
+static void chunk_merge(Chunk* a, Chunk* b, bool continuous) {
+    a->lines += b->lines;
+    a->records += b->records;
+    for(size_t i = 0; i < RSSI_BUCKETS; i++) {
+        a->rssi_hist[i] += b->rssi_hist[i];
+    }
+    if(b->rssi_count) {
+        if(a->rssi_count == 0 || b->rssi_min < a->rssi_min) {
+            a->rssi_min = b->rssi_min;
+        }
+        if(a->rssi_count == 0 || b->rssi_max > a->rssi_max) {
+            a->rssi_max = b->rssi_max;
+        }
+    }
+    a->rssi_count += b->rssi_count;
+    a->rssi_sum += b->rssi_sum;
+    for(size_t i = 0; i < GAP_BUCKETS; i++) {
+        a->gap_hist[i] += b->gap_hist[i];
+    }
+    stat_merge(&a->timeline, &b->timeline, continuous, a->gap_hist);
+
+    for(size_t i = 0; i < b->channels.capacity; i++) {
+        if(b->channels.slots[i].key) {
+            stat_table_get(&a->channels, b->channels.slots[i].key)->count +=
+                b->channels.slots[i].count;
+        }
+    }
+    for(size_t i = 0; i < b->devices.capacity; i++) {
+        const Stat* device = &b->devices.slots[i];
+        if(device->key) {
+            stat_merge(stat_table_get(&a->devices, device->key), device, continuous, NULL);
+        }
+    }
+
+    free(b->channels.slots);
+    free(b->devices.slots);
+}
+
+static int stat_compare_count(const void* a, const void* b) {
+    const Stat* sa = a;
+    const Stat* sb = b;
+    return sa->count < sb->count ? 1 : sa->count > sb->count ? -1 : 0;
+}
+
+static int stat_compare_key(const void* a, const void* b) {
+    const Stat* sa = a;
+    const Stat* sb = b;
+    return sa->key < sb->key ? -1 : sa->key > sb->key ? 1 : 0;
+}
+
+// The used slots of a table, sorted
+static Stat* stat_table_sorted(const StatTable* table, int (*compare)(const void*, const void*)) {
+    Stat* sorted = malloc(sizeof(Stat) * (table->used + 1));
+    size_t count = 0;
+    for(size_t i = 0; i < table->capacity; i++) {
+        if(table->slots[i].key) {
+            sorted[count++] = table->slots[i];
+        }
+    }
+    qsort(sorted, count, sizeof(Stat), compare);
+    return sorted;
+}
+
+static void print_bar(uint64_t value, uint64_t max) {
+    int width = max ? (int)(value * 40 / max) : 0;
+    for(int i = 0; i < width; i++) {
+        putchar('#');
+    }
+    putchar('\n');
+}
+
+static void print_report(const Chunk* total, size_t files, size_t top) {
+    printf("Files:   %zu\n", files);
+    printf("Lines:   %llu\n", (unsigned long long)total->lines);
+    printf(
+        "Packets: %llu (%llu lines without a payload skipped)\n\n",
+        (unsigned long long)total->records,
+        (unsigned long long)(total->lines - total->records));
+
+    printf("Packets per frequency and spreading factor\n");
+    Stat* channels = stat_table_sorted(&total->channels, stat_compare_key);
+    for(size_t i = 0; i < total->channels.used; i++) {
+        uint32_t hz = channels[i].key >> 8;
+        printf(
+            "  %4lu.%06lu MHz SF%-2u %10llu\n",
+            (unsigned long)(hz / 1000000),
+            (unsigned long)(hz % 1000000),
+            (unsigned)(channels[i].key & 0xFF),
+            (unsigned long long)channels[i].count);
+    }
+    free(channels);
+
+    printf("\nRSSI");
+    if(total->rssi_count) {
+        printf(
+            ", min %d, avg %lld, max %d dBm\n",
+            total->rssi_min,
+            (long long)(total->rssi_sum / (int64_t)total->rssi_count),
+            total->rssi_max);
+        uint64_t max = 0;
+        for(size_t i = 0; i < RSSI_BUCKETS; i++) {
+            max = total->rssi_hist[i] > max ? total->rssi_hist[i] : max;
+        }
+        for(size_t i = 0; i < RSSI_BUCKETS; i++) {
+            if(total->rssi_hist[i]) {
+                printf(
+                    "  %4d dBm %10llu ",
+                    RSSI_MIN + (int)i * RSSI_STEP,
+                    (unsigned long long)total->rssi_hist[i]);
+                print_bar(total->rssi_hist[i], max);
+            }
+        }
+    } else {
+        printf(": none\n");
+    }
+
+    printf("\nTime between packets");
+    if(total->timeline.gaps) {
+        printf(
+            ", avg %.1f s, max %lu s\n",
+            (double)total->timeline.gap_sum / total->timeline.gaps,
+            (unsigned long)total->timeline.gap_max);
+        uint64_t max = 0;
+        for(size_t i = 0; i < GAP_BUCKETS; i++) {
+            max = total->gap_hist[i] > max ? total->gap_hist[i] : max;
+        }
+        for(size_t i = 0; i < GAP_BUCKETS; i++) {
+            printf("  %-8s %10llu ", gap_names[i], (unsigned long long)total->gap_hist[i]);
+            print_bar(total->gap_hist[i], max);
+        }
+    } else {
+        printf(": no timed packets\n");
+    }
+
+    printf("\nDevices: %zu, by packet count\n", total->devices.used);
+    printf("  %-12s %10s %12s %12s\n", "DevAddr", "packets", "avg gap s", "max gap s");
+    Stat* devices = stat_table_sorted(&total->devices, stat_compare_count);
+    for(size_t i = 0; i < total->devices.used && i < top; i++) {
+        char name[16];
+        if(devices[i].key == DEVICE_OTHER) {
+            snprintf(name, sizeof(name), "not LoRaWAN");
+        } else {
+            snprintf(name, sizeof(name), "%08lX", (unsigned long)(devices[i].key & 0xFFFFFFFF));
+        }
+        if(devices[i].gaps) {
+            printf(
+                "  %-12s %10llu %12.1f %12lu\n",
+                name,
+                (unsigned long long)devices[i].count,
+                (double)devices[i].gap_sum / devices[i].gaps,
+                (unsigned long)devices[i].gap_max);
+        } else {
+            printf(
+                "  %-12s %10llu %12s %12s\n",
+                name,
+                (unsigned long long)devices[i].count,
+                "-",
+                "-");
+        }
+    }
+    free(devices);
+}
+
+int main(int argc, char** argv) {
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t top = 20;
+    int option;
+
+    while((option = getopt(argc, argv, "j:n:")) != -1) {
+        if(option == 'j') {
+            threads = strtol(optarg, NULL, 10);
+        } else if(option == 'n') {
+            top = strtoul(optarg, NULL, 10);
+        } else {
+            fprintf(stderr, "usage: %s [-j threads] [-n top_devices] file...\n", argv[0]);
+            return 2;
+        }
+    }
+    if(optind == argc) {
+        fprintf(stderr, "usage: %s [-j threads] [-n top_devices] file...\n", argv[0]);
+        return 2;
+    }
+    if(threads < 1) {
+        threads = 1;
+    }
+
+    size_t files = argc - optind;
+    size_t* file_chunks = calloc(files, sizeof(size_t)); // Chunks of each file, 0 if unreadable
+    Work work = {.chunks = NULL, .count = 0};
+    size_t chunks_capacity = 0;
+
+    for(size_t f = 0; f < files; f++) {
+        const char* path = argv[optind + f];
+        int fd = open(path, O_RDONLY);
+        struct stat st;
+        if(fd < 0 || fstat(fd, &st) < 0) {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            if(fd >= 0) {
+                close(fd);
+            }
+            continue;
+        }
+        if(st.st_size == 0) {
+            close(fd);
+            continue;
+        }
+
+        const char* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // The mapping stays valid
+        if(data == MAP_FAILED) {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            continue;
+        }
+        madvise((void*)data, st.st_size, MADV_SEQUENTIAL);
+
+        size_t count = st.st_size / CHUNK_MIN_SIZE + 1;
+        if(count > (size_t)threads) {
+            count = threads;
+        }
+        if(work.count + count > chunks_capacity) {
+            chunks_capacity = (work.count + count) * 2;
+            work.chunks = realloc(work.chunks, sizeof(Chunk) * chunks_capacity);
+        }
+
+        // Cut at line starts so every line belongs to exactly one chunk
+        const char* end = data + st.st_size;
+        const char* begin = data;
+        for(size_t c = 0; c < count; c++) {
+            const char* cut = c + 1 == count ? end : data + st.st_size * (c + 1) / count;
+            if(cut < begin) {
+                cut = begin;
+            }
+            const char* newline = cut < end ? memchr(cut, '\n', end - cut) : NULL;
+            cut = c + 1 == count ? end : newline ? newline + 1 : end;
+
+            Chunk* chunk = &work.chunks[work.count++];
+            memset(chunk, 0, sizeof(Chunk));
+            chunk->begin = begin;
+            chunk->end = cut;
+            begin = cut;
+        }
+        file_chunks[f] = count;
+    }
+
+    atomic_init(&work.next, 0);
+    pthread_t* pool = malloc(sizeof(pthread_t) * threads);
+    for(long t = 0; t < threads; t++) {
+        pthread_create(&pool[t], NULL, chunk_worker, &work);
+    }
+    for(long t = 0; t < threads; t++) {
+        pthread_join(pool[t], NULL);
+    }
+    free(pool);
+
+    // Chunks of a file continue each other, different files are separate captures
+    Chunk total;
+    memset(&total, 0, sizeof(total));
+    size_t index = 0;
+    for(size_t f = 0; f < files; f++) {
+        Chunk file_total;
+        memset(&file_total, 0, sizeof(file_total));
+        for(size_t c = 0; c < file_chunks[f]; c++) {
+            chunk_merge(&file_total, &work.chunks[index++], c > 0);
+        }
+        chunk_merge(&total, &file_total, false);
+    }
+
+    print_report(&total, files, top);
+
+    free(total.channels.slots);
+    free(total.devices.slots);
+    free(work.chunks);
+    free(file_chunks);
+    return 0;
+}
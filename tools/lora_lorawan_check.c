@@ -0,0 +1,288 @@
+/*
+Checks the LoRaWAN header decoder of the app, lora_lorawan.c, on a computer against a corpus of
+known frames, then times it over random packets.
+
+The corpus holds frames published with LoRaWAN decoders and frames built by hand for the cases
+they don't cover (FOpts, port 0, no port, types without a DevAddr), with the fields each one
+must decode to, and packets that must be refused.
+
+Build from the repository root:
+    cc -O2 -Iapplications_user/lora_app -o lora_lorawan_check tools/lora_lorawan_check.c \
+        applications_user/lora_app/lora_lorawan.c applications_user/lora_app/lora_hex.c
+
+Usage:
+    lora_lorawan_check [-n iterations]
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host/check.h"
+#include "lora_hex.h"
+#include "lora_lorawan.h"
+
+typedef struct {
+    const char* name;
+    const char* hex;
+    bool valid;
+    LoRaWANMType mtype;
+    uint32_t dev_addr;
+    uint8_t fctrl;
+    uint16_t fcnt;
+    const char* fopts; // Hex, NULL for none
+    int fport; // -1 for no port
+    size_t frm_payload_len;
+    const char* dev_eui; // Hex as sent
+    uint16_t dev_nonce;
+    uint32_t mic;
+} Case;
+
+static const Case corpus[] = {
+    {
+        .name = "unconfirmed uplink, port 1",
+        .hex = "40F17DBE4900020001954378762B11FF0D",
+        .valid = true,
+        .mtype = LoRaWANMTypeUnconfirmedUp,
+        .dev_addr = 0x49BE7DF1,
+        .fcnt = 2,
+        .fport = 1,
+        .frm_payload_len = 4,
+        .mic = 0x0DFF112B,
+    },
+    {
+        .name = "join request",
+        .hex = "00DC0000D07ED5B3701E6FEDF57CEEAF0085CC587FE913",
+        .valid = true,
+        .mtype = LoRaWANMTypeJoinRequest,
+        .fport = -1,
+        .dev_eui = "1E6FEDF57CEEAF00",
+        .dev_nonce = 0xCC85,
+        .mic = 0x13E97F58,
+    },
+    {
+        .name = "join accept with CFList",
+        .hex = "204DD85AE608B87FC4889970B7D2042C9E72959B0057AED6094B16003DF12DE145",
+        .valid = true,
+        .mtype = LoRaWANMTypeJoinAccept,
+        .fport = -1,
+        .mic = 0x45E12DF1,
+    },
+    {
+        .name = "join accept without CFList",
+        .hex = "20813F7A2B9ED4D2A1C86E4B0F33A95DC7",
+        .valid = true,
+        .mtype = LoRaWANMTypeJoinAccept,
+        .fport = -1,
+        .mic = 0xC75DA933,
+    },
+    {
+        .name = "confirmed downlink, ACK and LinkCheckAns in FOpts, no port",
+        .hex = "A00403020123010002050222334455",
+        .valid = true,
+        .mtype = LoRaWANMTypeConfirmedDown,
+        .dev_addr = 0x01020304,
+        .fctrl = 0x23,
+        .fcnt = 1,
+        .fopts = "020502",
+        .fport = -1,
+        .mic = 0x55443322,
+    },
+    {
+        .name = "unconfirmed downlink, MAC commands on port 0",
+        .hex = "60040302010034120003070A0BDEADBEEF",
+        .valid = true,
+        .mtype = LoRaWANMTypeUnconfirmedDown,
+        .dev_addr = 0x01020304,
+        .fcnt = 0x1234,
+        .fport = 0,
+        .frm_payload_len = 4,
+        .mic = 0xEFBEADDE,
+    },
+    {
+        .name = "confirmed uplink, ADR, FOpts and port 10",
+        .hex = "80AABBCCDD81FFFF060A0102030405060708090000",
+        .valid = true,
+        .mtype = LoRaWANMTypeConfirmedUp,
+        .dev_addr = 0xDDCCBBAA,
+        .fctrl = 0x81,
+        .fcnt = 0xFFFF,
+        .fopts = "06",
+        .fport = 10,
+        .frm_payload_len = 7,
+        .mic = 0x00000908,
+    },
+    {
+        .name = "rejoin request type 0",
+        .hex = "C00000000101020304050607083412AABBCCDD",
+        .valid = true,
+        .mtype = LoRaWANMTypeRejoinRequest,
+        .fport = -1,
+        .mic = 0xDDCCBBAA,
+    },
+    {
+        .name = "rejoin request type 1",
+        .hex = "C001010203040506070801020304050607083412AABBCCDD",
+        .valid = true,
+        .mtype = LoRaWANMTypeRejoinRequest,
+        .fport = -1,
+        .mic = 0xDDCCBBAA,
+    },
+    {
+        .name = "proprietary",
+        .hex = "E0DEADBEEF",
+        .valid = true,
+        .mtype = LoRaWANMTypeProprietary,
+        .fport = -1,
+        .mic = 0xEFBEADDE,
+    },
+    {.name = "empty", .hex = "", .valid = false},
+    {.name = "shorter than MHDR and MIC", .hex = "40010203", .valid = false},
+    {.name = "major version 1", .hex = "41F17DBE4900020001954378762B11FF0D", .valid = false},
+    {.name = "RFU bits set", .hex = "44F17DBE4900020001954378762B11FF0D", .valid = false},
+    {.name = "data frame without FCnt", .hex = "40F17DBE49000211FF0D2B", .valid = false},
+    {.name = "FOpts past the MIC", .hex = "40F17DBE490F020001954378762B11FF0D", .valid = false},
+    {.name = "FOpts and port 0", .hex = "40F17DBE49010200020011223344", .valid = false},
+    {.name = "join request too long", .hex = "00DC0000D07ED5B3701E6FEDF57CEEAF0085CC587FE91300",
+     .valid = false},
+    {.name = "join accept of 18 bytes", .hex = "20813F7A2B9ED4D2A1C86E4B0F33A95DC700",
+     .valid = false},
+    {.name = "rejoin request of 25 bytes",
+     .hex = "C00101020304050607080102030405060708343412AABBCCDD",
+     .valid = false},
+    {.name = "plain text", .hex = "48656C6C6F20776F726C6421", .valid = false},
+};
+
+static bool check_case(const Case* test) {
+    uint8_t payload[255];
+    uint8_t expected[LORA_LORAWAN_FOPTS_MAX];
+    LoRaWANFrame frame;
+
+    int32_t length = lora_hex_decode(test->hex, strlen(test->hex), payload, sizeof(payload));
+    if(length < 0) {
+        printf("FAIL %s: bad hex in the corpus\n", test->name);
+        return false;
+    }
+
+    bool valid = lora_lorawan_decode(payload, length, &frame);
+    if(valid != test->valid) {
+        printf("FAIL %s: decoded %s\n", test->name, valid ? "as LoRaWAN" : "as not LoRaWAN");
+        return false;
+    }
+    if(!valid) {
+        printf("ok   %s (refused)\n", test->name);
+        return true;
+    }
+
+    const char* error = NULL;
+    if(frame.mtype != test->mtype) {
+        error = "mtype";
+    } else if(frame.mic != test->mic) {
+        error = "MIC";
+    } else if(frame.dev_addr != test->dev_addr) {
+        error = "DevAddr";
+    } else if(frame.fctrl != test->fctrl) {
+        error = "FCtrl";
+    } else if(frame.fcnt != test->fcnt) {
+        error = "FCnt";
+    } else if(
+        frame.has_port != (test->fport >= 0) || (frame.has_port && frame.fport != test->fport)) {
+        error = "FPort";
+    } else if(frame.frm_payload_len != test->frm_payload_len) {
+        error = "FRMPayload length";
+    } else if(frame.dev_nonce != test->dev_nonce) {
+        error = "DevNonce";
+    }
+
+    size_t fopts_len = test->fopts ? strlen(test->fopts) / 2 : 0;
+    if(!error && (frame.fopts_len != fopts_len || (fopts_len > 0 && !frame.fopts))) {
+        error = "FOpts length";
+    }
+    if(!error && fopts_len > 0) {
+        lora_hex_decode(test->fopts, 2 * fopts_len, expected, sizeof(expected));
+        if(memcmp(frame.fopts, expected, fopts_len) != 0) {
+            error = "FOpts";
+        }
+    }
+    if(!error && test->dev_eui) {
+        lora_hex_decode(test->dev_eui, 2 * LORA_LORAWAN_EUI_LEN, expected, sizeof(expected));
+        if(!frame.dev_eui || memcmp(frame.dev_eui, expected, LORA_LORAWAN_EUI_LEN) != 0) {
+            error = "DevEUI";
+        }
+    }
+    // Everything must point into the payload, nothing is copied
+    if(!error && ((frame.fopts && (frame.fopts < payload || frame.fopts >= payload + length)) ||
+                  (frame.frm_payload &&
+                   (frame.frm_payload < payload ||
+                    frame.frm_payload + frame.frm_payload_len > payload + length)))) {
+        error = "pointer outside the payload";
+    }
+
+    if(error) {
+        printf("FAIL %s: wrong %s\n", test->name, error);
+        return false;
+    }
+    printf("ok   %s (%s)\n", test->name, lora_lorawan_mtype_name(frame.mtype));
+    return true;
+}
+
+static void bench(unsigned long iterations) {
+    static uint8_t packets[64][255];
+    static size_t lengths[64];
+    volatile uint32_t sink = 0;
+    size_t valid = 0;
+    LoRaWANFrame frame;
+
+    srand(1);
+    for(size_t p = 0; p < 64; p++) {
+        lengths[p] = rand() % 256;
+        for(size_t i = 0; i < lengths[p]; i++) {
+            packets[p][i] = rand();
+        }
+        if(lengths[p] > 0 && p % 2) {
+            packets[p][0] &= 0xE0; // A LoRaWAN R1 MHDR for half of them
+        }
+        valid += lora_lorawan_decode(packets[p], lengths[p], &frame);
+    }
+
+    double start = now_ns();
+    for(unsigned long n = 0; n < iterations; n++) {
+        if(lora_lorawan_decode(packets[n % 64], lengths[n % 64], &frame)) {
+            sink += frame.dev_addr;
+        }
+    }
+    double ns = (now_ns() - start) / iterations;
+    (void)sink;
+
+    printf("bench: %.1f ns per packet (%zu of 64 random packets decode as LoRaWAN)\n", ns, valid);
+}
+
+int main(int argc, char** argv) {
+    unsigned long iterations = 10000000;
+    size_t failed = 0;
+    int option;
+
+    while((option = getopt(argc, argv, "n:")) != -1) {
+        if(!check_option(option, &iterations)) {
+            fprintf(stderr, "usage: %s [-n iterations]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for(size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++) {
+        failed += !check_case(&corpus[i]);
+    }
+    if(failed) {
+        printf("%zu of %zu frames failed\n", failed, sizeof(corpus) / sizeof(corpus[0]));
+        return 1;
+    }
+
+    if(iterations > 0) {
+        bench(iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,214 @@
+/*
+Checks the radio profile file format of the app, lora_profile.c, on a computer.
+
+The built-in profiles and random valid ones must survive format -> parse -> format unchanged.
+Profile files are written by people, so every key is also given values just outside its range,
+numbers that don't fit in 32 bits and misspelt names, and the profile holding them must be
+skipped while the profiles around it still load.
+
+Build from the repository root:
+    cc -O2 -Iapplications_user/lora_app -o lora_profile_check tools/lora_profile_check.c \
+        applications_user/lora_app/lora_profile.c
+Add -fsanitize=address,undefined -g for the checks.
+
+Usage:
+    lora_profile_check [-n iterations] [-s seed]
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "host/check.h"
+#include "lora_profile.h"
+
+#define TEXT_MAX 4096
+
+static const uint8_t bandwidths[] = {0x00, 0x08, 0x01, 0x09, 0x02, 0x0A, 0x03, 0x04, 0x05, 0x06};
+
+static bool same_profile(const LoRaProfile* a, const LoRaProfile* b) {
+    return strcmp(a->name, b->name) == 0 && a->frequency == b->frequency && a->bw == b->bw &&
+           a->sf == b->sf && a->cr == b->cr && a->sync_word == b->sync_word &&
+           a->preamble == b->preamble && a->header_type == b->header_type && a->crc == b->crc &&
+           a->iq == b->iq;
+}
+
+// Format, parse back, compare, and make sure formatting again gives the same text
+static void round_trip(const LoRaProfile* profiles, size_t count) {
+    static char text[TEXT_MAX];
+    static char again[TEXT_MAX];
+    LoRaProfile parsed[LORA_PROFILE_MAX];
+
+    size_t length = lora_profile_format(profiles, count, text, sizeof(text));
+    CHECK(length < sizeof(text) && strlen(text) == length);
+    CHECK(lora_profile_format(profiles, count, NULL, 0) == length); // Sizing pass
+
+    CHECK(lora_profile_parse(text, length, parsed, LORA_PROFILE_MAX) == count);
+    for(size_t i = 0; i < count; i++) {
+        if(!same_profile(&profiles[i], &parsed[i])) {
+            fprintf(stderr, "profile %zu changed:\n%s", i, text);
+            exit(1);
+        }
+    }
+
+    CHECK(lora_profile_format(parsed, count, again, sizeof(again)) == length);
+    CHECK(memcmp(text, again, length) == 0);
+}
+
+static void random_profile(LoRaProfile* profile, unsigned long n) {
+    memset(profile, 0, sizeof(LoRaProfile));
+    snprintf(profile->name, sizeof(profile->name), "Random %u", (unsigned)(n % 100000));
+    profile->frequency = 150000000 + rng() % (960000000 - 150000000 + 1);
+    profile->bw = bandwidths[rng() % sizeof(bandwidths)];
+    profile->sf = 5 + rng() % 8;
+    profile->cr = 1 + rng() % 4;
+    profile->sync_word = 0x100 + rng() % 0xFF00; // Register values, see check_accepted
+    profile->preamble = 1 + rng() % 0xFFFF;
+    profile->header_type = rng() & 1;
+    profile->crc = rng() & 1;
+    profile->iq = rng() & 1;
+}
+
+static void check_round_trip(unsigned long iterations) {
+    for(size_t i = 0; i < lora_profile_builtin_count; i++) {
+        CHECK(lora_profile_is_valid(&lora_profile_builtin[i]));
+    }
+    round_trip(lora_profile_builtin, lora_profile_builtin_count);
+
+    LoRaProfile profiles[LORA_PROFILE_MAX];
+    for(unsigned long n = 0; n < iterations; n++) {
+        size_t count = 1 + rng() % LORA_PROFILE_MAX;
+        for(size_t i = 0; i < count; i++) {
+            random_profile(&profiles[i], n);
+        }
+        round_trip(profiles, count);
+    }
+
+    // A truncated format still reports the full length and stays NULL terminated
+    char small[32];
+    size_t length = lora_profile_format(
+        lora_profile_builtin, lora_profile_builtin_count, small, sizeof(small));
+    CHECK(length >= sizeof(small) && strlen(small) < sizeof(small));
+
+    printf("ok   %lu random sets round trip\n", iterations);
+}
+
+static void check_rejected(void) {
+    // Every line breaks the profile it is in, and only that one
+    static const char* const lines[] = {
+        "frequency=149999999",
+        "frequency=960000001",
+        "frequency=4294967296",
+        "frequency=0x1000000000",
+        "frequency=",
+        "frequency=915MHz",
+        "frequency=-915000000",
+        "bw=125001",
+        "bw=7",
+        "bw=0x04",
+        "sf=4",
+        "sf=13",
+        "sf=261",
+        "cr=4",
+        "cr=9",
+        "cr=1",
+        "sync=0x10000",
+        "sync=65536",
+        "preamble=0",
+        "preamble=65536",
+        "preamble=65548",
+        "header=2",
+        "crc=2",
+        "crc=256",
+        "iq=2",
+        "iq=257",
+        "freqency=868100000",
+        "spreading=7",
+        "power=14",
+        "=1",
+    };
+    static char text[TEXT_MAX];
+    LoRaProfile parsed[LORA_PROFILE_MAX];
+
+    for(size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+        int length = snprintf(
+            text,
+            sizeof(text),
+            "[Before]\nsf=7\n[Broken]\nsf=9\n%s\niq=1\n[After]\nsf=10\n",
+            lines[i]);
+        size_t count = lora_profile_parse(text, length, parsed, LORA_PROFILE_MAX);
+        if(count != 2 || strcmp(parsed[0].name, "Before") != 0 ||
+           strcmp(parsed[1].name, "After") != 0 || parsed[1].sf != 10) {
+            fprintf(stderr, "'%s' was not refused (%zu profiles)\n", lines[i], count);
+            exit(1);
+        }
+    }
+
+    printf("ok   %zu bad lines refused\n", sizeof(lines) / sizeof(lines[0]));
+}
+
+static void check_accepted(void) {
+    static const char text[] = "# Written by hand\r\n"
+                               "\r\n"
+                               "  [Edge]  \r\n"
+                               "frequency = 150000000\r\n"
+                               "\tbw=7810\r\n"
+                               "sf=5\r\n"
+                               "cr=8\r\n"
+                               "sync=0xFFFF\r\n"
+                               "preamble=65535\r\n"
+                               "header=1\r\n"
+                               "crc=0X1\r\n"
+                               "iq=1\r\n"
+                               "[Defaults]\n"
+                               "frequency=960000000\n"
+                               "[A name that is longer than the name field]\n"
+                               "not a key value line\n";
+    LoRaProfile parsed[LORA_PROFILE_MAX];
+
+    CHECK(lora_profile_parse(text, strlen(text), parsed, LORA_PROFILE_MAX) == 3);
+
+    const LoRaProfile edge = {"Edge", 150000000, 0x00, 5, 4, 0xFFFF, 65535, 1, 1, 1};
+    CHECK(same_profile(&parsed[0], &edge));
+
+    // Missing keys come from the first built-in profile
+    LoRaProfile defaults = lora_profile_builtin[0];
+    strcpy(defaults.name, "Defaults");
+    defaults.frequency = 960000000;
+    CHECK(same_profile(&parsed[1], &defaults));
+
+    CHECK(strlen(parsed[2].name) == LORA_PROFILE_NAME_LEN - 1);
+    CHECK(strncmp(parsed[2].name, "A name that is longer", 21) == 0);
+
+    // No more than max profiles are written
+    CHECK(lora_profile_parse(text, strlen(text), parsed, 1) == 1);
+    CHECK(strcmp(parsed[0].name, "Edge") == 0);
+
+    // One byte sync words become the register values other SX126x libraries write
+    static const char one_byte[] = "[Meshtastic]\nsync=0x2B\n[Private]\nsync=0x12\n"
+                                   "[Public]\nsync=52\n[Zero]\nsync=0\n";
+    CHECK(lora_profile_parse(one_byte, strlen(one_byte), parsed, LORA_PROFILE_MAX) == 4);
+    CHECK(parsed[0].sync_word == 0x24B4 && parsed[1].sync_word == 0x1424);
+    CHECK(parsed[2].sync_word == 0x3444 && parsed[3].sync_word == 0x0404);
+
+    printf("ok   hand written file\n");
+}
+
+int main(int argc, char** argv) {
+    unsigned long iterations = 10000;
+    int option;
+
+    while((option = getopt(argc, argv, "n:s:")) != -1) {
+        if(!check_option(option, &iterations)) {
+            fprintf(stderr, "usage: %s [-n iterations] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    check_round_trip(iterations);
+    check_rejected();
+    check_accepted();
+    return 0;
+}
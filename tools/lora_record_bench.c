@@ -0,0 +1,337 @@
+/*
+Fuzz and benchmark for the capture log line formatter, lora_record_format, on a computer.
+
+The fuzz pass formats random packets, with texts full of quotes and control characters,
+payloads longer than LoRa allows, out of range dates and random LoRaWAN headers, into a buffer
+of exactly LORA_RECORD_LINE_MAX bytes followed by a guard area.  Each line must stay inside the
+buffer, leave the guard untouched and read back through lora_record_parse with the same fields.
+The benchmark then compares the formatter with the snprintf code it replaced.
+
+Build from the repository root:
+    cc -O2 -Iapplications_user/lora_app -o lora_record_bench tools/lora_record_bench.c \
+        applications_user/lora_app/lora_record.c applications_user/lora_app/lora_hex.c \
+        applications_user/lora_app/lora_lorawan.c
+Add -fsanitize=address,undefined -g for the fuzz pass.
+
+Usage:
+    lora_record_bench [-n iterations] [-s seed]
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host/check.h"
+#include "lora_hex.h"
+#include "lora_record.h"
+
+#define GUARD_LEN  64
+#define GUARD_BYTE 0xA5
+
+static const char* random_text(char* text, size_t size) {
+    switch(rng() % 8) {
+    case 0:
+        return NULL;
+    case 1:
+        return "";
+    default: {
+        size_t length = rng() % (size - 1);
+        for(size_t i = 0; i < length; i++) {
+            text[i] = 1 + rng() % 255; // Anything but NULL
+        }
+        text[length] = '\0';
+        return text;
+    }
+    }
+}
+
+// What the formatter must write for a text: cut, with unsafe characters replaced
+static void expected_text(const char* text, char* out) {
+    size_t i = 0;
+    for(; text && text[i] && i < LORA_RECORD_TEXT_MAX; i++) {
+        char c = text[i];
+        out[i] = (c == '"' || c == '\\' || (unsigned char)c < ' ') ? '?' : c;
+    }
+    out[i] = '\0';
+}
+
+static bool field_is(const LoRaRecordField* field, const char* text) {
+    return field->len == strlen(text) && memcmp(field->ptr, text, field->len) == 0;
+}
+
+static bool check_line(const LoRaRecordPacket* packet, const char* line, size_t length) {
+    LoRaRecord record;
+    char expected[LORA_RECORD_TEXT_MAX + 8];
+    uint8_t payload[LORA_RECORD_PAYLOAD_MAX];
+    size_t payload_len = packet->payload_len;
+    if(payload_len > LORA_RECORD_PAYLOAD_MAX) {
+        payload_len = LORA_RECORD_PAYLOAD_MAX;
+    }
+
+    if(length == 0 || line[length - 1] != '\n' || memchr(line, '\n', length - 1)) {
+        return false;
+    }
+    if(!lora_record_parse(line, length - 1, &record)) {
+        return false;
+    }
+
+    snprintf(
+        expected,
+        sizeof(expected),
+        "%04u-%02u-%02u",
+        packet->year % 10000,
+        packet->month % 100,
+        packet->day % 100);
+    if(!field_is(&record.date, expected)) return false;
+    snprintf(
+        expected,
+        sizeof(expected),
+        "%02u:%02u:%02u",
+        packet->hour % 100,
+        packet->minute % 100,
+        packet->second % 100);
+    if(!field_is(&record.time, expected)) return false;
+
+    expected_text(packet->frequency, expected);
+    if(!field_is(&record.frequency, expected)) return false;
+    expected_text(packet->bw, expected);
+    if(!field_is(&record.bw, expected)) return false;
+    expected_text(packet->sf, expected);
+    if(!field_is(&record.sf, expected)) return false;
+
+    snprintf(expected, sizeof(expected), "%d", packet->rssi);
+    if(!field_is(&record.rssi, expected)) return false;
+
+    int32_t decoded =
+        lora_hex_decode(record.payload.ptr, record.payload.len, payload, sizeof(payload));
+    if(decoded != (int32_t)payload_len || memcmp(payload, packet->payload, payload_len) != 0) {
+        return false;
+    }
+
+    const LoRaWANFrame* frame = packet->lorawan;
+    if(!frame) {
+        return record.mtype.ptr == NULL;
+    }
+    if(!field_is(&record.mtype, lora_lorawan_mtype_name(frame->mtype))) return false;
+    if(lora_lorawan_is_data(frame->mtype)) {
+        snprintf(expected, sizeof(expected), "%08X", frame->dev_addr);
+        if(!field_is(&record.devaddr, expected)) return false;
+        snprintf(expected, sizeof(expected), "%02X", frame->fctrl);
+        if(!field_is(&record.fctrl, expected)) return false;
+        snprintf(expected, sizeof(expected), "%u", frame->fcnt);
+        if(!field_is(&record.fcnt, expected)) return false;
+        if(record.fopts.len != LORA_HEX_ENCODED_LEN(frame->fopts_len)) return false;
+        if(frame->fopts_len > 0 &&
+           (lora_hex_decode(record.fopts.ptr, record.fopts.len, payload, sizeof(payload)) !=
+                frame->fopts_len ||
+            memcmp(payload, frame->fopts, frame->fopts_len) != 0)) {
+            return false;
+        }
+        snprintf(expected, sizeof(expected), "%u", frame->fport);
+        return frame->has_port ? field_is(&record.fport, expected) : record.fport.ptr == NULL;
+    }
+    if(frame->mtype == LoRaWANMTypeJoinRequest) {
+        snprintf(expected, sizeof(expected), "%u", frame->dev_nonce);
+        return field_is(&record.devnonce, expected) && record.joineui.len == 16 &&
+               record.deveui.len == 16;
+    }
+    return record.devaddr.ptr == NULL && record.joineui.ptr == NULL;
+}
+
+static int fuzz(unsigned long iterations) {
+    static char buffer[LORA_RECORD_LINE_MAX + GUARD_LEN];
+    char frequency[40], bw[40], sf[40];
+    uint8_t payload[300];
+    LoRaWANFrame frame;
+
+    for(int mtype = 0; mtype < 8; mtype++) {
+        if(strlen(lora_lorawan_mtype_name(mtype)) > LORA_LORAWAN_NAME_MAX) {
+            fprintf(stderr, "%s is longer than LORA_LORAWAN_NAME_MAX\n",
+                    lora_lorawan_mtype_name(mtype));
+            return 1;
+        }
+    }
+
+    for(unsigned long n = 0; n < iterations; n++) {
+        LoRaRecordPacket packet = {
+            .year = rng(),
+            .month = rng(),
+            .day = rng(),
+            .hour = rng(),
+            .minute = rng(),
+            .second = rng(),
+            .frequency = random_text(frequency, sizeof(frequency)),
+            .bw = random_text(bw, sizeof(bw)),
+            .sf = random_text(sf, sizeof(sf)),
+            .rssi = rng(),
+            .payload = payload,
+            .payload_len = rng() % (sizeof(payload) + 1),
+        };
+        for(size_t i = 0; i < packet.payload_len; i++) {
+            payload[i] = rng();
+        }
+        // Half of the packets get a LoRaWAN R1 MHDR, a short FOptsLen keeps most of them valid
+        if(packet.payload_len > 5 && rng() % 2) {
+            payload[0] &= 0xE0;
+            payload[5] &= 0x87;
+        }
+        size_t air_len = packet.payload_len < LORA_RECORD_PAYLOAD_MAX ? packet.payload_len :
+                                                                        LORA_RECORD_PAYLOAD_MAX;
+        if(lora_lorawan_decode(payload, air_len, &frame)) {
+            packet.lorawan = &frame;
+        }
+
+        memset(buffer, GUARD_BYTE, sizeof(buffer));
+        size_t length = lora_record_format(&packet, buffer, LORA_RECORD_LINE_MAX);
+        if(length == 0 || length >= LORA_RECORD_LINE_MAX) {
+            fprintf(stderr, "iteration %lu: length %zu out of bounds\n", n, length);
+            return 1;
+        }
+        for(size_t i = length; i < sizeof(buffer); i++) {
+            if((uint8_t)buffer[i] != GUARD_BYTE) {
+                fprintf(stderr, "iteration %lu: byte %zu written past the line\n", n, i);
+                return 1;
+            }
+        }
+        if(!check_line(&packet, buffer, length)) {
+            fprintf(stderr, "iteration %lu: bad line: %.*s", n, (int)length, buffer);
+            return 1;
+        }
+    }
+
+    // The widest packet must fill the buffer exactly, one byte less must be refused: an
+    // Unconfirmed Data Down with 15 bytes of FOpts, FCnt 65535 and port 255
+    memset(frequency, '9', LORA_RECORD_TEXT_MAX);
+    frequency[LORA_RECORD_TEXT_MAX] = '\0';
+    memset(payload, 0xFF, sizeof(payload));
+    payload[0] = LoRaWANMTypeUnconfirmedDown << 5;
+    payload[5] = LORA_LORAWAN_FOPTS_MAX;
+    if(!lora_lorawan_decode(payload, LORA_RECORD_PAYLOAD_MAX, &frame)) {
+        fprintf(stderr, "widest LoRaWAN frame does not decode\n");
+        return 1;
+    }
+    LoRaRecordPacket widest = {
+        .year = 9999,
+        .month = 12,
+        .day = 31,
+        .frequency = frequency,
+        .bw = frequency,
+        .sf = frequency,
+        .rssi = INT16_MIN,
+        .payload = payload,
+        .payload_len = LORA_RECORD_PAYLOAD_MAX,
+        .lorawan = &frame,
+    };
+    size_t length = lora_record_format(&widest, buffer, LORA_RECORD_LINE_MAX);
+    if(length != LORA_RECORD_LINE_MAX - 1 ||
+       lora_record_format(&widest, buffer, LORA_RECORD_LINE_MAX - 1) != 0) {
+        fprintf(stderr, "widest line is %zu characters, expected %zu\n", length,
+                (size_t)LORA_RECORD_LINE_MAX - 1);
+        return 1;
+    }
+
+    printf("fuzz: %lu lines ok, longest possible line %zu characters\n", iterations, length);
+    return 0;
+}
+
+// The sniffer code before lora_record_format: hex, date and time strings, snprintf, strlen
+static size_t format_snprintf(const LoRaRecordPacket* packet, char* out, size_t out_size) {
+    char payload_hex[LORA_HEX_ENCODED_LEN(LORA_RECORD_PAYLOAD_MAX) + 1];
+    char time_string[12];
+    char date_string[14];
+
+    lora_hex_encode(packet->payload, packet->payload_len, payload_hex, sizeof(payload_hex));
+    snprintf(
+        time_string, sizeof(time_string), "%.2d:%.2d:%.2d", packet->hour, packet->minute,
+        packet->second);
+    snprintf(
+        date_string, sizeof(date_string), "%.4d-%.2d-%.2d", packet->year, packet->month,
+        packet->day);
+    snprintf(
+        out,
+        out_size,
+        "{\"date\":\"%s\", \"time\":\"%s\", \"frequency\":\"%s\", \"bw\":\"%s\", \"sf\":\"%s\", "
+        "\"RSSI\":\"%d\", \"payload\":\"%s\"}",
+        date_string,
+        time_string,
+        packet->frequency,
+        packet->bw,
+        packet->sf,
+        packet->rssi,
+        payload_hex);
+    size_t length = strlen(out);
+    out[length++] = '\n';
+    return length;
+}
+
+static void bench(unsigned long iterations) {
+    static char buffer[1024];
+    static uint8_t payload[LORA_RECORD_PAYLOAD_MAX];
+    static const size_t sizes[] = {12, 51, 255};
+    volatile size_t sink = 0;
+
+    for(size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = rng();
+    }
+
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        LoRaRecordPacket packet = {
+            .year = 2024,
+            .month = 5,
+            .day = 1,
+            .hour = 12,
+            .minute = 0,
+            .second = 3,
+            .frequency = "915.0",
+            .bw = "125 kHz",
+            .sf = "SF8",
+            .rssi = -71,
+            .payload = payload,
+            .payload_len = sizes[s],
+        };
+
+        double start = now_ns();
+        for(unsigned long n = 0; n < iterations; n++) {
+            sink += format_snprintf(&packet, buffer, sizeof(buffer));
+        }
+        double old_ns = (now_ns() - start) / iterations;
+
+        start = now_ns();
+        for(unsigned long n = 0; n < iterations; n++) {
+            sink += lora_record_format(&packet, buffer, sizeof(buffer));
+        }
+        double new_ns = (now_ns() - start) / iterations;
+
+        printf(
+            "bench: %3zu byte payload  snprintf %7.1f ns  lora_record_format %7.1f ns  (%.1fx)\n",
+            sizes[s],
+            old_ns,
+            new_ns,
+            old_ns / new_ns);
+    }
+    (void)sink;
+}
+
+int main(int argc, char** argv) {
+    unsigned long iterations = 200000;
+    int option;
+
+    while((option = getopt(argc, argv, "n:s:")) != -1) {
+        if(!check_option(option, &iterations)) {
+            fprintf(stderr, "usage: %s [-n iterations] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(iterations == 0) {
+        iterations = 1;
+    }
+    if(fuzz(iterations)) {
+        return 1;
+    }
+    bench(iterations);
+    return 0;
+}
@@ -0,0 +1,391 @@
+/*
+Checks the USB streaming path on a computer, with a pseudo-terminal in place of the USB link.
+
+Random packets are framed with the app's encoder, lora_frame.c, and written into the pty the
+way the Flipper writes to its second serial port, in chunks of random size.  Between the frames
+go noise, stray sync bytes, frames with a bad CRC and cut frames, and some sequence numbers are
+skipped like packets dropped on the Flipper.  tools/lora_stream_receive.py reads the other end
+of the pty and must save every good packet, unchanged, to its JSON and pcap files, and report
+each gap in the sequence.
+
+Build from the repository root:
+    cc -O2 -Iapplications_user/lora_app -o lora_stream_check tools/lora_stream_check.c \
+        applications_user/lora_app/lora_frame.c -lutil
+Add -fsanitize=address,undefined -g for the checks.
+
+Usage, from the repository root:
+    lora_stream_check [-n packets] [-s seed] [-p python]
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pty.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host/check.h"
+#include "lora_frame.h"
+
+#define RECEIVER      "tools/lora_stream_receive.py"
+#define PACKETS_MAX   2000
+#define WAIT_MAX_MS   20000 // For the receiver to read everything
+#define LORATAP_LEN   15
+#define PCAP_HEAD_LEN 24
+
+typedef struct {
+    LoRaFrameMeta meta;
+    uint8_t payload[255];
+    uint8_t length;
+    bool gap; // Sequence numbers were skipped before this packet
+} Packet;
+
+static const uint8_t bandwidths[] = {0x00, 0x08, 0x01, 0x09, 0x02, 0x0A, 0x03, 0x04, 0x05, 0x06};
+static const uint32_t bandwidth_hz[] =
+    {7810, 10420, 15630, 20830, 31250, 41670, 62500, 125000, 250000, 500000};
+
+static Packet packets[PACKETS_MAX];
+
+static void random_packet(Packet* packet, uint32_t* sequence, uint32_t* dropped) {
+    packet->gap = rng() % 16 == 0;
+    if(packet->gap) {
+        uint32_t lost = 1 + rng() % 5;
+        *sequence += lost;
+        *dropped += lost;
+    }
+    size_t b = rng() % sizeof(bandwidths);
+    packet->meta = (LoRaFrameMeta){
+        .sequence = (*sequence)++,
+        .dropped = *dropped,
+        .timestamp = 1700000000 + rng() % 100000000,
+        .tick = rng(),
+        .frequency = 150000000 + rng() % 810000001,
+        .bw = bandwidths[b],
+        .sf = 5 + rng() % 8,
+        .cr = 1 + rng() % 4,
+        .snr = (int8_t)(rng() % 50) - 30,
+        .rssi = -(int16_t)(rng() % 140),
+    };
+    packet->length = rng() % 8 ? rng() % 64 : rng() % 256; // Mostly short, like LoRaWAN
+    for(size_t i = 0; i < packet->length; i++) {
+        packet->payload[i] = rng();
+    }
+}
+
+// Write everything, the receiver reads while we write
+static void write_all(int fd, const uint8_t* data, size_t length) {
+    while(length > 0) {
+        ssize_t written = write(fd, data, length);
+        if(written < 0 && errno == EINTR) {
+            continue;
+        }
+        CHECK(written > 0);
+        data += written;
+        length -= written;
+    }
+}
+
+// Frames are not always written whole, the USB link sends them in 64 byte packets
+static void write_chunks(int fd, const uint8_t* data, size_t length) {
+    while(length > 0) {
+        size_t chunk = 1 + rng() % 96;
+        if(chunk > length) {
+            chunk = length;
+        }
+        write_all(fd, data, chunk);
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+// Something the receiver must skip: noise, a lone sync, a bad CRC or a cut frame
+static void write_garbage(int fd) {
+    uint8_t frame[LORA_FRAME_MAX_LEN];
+    Packet junk;
+    uint32_t sequence = 0, dropped = 0;
+    size_t length;
+
+    switch(rng() % 4) {
+    case 0:
+        length = 1 + rng() % 40;
+        for(size_t i = 0; i < length; i++) {
+            frame[i] = rng();
+        }
+        break;
+    case 1:
+        frame[0] = LORA_FRAME_SYNC_0;
+        frame[1] = LORA_FRAME_SYNC_1;
+        length = 2;
+        break;
+    case 2:
+        random_packet(&junk, &sequence, &dropped);
+        length = lora_frame_encode(&junk.meta, junk.payload, junk.length, frame, sizeof(frame));
+        frame[LORA_FRAME_HEAD_LEN + rng() % (length - LORA_FRAME_HEAD_LEN)] ^= 1 << (rng() % 8);
+        break;
+    default:
+        random_packet(&junk, &sequence, &dropped);
+        length = lora_frame_encode(&junk.meta, junk.payload, junk.length, frame, sizeof(frame));
+        length = LORA_FRAME_HEAD_LEN + rng() % (length - LORA_FRAME_HEAD_LEN);
+        break;
+    }
+    write_chunks(fd, frame, length);
+}
+
+static char* read_file(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if(!file) {
+        *length = 0;
+        return calloc(1, 1);
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = malloc(size + 1);
+    CHECK(fread(data, 1, size, file) == (size_t)size);
+    data[size] = '\0';
+    fclose(file);
+    *length = size;
+    return data;
+}
+
+static size_t count_lines(const char* path) {
+    size_t length;
+    char* data = read_file(path, &length);
+    size_t lines = 0;
+    for(size_t i = 0; i < length; i++) {
+        lines += data[i] == '\n';
+    }
+    free(data);
+    return lines;
+}
+
+static void sleep_ms(long ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000};
+    nanosleep(&ts, NULL);
+}
+
+// The JSON line the receiver must write for a packet, as Python's json.dumps
+static void expected_json(const Packet* packet, char* out, size_t out_size) {
+    const LoRaFrameMeta* meta = &packet->meta;
+    uint32_t hz = 0;
+    for(size_t i = 0; i < sizeof(bandwidths); i++) {
+        if(bandwidths[i] == meta->bw) {
+            hz = bandwidth_hz[i];
+        }
+    }
+    int n = snprintf(
+        out,
+        out_size,
+        "{\"sequence\": %u, \"dropped\": %u, \"timestamp\": %u, \"tick\": %u, "
+        "\"frequency\": %u, \"bw\": %u, \"sf\": %u, \"cr\": \"4/%u\", \"snr\": %d, "
+        "\"rssi\": %d, \"payload\": \"",
+        meta->sequence,
+        meta->dropped,
+        meta->timestamp,
+        meta->tick,
+        meta->frequency,
+        hz,
+        meta->sf,
+        meta->cr + 4,
+        meta->snr,
+        meta->rssi);
+    for(size_t i = 0; i < packet->length; i++) {
+        n += snprintf(out + n, out_size - n, "%02X", packet->payload[i]);
+    }
+    snprintf(out + n, out_size - n, "\"}\n");
+}
+
+static void check_json(const char* path, size_t count) {
+    size_t length;
+    char* data = read_file(path, &length);
+    char expected[1024];
+    char* line = data;
+
+    for(size_t i = 0; i < count; i++) {
+        expected_json(&packets[i], expected, sizeof(expected));
+        size_t expected_len = strlen(expected);
+        if(strncmp(line, expected, expected_len) != 0) {
+            char* end = strchr(line, '\n');
+            fprintf(
+                stderr,
+                "packet %zu:\nexpected %sreceived %.*s\n",
+                i,
+                expected,
+                end ? (int)(end - line + 1) : (int)strlen(line),
+                line);
+            exit(1);
+        }
+        line += expected_len;
+    }
+    CHECK(*line == '\0');
+    free(data);
+}
+
+static uint32_t get_u32_le(const uint8_t* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void check_pcap(const char* path, size_t count) {
+    size_t length;
+    uint8_t* data = (uint8_t*)read_file(path, &length);
+    CHECK(length >= PCAP_HEAD_LEN);
+    CHECK(get_u32_le(data) == 0xA1B2C3D4 && get_u32_le(data + 20) == 270); // LoRaTap
+
+    size_t offset = PCAP_HEAD_LEN;
+    for(size_t i = 0; i < count; i++) {
+        const Packet* packet = &packets[i];
+        CHECK(offset + 16 <= length);
+        CHECK(get_u32_le(data + offset) == packet->meta.timestamp);
+        CHECK(get_u32_le(data + offset + 4) == 0); // No sub-second time on the Flipper
+        uint32_t captured = get_u32_le(data + offset + 8);
+        CHECK(captured == LORATAP_LEN + (uint32_t)packet->length);
+        CHECK(get_u32_le(data + offset + 12) == captured);
+        offset += 16;
+
+        const uint8_t* loratap = data + offset;
+        CHECK(offset + captured <= length);
+        uint32_t frequency =
+            (uint32_t)loratap[4] << 24 | loratap[5] << 16 | loratap[6] << 8 | loratap[7];
+        CHECK(frequency == packet->meta.frequency && loratap[9] == packet->meta.sf);
+        CHECK(memcmp(loratap + LORATAP_LEN, packet->payload, packet->length) == 0);
+        offset += captured;
+    }
+    CHECK(offset == length);
+    free(data);
+}
+
+// Every skipped sequence number must be reported, once, before the packet after it
+static void check_gaps(const char* path, size_t count) {
+    size_t length;
+    char* data = read_file(path, &length);
+    char expected[64];
+    size_t gaps = 0;
+
+    for(size_t i = 1; i < count; i++) {
+        if(!packets[i].gap) {
+            continue;
+        }
+        uint32_t missing = packets[i].meta.sequence - packets[i - 1].meta.sequence - 1;
+        snprintf(
+            expected,
+            sizeof(expected),
+            "%u packets missing before %u\n",
+            missing,
+            packets[i].meta.sequence);
+        CHECK(strstr(data, expected) != NULL);
+        gaps++;
+    }
+    CHECK(count_lines(path) == gaps);
+    free(data);
+    printf("ok   %zu gaps reported\n", gaps);
+}
+
+int main(int argc, char** argv) {
+    unsigned long count = 500;
+    const char* python = "python3";
+    int option;
+
+    while((option = getopt(argc, argv, "n:s:p:")) != -1) {
+        if(check_option(option, &count)) {
+            continue;
+        }
+        switch(option) {
+        case 'p':
+            python = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n packets] [-s seed] [-p python]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(count == 0 || count > PACKETS_MAX) {
+        count = PACKETS_MAX;
+    }
+
+    char directory[] = "/tmp/lora_stream_check.XXXXXX";
+    CHECK(mkdtemp(directory) != NULL);
+    char json_path[64], pcap_path[64], log_path[64];
+    snprintf(json_path, sizeof(json_path), "%s/packets.json", directory);
+    snprintf(pcap_path, sizeof(pcap_path), "%s/packets.pcap", directory);
+    snprintf(log_path, sizeof(log_path), "%s/stderr.txt", directory);
+
+    int master, slave;
+    char slave_path[64];
+    struct termios mode;
+    CHECK(openpty(&master, &slave, slave_path, NULL, NULL) == 0);
+
+    pid_t receiver = fork();
+    CHECK(receiver >= 0);
+    if(receiver == 0) {
+        int log = open(log_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        dup2(log, STDERR_FILENO);
+        close(master);
+        close(slave);
+        execlp(
+            python, python, RECEIVER, "--json", json_path, "--pcap", pcap_path, slave_path, NULL);
+        perror(python);
+        _exit(127);
+    }
+
+    // The receiver makes the terminal raw and that flushes what was written before, so wait
+    // for the pty to leave the line mode it starts in
+    long waited = 0;
+    do {
+        sleep_ms(10);
+        waited += 10;
+        CHECK(tcgetattr(slave, &mode) == 0);
+    } while((mode.c_lflag & ICANON) && waited < WAIT_MAX_MS);
+    CHECK(!(mode.c_lflag & ICANON));
+
+    uint8_t frame[LORA_FRAME_MAX_LEN];
+    uint32_t sequence = 0, dropped = 0;
+    for(size_t i = 0; i < count; i++) {
+        random_packet(&packets[i], &sequence, &dropped);
+        if(i == 0) {
+            packets[i].gap = false; // The receiver can only see gaps after the first packet
+        }
+        if(rng() % 4 == 0) {
+            write_garbage(master);
+        }
+        size_t length = lora_frame_encode(
+            &packets[i].meta, packets[i].payload, packets[i].length, frame, sizeof(frame));
+        CHECK(length == (size_t)LORA_FRAME_HEAD_LEN + LORA_FRAME_META_LEN + packets[i].length +
+                            LORA_FRAME_CRC_LEN);
+        write_chunks(master, frame, length);
+    }
+
+    // Closing the master hangs the terminal up, wait until everything was read first
+    for(waited = 0; count_lines(json_path) < count && waited < WAIT_MAX_MS; waited += 10) {
+        sleep_ms(10);
+    }
+    close(slave);
+    close(master);
+    int status;
+    CHECK(waitpid(receiver, &status, 0) == receiver);
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        size_t length;
+        char* log = read_file(log_path, &length);
+        fprintf(stderr, "receiver failed:\n%s", log);
+        free(log);
+        return 1;
+    }
+
+    check_json(json_path, count);
+    printf("ok   %lu packets saved as JSON\n", count);
+    check_pcap(pcap_path, count);
+    printf("ok   %lu packets saved as pcap\n", count);
+    check_gaps(log_path, count);
+
+    unlink(json_path);
+    unlink(pcap_path);
+    unlink(log_path);
+    rmdir(directory);
+    return 0;
+}
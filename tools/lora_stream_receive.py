@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""Receive the packets streamed by the LoRa app over USB and save them.
+
+Usage: lora_stream_receive.py [--pcap FILE] [--json FILE] PORT
+
+Turn "USB Stream" on in the app configuration, then point PORT at the second
+serial port the Flipper shows (for example /dev/ttyACM1 on Linux).  Without
+--pcap or --json, packets are printed as JSON lines.  The pcap file uses the
+LoRaTap link type and opens in Wireshark.
+
+PORT can be any file or terminal, so the receiver can be tried without a
+Flipper on a pseudo-terminal pair:
+    socat -d -d pty,raw,echo=0 pty,raw,echo=0      # prints the two /dev/pts names
+    lora_stream_receive.py /dev/pts/A
+    cat frames.bin > /dev/pts/B
+
+The frame layout is described in applications_user/lora_app/lora_frame.h.
+"""
+
+import argparse
+import errno
+import json
+import os
+import struct
+import sys
+import tty
+
+SYNC = b"\xa5\x5a"
+TYPE_PACKET = 0x01
+META = struct.Struct("<BIIIIIBBBbh")
+CRC_LEN = 2
+MAX_BODY = META.size + 255
+
+LINKTYPE_LORATAP = 270
+BANDWIDTH_HZ = {
+    0x00: 7810,
+    0x08: 10420,
+    0x01: 15630,
+    0x09: 20830,
+    0x02: 31250,
+    0x0A: 41670,
+    0x03: 62500,
+    0x04: 125000,
+    0x05: 250000,
+    0x06: 500000,
+}
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as lora_frame_crc16."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+class FrameReader:
+    """Finds frames in a byte stream, skipping noise and frames with a bad CRC."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.bad_frames = 0
+
+    def packets(self, data):
+        """Add received bytes, return the packets completed by them."""
+        self.buffer += data
+        packets = []
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                del self.buffer[:-1]  # Keep a possible first sync byte
+                return packets
+            del self.buffer[:start]
+            if len(self.buffer) < 4:
+                return packets
+            (length,) = struct.unpack_from("<H", self.buffer, 2)
+            end = 4 + length + CRC_LEN
+            if META.size <= length <= MAX_BODY and len(self.buffer) < end:
+                return packets  # Wait for the rest of the frame
+            body = bytes(self.buffer[4 : 4 + length])
+            if length < META.size or length > MAX_BODY or (
+                struct.unpack_from("<H", self.buffer, 4 + length)[0] != crc16(body)
+            ):
+                self.bad_frames += 1
+                del self.buffer[:1]  # Not a frame, look for the next sync
+                continue
+            del self.buffer[:end]
+            packet = decode_body(body)
+            if packet is not None:
+                packets.append(packet)
+
+
+def decode_body(body):
+    fields = META.unpack_from(body)
+    kind, sequence, dropped, timestamp, tick, frequency, bw, sf, cr, snr, rssi = fields
+    if kind != TYPE_PACKET:
+        return None
+    return {
+        "sequence": sequence,
+        "dropped": dropped,
+        "timestamp": timestamp,
+        "tick": tick,
+        "frequency": frequency,
+        "bw": BANDWIDTH_HZ.get(bw, 0),
+        "sf": sf,
+        "cr": "4/%d" % (cr + 4),
+        "snr": snr,
+        "rssi": rssi,
+        "payload": body[META.size :].hex().upper(),
+    }
+
+
+class PcapWriter:
+    def __init__(self, f):
+        self.f = f
+        f.write(struct.pack("<IHHiIII", 0xA1B2C3D4, 2, 4, 0, 0, 65535, LINKTYPE_LORATAP))
+
+    def write(self, packet):
+        payload = bytes.fromhex(packet["payload"])
+        # LoRaTap version 0 header, big endian
+        loratap = struct.pack(
+            ">BBHIBBBBBbB",
+            0,
+            0,
+            15,
+            packet["frequency"],
+            packet["bw"] // 125000,
+            packet["sf"],
+            max(0, min(255, packet["rssi"] + 139)),
+            max(0, min(255, packet["rssi"] + 139)),
+            0,
+            max(-128, min(127, packet["snr"] * 4)),
+            0,
+        )
+        frame = loratap + payload
+        # The RTC only gives whole seconds, the tick is not aligned with them
+        self.f.write(struct.pack("<IIII", packet["timestamp"], 0, len(frame), len(frame)))
+        self.f.write(frame)
+        self.f.flush()
+
+
+def open_port(path):
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    if os.isatty(fd):
+        tty.setraw(fd)  # Binary frames, no line editing or echo
+    return fd
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description="Save packets streamed by the LoRa app.")
+    parser.add_argument("port", help="serial port, terminal or file to read")
+    parser.add_argument("--pcap", help="write a LoRaTap pcap file")
+    parser.add_argument("--json", help="write JSON lines to a file")
+    args = parser.parse_args(argv[1:])
+
+    pcap = PcapWriter(open(args.pcap, "wb")) if args.pcap else None
+    out = open(args.json, "a") if args.json else (None if pcap else sys.stdout)
+
+    reader = FrameReader()
+    fd = open_port(args.port)
+    last_sequence = None
+    try:
+        while True:
+            try:
+                data = os.read(fd, 4096)
+            except OSError as e:
+                if e.errno != errno.EIO:
+                    raise
+                break  # The Flipper was unplugged, or the other end of a pty closed
+            if not data:
+                break
+            for packet in reader.packets(data):
+                if last_sequence is not None and packet["sequence"] != last_sequence + 1:
+                    missing = packet["sequence"] - last_sequence - 1
+                    sys.stderr.write(
+                        "%d packets missing before %d\n" % (missing, packet["sequence"])
+                    )
+                last_sequence = packet["sequence"]
+                if pcap:
+                    pcap.write(packet)
+                if out:
+                    out.write(json.dumps(packet) + "\n")
+                    out.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        os.close(fd)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
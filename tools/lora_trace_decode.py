@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""Decode an SPI trace dumped by the LoRa app (apps_data/lora/spi_trace.bin).
+
+Usage: lora_trace_decode.py spi_trace.bin
+
+The file layout is described by LoRaTraceHeader and LoRaTraceEntry in
+applications_user/lora_app/lora_trace.h.
+"""
+
+import struct
+import sys
+
+HEADER = struct.Struct("<4sHHIII")
+ENTRY = struct.Struct("<IIHBB4s")
+MAGIC = b"LTRC"
+VERSION = 1
+
+# SX126x opcodes, datasheet section 11
+OPCODES = {
+    0x02: "ClearIrqStatus",
+    0x08: "SetDioIrqParams",
+    0x0D: "WriteRegister",
+    0x0E: "WriteBuffer",
+    0x13: "GetRxBufferStatus",
+    0x14: "GetPacketStatus",
+    0x1D: "ReadRegister",
+    0x1E: "ReadBuffer",
+    0x80: "SetStandby",
+    0x82: "SetRx",
+    0x83: "SetTx",
+    0x86: "SetRfFrequency",
+    0x8A: "SetPacketType",
+    0x8B: "SetModulationParams",
+    0x8C: "SetPacketParams",
+    0x8E: "SetTxParams",
+    0x8F: "SetBufferBaseAddress",
+    0x95: "SetPaConfig",
+    0x96: "SetRegulatorMode",
+    0x97: "SetDIO3AsTcxoCtrl",
+    0x98: "CalibrateImage",
+    0x9D: "SetDIO2AsRfSwitchCtrl",
+    0xC0: "GetStatus",
+}
+
+CHIP_MODES = {2: "STBY_RC", 3: "STBY_XOSC", 4: "FS", 5: "RX", 6: "TX"}
+COMMAND_STATUS = {
+    2: "data available",
+    3: "timeout",
+    4: "processing error",
+    5: "failure",
+    6: "TX done",
+}
+
+
+def describe_status(status):
+    mode = CHIP_MODES.get((status >> 4) & 0x07, "mode %d" % ((status >> 4) & 0x07))
+    command = (status >> 1) & 0x07
+    return "%s, %s" % (mode, COMMAND_STATUS.get(command, "cmd %d" % command))
+
+
+def describe(opcode, length, data):
+    """A short text for the bytes kept with a transaction."""
+    if opcode == 0xC0:
+        return describe_status(data[0])
+    if opcode == 0x13:
+        return "%s, length %d at 0x%02X" % (describe_status(data[0]), data[1], data[2])
+    if opcode == 0x14:
+        return "RSSI %d dBm, SNR %d dB, signal %d dBm" % (
+            -data[1] / 2,
+            struct.unpack("b", bytes([data[2]]))[0] / 4,
+            -data[3] / 2,
+        )
+    if opcode == 0x1D:
+        values = " ".join("%02X" % b for b in data[2 : 2 + max(0, min(2, length - 3))])
+        return "0x%02X%02X = %s" % (data[0], data[1], values)
+    if opcode == 0x0D:
+        return "0x%02X%02X = %02X" % (data[0], data[1], data[2])
+    if opcode == 0x86 and length >= 4:
+        pll = int.from_bytes(data, "big")
+        return "%.4f MHz" % (pll * 32e6 / (1 << 25) / 1e6)
+    if opcode in (0x0E, 0x1E):
+        # The offset byte(s) are counted in length, the payload is kept in their place
+        payload = length - (1 if opcode == 0x0E else 2)
+        shown = " ".join("%02X" % b for b in data[: max(0, min(4, payload))])
+        return "%d byte payload %s" % (payload, shown)
+    return " ".join("%02X" % b for b in data[: min(4, length)])
+
+
+def decode(blob, out):
+    if len(blob) < HEADER.size:
+        raise ValueError("file too short for a trace header")
+    magic, version, entry_size, count, dropped, cycles_per_us = HEADER.unpack_from(blob)
+    if magic != MAGIC or version != VERSION or entry_size != ENTRY.size:
+        raise ValueError("not a version %d SPI trace" % VERSION)
+    if len(blob) < HEADER.size + count * ENTRY.size:
+        raise ValueError("file truncated, %d entries expected" % count)
+
+    out.write("%d transactions, %d older ones dropped\n" % (count, dropped))
+    out.write("%12s %10s %8s  %-22s %4s  %s\n" % ("tick ms", "+us", "busy us", "command", "len", ""))
+
+    previous = None
+    for i in range(count):
+        tick, cycles, busy_us, opcode, length, data = ENTRY.unpack_from(
+            blob, HEADER.size + i * ENTRY.size
+        )
+        # The cycle counter wraps after a minute, use it only between close entries
+        delta = ""
+        if previous is not None and tick - previous[0] < 30000:
+            delta = "%d" % (((cycles - previous[1]) & 0xFFFFFFFF) // max(1, cycles_per_us))
+        previous = (tick, cycles)
+
+        name = OPCODES.get(opcode, "0x%02X" % opcode)
+        out.write(
+            "%12d %10s %8s  %-22s %4d  %s\n"
+            % (tick, delta, busy_us or "", name, length, describe(opcode, length, data))
+        )
+
+
+def main(argv):
+    if len(argv) != 2:
+        sys.stderr.write(__doc__)
+        return 2
+    with open(argv[1], "rb") as f:
+        blob = f.read()
+    try:
+        decode(blob, sys.stdout)
+    except ValueError as e:
+        sys.stderr.write("%s: %s\n" % (argv[1], e))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
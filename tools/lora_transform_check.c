@@ -0,0 +1,206 @@
+/*
+Checks the replay payload transforms of the app, lora_transform.c, on a computer.
+
+Every stage runs on fixed payloads with fixed seeds and must produce the bytes listed here, so a
+change to the random generator or to how a stage draws from it shows up as a failure instead of
+silently changing what a replay sends.  The parser must take every line the format allows and
+refuse malformed ones, numbers that don't fit included.
+
+Build from the repository root:
+    cc -O2 -Iapplications_user/lora_app -o lora_transform_check tools/lora_transform_check.c \
+        applications_user/lora_app/lora_transform.c applications_user/lora_app/lora_hex.c
+Add -fsanitize=address,undefined -g for the checks.
+
+Usage:
+    lora_transform_check
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host/check.h"
+#include "lora_transform.h"
+
+static LoRaTransformPipeline pipeline;
+
+// Clear the pipeline and add lines from a NULL terminated list, all of which must parse
+static void load(const char* const* lines) {
+    lora_transform_clear(&pipeline);
+    for(; *lines; lines++) {
+        if(!lora_transform_parse_line(&pipeline, *lines, strlen(*lines))) {
+            fprintf(stderr, "'%s' refused\n", *lines);
+            exit(1);
+        }
+    }
+}
+
+static bool parses(const char* line) {
+    lora_transform_clear(&pipeline);
+    return lora_transform_parse_line(&pipeline, line, strlen(line));
+}
+
+// Transform one packet and compare it with the expected bytes
+static void expect(
+    const uint8_t* payload,
+    size_t length,
+    const uint8_t* expected,
+    size_t expected_length) {
+    uint8_t data[255];
+    memcpy(data, payload, length);
+    size_t result = lora_transform_apply(&pipeline, data, length);
+    if(result != expected_length || memcmp(data, expected, expected_length) != 0) {
+        fprintf(stderr, "got %zu bytes:", result);
+        for(size_t i = 0; i < result; i++) {
+            fprintf(stderr, " %02X", data[i]);
+        }
+        fprintf(stderr, "\n");
+        exit(1);
+    }
+}
+
+static void check_random(void) {
+    // The low byte of the first words of xorshift32 (13, 17, 5), from the default seed and 1
+    static const uint8_t from_default[] = {0x3A, 0xAB, 0xAC, 0x26, 0xAF, 0x23, 0x1A, 0x71};
+    static const uint8_t from_one[] = {0x21, 0x01, 0xC5, 0x4F, 0xD1, 0xD0, 0x1A, 0xB2};
+    const uint8_t zero = 0;
+
+    // A one byte mutation of a one byte payload writes the low byte of one word per packet
+    load((const char*[]){"mutate-bytes 1", NULL});
+    for(size_t i = 0; i < sizeof(from_default); i++) {
+        expect(&zero, 1, &from_default[i], 1);
+    }
+
+    load((const char*[]){"seed 1", "mutate-bytes 1", NULL});
+    for(size_t i = 0; i < sizeof(from_one); i++) {
+        expect(&zero, 1, &from_one[i], 1);
+    }
+
+    // Reset goes back to the first word, seed 0 falls back to the default seed
+    lora_transform_reset(&pipeline);
+    expect(&zero, 1, &from_one[0], 1);
+    load((const char*[]){"seed 0", "mutate-bytes 1", NULL});
+    expect(&zero, 1, &from_default[0], 1);
+
+    printf("ok   random sequence\n");
+}
+
+static void check_stages(void) {
+    static const uint8_t ramp[] = {0, 1, 2, 3, 4, 5, 6, 7};
+    static const uint8_t zeros[16] = {0};
+
+    load((const char*[]){"patch 2 DEADBEEF", NULL});
+    expect(ramp, 8, (const uint8_t[]){0, 1, 0xDE, 0xAD, 0xBE, 0xEF, 6, 7}, 8);
+    expect(ramp, 4, (const uint8_t[]){0, 1, 0xDE, 0xAD}, 4); // Clipped to the payload
+    expect(ramp, 2, ramp, 2); // Starts past the end
+
+    // The field is read from every packet, the step adds once more per packet already sent
+    static const uint8_t field[] = {0xAA, 0xF0, 0xFF, 0xBB};
+    load((const char*[]){"counter 1 2 0x10 3", NULL});
+    expect(field, 4, (const uint8_t[]){0xAA, 0x00, 0x00, 0xBB}, 4);
+    expect(field, 4, (const uint8_t[]){0xAA, 0x03, 0x00, 0xBB}, 4);
+    expect(field, 4, (const uint8_t[]){0xAA, 0x06, 0x00, 0xBB}, 4);
+    expect(field, 2, field, 2); // Doesn't fit, left alone
+    load((const char*[]){"counter 0 1 -1", NULL});
+    expect(zeros, 1, (const uint8_t[]){0xFF}, 1);
+    load((const char*[]){"counter 0 4 -2147483648", NULL});
+    expect(zeros, 4, (const uint8_t[]){0x00, 0x00, 0x00, 0x80}, 4);
+
+    load((const char*[]){"seed 0x1234", "mutate-bytes 4 2", NULL});
+    expect(
+        zeros,
+        16,
+        (const uint8_t[]){0, 0, 0x2E, 0xF7, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xF3, 0, 0},
+        16);
+
+    load((const char*[]){"seed 42", "mutate-bits 5 1", NULL});
+    expect(zeros, 8, (const uint8_t[]){0, 0, 0, 0, 0x18, 0x01, 0x10, 0x01}, 8);
+
+    load((const char*[]){"truncate 3", NULL});
+    expect(ramp, 8, ramp, 3);
+    expect(ramp, 2, ramp, 2);
+
+    // Stages run in order, the patch is cut by the truncate that follows it
+    load((const char*[]){"patch 0 FFFF", "truncate 1", "counter 0 1 1", NULL});
+    expect(ramp, 8, (const uint8_t[]){0x00}, 1);
+
+    printf("ok   stages\n");
+}
+
+static void check_parse(void) {
+    static const char* const accepted[] = {
+        "",
+        "   \r",
+        "# comment",
+        "seed 4294967295",
+        "seed 0xFFFFFFFF",
+        "counter 0 4 2147483647",
+        "counter 0 4 -0x80000000 -1",
+        "patch 255 00",
+        "mutate-bytes 255 255",
+        "truncate\t0 # comment",
+    };
+    static const char* const refused[] = {
+        "seed",
+        "seed -1",
+        "seed 4294967296",
+        "seed 0x100000000",
+        "counter 0 2 4294967296", // Used to wrap around to 0
+        "counter 0 2 2147483648",
+        "counter 0 2 -2147483649",
+        "counter 0 2 0x80000000",
+        "counter 0 2 1 99999999999",
+        "counter 0 0 1",
+        "counter 0 5 1",
+        "counter 0 2",
+        "patch 256 00",
+        "patch 0 0",
+        "patch 0 GG",
+        "patch 0 00112233445566778899AABBCCDDEEFF00",
+        "mutate-bytes",
+        "mutate-bits 1 2 3",
+        "truncate -1",
+        "truncate 0x",
+        "truncate 1x",
+        "reverse 1",
+        "counter 0 1 1 1 1 1",
+    };
+
+    for(size_t i = 0; i < sizeof(accepted) / sizeof(accepted[0]); i++) {
+        if(!parses(accepted[i])) {
+            fprintf(stderr, "'%s' refused\n", accepted[i]);
+            exit(1);
+        }
+    }
+    for(size_t i = 0; i < sizeof(refused) / sizeof(refused[0]); i++) {
+        if(parses(refused[i])) {
+            fprintf(stderr, "'%s' accepted\n", refused[i]);
+            exit(1);
+        }
+        CHECK(pipeline.count == 0);
+    }
+
+    // Lines are not NULL terminated, a number must stop at the given length
+    lora_transform_clear(&pipeline);
+    CHECK(lora_transform_parse_line(&pipeline, "truncate 12345", 11));
+    CHECK(pipeline.count == 1 && pipeline.stages[0].length == 12);
+
+    // A full pipeline refuses more stages but still takes a seed
+    lora_transform_clear(&pipeline);
+    for(int i = 0; i < LORA_TRANSFORM_MAX_STAGES; i++) {
+        CHECK(lora_transform_parse_line(&pipeline, "truncate 1", 10));
+    }
+    CHECK(!lora_transform_parse_line(&pipeline, "truncate 1", 10));
+    CHECK(lora_transform_parse_line(&pipeline, "seed 7", 6) && pipeline.seed == 7);
+
+    printf("ok   parser\n");
+}
+
+int main(void) {
+    check_random();
+    check_stages();
+    check_parse();
+    return 0;
+}